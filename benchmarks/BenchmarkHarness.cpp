@@ -0,0 +1,33 @@
+#include "BenchmarkHarness.hpp"
+
+#include <algorithm>
+#include <omp.h>
+
+namespace RtEngine {
+	double BenchmarkHarness::millisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	BenchmarkHarness::FrameTimes BenchmarkHarness::measureFrames(uint32_t frame_count,
+																 const std::function<void()> &frame) {
+		FrameTimes times;
+		for (uint32_t i = 0; i < frame_count; i++) {
+			const auto start = Clock::now();
+			frame();
+			const double ms = millisecondsSince(start);
+			times.mean_ms += ms;
+			times.max_ms = std::max(times.max_ms, ms);
+		}
+		times.mean_ms /= std::max(frame_count, 1u);
+		return times;
+	}
+
+	BenchmarkHarness::FrameTimes BenchmarkHarness::measureFrames(uint32_t frame_count, int thread_count,
+																 const std::function<void()> &frame) {
+		const int previous_thread_count = omp_get_max_threads();
+		omp_set_num_threads(thread_count);
+		const FrameTimes times = measureFrames(frame_count, frame);
+		omp_set_num_threads(previous_thread_count);
+		return times;
+	}
+} // namespace RtEngine
@@ -0,0 +1,29 @@
+#ifndef BENCHMARKHARNESS_HPP
+#define BENCHMARKHARNESS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace RtEngine {
+	// timing shared by the cpu benchmarks
+	class BenchmarkHarness {
+		BenchmarkHarness() = delete;
+
+	public:
+		using Clock = std::chrono::high_resolution_clock;
+
+		struct FrameTimes {
+			double mean_ms = 0.0;
+			double max_ms = 0.0;
+		};
+
+		static double millisecondsSince(Clock::time_point start);
+		// calls frame frame_count times and times every call
+		static FrameTimes measureFrames(uint32_t frame_count, const std::function<void()> &frame);
+		// same on thread_count openmp threads, the previous thread count is restored afterwards
+		static FrameTimes measureFrames(uint32_t frame_count, int thread_count, const std::function<void()> &frame);
+	};
+} // namespace RtEngine
+
+#endif // BENCHMARKHARNESS_HPP
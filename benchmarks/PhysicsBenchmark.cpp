@@ -0,0 +1,80 @@
+#include "PhysicsBenchmark.hpp"
+
+#include <MeshRenderer.hpp>
+#include <Node.hpp>
+#include <PhysicsSystem.hpp>
+#include <Rigidbody.hpp>
+#include <Scene.hpp>
+#include <omp.h>
+#include <random>
+#include <spdlog/spdlog.h>
+
+#include "BenchmarkHarness.hpp"
+
+namespace RtEngine {
+	namespace {
+		std::shared_ptr<Node> createBoxNode(const std::string &name, const std::shared_ptr<MeshAsset> &box,
+											const glm::vec3 &position, const glm::vec3 &scale) {
+			auto node = std::make_shared<Node>();
+			node->name = name;
+			node->transform->decomposed_transform = {position, glm::vec3(0.0f), scale};
+			// never started, the renderer only gives the physics the bounds of the node
+			auto mesh_renderer = std::make_shared<MeshRenderer>(nullptr, node);
+			mesh_renderer->mesh_asset = box;
+			node->addComponent(mesh_renderer);
+			return node;
+		}
+	} // namespace
+
+	void PhysicsBenchmark::run(uint32_t body_count, uint32_t frame_count) {
+		auto box = std::make_shared<MeshAsset>();
+		box->bounding_box = Aabb{glm::vec3(-1.0f), glm::vec3(1.0f)};
+
+		Scene scene("", nullptr);
+		auto root = std::make_shared<Node>();
+		root->name = Scene::ROOT_NODE_NAME;
+		scene.addNode(root);
+
+		auto ground = createBoxNode("ground", box, glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(200.0f, 1.0f, 200.0f));
+		ground->parent = root;
+		root->children.push_back(ground);
+		scene.addNode(ground);
+
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> horizontal(-190.0f, 190.0f), height(1.0f, 60.0f);
+		for (uint32_t i = 0; i < body_count; i++) {
+			auto body = createBoxNode("body_" + std::to_string(i), box,
+									  glm::vec3(horizontal(random), height(random), horizontal(random)), glm::vec3(0.2f));
+			body->addComponent(std::make_shared<Rigidbody>(body, 9.81f));
+			body->parent = root;
+			root->children.push_back(body);
+			scene.addNode(body);
+		}
+		scene.refreshTransforms();
+
+		const auto rebuild_start = BenchmarkHarness::Clock::now();
+		PhysicsSystem physics;
+		physics.rebuild(scene.getComponentPools());
+		const double rebuild_ms = BenchmarkHarness::millisecondsSince(rebuild_start);
+
+		// the bodies keep falling over both runs, the second half of the frames has more of them resting
+		const int max_threads = omp_get_max_threads();
+		const auto serial = BenchmarkHarness::measureFrames(frame_count, 1, [&]() { physics.step(); });
+		const auto parallel = BenchmarkHarness::measureFrames(frame_count, max_threads, [&]() { physics.step(); });
+
+		uint32_t landed = 0;
+		for (uint32_t i = 0; i < body_count; i++) {
+			landed += scene.getNode(i + 2)->transform->decomposed_transform.translation.y <= 0.21f;
+		}
+
+		spdlog::info("Physics benchmark, {} bodies, {} static bounds, {} frames per run, rebuild {:.2f} ms",
+					 physics.size(), physics.getStaticCount(), frame_count, rebuild_ms);
+		spdlog::info("  step, 1 thread:   {:.3f} ms/frame, max {:.3f} ms", serial.mean_ms, serial.max_ms);
+		spdlog::info("  step, {:>2} threads: {:.3f} ms/frame, max {:.3f} ms", max_threads, parallel.mean_ms,
+					 parallel.max_ms);
+		spdlog::info("  {} bodies landed, {} contacts in the last step", landed, physics.getContactCount());
+		auto verdict = [](double ms) { return ms < TARGET_STEP_MS ? "within" : "over"; };
+		spdlog::info("  target {:.1f} ms/frame for 50k bodies: 1 thread {}, {} threads {}", TARGET_STEP_MS,
+					 verdict(serial.mean_ms), max_threads, verdict(parallel.mean_ms));
+	}
+} // namespace RtEngine
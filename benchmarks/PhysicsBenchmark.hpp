@@ -0,0 +1,21 @@
+#ifndef PHYSICSBENCHMARK_HPP
+#define PHYSICSBENCHMARK_HPP
+
+#include <cstdint>
+
+namespace RtEngine {
+	// times the physics step on a generated scene of boxes falling onto a ground box
+	class PhysicsBenchmark {
+		PhysicsBenchmark() = delete;
+
+	public:
+		// a step on 50k bodies should take well under this
+		static constexpr double TARGET_STEP_MS = 1.0;
+
+		// body_count boxes start at random heights, the step is measured on one and on all threads and compared
+		// with TARGET_STEP_MS
+		static void run(uint32_t body_count, uint32_t frame_count);
+	};
+} // namespace RtEngine
+
+#endif // PHYSICSBENCHMARK_HPP
@@ -0,0 +1,100 @@
+#include "PickingBenchmark.hpp"
+
+#include <InstanceBvh.hpp>
+#include <MeshRenderer.hpp>
+#include <Node.hpp>
+#include <Scene.hpp>
+#include <random>
+#include <spdlog/spdlog.h>
+
+#include "BenchmarkHarness.hpp"
+
+namespace RtEngine {
+	void PickingBenchmark::run(uint32_t instance_count, uint32_t query_count) {
+		auto box = std::make_shared<MeshAsset>();
+		box->bounding_box = Aabb{glm::vec3(-1.0f), glm::vec3(1.0f)};
+
+		Scene scene("", nullptr);
+		auto root = std::make_shared<Node>();
+		root->name = Scene::ROOT_NODE_NAME;
+		scene.addNode(root);
+
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(-500.0f, 500.0f), scale(0.2f, 2.0f), unit(-1.0f, 1.0f);
+		for (uint32_t i = 0; i < instance_count; i++) {
+			auto node = std::make_shared<Node>();
+			node->name = "box_" + std::to_string(i);
+			node->transform->decomposed_transform = {
+					glm::vec3(position(random), position(random) * 0.1f, position(random)),
+					glm::vec3(unit(random), unit(random), unit(random)), glm::vec3(scale(random))};
+			// never started, the bvh only needs the bounds of the mesh
+			auto mesh_renderer = std::make_shared<MeshRenderer>(nullptr, node);
+			mesh_renderer->mesh_asset = box;
+			node->addComponent(mesh_renderer);
+			node->parent = root;
+			root->children.push_back(node);
+			scene.addNode(node);
+		}
+		scene.refreshTransforms();
+		scene.getComponentPools();
+
+		auto start = BenchmarkHarness::Clock::now();
+		const InstanceBvh &bvh = scene.getInstanceBvh();
+		const double rebuild_ms = BenchmarkHarness::millisecondsSince(start);
+
+		// rays from above the field towards random points on it, boxes of a few units around random points
+		std::vector<glm::vec3> origins, directions;
+		std::vector<Aabb> boxes;
+		for (uint32_t i = 0; i < query_count; i++) {
+			const glm::vec3 origin(position(random), 100.0f, position(random));
+			const glm::vec3 target(position(random), 0.0f, position(random));
+			origins.push_back(origin);
+			directions.push_back(glm::normalize(target - origin));
+			const glm::vec3 center(position(random), 0.0f, position(random));
+			boxes.push_back(Aabb{center - glm::vec3(5.0f), center + glm::vec3(5.0f)});
+		}
+
+		auto measure = [&](uint32_t *hit_count, size_t *found_count) {
+			*hit_count = 0;
+			InstancePick pick;
+			start = BenchmarkHarness::Clock::now();
+			for (uint32_t i = 0; i < query_count; i++) {
+				*hit_count += bvh.pick(origins[i], directions[i], &pick);
+			}
+			const double pick_ms = BenchmarkHarness::millisecondsSince(start) / std::max(query_count, 1u);
+
+			std::vector<InstanceRef> found;
+			start = BenchmarkHarness::Clock::now();
+			for (uint32_t i = 0; i < query_count; i++) {
+				bvh.queryBox(boxes[i], found);
+			}
+			*found_count = found.size();
+			return std::make_pair(pick_ms, BenchmarkHarness::millisecondsSince(start) / std::max(query_count, 1u));
+		};
+
+		uint32_t hits;
+		size_t found;
+		const auto [pick_ms, box_ms] = measure(&hits, &found);
+
+		spdlog::info("Picking benchmark, {} instances, {} bvh nodes, {} queries per run, rebuild {:.2f} ms", bvh.size(),
+					 bvh.getNodeCount(), query_count, rebuild_ms);
+		spdlog::info("  built:  pick {:.4f} ms, box query {:.4f} ms, {} rays hit, {} instances in boxes", pick_ms,
+					 box_ms, hits, found);
+
+		// every tenth box moves, the refit happens when the bvh is asked for next
+		for (uint32_t i = 0; i < instance_count; i += 10) {
+			std::shared_ptr<Node> node = scene.getNode(i + 1);
+			node->transform->decomposed_transform.translation += glm::vec3(unit(random), unit(random), unit(random));
+			node->transform->markDirty();
+		}
+		scene.refreshTransforms();
+		start = BenchmarkHarness::Clock::now();
+		scene.getInstanceBvh();
+		const double refit_ms = BenchmarkHarness::millisecondsSince(start);
+
+		const auto [refit_pick_ms, refit_box_ms] = measure(&hits, &found);
+		spdlog::info("  refit {:.2f} ms after {} moves: pick {:.4f} ms, box query {:.4f} ms, {} rays hit, "
+					 "{} instances in boxes",
+					 refit_ms, (instance_count + 9) / 10, refit_pick_ms, refit_box_ms, hits, found);
+	}
+} // namespace RtEngine
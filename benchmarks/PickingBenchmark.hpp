@@ -0,0 +1,17 @@
+#ifndef PICKINGBENCHMARK_HPP
+#define PICKINGBENCHMARK_HPP
+
+#include <cstdint>
+
+namespace RtEngine {
+	// times the instance bvh of a generated scene of scattered boxes
+	class PickingBenchmark {
+		PickingBenchmark() = delete;
+
+	public:
+		// query_count rays and boxes are measured on the built tree and again after a share of the boxes moved
+		static void run(uint32_t instance_count, uint32_t query_count);
+	};
+} // namespace RtEngine
+
+#endif // PICKINGBENCHMARK_HPP
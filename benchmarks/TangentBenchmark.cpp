@@ -0,0 +1,105 @@
+#include "TangentBenchmark.hpp"
+
+#include <TangentGenerator.hpp>
+#include <algorithm>
+#include <omp.h>
+#include <spdlog/spdlog.h>
+
+#include "BenchmarkHarness.hpp"
+
+namespace RtEngine {
+	namespace {
+		struct Grid {
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		// upright uvs with their origin in the top left corner, u is mirrored at the center line
+		Grid createGrid(uint32_t quads_per_side) {
+			const uint32_t n = std::max(quads_per_side, 2u);
+			const float center = static_cast<float>(n / 2);
+			Grid grid;
+			grid.vertices.reserve((n + 1) * (n + 1));
+			for (uint32_t y = 0; y <= n; y++) {
+				for (uint32_t x = 0; x <= n; x++) {
+					Vertex vertex{};
+					vertex.pos = glm::vec3(x, y, 0.0f);
+					vertex.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+					vertex.tangent = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+					vertex.color = glm::vec3(1.0f);
+					vertex.texCoord = glm::vec3(std::abs(static_cast<float>(x) - center) / n, 1.0f - 1.0f * y / n, 0.0f);
+					grid.vertices.push_back(vertex);
+				}
+			}
+			grid.indices.reserve(6 * n * n);
+			for (uint32_t y = 0; y < n; y++) {
+				for (uint32_t x = 0; x < n; x++) {
+					const uint32_t a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+					grid.indices.insert(grid.indices.end(), {a, b, d, a, d, c});
+				}
+			}
+			return grid;
+		}
+
+		// the left half has to point along -x with a negative sign, the right half along +x with a positive one
+		uint32_t countWrongCorners(const Grid &grid, uint32_t quads_per_side) {
+			const float center = static_cast<float>(std::max(quads_per_side, 2u) / 2);
+			uint32_t wrong = 0;
+			for (size_t t = 0; t < grid.indices.size() / 3; t++) {
+				const uint32_t *triangle = &grid.indices[3 * t];
+				const float centroid_x = (grid.vertices[triangle[0]].pos.x + grid.vertices[triangle[1]].pos.x +
+										  grid.vertices[triangle[2]].pos.x) / 3.0f;
+				const float expected = centroid_x < center ? -1.0f : 1.0f;
+				for (uint32_t c = 0; c < 3; c++) {
+					const glm::vec4 &tangent = grid.vertices[triangle[c]].tangent;
+					if (std::abs(tangent.x - expected) > 1e-4f || tangent.w != expected) {
+						wrong++;
+					}
+				}
+			}
+			return wrong;
+		}
+
+		// generation works in place, so every frame starts from a fresh copy that is not timed
+		double measureTrianglesPerSecond(const Grid &source, uint32_t frame_count, int thread_count, Grid *result) {
+			const int previous_threads = omp_get_max_threads();
+			omp_set_num_threads(thread_count);
+			double total_ms = 0.0;
+			for (uint32_t frame = 0; frame < std::max(frame_count, 1u); frame++) {
+				*result = source;
+				const auto start = BenchmarkHarness::Clock::now();
+				TangentGenerator::generateMissing(result->vertices, result->indices, "grid");
+				total_ms += BenchmarkHarness::millisecondsSince(start);
+			}
+			omp_set_num_threads(previous_threads);
+			const double triangle_count = static_cast<double>(source.indices.size() / 3);
+			return triangle_count * std::max(frame_count, 1u) / std::max(total_ms / 1000.0, 1e-9);
+		}
+	} // namespace
+
+	void TangentBenchmark::run(uint32_t quads_per_side, uint32_t frame_count) {
+		const Grid source = createGrid(quads_per_side);
+
+		// the generator logs every mesh, which would drown the results
+		const spdlog::level::level_enum previous_level = spdlog::get_level();
+		spdlog::set_level(spdlog::level::warn);
+		Grid result;
+		const int max_threads = omp_get_max_threads();
+		const double serial_rate = measureTrianglesPerSecond(source, frame_count, 1, &result);
+		const double parallel_rate = measureTrianglesPerSecond(source, frame_count, max_threads, &result);
+		spdlog::set_level(previous_level);
+
+		spdlog::info("Tangent benchmark, {} triangles, {} vertices, {} frames, {} vertices split at the seam",
+					 source.indices.size() / 3, source.vertices.size(), frame_count,
+					 result.vertices.size() - source.vertices.size());
+		spdlog::info("  1 thread:   {:.2f} M triangles/s, {:.1f} ms", serial_rate / 1e6,
+					 source.indices.size() / 3 / serial_rate * 1000.0);
+		spdlog::info("  {:>2} threads: {:.2f} M triangles/s, {:.1f} ms", max_threads, parallel_rate / 1e6,
+					 source.indices.size() / 3 / parallel_rate * 1000.0);
+
+		const uint32_t wrong = countWrongCorners(result, quads_per_side);
+		if (wrong > 0) {
+			spdlog::error("  {} corners got a wrong tangent or sign", wrong);
+		}
+	}
+} // namespace RtEngine
@@ -0,0 +1,17 @@
+#ifndef TANGENTBENCHMARK_HPP
+#define TANGENTBENCHMARK_HPP
+
+#include <cstdint>
+
+namespace RtEngine {
+	// times tangent generation on a flat grid whose left half has mirrored uvs
+	class TangentBenchmark {
+		TangentBenchmark() = delete;
+
+	public:
+		// grid of quads_per_side^2 quads, generated frame_count times on one and on all threads
+		static void run(uint32_t quads_per_side, uint32_t frame_count);
+	};
+} // namespace RtEngine
+
+#endif // TANGENTBENCHMARK_HPP
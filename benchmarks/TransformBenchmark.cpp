@@ -0,0 +1,119 @@
+#include "TransformBenchmark.hpp"
+
+#include <Node.hpp>
+#include <Rigidbody.hpp>
+#include <Scene.hpp>
+#include <TransformHierarchy.hpp>
+#include <algorithm>
+#include <omp.h>
+#include <random>
+#include <spdlog/spdlog.h>
+
+#include "BenchmarkHarness.hpp"
+
+namespace RtEngine {
+	namespace {
+		double measureMilliseconds(uint32_t frame_count, const std::function<void()> &frame) {
+			return BenchmarkHarness::measureFrames(frame_count, frame).mean_ms;
+		}
+	} // namespace
+
+	void TransformBenchmark::run(uint32_t node_count, float changing_fraction, uint32_t frame_count) {
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+
+		// parents are picked among the earlier nodes, which gives a tree of logarithmic depth with uneven fan out
+		std::vector<std::shared_ptr<Node>> nodes(std::max(node_count, 1u));
+		for (uint32_t i = 0; i < nodes.size(); i++) {
+			nodes[i] = std::make_shared<Node>();
+			nodes[i]->transform->decomposed_transform = {glm::vec3(offset(random), offset(random), offset(random)),
+														 glm::vec3(offset(random) * 18.0f), glm::vec3(1.0f)};
+			if (i > 0) {
+				const auto parent = std::uniform_int_distribution<uint32_t>(0, i - 1)(random);
+				nodes[i]->parent = nodes[parent];
+				nodes[parent]->children.push_back(nodes[i]);
+			}
+		}
+
+		std::vector<uint32_t> changing(nodes.size());
+		for (uint32_t i = 0; i < changing.size(); i++) {
+			changing[i] = i;
+		}
+		std::shuffle(changing.begin(), changing.end(), random);
+		changing.resize(static_cast<size_t>(std::clamp(changing_fraction, 0.0f, 1.0f) * nodes.size()));
+
+		const double recursive_ms =
+				measureMilliseconds(frame_count, [&]() { nodes[0]->refreshTransform(glm::mat4(1.0f)); });
+		std::vector<glm::mat4> reference(nodes.size());
+		for (uint32_t i = 0; i < nodes.size(); i++) {
+			reference[i] = nodes[i]->transform->getWorldTransform();
+		}
+
+		double rebuild_ms, static_ms, subset_ms, all_ms;
+		uint64_t subset_updates = 0;
+		float max_difference = 0.0f;
+		{
+			TransformHierarchy hierarchy;
+			const auto rebuild_start = BenchmarkHarness::Clock::now();
+			hierarchy.rebuild(nodes[0]);
+			rebuild_ms = BenchmarkHarness::millisecondsSince(rebuild_start);
+			hierarchy.update();
+
+			for (uint32_t i = 0; i < nodes.size(); i++) {
+				const glm::mat4 world = nodes[i]->transform->getWorldTransform();
+				for (uint32_t c = 0; c < 4; c++) {
+					const glm::vec4 difference = glm::abs(world[c] - reference[i][c]);
+					max_difference = std::max({max_difference, difference.x, difference.y, difference.z, difference.w});
+				}
+			}
+
+			static_ms = measureMilliseconds(frame_count, [&]() { hierarchy.update(); });
+
+			subset_ms = measureMilliseconds(frame_count, [&]() {
+				for (uint32_t index: changing) {
+					nodes[index]->transform->decomposed_transform.translation.x += 0.001f;
+					nodes[index]->transform->markDirty();
+				}
+				subset_updates += hierarchy.update();
+			});
+
+			all_ms = measureMilliseconds(frame_count, [&]() {
+				for (auto &node: nodes) {
+					node->transform->decomposed_transform.translation.x += 0.001f;
+					node->transform->markDirty();
+				}
+				hierarchy.update();
+			});
+		}
+
+		spdlog::info("Transform benchmark, {} nodes, {} frames, hierarchy rebuild {:.2f} ms, max difference {}",
+					 nodes.size(), frame_count, rebuild_ms, max_difference);
+		spdlog::info("  recursive refresh:        {:.3f} ms/frame", recursive_ms);
+		spdlog::info("  hierarchy, static:        {:.3f} ms/frame", static_ms);
+		spdlog::info("  hierarchy, {:>6} moving: {:.3f} ms/frame, {} transforms recomputed per frame", changing.size(),
+					 subset_ms, subset_updates / std::max(frame_count, 1u));
+		spdlog::info("  hierarchy, all moving:    {:.3f} ms/frame", all_ms);
+
+		// a full scene update where every node falls, so every transform is recomputed every frame
+		Scene scene("", nullptr);
+		nodes[0]->name = Scene::ROOT_NODE_NAME;
+		scene.addNode(nodes[0]);
+		for (uint32_t i = 1; i < nodes.size(); i++) {
+			nodes[i]->name = "node_" + std::to_string(i);
+			nodes[i]->addComponent(std::make_shared<Rigidbody>(nodes[i], 1.0f));
+			scene.addNode(nodes[i]);
+		}
+		auto update_flags = std::make_shared<UpdateFlags>();
+		scene.update(update_flags);
+
+		const int max_threads = omp_get_max_threads();
+		const double serial_ms =
+				BenchmarkHarness::measureFrames(frame_count, 1, [&]() { scene.update(update_flags); }).mean_ms;
+		const double parallel_ms =
+				BenchmarkHarness::measureFrames(frame_count, max_threads, [&]() { scene.update(update_flags); })
+						.mean_ms;
+		spdlog::info("  scene update, 1 thread:   {:.3f} ms/frame", serial_ms);
+		spdlog::info("  scene update, {:>2} threads: {:.3f} ms/frame, {:.1f}x", max_threads, parallel_ms,
+					 serial_ms / std::max(parallel_ms, 1e-9));
+	}
+} // namespace RtEngine
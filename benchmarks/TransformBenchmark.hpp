@@ -0,0 +1,18 @@
+#ifndef TRANSFORMBENCHMARK_HPP
+#define TRANSFORMBENCHMARK_HPP
+
+#include <cstdint>
+
+namespace RtEngine {
+	// compares the recursive transform refresh with the flattened hierarchy on a generated scene graph
+	class TransformBenchmark {
+		TransformBenchmark() = delete;
+
+	public:
+		// random tree of node_count nodes, the hierarchy is measured without changes, with changing_fraction of the
+		// nodes moving every frame and with every node moving, then a scene update on one and on all threads
+		static void run(uint32_t node_count, float changing_fraction, uint32_t frame_count);
+	};
+} // namespace RtEngine
+
+#endif // TRANSFORMBENCHMARK_HPP
@@ -0,0 +1,49 @@
+#include <CommandLineParser.hpp>
+#include <cstdlib>
+#include <spdlog/spdlog.h>
+
+#include "PhysicsBenchmark.hpp"
+#include "PickingBenchmark.hpp"
+#include "TangentBenchmark.hpp"
+#include "TransformBenchmark.hpp"
+
+using namespace RtEngine;
+
+// runs the selected cpu benchmarks on generated scenes, all of them if none is selected
+int main(int argc, char *argv[]) {
+	bool help = false, transform = false, physics = false, picking = false, tangents = false;
+
+	CommandLineParser cli_parser;
+	cli_parser.addFlag("--help", &help, "Show this message.");
+	cli_parser.addFlag("--transform", &transform,
+					   "Time transform updates on a generated scene graph with 100k nodes.");
+	cli_parser.addFlag("--physics", &physics, "Time the physics step on 50k boxes falling onto a ground box.");
+	cli_parser.addFlag("--picking", &picking, "Time picking rays and box queries against 100k instances.");
+	cli_parser.addFlag("--tangents", &tangents, "Time tangent generation on a 1M triangle grid with a mirrored seam.");
+	cli_parser.parse(argc, argv);
+
+	if (help) {
+		cli_parser.printHelp();
+		return EXIT_SUCCESS;
+	}
+
+	const bool all = !transform && !physics && !picking && !tangents;
+	try {
+		if (all || transform) {
+			TransformBenchmark::run(100000, 0.01f, 100);
+		}
+		if (all || physics) {
+			PhysicsBenchmark::run(50000, 100);
+		}
+		if (all || picking) {
+			PickingBenchmark::run(100000, 1000);
+		}
+		if (all || tangents) {
+			TangentBenchmark::run(708, 5);
+		}
+	} catch (const std::exception &e) {
+		spdlog::error(e.what());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
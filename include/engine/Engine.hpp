@@ -13,10 +13,13 @@ namespace RtEngine {
         OFFLINE,
         REFERENCE,
         BENCHMARK,
+        SCALING,
     };
 
     struct EngineOptions {
         std::string config_file, resources_dir;
+        std::string pack_scene;
+        std::string scaling_tag;
         bool verbose = false;
         RunnerType runner_type = NONE;
     };
@@ -51,6 +54,8 @@ namespace RtEngine {
 
         void mainLoop();
 
+        void selectClickedNode() const;
+
         void finishFrame();
 
         void cleanup();
@@ -12,6 +12,11 @@ namespace RtEngine {
         UNKNOWN
     };
 
+    enum MouseButton {
+        MOUSE_LEFT, MOUSE_RIGHT, MOUSE_MIDDLE,
+        MOUSE_UNKNOWN
+    };
+
     class InputManager {
     public:
         explicit InputManager(std::shared_ptr<Window> window);
@@ -19,18 +24,24 @@ namespace RtEngine {
         bool getKeyDown(Keycode key) const;
         bool getKeyUp(Keycode key) const;
 
+        bool getMouseButtonDown(MouseButton button) const;
+        bool getMouseButtonUp(MouseButton button) const;
+
         glm::vec2 getMousePosition() const;
         void reset();
 
     private:
         void processGlfwKeyEvent(int key, int action);
         void processGlfwMouseEvent(double xPos, double yPos);
+        void processGlfwMouseButtonEvent(int button, int action);
 
         static Keycode glfwToEngineKeycode(int glfw_key);
+        static MouseButton glfwToEngineMouseButton(int glfw_button);
 
         std::shared_ptr<Window> window;
 
         std::unordered_set<Keycode> down_keycodes, up_keycodes;
+        std::unordered_set<MouseButton> down_buttons, up_buttons;
         glm::vec2 mouse_pos;
     };
 } // RtEngine
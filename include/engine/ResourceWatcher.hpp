@@ -0,0 +1,31 @@
+#ifndef VULKAN_RAYTRACING_RESOURCEWATCHER_HPP
+#define VULKAN_RAYTRACING_RESOURCEWATCHER_HPP
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RtEngine {
+    // watches the resources directory with inotify, files count as changed once they have been fully written
+    class ResourceWatcher {
+    public:
+        explicit ResourceWatcher(const std::string &resources_dir);
+        ~ResourceWatcher();
+
+        ResourceWatcher(const ResourceWatcher &) = delete;
+        ResourceWatcher &operator=(const ResourceWatcher &) = delete;
+
+        // returns the paths relative to the resources directory of all files changed since the last call
+        std::vector<std::string> poll();
+
+    private:
+        void addWatches(const std::filesystem::path &dir);
+        void addWatch(const std::filesystem::path &dir);
+
+        std::string resources_dir;
+        int inotify_fd = -1;
+        std::unordered_map<int, std::string> watched_dirs; // watch descriptor -> dir relative to the resources
+    };
+} // RtEngine
+
+#endif //VULKAN_RAYTRACING_RESOURCEWATCHER_HPP
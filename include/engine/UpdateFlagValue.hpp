@@ -9,6 +9,8 @@ namespace RtEngine {
         MATERIAL_UPDATE = 1 << 1,
         SCENE_UPDATE = 1 << 2,
         TARGET_RESET = 1 << 3,
+        MATERIAL_PATCH = 1 << 4, // material data or texture contents changed, the layout stayed the same
+        MATERIAL_VALUES = 1 << 5, // only material parameters changed, no textures and no emitters
     };
 
     class UpdateFlags {
@@ -22,7 +24,8 @@ namespace RtEngine {
                 flags |= STATIC_GEOMETRY_UPDATE | MATERIAL_UPDATE | TARGET_RESET;
             }
 
-            if (flag == STATIC_GEOMETRY_UPDATE || flag == MATERIAL_UPDATE) {
+            if (flag == STATIC_GEOMETRY_UPDATE || flag == MATERIAL_UPDATE || flag == MATERIAL_PATCH ||
+                flag == MATERIAL_VALUES) {
                 flags |= TARGET_RESET;
             }
         }
@@ -31,6 +34,11 @@ namespace RtEngine {
             flags |= other->flags;
         }
 
+        // only clears flag itself, not the flags it implied when it was set
+        void clearFlag(UpdateFlagValue flag) {
+            flags &= ~flag;
+        }
+
         bool hasAny() const {
             return flags != 0;
         }
@@ -18,14 +18,17 @@ namespace RtEngine {
         void addResizeCallback(const std::function<void(int, int)> &func);
         void addKeyCallback(const std::function<void(int, int, int, int)> &func);
         void addMouseCallback(const std::function<void(double, double)> &func);
+        void addMouseButtonCallback(const std::function<void(int, int, int)> &func);
 
         static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
         static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
         static void mouseCallback(GLFWwindow *window, double xPos, double yPos);
+        static void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
 
         std::vector<std::function<void(int, int)>> resize_callbacks;
         std::vector<std::function<void(int, int, int, int)>> key_callbacks;
         std::vector<std::function<void(double, double)>> mouse_callbacks;
+        std::vector<std::function<void(int, int, int)>> mouse_button_callbacks;
     private:
         void initGlfwWindow(uint32_t width, uint32_t height);
 
@@ -16,11 +16,13 @@ namespace RtEngine {
 		CommandManager(const std::shared_ptr<DeviceManager> &deviceManager);
 		void createCommandPool();
 		VkCommandBuffer beginSingleTimeCommands() const;
+		// submits the commands and waits for them, but not for the other work on the queue
 		void endSingleTimeCommand(VkCommandBuffer commandBuffer) const;
 		void destroy() const;
 
 	private:
 		std::shared_ptr<DeviceManager> deviceManager;
+		VkFence singleTimeFence{};
 	};
 
 } // namespace RtEngine
@@ -17,6 +17,8 @@ namespace RtEngine {
         virtual std::vector<std::shared_ptr<MeshAsset>> getMeshAssets() = 0;
         virtual std::vector<std::shared_ptr<MaterialInstance>> getMaterialInstances() = 0;
         virtual void fillDrawContext(const std::shared_ptr<DrawContext> &draw_context) = 0;
+        // rebuilds every draw list entry, for changes the transforms do not cover like materials and meshes
+        virtual void refreshRenderObjects() = 0;
         virtual std::shared_ptr<Material> getMaterial() = 0;
         virtual std::shared_ptr<EnvironmentMap> getEnvironmentMap() = 0;
         virtual void* getSceneData(size_t *size, uint32_t emitting_instances_count) = 0;
@@ -32,10 +32,15 @@ namespace RtEngine {
 		void init(std::shared_ptr<Window> window);
 		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
 
-		void loadScene(std::shared_ptr<IScene> scene);
+		// returns the resources of the previously shown scene, which are still alive
+		std::shared_ptr<SceneResources> loadScene(std::shared_ptr<IScene> scene);
+		std::shared_ptr<SceneResources> activateSceneResources(const std::shared_ptr<SceneResources> &resources);
+		void destroySceneResources(const std::shared_ptr<SceneResources> &resources);
+		bool usesCompactVertices() const;
 
 		void updateSceneRepresentation(const std::shared_ptr<DrawContext> &draw_context, UpdateFlagsHandle update_flags);
 		void updateRenderTarget(const std::shared_ptr<RenderTarget> &target);
+		void reloadMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset);
 
 		void waitForIdle();
 		void waitForNextFrameStart();
@@ -58,6 +63,12 @@ namespace RtEngine {
 
 		std::shared_ptr<RenderTarget> createRenderTarget(uint32_t width, uint32_t height);
 
+		// ray tracing time of the last frame recorded into the current frame slot, call after waitForNextFrameStart.
+		// negative while no result is available
+		double getLastGpuFrameTime() const;
+		const SceneAdapter::BuildTimings &getBuildTimings() const;
+		VkDeviceSize getAllocatedDeviceMemory() const;
+
 		std::shared_ptr<VulkanContext> getVulkanContext();
 
 		std::shared_ptr<TextureRepository> getTextureRepository();
@@ -73,6 +84,9 @@ namespace RtEngine {
 		DeletionQueue mainDeletionQueue;
 
 		uint32_t recursion_depth = 5;
+		bool compact_vertices = false;
+		bool mesh_lods = true;
+		float lod_pixel_error = 1.0f;
 		std::vector<int32_t> push_constants{};
 
 		std::shared_ptr<VulkanContext> vulkan_context;
@@ -87,6 +101,11 @@ namespace RtEngine {
 		std::vector<VkSemaphore> renderFinishedSemaphores;
 		std::vector<VkFence> inFlightFences;
 
+		// a begin and end timestamp per frame in flight
+		VkQueryPool timestamp_query_pool = VK_NULL_HANDLE;
+		std::vector<bool> timestamps_written;
+		float timestamp_period = 1.0f; // nanoseconds per tick
+
 		bool framebufferResized = false;
 
 		uint32_t max_frames_in_flight = 1;
@@ -102,6 +121,7 @@ namespace RtEngine {
 		std::shared_ptr<DescriptorAllocator> createDescriptorAllocator();
 		void createCommandBuffers();
 		void createSyncObjects();
+		void createTimestampQueries();
 
 		void pollSdlEvents();
 
@@ -12,11 +12,13 @@ namespace RtEngine {
 		AssimpModelLoader() = default;
 
 	protected:
-		void loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) override;
-		void processNode(aiNode *node, const aiScene *scene, std::vector<Vertex> &vertices,
-						 std::vector<uint32_t> &indices);
-		void processMesh(aiMesh *mesh, const aiScene *scene, std::vector<Vertex> &vertices,
-						 std::vector<uint32_t> &indices);
+		void loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+					  std::vector<Submesh> &submeshes) override;
+		void processNode(aiNode *node, const aiScene *scene, const glm::mat4 &parent_transform,
+						 std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+						 std::vector<Submesh> &submeshes);
+		void processMesh(aiMesh *mesh, const aiScene *scene, const glm::mat4 &transform, std::vector<Vertex> &vertices,
+						 std::vector<uint32_t> &indices, std::vector<Submesh> &submeshes);
 	};
 
 } // namespace RtEngine
@@ -0,0 +1,26 @@
+#ifndef GLTFMODELLOADER_HPP
+#define GLTFMODELLOADER_HPP
+
+#include <ModelLoader.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace RtEngine {
+	// reads .gltf and .glb files without assimp, binary buffers are memory mapped and the accessors are read
+	// straight into the vertex and index buffers
+	class GltfModelLoader : public ModelLoader {
+	public:
+		GltfModelLoader() = default;
+
+		static bool isGltfFile(const std::string &path);
+
+		// converts the metallic roughness materials of the file into metal rough instance yaml nodes named
+		// <file name>/<material name>, texture paths are relative to the resources directory
+		static std::vector<YAML::Node> loadMaterials(const std::string &resources_path, const std::string &path);
+
+	protected:
+		void loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+					  std::vector<Submesh> &submeshes) override;
+	};
+
+} // namespace RtEngine
+#endif // GLTFMODELLOADER_HPP
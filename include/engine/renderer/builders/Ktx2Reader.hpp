@@ -0,0 +1,17 @@
+#ifndef KTX2READER_HPP
+#define KTX2READER_HPP
+
+#include <ResourceBuilder.hpp>
+#include <string>
+
+namespace RtEngine {
+	// reads pre-built mip chains from KTX2 containers, only plain 2D images without supercompression are supported
+	class Ktx2Reader {
+		Ktx2Reader() = delete;
+
+	public:
+		static ImageData read(const std::string &path);
+	};
+} // namespace RtEngine
+
+#endif // KTX2READER_HPP
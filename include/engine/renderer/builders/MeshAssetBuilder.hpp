@@ -4,6 +4,7 @@
 #include <AccelerationStructure.hpp>
 #include <MeshAsset.hpp>
 #include <ModelLoader.hpp>
+#include <yaml-cpp/yaml.h>
 
 #include "ResourceBuilder.hpp"
 
@@ -14,6 +15,8 @@ namespace RtEngine {
 		MeshAssetBuilder(VkDevice device, const std::string &resource_path) :
 			device(device), resource_path(resource_path){};
 		MeshAsset loadMeshAsset(std::string path);
+		// material instance nodes defined by the model file itself, empty for formats without materials
+		std::vector<YAML::Node> loadMaterials(const std::string &path);
 		void destroyMeshAsset(MeshAsset &meshAsset);
 
 	private:
@@ -0,0 +1,29 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <MeshAsset.hpp>
+#include <Vertex.hpp>
+#include <vector>
+
+namespace RtEngine {
+	class MeshOptimizer {
+		MeshOptimizer() = delete;
+
+	public:
+		// welds, reorders triangles for the post-transform cache and vertices for fetch locality
+		static void optimize(MeshBuffers &mesh_buffers, const std::string &name);
+
+		static void weldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+		static std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertex_count);
+		// reorders the triangles inside each submesh, the submesh ranges stay valid
+		static void optimizeVertexCache(std::vector<uint32_t> &indices, const std::vector<Submesh> &submeshes,
+										uint32_t vertex_count);
+		static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+		// average cache miss ratio: transformed vertices per triangle with a FIFO cache
+		static float computeAcmr(const std::vector<uint32_t> &indices, uint32_t vertex_count,
+								 uint32_t cache_size = 16);
+	};
+} // namespace RtEngine
+
+#endif // MESHOPTIMIZER_HPP
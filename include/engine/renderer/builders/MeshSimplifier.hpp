@@ -0,0 +1,30 @@
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <MeshAsset.hpp>
+#include <Vertex.hpp>
+#include <string>
+#include <vector>
+
+namespace RtEngine {
+	// quadric error edge collapse, simplified index buffers keep referencing the vertices of the full mesh
+	class MeshSimplifier {
+		MeshSimplifier() = delete;
+
+	public:
+		// fills mesh_buffers.lods, small meshes and meshes that barely simplify get no lods
+		static void generateLods(MeshBuffers &mesh_buffers, const std::string &name);
+
+		// collapses edges until at most target_index_count indices are left or the next collapse would move the
+		// surface further than max_error, vertices on open edges (borders and attribute seams) and between submeshes
+		// never move. submeshes are updated to the ranges of the result, result_error receives the largest error of
+		// all collapses
+		static std::vector<uint32_t> simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+											  std::vector<Submesh> &submeshes, size_t target_index_count,
+											  float max_error, float &result_error);
+
+		static BoundingSphere computeBoundingSphere(const std::vector<Vertex> &vertices);
+	};
+} // namespace RtEngine
+
+#endif // MESHSIMPLIFIER_HPP
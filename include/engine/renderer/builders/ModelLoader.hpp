@@ -3,6 +3,7 @@
 
 #include <MeshAsset.hpp>
 #include <../renderer/resources/Vertex.hpp>
+#include <memory>
 #include <string.h>
 #include <vector>
 
@@ -13,9 +14,16 @@ namespace RtEngine {
 		virtual ~ModelLoader() = default;
 
 		MeshAsset loadMeshAsset(std::string ressources_path, std::string path);
+		// loaded and optimized buffers, ready to be stored in an asset pack
+		MeshBuffers loadMeshBuffers(const std::string &resources_path, const std::string &path);
+		static MeshAsset createMeshAsset(const std::string &path, MeshBuffers meshBuffers);
+		// gltf files are read natively, everything else goes through assimp
+		static std::shared_ptr<ModelLoader> createLoader(const std::string &path);
 
 	protected:
-		virtual void loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) = 0;
+		// appends one submesh per part of the model, with the node transforms of the file applied
+		virtual void loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+							  std::vector<Submesh> &submeshes) = 0;
 	};
 
 } // namespace RtEngine
@@ -3,8 +3,11 @@
 
 #include <Texture.hpp>
 #include <cstring>
+#include <span>
 #include <stb_image.h>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 #include "CommandManager.hpp"
 
@@ -13,7 +16,7 @@ namespace RtEngine {
 		VkBuffer handle = VK_NULL_HANDLE;
 		VkDeviceMemory bufferMemory;
 		uint64_t deviceAddress;
-		size_t size;
+		size_t size = 0;
 
 		void update(VkDevice device, void *data, size_t size, size_t offset = 0) {
 			void *mapped_data;
@@ -23,6 +26,18 @@ namespace RtEngine {
 		}
 	};
 
+	// decoded pixel data of an image that has not been uploaded yet, mip levels are stored back to back
+	struct ImageData {
+		std::vector<uint8_t> pixels;
+		// used instead of pixels when the data lives in memory owned by someone else, e.g. a mapped asset pack
+		std::span<const uint8_t> mapped;
+		VkExtent3D extent;
+		VkFormat format;
+		uint32_t mip_levels = 1;
+
+		std::span<const uint8_t> bytes() const { return mapped.empty() ? std::span<const uint8_t>(pixels) : mapped; }
+	};
+
 	class ResourceBuilder {
 	public:
 		ResourceBuilder() = default;
@@ -32,37 +47,71 @@ namespace RtEngine {
 
 		AllocatedBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
 		AllocatedBuffer stageMemoryToNewBuffer(void *data, size_t size, VkBufferUsageFlags usage);
-		void copyBuffer(AllocatedBuffer src, AllocatedBuffer dst, VkDeviceSize size);
+		// the destination buffer has to be created with VK_BUFFER_USAGE_TRANSFER_DST_BIT
+		void stageMemoryToBuffer(void *data, size_t size, AllocatedBuffer dst, VkDeviceSize dst_offset);
+		void copyBuffer(AllocatedBuffer src, AllocatedBuffer dst, VkDeviceSize size, VkDeviceSize dst_offset = 0);
+		// records the write into command_buffer instead of submitting it, size and dst_offset have to be multiples of 4
+		// and dst needs VK_BUFFER_USAGE_TRANSFER_DST_BIT. synchronisation with the readers is up to the caller
+		static void recordBufferUpdate(VkCommandBuffer command_buffer, VkBuffer dst, VkDeviceSize dst_offset,
+									   const void *data, VkDeviceSize size);
 		void destroyBuffer(AllocatedBuffer buffer);
 
 		AllocatedImage createImage(VkExtent3D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-								   VkImageAspectFlags aspectFlags);
+								   VkImageAspectFlags aspectFlags, uint32_t mip_levels = 1);
 		AllocatedImage createImage(void *data, VkExtent3D extent, VkFormat format, VkImageTiling tiling,
 								   VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
 								   VkImageLayout target_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		std::vector<AllocatedImage> createImages(const std::vector<ImageData> &images, VkImageTiling tiling,
+												 VkImageUsageFlags usage, VkImageAspectFlags aspectFlags);
 		Texture loadTextureImage(std::string path, TextureType type = PARAMETER);
+		ImageData decodeTextureImage(const std::string &path, TextureType type = PARAMETER);
+		static ImageData decodeTextureFile(const std::string &full_path, TextureType type = PARAMETER);
+		// throws for formats the device can not sample, RGB8 is widened to RGBA8 on devices without RGB8 support
+		void validateTextureFormat(const std::string &path, ImageData &image_data, TextureType type) const;
+		ImageData loadKtx2Texture(const std::string &path, TextureType type);
+		bool loadImportedTexture(const std::string &path, TextureType type, ImageData &image_data);
+		void importTextureImage(const std::string &path, TextureType type, ImageData &image_data);
 		uint8_t *loadImageData(std::string path, int *width, int *height, int *channels);
 
 		uint8_t *downloadImage(AllocatedImage image, uint32_t bytes_per_channel = 1);
 
-		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+									uint32_t mip_levels = 1);
 
 		void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkPipelineStageFlags srcStage,
 								   VkPipelineStageFlags dstStage, VkAccessFlags srcAccessMask,
-								   VkAccessFlags dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout);
+								   VkAccessFlags dstAccessMask, VkImageLayout oldLayout, VkImageLayout newLayout,
+								   uint32_t mip_levels = 1);
 		void transitionImageLayout(VkImage image, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
 								   VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageLayout oldLayout,
 								   VkImageLayout newLayout);
 
 		void destroyImage(AllocatedImage image);
 
+		static VkDeviceSize getImageSize(VkExtent3D extent, VkFormat format);
+
+		// device memory of all buffers and images that are currently alive
+		VkDeviceSize getAllocatedBytes() const { return allocations->allocated_bytes; }
+
 	private:
 		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+		void trackAllocation(VkDeviceMemory memory, VkDeviceSize size);
+		void trackFree(VkDeviceMemory memory);
+
+		// shared by all copies, acceleration structures keep a builder of their own
+		struct AllocationTracker {
+			std::unordered_map<VkDeviceMemory, VkDeviceSize> sizes;
+			VkDeviceSize allocated_bytes = 0;
+		};
+		std::shared_ptr<AllocationTracker> allocations = std::make_shared<AllocationTracker>();
 		std::shared_ptr<DeviceManager> device_manager;
 		std::shared_ptr<CommandManager> commandManager;
 		std::string resource_path;
 
+		std::string getTextureCachePath(const std::string &path, TextureType type) const;
 		void copyBufferToImage(VkBuffer buffer, VkImage image, VkExtent3D extent);
+		void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, VkExtent3D extent,
+							   VkDeviceSize buffer_offset, uint32_t mip_level = 0);
 		void copyImageToBuffer(VkImage image, VkBuffer buffer, VkExtent3D extent);
 	};
 
@@ -0,0 +1,25 @@
+#ifndef TANGENTGENERATOR_HPP
+#define TANGENTGENERATOR_HPP
+
+#include <Vertex.hpp>
+#include <string>
+#include <vector>
+
+namespace RtEngine {
+	// mikktspace style tangents for vertices the source file has none for
+	class TangentGenerator {
+		TangentGenerator() = delete;
+
+	public:
+		// loaders mark vertices without a tangent with w == 0, otherwise w is the bitangent sign as in gltf:
+		// cross(normal, tangent) * w points along +y of the normal map, which is up in the image
+		static bool hasTangent(const Vertex &vertex) { return vertex.tangent.w != 0.0f; }
+
+		// fills in every vertex without a tangent, vertices used by triangles with mirrored and unmirrored uvs are
+		// split so both sides get their own sign, returns the number of generated tangents
+		static size_t generateMissing(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+									  const std::string &name);
+	};
+} // namespace RtEngine
+
+#endif // TANGENTGENERATOR_HPP
@@ -0,0 +1,32 @@
+#ifndef TEXTURECOMPRESSOR_HPP
+#define TEXTURECOMPRESSOR_HPP
+
+#include <ResourceBuilder.hpp>
+#include <string>
+
+namespace RtEngine {
+	// import step for textures: mip chain generation, BC7/BC5 block compression and the on-disk cache of the results
+	class TextureCompressor {
+		TextureCompressor() = delete;
+
+	public:
+		static bool isBlockCompressed(VkFormat format);
+		static bool isSrgb(VkFormat format);
+		static VkExtent3D getMipLevelExtent(VkExtent3D extent, uint32_t level);
+
+		// replaces the single RGBA8 level of image_data with a full chain, sRGB levels are filtered in linear space
+		static void generateMipChain(ImageData &image_data, bool normal_map);
+		// compresses every level of an RGBA8 chain to BC7, normal maps keep only xy and go to BC5
+		static void compress(ImageData &image_data, bool normal_map);
+
+		static bool loadFromCache(const std::string &cache_path, const std::string &source_path,
+								  ImageData &image_data);
+		static void storeInCache(const std::string &cache_path, const std::string &source_path,
+								 const ImageData &image_data);
+
+		static void encodeBC7Block(const uint8_t *pixels, uint8_t *block);
+		static void encodeBC4Block(const uint8_t *values, uint8_t *block);
+	};
+} // namespace RtEngine
+
+#endif // TEXTURECOMPRESSOR_HPP
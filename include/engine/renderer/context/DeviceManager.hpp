@@ -38,6 +38,9 @@ namespace RtEngine {
 		VkInstance getInstance() const;
 		QueueFamilyIndices getQueueIndices() const;
 		VkQueue getQueue(QueueType type) const;
+		bool supportsBlockCompression() const;
+		// optimal tiling images of the format can be uploaded to and sampled
+		bool supportsSampledImageFormat(VkFormat format) const;
 
 	private:
 		void createInstance(bool enable_validation_layers);
@@ -74,6 +77,7 @@ namespace RtEngine {
 		VkDebugUtilsMessengerEXT debugMessenger;
 		QueueFamilyIndices queue_indices;
 		VkQueue graphics_queue, present_queue;
+		bool block_compression_supported = false;
 	};
 } // namespace RtEngine
 
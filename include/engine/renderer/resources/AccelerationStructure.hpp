@@ -25,19 +25,29 @@ namespace RtEngine {
 								 uint32_t max_vertex, uint32_t triangle_count, uint32_t vertex_stride,
 								 uint32_t vertex_offset, uint32_t index_offset);
 
-		void addInstance(std::shared_ptr<AccelerationStructure> &instance, glm::mat4 transform_matrix,
-						 uint32_t instanceId);
+		// the instances are kept after they were uploaded, so single transforms can be patched before a refit
+		void addInstance(uint64_t blas_address, glm::mat4 transform_matrix, uint32_t instanceId);
+		void setInstanceTransform(uint32_t index, const glm::mat4 &transform_matrix);
+		// a refit may switch the blas of an instance, e.g. to another lod of the same mesh
+		void setInstanceBlas(uint32_t index, uint64_t blas_address);
+		void clearInstances();
 		void addInstanceGeometry();
 		void update_instance_geometry(uint32_t index);
 
 		void
 		build(VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR,
 			  VkBuildAccelerationStructureModeKHR mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR);
+		// records a refit of the top level structure with the current instances into command_buffer instead of
+		// submitting it and waiting. the instance data and the scratch space are kept per frame in flight, so they are
+		// only rewritten once the fence of frame_index signalled. the instance count has to match the last build
+		void recordInstanceUpdate(VkCommandBuffer command_buffer, uint32_t frame_index,
+								  VkBuildAccelerationStructureFlagsKHR flags);
 
 		void destroy();
 
 		VkAccelerationStructureKHR getHandle() const;
 		uint64_t getDeviceAddress() const;
+		size_t getSize() const;
 
 	private:
 		void fillInstanceBuffer();
@@ -54,6 +64,12 @@ namespace RtEngine {
 
 		AllocatedBuffer instance_buffer;
 		std::vector<VkAccelerationStructureInstanceKHR> instances{};
+
+		struct FrameUpdateBuffers {
+			AllocatedBuffer instance_buffer;
+			AllocatedBuffer scratch_buffer;
+		};
+		std::vector<FrameUpdateBuffers> frame_update_buffers{};
 		std::vector<Geometry> geometries{};
 	};
 
@@ -0,0 +1,41 @@
+#ifndef COMPACTVERTEX_HPP
+#define COMPACTVERTEX_HPP
+
+#include <Vertex.hpp>
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+
+namespace RtEngine {
+	namespace VertexCodec {
+		using namespace glm;
+		using uint = uint32_t;
+
+#define VERTEX_CODEC_FUNC inline
+#include "../../../../shaders/common/vertex_codec.glsl"
+#undef VERTEX_CODEC_FUNC
+	} // namespace VertexCodec
+
+	// attribute stream of the compact layout, positions live in their own tightly packed stream
+	struct CompactVertexAttributes {
+		uint32_t normal;
+		uint32_t tangent;
+		uint32_t uv;
+
+		static CompactVertexAttributes encode(const Vertex &vertex) {
+			return {VertexCodec::encodeOctahedral(vertex.normal), VertexCodec::encodeTangent(vertex.tangent),
+					VertexCodec::encodeUv(glm::vec2(vertex.texCoord))};
+		}
+
+		Vertex decode(const glm::vec3 &position) const {
+			Vertex vertex{};
+			vertex.pos = position;
+			vertex.normal = VertexCodec::decodeOctahedral(normal);
+			vertex.tangent = VertexCodec::decodeTangent(tangent);
+			vertex.color = glm::vec3(1.0f);
+			vertex.texCoord = glm::vec3(VertexCodec::decodeUv(uv), 0.0f);
+			return vertex;
+		}
+	};
+} // namespace RtEngine
+
+#endif // COMPACTVERTEX_HPP
@@ -0,0 +1,59 @@
+#ifndef DRAWLIST_HPP
+#define DRAWLIST_HPP
+
+#include <IRenderable.hpp>
+#include <vector>
+
+namespace RtEngine {
+	// what happened to a draw list since the scene adapter last consumed it
+	struct DrawListChanges {
+		// objects were added, removed or replaced, their indices are no longer the ones the tlas was built with
+		bool structure_changed = false;
+		// indices of objects that only got a new transform, empty whenever the structure changed
+		std::vector<uint32_t> moved_objects;
+		// the emitting power of a submesh changed without a structure change
+		bool emission_changed = false;
+	};
+
+	// the render objects of a scene, kept across frames. mesh renderers add their entry once when they start and only
+	// patch its transform afterwards, so a frame without changes does not touch the list at all
+	class DrawList {
+	public:
+		static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+		// handles stay valid until the object is removed, object indices change whenever an object is removed
+		uint32_t add(RenderObject object);
+		void remove(uint32_t handle);
+		// an object that keeps its mesh and the material of every submesh only counts as moved, the lod and instance
+		// buffer fields the scene adapter filled in are kept
+		void update(uint32_t handle, RenderObject object);
+		void setTransform(uint32_t handle, const glm::mat4 &transform);
+
+		std::vector<RenderObject> &getRenderObjects() { return objects; }
+		uint32_t getEmittingObjectCount() const { return emitting_object_count; }
+		size_t size() const { return objects.size(); }
+
+		const DrawListChanges &getChanges() const { return changes; }
+		bool hasChanges() const {
+			return changes.structure_changed || !changes.moved_objects.empty() || changes.emission_changed;
+		}
+		void clearChanges();
+
+	private:
+		void markStructureChanged();
+		void markMoved(uint32_t index);
+		static bool keepsInstance(const RenderObject &current, const RenderObject &object);
+		static uint32_t countEmittingSubmeshes(const RenderObject &object);
+
+		std::vector<RenderObject> objects;
+		std::vector<uint32_t> object_handles; // handle of every object
+		std::vector<uint8_t> object_moved; // keeps moved_objects free of duplicates
+		std::vector<uint32_t> handle_objects; // object index of every handle
+		std::vector<uint32_t> free_handles;
+
+		DrawListChanges changes;
+		uint32_t emitting_object_count = 0;
+	};
+} // namespace RtEngine
+
+#endif // DRAWLIST_HPP
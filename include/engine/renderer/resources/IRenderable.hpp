@@ -1,4 +1,5 @@
 #include <AccelerationStructure.hpp>
+#include <MeshAsset.hpp>
 #include <RenderTarget.hpp>
 
 #ifndef BASICS_IRENDERABLE_HPP
@@ -6,27 +7,46 @@
 
 namespace RtEngine {
 	struct InstanceMappingData {
-		uint32_t geometry_id;
-		uint32_t material_index;
+		uint32_t geometry_id; // of the first submesh
+		uint32_t material_offset; // start of the submesh materials, filled in by the instance manager
 	};
 
 	struct EmittingInstanceData {
 		glm::mat4 model_matrix;
 		uint32_t instance_id;
 		uint32_t primitive_count;
-		uint32_t padding[2];
+		uint32_t geometry_index; // submesh inside the instance
+		uint32_t padding;
+	};
+
+	struct SubmeshMaterial {
+		uint32_t material_index;
+		float emitting_power;
 	};
 
+	// resources are referenced by handle and device address, copying and reading render objects never touches a
+	// reference count
 	struct RenderObject {
 		InstanceMappingData instance_mapping_data;
-		std::shared_ptr<AccelerationStructure> acceleration_structure;
+		uint64_t blas_address; // of the selected lod
 		glm::mat4 transform;
 		uint32_t primitive_count;
-		float emitting_power;
+		float emitting_power; // largest of the submeshes
+		// source of the lods the scene adapter picks from, resolved through the mesh repository
+		MeshHandle mesh;
+		std::vector<SubmeshMaterial> submesh_materials; // one per geometry of the blas
 	};
 
+	class DrawList;
+
+	// what a runner renders this frame, the render objects themselves live in the draw list of the scene
 	struct DrawContext {
 		std::vector<std::shared_ptr<RenderTarget>> targets;
+		// set by the first camera, used to pick mesh lods by their projected size
+		glm::vec3 view_position = glm::vec3(0);
+		// size in pixels of a unit length at distance one, zero disables lod selection
+		float pixels_per_unit = 0.0f;
+		std::shared_ptr<DrawList> draw_list;
 
 		void nextFrame()
 		{
@@ -37,28 +57,10 @@ namespace RtEngine {
 		}
 
 		void clear() {
-			emitting_object_count = 0;
-			objects.clear();
+			targets.clear();
+			pixels_per_unit = 0.0f;
+			draw_list = nullptr;
 		}
-
-		void addRenderObject(const RenderObject& render_obj) {
-			objects.push_back(render_obj);
-			if (render_obj.emitting_power > 0.0f) {
-				emitting_object_count++;
-			}
-		}
-
-		std::vector<RenderObject>& getRenderObjects() {
-			return objects;
-		}
-
-		uint32_t getEmittingObjectCount() const {
-			return emitting_object_count;
-		}
-
-	private:
-		std::vector<RenderObject> objects;
-		uint32_t emitting_object_count = 0;
 	};
 
 	class IRenderable {
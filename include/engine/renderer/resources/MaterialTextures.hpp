@@ -3,6 +3,7 @@
 
 #include <DeletionQueue.hpp>
 #include <ResourceBuilder.hpp>
+#include <cassert>
 #include <memory>
 #include <unordered_map>
 #include <spdlog/spdlog.h>
@@ -22,7 +23,9 @@ namespace RtEngine {
 		std::vector<VkImageView> getOrderedImageViews() {
 			std::vector<VkImageView> image_views(MAX_TEXTURE_COUNT);
 			for (uint32_t i = 0; i < next_tex_idx; i++) {
-				image_views[i] = ordered_textures[i]->image.imageView;
+				const Texture *tex = texture_repository->getTexture(ordered_textures[i]);
+				assert(tex != nullptr);
+				image_views[i] = tex->image.imageView;
 			}
 
 			for (uint32_t i = next_tex_idx; i < MAX_TEXTURE_COUNT; i++) {
@@ -37,12 +40,15 @@ namespace RtEngine {
 				return texture_name_cache[tex->name];
 			}
 
-			ordered_textures[next_tex_idx] = tex;
+			assert(tex->handle.isValid());
+			ordered_textures[next_tex_idx] = tex->handle;
 			texture_name_cache[tex->name] = next_tex_idx;
 			next_tex_idx++;
 			return next_tex_idx - 1;
 		}
 
+		uint32_t getTextureCount() const { return next_tex_idx; }
+
 		void clear() {
 			next_tex_idx = 0;
 			texture_name_cache.clear();
@@ -54,7 +60,7 @@ namespace RtEngine {
 		std::shared_ptr<TextureRepository> texture_repository;
 
 		// these are ordered so that the texture indices given out to the
-		std::array<std::shared_ptr<Texture>, MAX_TEXTURE_COUNT> ordered_textures{};
+		std::array<TextureHandle, MAX_TEXTURE_COUNT> ordered_textures{};
 		uint32_t next_tex_idx = 0;
 
 		std::unordered_map<std::string, uint32_t> texture_name_cache{};
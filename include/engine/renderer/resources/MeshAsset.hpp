@@ -1,14 +1,32 @@
 #ifndef MESHASSET_HPP
 #define MESHASSET_HPP
 
+#include <Aabb.hpp>
+#include <Handle.hpp>
 #include <bits/shared_ptr.h>
 #include "AccelerationStructure.hpp"
 #include "ResourceBuilder.hpp"
 
 namespace RtEngine {
+	// range of the index buffer drawn with one material, becomes its own geometry in the blas
+	struct Submesh {
+		uint32_t index_offset = 0;
+		uint32_t index_count = 0;
+		std::string material_name; // name inside the model file, empty if it has none
+	};
+
+	// simplified index buffer over the vertices of the full mesh
+	struct LodBuffers {
+		std::vector<uint32_t> indices;
+		std::vector<Submesh> submeshes; // same submeshes as the full mesh, ranges into the lod indices
+		float error = 0.0f; // largest surface deviation relative to the bounding sphere radius
+	};
+
 	struct MeshBuffers {
 		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
+		std::vector<uint32_t> indices; // grouped by submesh, all indices refer to the shared vertices
+		std::vector<Submesh> submeshes;
+		std::vector<LodBuffers> lods; // each level has about a quarter of the triangles of the previous one
 	};
 
 	struct GeometryData {
@@ -16,15 +34,37 @@ namespace RtEngine {
 		uint32_t triangle_offset = 0;
 	};
 
+	struct BoundingSphere {
+		glm::vec3 center = glm::vec3(0.0f);
+		float radius = 0.0f;
+	};
+
+	// gpu side of a lod, filled in when the geometry is uploaded
+	struct MeshLod {
+		uint32_t geometry_id = 0; // of the first submesh, the others follow
+		uint32_t triangle_count = 0;
+		float error = 0.0f;
+		GeometryData instance_data;
+		std::shared_ptr<AccelerationStructure> accelerationStructure;
+	};
+
+	struct MeshAsset;
+	using MeshHandle = Handle<MeshAsset>;
+
 	struct MeshAsset {
 		std::string name;
 		std::string path;
-		uint32_t geometry_id;
+		std::vector<std::string> alias_paths; // other files with identical content that share this asset
+		MeshHandle handle; // given out by the mesh repository, shared by all aliases
+		uint32_t geometry_id; // of the first submesh, the others follow
 		uint32_t vertex_count = 0;
 		uint32_t triangle_count = 0;
 		GeometryData instance_data;
 		MeshBuffers meshBuffers;
+		BoundingSphere bounds;
+		Aabb bounding_box; // object space
 		std::shared_ptr<AccelerationStructure> accelerationStructure;
+		std::vector<MeshLod> lods;
 	};
 
 } // namespace RtEngine
@@ -1,6 +1,7 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <Handle.hpp>
 #include <string>
 #include <vulkan/vulkan_core.h>
 
@@ -19,6 +20,9 @@ namespace RtEngine {
 		ENVIRONMENT,
 	};
 
+	class Texture;
+	using TextureHandle = Handle<Texture>;
+
 	class Texture {
 	public:
 		Texture() = default;
@@ -30,6 +34,8 @@ namespace RtEngine {
 		std::string path;
 		TextureType type;
 		AllocatedImage image;
+		uint64_t content_hash = 0; // 0 for images not owned by the texture repository
+		TextureHandle handle; // given out by the texture repository
 	};
 
 } // namespace RtEngine
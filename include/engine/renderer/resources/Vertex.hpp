@@ -53,7 +53,8 @@ namespace RtEngine {
 		}
 
 		bool operator==(const Vertex &other) const {
-			return pos == other.pos && color == other.color && texCoord == other.texCoord && normal == other.normal;
+			return pos == other.pos && color == other.color && texCoord == other.texCoord && normal == other.normal &&
+				   tangent == other.tangent;
 		}
 	};
 } // namespace RtEngine
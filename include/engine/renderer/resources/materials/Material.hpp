@@ -45,6 +45,8 @@ namespace RtEngine {
 		std::vector<std::shared_ptr<MaterialInstance>> getInstances();
 
 		std::shared_ptr<MaterialInstance> getInstanceByName(const std::string &name);
+		// nullptr once the instance was dropped by a reset
+		MaterialInstance *getInstance(MaterialInstanceHandle handle) const;
 
 		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override = 0;
 		virtual void getPushConstantValues(std::vector<int32_t>& push_constants) = 0;
@@ -59,7 +61,10 @@ namespace RtEngine {
 		DescriptorAllocator descriptorAllocator;
 		DeletionQueue mainDeletionQueue;
 
+		void addInstance(const std::shared_ptr<MaterialInstance> &instance);
+
 		std::unordered_map<std::string, std::shared_ptr<MaterialInstance>> instances;
+		HandleTable<MaterialInstance> instance_table;
 	};
 
 } // namespace RtEngine
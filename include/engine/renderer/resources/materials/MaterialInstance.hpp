@@ -1,11 +1,15 @@
 #ifndef VULKAN_RAYTRACING_MATERIALINSTANCE_HPP
 #define VULKAN_RAYTRACING_MATERIALINSTANCE_HPP
+#include "Handle.hpp"
 #include "MaterialTextures.hpp"
 #include "ISerializable.hpp"
 #include <yaml-cpp/yaml.h>
 #include "YAML_glm.hpp"
 
 namespace RtEngine {
+    class MaterialInstance;
+    using MaterialInstanceHandle = Handle<MaterialInstance>;
+
     class MaterialInstance : public ISerializable {
     public:
         MaterialInstance() = default;
@@ -25,10 +29,15 @@ namespace RtEngine {
         }
 
         virtual float getEmissionPower() { return 0.0f; }
+        // index of a parameter by its key in the scene file, -1 if there is no such parameter
+        virtual int32_t findParameter(const std::string &parameter) const { return -1; }
+        // index comes from findParameter, scalars are taken from x
+        virtual void setParameter(int32_t index, const glm::vec4 &value) {}
 
         void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override = 0;
 
         std::string name = "";
+        MaterialInstanceHandle handle; // given out by the material owning the instance
     protected:
         uint32_t material_index = 0;
     };
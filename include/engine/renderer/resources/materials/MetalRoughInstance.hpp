@@ -1,6 +1,8 @@
 #ifndef VULKAN_RAYTRACING_METALROUGHINSTANCE_HPP
 #define VULKAN_RAYTRACING_METALROUGHINSTANCE_HPP
+#include <array>
 #include <glm/gtc/epsilon.hpp>
+#include <string_view>
 
 #include "MaterialInstance.hpp"
 #include "MaterialTextures.hpp"
@@ -18,16 +20,23 @@ namespace RtEngine {
         YAML::Node writeResourcesToYaml() override;
 
         float getEmissionPower() override;
+        int32_t findParameter(const std::string &parameter) const override;
+        void setParameter(int32_t index, const glm::vec4 &value) override;
 
         void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
 
     protected:
+        // in the order of PARAMETER_NAMES
+        enum Parameter : int32_t { ALBEDO, METALLIC, ROUGHNESS, AO, ETA, EMISSION_COLOR, EMISSION_POWER };
+        static constexpr std::array<std::string_view, 7> PARAMETER_NAMES = {
+            "albedo", "metallic", "roughness", "ao", "eta", "emission_color", "emission_power"};
+
         struct MetalRoughResources {
             glm::vec3 albedo;
             float padding;
             glm::vec4 properties; // metallic roughness ao eta
             glm::vec4 emission;
-            glm::ivec4 tex_indices; // albedo, metal_rough_ao, normal
+            glm::ivec4 tex_indices; // albedo, metal_rough_ao, normal, metal_rough_ao channel layout
             bool operator==(const MetalRoughResources &other) const {
                 return glm::all(glm::epsilonEqual(albedo, other.albedo, 0.0001f)) &&
                        glm::all(glm::epsilonEqual(properties, other.properties, 0.0001f)) &&
@@ -41,6 +50,8 @@ namespace RtEngine {
         std::shared_ptr<Texture> albedo_tex;
         std::shared_ptr<Texture> metal_rough_ao_tex;
         std::shared_ptr<Texture> normal_tex;
+        // gltf packs the texture as ao, roughness, metallic instead of metallic, roughness, ao
+        bool gltf_channel_layout = false;
 
         glm::vec3 albedo = glm::vec3(0.0f);
         float metallic = 0.5f, roughness = 0.5f, ao = 0.5f, eta = 1;
@@ -2,6 +2,7 @@
 #define GEOMETRYMANAGER_HPP
 
 #include <VulkanContext.hpp>
+#include <unordered_map>
 
 namespace RtEngine {
 
@@ -12,19 +13,60 @@ namespace RtEngine {
 			vulkan_context(vulkan_context) {}
 
 		void createGeometryBuffers(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets);
+		// writes a reloaded mesh into its existing range and rebuilds only its blas,
+		// returns false if the mesh no longer fits into the range it was uploaded to
+		bool updateMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset);
 		void writeGeometryBuffers() const;
+		// replaced blas stay alive until the tlas referencing them was rebuilt
+		void destroyRetiredBlas();
+		// the geometry ids, offsets and blas live in the mesh assets, which are shared with the other scenes using
+		// the same meshes. writes the ones of this manager back before its scene is shown again
+		void bindMeshAssets() const;
+		VkDeviceSize getDeviceMemorySize() const;
+
+		void setCompactVertices(bool compact);
+		bool usesCompactVertices() const;
 
 		void destroy();
 
 	private:
-		AllocatedBuffer createVertexBuffer(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) const;
+		void createVertexBuffers(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets);
 		AllocatedBuffer createIndexBuffer(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) const;
 		AllocatedBuffer createGeometryMappingBuffer(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) const;
 		void createBlas(std::vector<std::shared_ptr<MeshAsset>> &meshes);
+		std::shared_ptr<AccelerationStructure> buildBlas(uint32_t vertex_count, const GeometryData &geometry_data,
+														 const std::vector<Submesh> &submeshes) const;
+		// writes the geometry mapping entries of the submeshes starting at geometry_id
+		void stageSubmeshGeometryData(uint32_t geometry_id, const GeometryData &mesh_data,
+									  const std::vector<Submesh> &submeshes) const;
+		// full index buffer and all lods
+		static uint32_t getIndexCount(const MeshBuffers &mesh_buffers);
+		void storeMeshBinding(const std::shared_ptr<MeshAsset> &mesh_asset);
 
 		std::shared_ptr<VulkanContext> vulkan_context;
-		AllocatedBuffer vertex_buffer, index_buffer, geometry_mapping_buffer;
-		std::vector<std::shared_ptr<AccelerationStructure>> blas;
+		uint32_t getVertexStride() const;
+
+		// with compact vertices the vertex buffer only holds positions and the attributes are stored separately
+		bool compact_vertices = false;
+		AllocatedBuffer vertex_buffer, attribute_buffer, index_buffer, geometry_mapping_buffer;
+		std::vector<std::shared_ptr<AccelerationStructure>> blas, retired_blas;
+
+		// the space reserved for each mesh in the shared buffers, keyed by the geometry id of its first submesh
+		struct GeometryRange {
+			uint32_t vertex_capacity;
+			uint32_t index_capacity;
+			uint32_t submesh_count;
+		};
+		std::unordered_map<uint32_t, GeometryRange> geometry_ranges;
+
+		struct MeshBinding {
+			std::shared_ptr<MeshAsset> mesh_asset;
+			uint32_t geometry_id;
+			GeometryData instance_data;
+			std::shared_ptr<AccelerationStructure> acceleration_structure;
+			std::vector<MeshLod> lods;
+		};
+		std::vector<MeshBinding> mesh_bindings;
 	};
 } // namespace RtEngine
 
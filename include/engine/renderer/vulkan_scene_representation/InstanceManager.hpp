@@ -6,6 +6,7 @@
 #define INSTANCEMANAGER_HPP
 
 #include <Material.hpp>
+#include <MeshRepository.hpp>
 
 #include "../resources/IRenderable.hpp"
 
@@ -17,7 +18,7 @@ namespace RtEngine {
 		InstanceManager(std::shared_ptr<ResourceBuilder> resource_builder) : resource_builder(resource_builder) {}
 
 		void createInstanceMappingBuffer(std::vector<RenderObject> &objects);
-		void createEmittingInstancesBuffer(const std::vector<RenderObject> &objects);
+		void createEmittingInstancesBuffer(const std::vector<RenderObject> &objects, const MeshRepository &mesh_repository);
 
 		AllocatedBuffer getInstanceBuffer() const;
 		AllocatedBuffer getEmittingInstancesBuffer() const;
@@ -11,13 +11,24 @@ namespace RtEngine {
         MaterialManager(std::shared_ptr<ResourceBuilder> resource_builder, std::shared_ptr<TextureRepository> tex_repo);
 
         void updateMaterialResources(std::shared_ptr<IScene> scene);
+        // rewrites the material buffer in place and refreshes the texture descriptors,
+        // falls back to a full update if the instances no longer fit into the buffer
+        void patchMaterialResources(std::shared_ptr<IScene> scene);
+        // collects the material buffer contents for a write recorded into the frame, false if the instances no longer
+        // fit into the buffer or refer to new textures and need a patch instead
+        bool collectMaterialValues(std::shared_ptr<IScene> scene, std::vector<uint32_t> *material_values) const;
 
         AllocatedBuffer createMaterialBuffer(const std::vector<std::shared_ptr<MaterialInstance>> &instances) const;
+        size_t getDeviceMemorySize() const { return material_buffer.size; }
+        VkBuffer getMaterialBuffer() const { return material_buffer.handle; }
 
         void destroy();
 
     private:
+        std::vector<std::byte> collectMaterialData(const std::vector<std::shared_ptr<MaterialInstance>> &instances) const;
+
         std::shared_ptr<ResourceBuilder> resource_builder;
+        std::shared_ptr<TextureRepository> tex_repo;
 
         AllocatedBuffer material_buffer;
         std::shared_ptr<MaterialTextures<>> material_textures;
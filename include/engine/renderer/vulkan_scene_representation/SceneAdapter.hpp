@@ -1,8 +1,10 @@
 #ifndef SCENEMANAGER_HPP
 #define SCENEMANAGER_HPP
 
+#include <DrawList.hpp>
 #include <GeometryManager.hpp>
 #include <InstanceManager.hpp>
+#include <MeshRepository.hpp>
 #include <memory>
 #include <OptionsWindow.hpp>
 #include <VulkanContext.hpp>
@@ -13,6 +15,38 @@
 #include "UpdateFlagValue.hpp"
 
 namespace RtEngine {
+	// a write into a device local buffer that frames in flight may still read, recorded into the next frame
+	struct PendingBufferWrite {
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		std::vector<uint32_t> data;
+	};
+
+	// everything on the gpu that belongs to one loaded scene. a new set is built next to the active one, so the
+	// active scene keeps rendering until the new one is complete
+	struct SceneResources {
+		std::shared_ptr<IScene> scene;
+
+		std::shared_ptr<GeometryManager> geometry_manager;
+		std::shared_ptr<InstanceManager> instance_manager;
+		std::shared_ptr<MaterialManager> material_manager;
+		std::shared_ptr<AccelerationStructure> top_level_acceleration_structure;
+		std::vector<AllocatedBuffer> uniform_buffers;
+		std::vector<void *> uniform_buffers_mapped;
+
+		// lod of every instance in the tlas, 0 is the full mesh
+		std::vector<uint32_t> selected_lods;
+		glm::vec3 selected_view_position = glm::vec3(0);
+		float selected_pixels_per_unit = 0.0f;
+		// scratch list of the objects whose lod changed this frame
+		std::vector<uint32_t> lod_changed_objects;
+		// the tlas instances were patched and still have to be refit in the command buffer of the frame
+		bool tlas_refit_pending = false;
+		std::vector<PendingBufferWrite> pending_buffer_writes;
+
+		VkDeviceSize getDeviceMemorySize() const;
+	};
+
 	class SceneAdapter {
 	public:
 		struct SceneInfo
@@ -21,86 +55,110 @@ namespace RtEngine {
 			uint32_t emitting_instances_count;
 		};
 
+		// wall clock time of the last builds, the builds wait for the device so this includes the gpu work
+		struct BuildTimings {
+			double geometry_ms = 0.0; // geometry upload and the blas of every mesh
+			double tlas_build_ms = 0.0;
+			// only the host side, the refit runs in the frame command buffer and counts towards the gpu frame time
+			double tlas_refit_ms = 0.0;
+		};
+
 		SceneAdapter() = default;
 		SceneAdapter(const std::shared_ptr<VulkanContext> &vulkanContext,
 					 const std::shared_ptr<TextureRepository>& texture_repository,
+					 const std::shared_ptr<MeshRepository>& mesh_repository,
 					 const uint32_t max_frames_in_flight,
 					 const VkPhysicalDeviceRayTracingPipelinePropertiesKHR& raytracingProperties) :
-			vulkan_context(vulkanContext), texture_repository(texture_repository),
+			vulkan_context(vulkanContext), texture_repository(texture_repository), mesh_repository(mesh_repository),
 			max_frames_in_flight(max_frames_in_flight) {
 
-			instance_manager = std::make_shared<InstanceManager>(vulkan_context->resource_builder);
-			geometry_manager = std::make_shared<GeometryManager>(vulkan_context);
-			material_manager = std::make_shared<MaterialManager>(vulkan_context->resource_builder, texture_repository);
-
-			main_deletion_queue.pushFunction([&]() {
-				geometry_manager->destroy();
-				instance_manager->destroy();
-				material_manager->destroy();
-			});
-
 			createSceneLayout();
 			createSceneDescriptorSets(scene_descriptor_set_layout);
 			initDefaultResources(raytracingProperties);
 		}
 
-		void loadNewScene(const std::shared_ptr<IScene> &new_scene);
+		// builds the resources of the new scene while the active ones stay untouched, then waits for the device and
+		// swaps them. the previously active resources are returned, to be cached or destroyed by the caller
+		std::shared_ptr<SceneResources> loadNewScene(const std::shared_ptr<IScene> &new_scene);
+		// shows resources built by an earlier loadNewScene again with their tlas and instance buffers, only the
+		// material buffer is uploaded again. returns the previously active ones
+		std::shared_ptr<SceneResources> activateSceneResources(const std::shared_ptr<SceneResources> &resources);
+		// the resources must not be the active ones
+		void destroySceneResources(SceneResources &resources) const;
+		void setCompactVertices(bool compact);
+		void setLodSelection(bool enabled, float max_pixel_error);
 
 		void updateScene(const std::shared_ptr<DrawContext> &draw_context, uint32_t current_frame, UpdateFlagsHandle update_flags);
+		// records the updates that updateScene left for the gpu in front of the ray tracing of the frame
+		void recordFrameUpdates(VkCommandBuffer command_buffer, uint32_t current_frame);
 		void updateRenderTarget(std::shared_ptr<RenderTarget> target);
+		void reloadMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset);
 
 		void clearResources();
 
 		std::shared_ptr<Material> getMaterial() const;
 		VkDescriptorSet getSceneDescriptorSet(uint32_t frame_index) const;
+		const BuildTimings &getBuildTimings() const { return build_timings; }
 
 		std::shared_ptr<VulkanContext> vulkan_context;
 		std::shared_ptr<TextureRepository> texture_repository;
+		std::shared_ptr<MeshRepository> mesh_repository;
 
 		std::unordered_map<std::string, std::shared_ptr<Material>> defaultMaterials;
 
 	private:
 		void createSceneLayout();
 		void createSceneDescriptorSets(const VkDescriptorSetLayout &layout);
-		void createUniformBuffers(const std::shared_ptr<IScene> &scene);
+		std::shared_ptr<SceneResources> createSceneResources(const std::shared_ptr<IScene> &scene);
+		void createUniformBuffers(SceneResources &resources) const;
 
 		void initDefaultResources(const VkPhysicalDeviceRayTracingPipelinePropertiesKHR& raytracingProperties);
 		void createDefaultSamplers();
 		void createDefaultMaterials(const VkPhysicalDeviceRayTracingPipelinePropertiesKHR& raytracingProperties);
 
-		void setupNewScene(const std::shared_ptr<IScene> &scene);
-		void createTlas();
-
-		void updateGeometryResources(const std::shared_ptr<IScene> &scene);
-		void updateStaticGeometry(std::vector<RenderObject> render_objects, UpdateFlagsHandle update_flags);
-		void updateDynamicGeometry(std::vector<RenderObject> render_objects, uint32_t update_flags);
+		void createTlas(SceneResources &resources) const;
+
+		void updateGeometryResources(SceneResources &resources);
+		// switches render objects to the coarsest lod whose error stays below lod_pixel_error on screen, with some
+		// hysteresis around the threshold. all of them if select_all is set or the view changed and only the moved
+		// ones otherwise. changed_objects receives the objects whose lod differs from the one in the tlas
+		void selectLods(std::vector<RenderObject> &render_objects, const DrawListChanges &changes,
+						const DrawContext &draw_context, bool select_all, std::vector<uint32_t> *changed_objects);
+		bool selectLod(RenderObject &object, const DrawContext &draw_context, uint32_t &selected_lod) const;
+		// rebuilds the instance buffer and the tlas
+		void updateStaticGeometry(std::vector<RenderObject> &render_objects);
+		// patches the transforms of the moved instances and the blas and geometry id of the lod switches, the tlas
+		// is refit and the instance buffer written with the next frame. returns true if an emitter moved
+		bool updateDynamicGeometry(const std::vector<RenderObject> &render_objects,
+								   const std::vector<uint32_t> &moved_objects,
+								   const std::vector<uint32_t> &lod_changed_objects);
+		void updateEmittingInstances(const std::vector<RenderObject> &render_objects);
 
 		void updateSceneDescriptorSets();
-		void updateTlas(std::vector<RenderObject> objects) const;
+		void updateTlas(const std::vector<RenderObject> &objects) const;
 
-		void updateMaterial(const std::shared_ptr<IScene> &scene) const;
+		void updateMaterial() const;
 
-		void updateSceneData(const std::shared_ptr<IScene> &scene, const std::shared_ptr<DrawContext> &draw_context, uint32_t current_frame) const;
+		void updateSceneData(const std::shared_ptr<IScene> &scene, const DrawList &draw_list, uint32_t current_frame) const;
 
-		DeletionQueue main_deletion_queue, scene_resource_deletion_queue;
+		DeletionQueue main_deletion_queue;
 		uint32_t max_frames_in_flight;
 
-		std::shared_ptr<IScene> loaded_scene;
+		std::shared_ptr<SceneResources> active_resources;
 
 		VkSampler defaultSamplerLinear;
 		VkSampler defaultSamplerNearest;
 		VkSampler defaultSamplerAnisotropic;
 
-		std::shared_ptr<GeometryManager> geometry_manager;
-		std::shared_ptr<InstanceManager> instance_manager;
-		std::shared_ptr<MaterialManager> material_manager;
+		// applied to the geometry of the next loaded scene
+		bool compact_vertices = false;
+		bool mesh_lods = true;
+		float lod_pixel_error = 1.0f;
 
-		std::shared_ptr<AccelerationStructure> top_level_acceleration_structure;
+		BuildTimings build_timings;
 
 		VkDescriptorSetLayout scene_descriptor_set_layout;
 		std::vector<VkDescriptorSet> scene_descriptor_sets{};
-		std::vector<AllocatedBuffer> sceneUniformBuffers;
-		std::vector<void *> sceneUniformBuffersMapped;
 	};
 
 } // namespace RtEngine
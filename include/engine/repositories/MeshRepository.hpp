@@ -1,12 +1,15 @@
 #ifndef MESHREPOSITORY_HPP
 #define MESHREPOSITORY_HPP
 #include <DeletionQueue.hpp>
+#include <Handle.hpp>
+#include <HashUtil.hpp>
 #include <MeshAssetBuilder.hpp>
 
 #include <memory>
 
 namespace RtEngine {
 	class VulkanContext;
+	class AssetPack;
 
 	class MeshRepository {
 	public:
@@ -14,14 +17,33 @@ namespace RtEngine {
 		MeshRepository(const std::shared_ptr<VulkanContext> &context, const std::string &resource_dir);
 
 		std::shared_ptr<MeshAsset> getMesh(const std::string &name);
+		// for per frame lookups, nullptr after destroy
+		MeshAsset *getMesh(MeshHandle handle) const { return mesh_table.get(handle); }
 		std::string addMesh(std::string path);
+		// registers a mesh imported by importMesh, returns the name given to the mesh
+		std::string addMesh(const std::string &path, MeshAsset mesh_asset);
+		// reads the mesh from pack or imports the file without registering it, so it can run on a loader thread
+		MeshAsset importMesh(const std::string &path, const std::shared_ptr<AssetPack> &pack) const;
+		bool hasMesh(const std::string &path) const { return mesh_path_cache.contains(path); }
+		// reloads a changed file into the already loaded asset, returns nullptr if no mesh was loaded from the path
+		std::shared_ptr<MeshAsset> reloadMesh(const std::string &path);
+		// material instance nodes that come with the model file, packed scenes already contain them and must not ask
+		std::vector<YAML::Node> loadMeshMaterials(const std::string &path) const;
+		// meshes found in a mounted pack are read from it instead of being imported from disk
+		void setAssetPack(const std::shared_ptr<AssetPack> &pack);
+		const DeduplicationStats &getDeduplicationStats() const;
+		void resetDeduplicationStats();
 		void destroy();
 
 	private:
 		std::shared_ptr<MeshAssetBuilder> mesh_asset_builder;
 		DeletionQueue deletion_queue;
+		std::shared_ptr<AssetPack> asset_pack;
 
 		std::unordered_map<std::string, std::shared_ptr<MeshAsset>> mesh_name_cache, mesh_path_cache;
+		std::unordered_map<uint64_t, std::shared_ptr<MeshAsset>> mesh_hash_cache;
+		HandleTable<MeshAsset> mesh_table;
+		DeduplicationStats dedup_stats;
 	};
 
 } // namespace RtEngine
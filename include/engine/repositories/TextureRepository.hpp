@@ -5,10 +5,17 @@
 #ifndef VULKAN_RAYTRACING_TEXTUREREPOSITORY_HPP
 #define VULKAN_RAYTRACING_TEXTUREREPOSITORY_HPP
 
+#include <algorithm>
+#include <array>
 #include <glm/packing.hpp>
 #include <glm/vec4.hpp>
 #include <spdlog/spdlog.h>
 
+#include "AssetPack.hpp"
+#include "Handle.hpp"
+#include "HashUtil.hpp"
+#include "PathUtil.hpp"
+#include "QuickTimer.hpp"
 #include "ResourceBuilder.hpp"
 #include "Texture.hpp"
 
@@ -25,12 +32,177 @@ namespace RtEngine {
                 return texture_path_cache[path];
             }
 
-            const std::shared_ptr<Texture> tex = std::make_shared<Texture>(resource_builder->loadTextureImage(path, type));
-            texture_name_cache[tex->name] = tex;
-            texture_path_cache[tex->path] = tex;
+            // the image is filled in by the next uploadPendingTextures call
+            const std::shared_ptr<Texture> tex =
+                    std::make_shared<Texture>(PathUtil::getFileName(path), type, path, AllocatedImage{});
+            addTexture(tex);
+            pending_textures.push_back(tex);
             return tex;
         }
 
+        // decodes all textures added since the last call in parallel and uploads them in one batch,
+        // textures missing from the disk cache get their mip chain and block compression generated first.
+        // loaded_images holds images a loader thread already got through loadTextureImages, keyed by path.
+        // a texture that fails to load keeps its handle and shows the default texture, or its previous image if it
+        // had one. returns false if any texture failed
+        bool uploadPendingTextures(std::unordered_map<std::string, ImageData> loaded_images = {}) {
+            if (pending_textures.empty()) {
+                return true;
+            }
+            QuickTimer timer("Decoding and uploading textures");
+
+            std::vector<ImageData> image_data(pending_textures.size());
+            std::vector<std::pair<std::string, TextureType>> missing_textures;
+            std::vector<uint32_t> missing_indices;
+            for (uint32_t i = 0; i < pending_textures.size(); i++) {
+                auto loaded_image = loaded_images.find(pending_textures[i]->path);
+                if (loaded_image != loaded_images.end()) {
+                    image_data[i] = std::move(loaded_image->second);
+                } else {
+                    missing_textures.emplace_back(pending_textures[i]->path, pending_textures[i]->type);
+                    missing_indices.push_back(i);
+                }
+            }
+
+            std::vector<ImageData> missing_images(missing_textures.size());
+            std::vector<std::string> errors(missing_textures.size());
+            loadImages(missing_textures, asset_pack, missing_images, &errors);
+
+            // materials already hold the handles, so failed textures stay registered
+            std::vector<uint8_t> failed(pending_textures.size(), 0);
+            for (uint32_t i = 0; i < missing_indices.size(); i++) {
+                if (errors[i].empty()) {
+                    image_data[missing_indices[i]] = std::move(missing_images[i]);
+                    continue;
+                }
+                const std::shared_ptr<Texture> &tex = pending_textures[missing_indices[i]];
+                spdlog::error("Failed to load texture {}: {}", tex->path, errors[i]);
+                failed[missing_indices[i]] = 1;
+                if (tex->image.image == VK_NULL_HANDLE) {
+                    tex->image = getDefaultTex(tex->type)->image;
+                    tex->content_hash = 0;
+                }
+            }
+            uint32_t loaded_count = 0;
+            for (uint32_t i = 0; i < pending_textures.size(); i++) {
+                if (failed[i]) {
+                    continue;
+                }
+                if (i != loaded_count) {
+                    image_data[loaded_count] = std::move(image_data[i]);
+                    pending_textures[loaded_count] = pending_textures[i];
+                }
+                loaded_count++;
+            }
+            const bool all_loaded = loaded_count == pending_textures.size();
+            image_data.resize(loaded_count);
+            pending_textures.resize(loaded_count);
+
+            std::vector<uint64_t> content_hashes(pending_textures.size());
+#pragma omp parallel for
+            for (int i = 0; i < static_cast<int>(pending_textures.size()); i++) {
+                content_hashes[i] = hashImageData(image_data[i]);
+            }
+
+            // identical content under different paths is uploaded once and shared
+            std::vector<ImageData> upload_data;
+            std::vector<uint64_t> upload_hashes;
+            for (uint32_t i = 0; i < pending_textures.size(); i++) {
+                const uint64_t hash = content_hashes[i];
+                if (shared_images.contains(hash) ||
+                    std::find(upload_hashes.begin(), upload_hashes.end(), hash) != upload_hashes.end()) {
+                    spdlog::debug("Texture {} has the same content as an already loaded texture",
+                                  pending_textures[i]->path);
+                    dedup_stats.aliased_assets++;
+                    dedup_stats.bytes_saved += image_data[i].bytes().size();
+                    continue;
+                }
+                upload_data.push_back(std::move(image_data[i]));
+                upload_hashes.push_back(hash);
+            }
+
+            std::vector<AllocatedImage> images = resource_builder->createImages(
+                    upload_data, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+            for (uint32_t i = 0; i < images.size(); i++) {
+                shared_images[upload_hashes[i]] = SharedImage{images[i], 0};
+            }
+            for (uint32_t i = 0; i < pending_textures.size(); i++) {
+                SharedImage &shared_image = shared_images[content_hashes[i]];
+                shared_image.ref_count++;
+                pending_textures[i]->image = shared_image.image;
+                pending_textures[i]->content_hash = content_hashes[i];
+            }
+            spdlog::debug("Uploaded {} of {} textures in one batch", images.size(), pending_textures.size());
+            pending_textures.clear();
+            return all_loaded;
+        }
+
+        // decodes and imports textures without uploading or registering them, so a loader thread can prepare the
+        // textures of the next scene while the current one is rendered. images from pack stay mapped in it.
+        // textures that fail are left out, uploadPendingTextures tries them again and falls back to the default
+        std::unordered_map<std::string, ImageData> loadTextureImages(
+                const std::vector<std::pair<std::string, TextureType>> &textures,
+                const std::shared_ptr<AssetPack> &pack) const {
+            std::vector<ImageData> image_data(textures.size());
+            std::vector<std::string> errors(textures.size());
+            loadImages(textures, pack, image_data, &errors);
+
+            std::unordered_map<std::string, ImageData> loaded_images;
+            for (uint32_t i = 0; i < textures.size(); i++) {
+                if (errors[i].empty()) {
+                    loaded_images[textures[i].first] = std::move(image_data[i]);
+                }
+            }
+            return loaded_images;
+        }
+
+        bool hasTexture(const std::string &path) const {
+            return texture_path_cache.contains(path);
+        }
+
+        // re-decodes a changed file into the already loaded texture object, every material slot holding it sees
+        // the new image once its descriptors are rewritten, returns false if no texture was loaded from the path
+        bool reloadTexture(const std::string &path) {
+            if (!texture_path_cache.contains(path)) {
+                return false;
+            }
+            const std::shared_ptr<Texture> tex = texture_path_cache[path];
+            if (std::find(pending_textures.begin(), pending_textures.end(), tex) != pending_textures.end()) {
+                return true;
+            }
+
+            // textures added elsewhere go first, so a failure below belongs to this one
+            uploadPendingTextures();
+
+            // the texture keeps its handle and its old image if decoding fails
+            const uint64_t old_hash = tex->content_hash;
+            pending_textures.push_back(tex);
+            if (!uploadPendingTextures()) {
+                throw std::runtime_error("Keeping the previous image of " + path);
+            }
+            releaseImage(old_hash);
+            spdlog::info("Reloaded texture {}", path);
+            return true;
+        }
+
+        const DeduplicationStats &getDeduplicationStats() const {
+            return dedup_stats;
+        }
+
+        void resetDeduplicationStats() {
+            dedup_stats = {};
+        }
+
+        // textures found in a mounted pack are read from it instead of being imported from disk
+        void setAssetPack(const std::shared_ptr<AssetPack> &pack) {
+            asset_pack = pack;
+        }
+
+        // for lookups on hot paths, the handle only resolves to the texture object, its image may still be pending
+        Texture *getTexture(const TextureHandle handle) const {
+            return texture_table.get(handle);
+        }
+
         std::shared_ptr<Texture> getTextureByName(const std::string& name) {
             if (!texture_name_cache.contains(name)) {
                 return error_tex;
@@ -77,15 +249,84 @@ namespace RtEngine {
         }
 
         void destroy() {
-            for (const auto&[_, tex] : texture_name_cache) {
+            for (const auto &tex : {default_tex, default_normal_tex, error_tex}) {
                 resource_builder->destroyImage(tex->image);
             }
+            for (const auto &[_, shared_image] : shared_images) {
+                resource_builder->destroyImage(shared_image.image);
+            }
+            shared_images.clear();
             texture_name_cache.clear();
             texture_path_cache.clear();
+            texture_table.clear();
         }
 
     private:
+        // textures stay registered until destroy, materials of cached scenes still hold their handles. ref_count
+        // is the number of textures showing the image, a reload that moves the last of them to new content frees it
+        struct SharedImage {
+            AllocatedImage image;
+            uint32_t ref_count;
+        };
+
+        // decodes in parallel, then imports the textures missing from the disk cache. errors holds one message per
+        // texture, empty for the ones that loaded
+        void loadImages(const std::vector<std::pair<std::string, TextureType>> &textures,
+                        const std::shared_ptr<AssetPack> &pack, std::vector<ImageData> &image_data,
+                        std::vector<std::string> *errors) const {
+            std::vector<uint8_t> needs_import(textures.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < static_cast<int>(textures.size()); i++) {
+                try {
+                    const auto &[path, type] = textures[i];
+                    if (pack != nullptr && pack->readTexture(path, image_data[i])) {
+                        // packed textures are already imported and are uploaded straight from the mapping
+                        resource_builder->validateTextureFormat(path, image_data[i], type);
+                    } else if (PathUtil::getExtension(path) == "ktx2") {
+                        // KTX2 files already carry their final format and mip chain
+                        image_data[i] = resource_builder->loadKtx2Texture(path, type);
+                    } else if (!resource_builder->loadImportedTexture(path, type, image_data[i])) {
+                        image_data[i] = resource_builder->decodeTextureImage(path, type);
+                        needs_import[i] = 1;
+                    }
+                } catch (const std::exception &e) {
+                    (*errors)[i] = e.what();
+                }
+            }
+
+            // the encoder parallelizes over blocks itself, so imports run one texture at a time
+            for (uint32_t i = 0; i < textures.size(); i++) {
+                if (needs_import[i] && (*errors)[i].empty()) {
+                    spdlog::info("Importing texture {}", textures[i].first);
+                    resource_builder->importTextureImage(textures[i].first, textures[i].second, image_data[i]);
+                }
+            }
+        }
+
+        static uint64_t hashImageData(const ImageData &image_data) {
+            const std::span<const uint8_t> bytes = image_data.bytes();
+            const std::array<uint32_t, 4> description = {static_cast<uint32_t>(image_data.format),
+                                                         image_data.extent.width, image_data.extent.height,
+                                                         image_data.mip_levels};
+            const uint64_t seed = HashUtil::xxHash64(description.data(), sizeof(description));
+            return HashUtil::xxHash64(bytes.data(), bytes.size(), seed);
+        }
+
+        void releaseImage(const uint64_t content_hash) {
+            if (!shared_images.contains(content_hash)) {
+                return;
+            }
+            SharedImage &shared_image = shared_images[content_hash];
+            if (--shared_image.ref_count == 0) {
+                resource_builder->destroyImage(shared_image.image);
+                shared_images.erase(content_hash);
+            }
+        }
+
         std::shared_ptr<Texture> addTexture(std::shared_ptr<Texture> tex) {
+            if (!tex->handle.isValid()) {
+                tex->handle = texture_table.insert(tex);
+            }
             texture_name_cache[tex->name] = tex;
             texture_path_cache[tex->path] = tex;
             return tex;
@@ -93,6 +334,11 @@ namespace RtEngine {
 
         std::shared_ptr<ResourceBuilder> resource_builder;
         std::unordered_map<std::string, std::shared_ptr<Texture>> texture_name_cache, texture_path_cache;
+        HandleTable<Texture> texture_table;
+        std::vector<std::shared_ptr<Texture>> pending_textures;
+        std::shared_ptr<AssetPack> asset_pack;
+        std::unordered_map<uint64_t, SharedImage> shared_images;
+        DeduplicationStats dedup_stats;
 
         std::shared_ptr<Texture> default_tex, default_normal_tex, error_tex;
 
@@ -1,6 +1,9 @@
 #ifndef VULKAN_RAYTRACING_RUNNER_HPP
 #define VULKAN_RAYTRACING_RUNNER_HPP
+#include <future>
+
 #include "ISerializable.hpp"
+#include "ResourceWatcher.hpp"
 #include "SceneManager.hpp"
 #include "SceneReader.hpp"
 #include "VulkanRenderer.hpp"
@@ -11,10 +14,15 @@ namespace RtEngine {
         Runner(std::shared_ptr<EngineContext> engine_context, const std::shared_ptr<GuiRenderer> &gui_renderer, const std::shared_ptr<SceneManager> &scene_manager);
 
         std::string getScenePath() const;
+        // loads the scene before returning, renderScene loads scene switches in the background instead
         virtual void loadScene(const std::string &scene_path);
         virtual void renderScene();
 
         void setUpdateFlags(const UpdateFlagsHandle &new_flags) const;
+        // blocks until a background load is done and drops the scene, nothing may be torn down while it runs
+        void waitForSceneLoad();
+        // destroys every cached scene, the renderer has to be idle
+        void clearSceneCache();
 
         bool isRunning() const;
 
@@ -28,19 +36,40 @@ namespace RtEngine {
 
         void handle_resize() const;
 
+        // the scene is prepared on a loader thread while the current one keeps rendering, it is swapped in between
+        // two frames once it is ready
+        void startSceneLoad(const std::string &scene_path);
+        void finishSceneLoad();
+        void activateScene(PreparedScene prepared_scene);
+        // switching back to a recently shown scene reuses its gpu resources, nothing is read or uploaded
+        void activateCachedScene(CachedScene cached_scene);
+        void retireScene(const std::shared_ptr<Scene> &old_scene, const std::shared_ptr<SceneResources> &old_resources);
+        void destroyCachedScenes(const std::vector<CachedScene> &cached_scenes) const;
+
+        void reloadChangedResources();
+        void reloadSceneMaterials();
+
         std::shared_ptr<DrawContext> createMainDrawContext() const;
 
         bool running = true;
         std::string scene_name;
+        uint32_t cached_scene_count = 2;
+        float scene_cache_budget_mb = 1024.0f;
 
         std::shared_ptr<EngineContext> engine_context;
         std::shared_ptr<VulkanRenderer> renderer;
         std::shared_ptr<GuiRenderer> gui_manager;
 
+        std::shared_ptr<DrawContext> main_draw_context;
         std::shared_ptr<SceneReader> scene_reader;
         std::shared_ptr<SceneManager> scene_manager;
+        std::shared_ptr<ResourceWatcher> resource_watcher;
 
         UpdateFlagsHandle update_flags;
+
+        std::future<PreparedScene> pending_scene;
+        // requested while another scene was loading, that one is dropped once it is ready
+        std::string queued_scene_path;
     };
 } // RtEngine
 
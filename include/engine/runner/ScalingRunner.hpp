@@ -0,0 +1,61 @@
+#ifndef SCALINGRUNNER_HPP
+#define SCALINGRUNNER_HPP
+
+#include <StressSceneGenerator.hpp>
+#include <random>
+
+#include "Runner.hpp"
+
+namespace RtEngine {
+	struct ScalingResult {
+		StressSceneParameters parameters;
+		uint64_t triangle_count = 0;
+		double load_ms = 0.0; // reading the scene and starting it, without any gpu work
+		double geometry_ms = 0.0;
+		double tlas_build_ms = 0.0;
+		double cpu_update_ms = 0.0; // scene update and scene representation update per frame
+		double tlas_refit_ms = 0.0;
+		double gpu_frame_ms = 0.0;
+		double device_memory_mb = 0.0;
+	};
+
+	// loads generated stress scenes of growing size one after another and writes one row per scene to
+	// resources/benchmarks/scaling_<tag>.csv
+	class ScalingRunner : public Runner {
+	public:
+		ScalingRunner(const std::shared_ptr<EngineContext> &engine_context,
+					  const std::shared_ptr<GuiRenderer> &gui_renderer,
+					  const std::shared_ptr<SceneManager> &scene_manager, const std::string &tag);
+
+		void loadScene(const std::string &scene_path) override;
+		void renderScene() override;
+
+	protected:
+		void prepareFrame(VkCommandBuffer cmd, const std::shared_ptr<DrawContext> &draw_context) override;
+
+	private:
+		void startCase();
+		void finishCase();
+		// moves MOVING_FRACTION of every instance array a little, so every frame refits the tlas
+		void moveInstances();
+		void writeResults() const;
+
+		static constexpr uint32_t WARMUP_FRAMES = 5;
+		static constexpr uint32_t MEASURED_FRAMES = 60;
+		static constexpr float MOVING_FRACTION = 0.01f;
+		// the stress scenes with their instance sidecars, up to tens of MB per case
+		const std::string TMP_FOLDER = "./tmp";
+
+		std::string tag;
+		std::vector<StressSceneParameters> sweep;
+		std::vector<ScalingResult> results;
+		size_t current_case = 0;
+		uint32_t case_frame = 0;
+		ScalingResult current_result;
+		uint32_t gpu_frame_count = 0;
+
+		std::mt19937 random{42};
+	};
+} // namespace RtEngine
+
+#endif // SCALINGRUNNER_HPP
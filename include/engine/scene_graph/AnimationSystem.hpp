@@ -0,0 +1,79 @@
+#ifndef ANIMATIONSYSTEM_HPP
+#define ANIMATIONSYSTEM_HPP
+
+#include <Animation.hpp>
+#include <MaterialInstance.hpp>
+#include <UpdateFlagValue.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RtEngine {
+	class ComponentPools;
+	class Material;
+	class Transform;
+
+	// the keyframes of every animation in a scene back to back, so sampling walks a few flat arrays. all tracks are
+	// sampled in one batch and only the values that changed since the last frame are written to their targets
+	class AnimationSystem {
+	public:
+		// smaller batches are not worth waking up the thread pool for
+		static constexpr int64_t PARALLEL_BATCH_SIZE = 1024;
+
+		AnimationSystem() = default;
+		~AnimationSystem();
+
+		AnimationSystem(const AnimationSystem &) = delete;
+		AnimationSystem &operator=(const AnimationSystem &) = delete;
+
+		// has to be called again whenever nodes or components change, material tracks look up their instance in
+		// material
+		void rebuild(const ComponentPools &component_pools, const std::shared_ptr<Material> &material);
+		void invalidate() { valid = false; }
+		bool isValid() const { return valid; }
+
+		void setLooping(uint32_t first_track, uint32_t track_count, bool loop);
+
+		// samples every track at time and writes the changed values into the transforms and material instances.
+		// returns MATERIAL_VALUES if material parameters changed, MATERIAL_PATCH if an instance started or stopped
+		// emitting and NO_UPDATE otherwise
+		UpdateFlagValue apply(double time);
+
+		size_t getTrackCount() const { return track_targets.size(); }
+		size_t getKeyCount() const { return key_times.size(); }
+		// transforms and material parameters written by the last apply
+		uint32_t getWrittenCount() const { return written_count; }
+
+	private:
+		void sample(double time);
+		void detach();
+
+		// every track owns key_counts[i] keys starting at first_keys[i]
+		std::vector<float> key_times;
+		std::vector<glm::vec4> key_values;
+		std::vector<uint32_t> first_keys;
+		std::vector<uint32_t> key_counts;
+		std::vector<uint8_t> step_interpolation;
+		std::vector<uint8_t> looping;
+		// last key at or before the sampled time, playback mostly moves forward so the search starts there
+		std::vector<uint32_t> key_cursors;
+		std::vector<glm::vec4> samples;
+		std::vector<glm::vec4> written_samples;
+		std::vector<uint8_t> written;
+
+		std::vector<AnimationTarget> track_targets;
+		// one of the two per track, depending on the target. instances are resolved every apply, so a reloaded
+		// material drops its tracks instead of leaving a dangling pointer
+		std::vector<Transform *> transforms;
+		std::vector<MaterialInstanceHandle> material_instances;
+		// from MaterialInstance::findParameter, resolved once in rebuild
+		std::vector<int32_t> parameters;
+		std::shared_ptr<Material> material;
+		std::vector<Animation *> animations;
+
+		uint32_t written_count = 0;
+		bool valid = false;
+	};
+} // namespace RtEngine
+
+#endif // ANIMATIONSYSTEM_HPP
@@ -0,0 +1,51 @@
+#ifndef COMPONENTPOOLS_HPP
+#define COMPONENTPOOLS_HPP
+
+#include <Component.hpp>
+#include <ComponentTypeId.hpp>
+#include <memory>
+#include <vector>
+
+namespace RtEngine {
+	// handles to every component of one concrete type in the scene, in depth first order. the components themselves
+	// stay individually allocated and owned by their nodes, so a pool saves the tree walk and the type checks but
+	// iterating it still follows one pointer per component. systems with hot per frame data, like the physics and
+	// animation systems, copy that data into arrays of their own
+	struct ComponentPool {
+		bool parallel_update = false;
+		bool system_driven = false;
+		std::vector<std::shared_ptr<Component>> components;
+		std::vector<Node *> nodes;
+	};
+
+	// per type pools over all nodes reachable from the root, indexed by ComponentTypeId
+	class ComponentPools {
+	public:
+		// has to be called again whenever nodes or components are added, removed or reparented
+		void rebuild(const std::shared_ptr<Node> &root);
+		void invalidate() { valid = false; }
+		bool isValid() const { return valid; }
+
+		std::vector<ComponentPool> &getPools() { return pools; }
+
+		template<typename T>
+		const ComponentPool &getPool() const {
+			const uint32_t type_id = ComponentTypeId::of<T>();
+			return type_id < pools.size() ? pools[type_id] : empty_pool;
+		}
+
+		template<typename T, typename F>
+		void forEach(F &&function) const {
+			for (const auto &component: getPool<T>().components) {
+				function(std::static_pointer_cast<T>(component));
+			}
+		}
+
+	private:
+		std::vector<ComponentPool> pools;
+		ComponentPool empty_pool;
+		bool valid = false;
+	};
+} // namespace RtEngine
+
+#endif // COMPONENTPOOLS_HPP
@@ -5,11 +5,14 @@
 #include "Material.hpp"
 
 namespace RtEngine {
+    class DrawList;
+
     class ISceneManager {
     public:
         virtual ~ISceneManager() = default;
 
         virtual std::shared_ptr<Material> getCurrentMaterial() = 0;
+        virtual std::shared_ptr<DrawList> getCurrentDrawList() = 0;
     };
 }
 
@@ -0,0 +1,63 @@
+#ifndef INSTANCEARRAY_HPP
+#define INSTANCEARRAY_HPP
+
+#include <DrawList.hpp>
+#include <EngineContext.hpp>
+#include <Material.hpp>
+#include <MeshAsset.hpp>
+#include <string>
+#include <vector>
+
+namespace RtEngine {
+	class InstanceBvh;
+
+	// many copies of one mesh that only differ in their world transform. the copies go straight into the draw list,
+	// there is no node, transform or mesh renderer per copy
+	class InstanceArray {
+	public:
+		InstanceArray(const std::shared_ptr<EngineContext> &context, std::string name, std::string mesh_asset_name,
+					  std::string material_instance_name, std::vector<glm::mat4> transforms) :
+			name(std::move(name)), mesh_asset_name(std::move(mesh_asset_name)),
+			material_instance_name(std::move(material_instance_name)), context(context),
+			transforms(std::move(transforms)) {}
+
+		// adds one draw list entry per transform, they stay there until destroy
+		void start(const std::shared_ptr<DrawList> &scene_draw_list);
+		void destroy();
+		// rebuilds the draw list entries from the current mesh and materials
+		void refreshRenderObjects();
+
+		void setTransform(uint32_t instance, const glm::mat4 &transform);
+		const std::vector<glm::mat4> &getTransforms() const { return transforms; }
+		size_t size() const { return transforms.size(); }
+		// moved copies flag their bvh entries, the copies are entries first_entry and on
+		void attachToBvh(InstanceBvh *bvh, uint32_t first_entry);
+
+		std::shared_ptr<MeshAsset> getMeshAsset() const { return mesh_asset; }
+		const std::vector<std::shared_ptr<MaterialInstance>> &getSubmeshMaterials() const { return submesh_materials; }
+
+		std::string name;
+		std::string mesh_asset_name;
+		// empty if every submesh keeps the material of the model file
+		std::string material_instance_name;
+		// relative to the scene file, empty if the transforms are stored inline
+		std::string transforms_file;
+
+	private:
+		void resolveSubmeshMaterials();
+
+		std::shared_ptr<EngineContext> context;
+		std::vector<glm::mat4> transforms;
+
+		std::shared_ptr<MeshAsset> mesh_asset;
+		std::vector<std::shared_ptr<MaterialInstance>> submesh_materials;
+
+		std::shared_ptr<DrawList> draw_list;
+		std::vector<uint32_t> draw_handles;
+
+		InstanceBvh *bvh = nullptr;
+		uint32_t first_entry = 0;
+	};
+} // namespace RtEngine
+
+#endif // INSTANCEARRAY_HPP
@@ -0,0 +1,120 @@
+#ifndef INSTANCEBVH_HPP
+#define INSTANCEBVH_HPP
+
+#include <Aabb.hpp>
+#include <Node.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RtEngine {
+	class ComponentPools;
+	class InstanceArray;
+	class Transform;
+
+	// a node with a mesh renderer or one copy of an instance array
+	struct InstanceRef {
+		static constexpr uint32_t NO_INSTANCE_ARRAY = UINT32_MAX;
+
+		NodeId node = NO_NODE;
+		// index into the instance arrays of the scene
+		uint32_t instance_array = NO_INSTANCE_ARRAY;
+		uint32_t instance = 0;
+
+		bool isNode() const { return node != NO_NODE; }
+	};
+
+	struct InstancePick {
+		InstanceRef instance;
+		float distance = 0.0f; // along the ray direction, in multiples of its length
+	};
+
+	// bvh over the world space bounds of everything drawn in a scene, for picking and box selection on the cpu. moved
+	// instances only flag their entry, the bounds and the nodes above them are refit in one go before the next query
+	class InstanceBvh {
+	public:
+		static constexpr uint32_t MAX_LEAF_SIZE = 4;
+		// while fewer than this fraction of the entries moved, the refit walks up from their leaves instead of
+		// visiting every node
+		static constexpr double PARTIAL_REFIT_FRACTION = 0.1;
+		// refits keep the topology, once the summed node surface area grew by this factor the tree is rebuilt
+		static constexpr float REBUILD_AREA_FACTOR = 2.0f;
+
+		InstanceBvh() = default;
+		~InstanceBvh();
+
+		InstanceBvh(const InstanceBvh &) = delete;
+		InstanceBvh &operator=(const InstanceBvh &) = delete;
+
+		// has to be called again whenever nodes, components or instance arrays change and when meshes are reloaded,
+		// expects up to date world transforms
+		void rebuild(const ComponentPools &component_pools,
+					 const std::vector<std::shared_ptr<InstanceArray>> &instance_arrays);
+		void invalidate() { valid = false; }
+		bool isValid() const { return valid; }
+
+		// ignored for nodes without an entry
+		void markNodeMoved(NodeId node);
+		void markEntryMoved(uint32_t entry);
+		// recomputes the bounds of the moved entries and every bvh node above them. after as many moves as there are
+		// entries the quality of the tree is checked and it is rebuilt if necessary
+		void refit();
+
+		// closest instance whose bounds the ray hits. a box around the origin counts from where the ray leaves it, so
+		// instances inside the room the camera stands in are picked before the room itself
+		bool pick(const glm::vec3 &origin, const glm::vec3 &direction, InstancePick *hit) const;
+		// appends every instance whose bounds overlap box
+		void queryBox(const Aabb &box, std::vector<InstanceRef> &instances) const;
+
+		size_t size() const { return entries.size(); }
+		size_t getNodeCount() const { return bvh_nodes.size(); }
+		const Aabb &getBounds() const;
+
+	private:
+		static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+		struct Entry {
+			InstanceRef instance;
+			Aabb local_bounds;
+			// one of the two, depending on the kind of instance
+			Transform *transform = nullptr;
+			InstanceArray *instance_array = nullptr;
+		};
+
+		// leaves cover entry_order[first, first + count), inner nodes have their children at first and first + 1
+		struct BvhNode {
+			Aabb bounds;
+			uint32_t first = 0;
+			uint32_t count = 0;
+			uint32_t parent = UINT32_MAX;
+
+			bool isLeaf() const { return count > 0; }
+		};
+
+		void build();
+		void refitAll();
+		float computeNodeArea() const;
+		Aabb computeEntryBounds(const Entry &entry) const;
+		void refitLeaf(uint32_t node_index);
+		void detach();
+
+		std::vector<Entry> entries;
+		std::vector<Aabb> entry_bounds;
+		std::vector<uint32_t> entry_order;
+		std::vector<uint32_t> entry_leaves;
+		// indexed by NodeId, NO_ENTRY for nodes that are not drawn
+		std::vector<uint32_t> node_entries;
+		std::vector<InstanceArray *> instance_arrays;
+
+		// children always come after their parent, so a reverse walk refits bottom up
+		std::vector<BvhNode> bvh_nodes;
+		std::vector<uint32_t> moved_entries;
+		std::vector<uint8_t> entry_moved;
+		size_t moves_since_check = 0;
+		float built_node_area = 0.0f;
+
+		bool valid = false;
+	};
+} // namespace RtEngine
+
+#endif // INSTANCEBVH_HPP
@@ -2,9 +2,14 @@
 #define BASICS_NODE_HPP
 
 #include <../renderer/resources/IRenderable.hpp>
+#include <ComponentTypeId.hpp>
 #include <Transform.hpp>
 
 namespace RtEngine {
+	// index of a node in its scene, stays the same for the lifetime of the scene
+	using NodeId = uint32_t;
+	static constexpr NodeId NO_NODE = UINT32_MAX;
+
 	class Node : public IRenderable {
 	public:
 		Node();
@@ -13,15 +18,14 @@ namespace RtEngine {
 		void draw(DrawContext &ctx) override;
 		void refreshTransform(const glm::mat4 &parentMatrix);
 		void addComponent(const std::shared_ptr<Component> &component);
+		// T has to be the concrete type of the component, the first one added wins
 		template<typename T>
 		std::shared_ptr<T> getComponent() {
-			for (auto &component: components) {
-				auto casted = std::dynamic_pointer_cast<T>(component);
-				if (casted) {
-					return casted;
-				}
+			const uint32_t type_id = ComponentTypeId::of<T>();
+			if (type_id >= component_slots.size() || component_slots[type_id] == NO_COMPONENT) {
+				return nullptr;
 			}
-			return nullptr;
+			return std::static_pointer_cast<T>(components[component_slots[type_id]]);
 		}
 
 		void start() const;
@@ -29,12 +33,18 @@ namespace RtEngine {
 		void destroy() const;
 
 		std::string name;
+		NodeId id = NO_NODE; // given out by Scene::addNode
 
 		std::weak_ptr<Node> parent;
 		std::vector<std::shared_ptr<Node>> children;
 
 		std::vector<std::shared_ptr<Component>> components;
 		std::shared_ptr<Transform> transform;
+
+	private:
+		static constexpr uint32_t NO_COMPONENT = UINT32_MAX;
+		// index into components per ComponentTypeId
+		std::vector<uint32_t> component_slots;
 	};
 
 } // namespace RtEngine
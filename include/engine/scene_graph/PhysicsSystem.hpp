@@ -0,0 +1,95 @@
+#ifndef PHYSICSSYSTEM_HPP
+#define PHYSICSSYSTEM_HPP
+
+#include <Aabb.hpp>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+namespace RtEngine {
+	class ComponentPools;
+	class Rigidbody;
+	class Transform;
+
+	// all rigidbodies of a scene as structure of arrays, integrated in batches and pushed out of the static scene
+	// bounds. bodies without velocity rest until their gravity, their transform or the static bounds change. the
+	// system owns the positions of the bodies between two rebuilds, a translation written by anything else is taken
+	// over with the next step. everything is simulated in world space and the positions are converted back into the
+	// space of the parent node when they are written to the transforms
+	class PhysicsSystem {
+	public:
+		// smaller batches are not worth waking up the thread pool for
+		static constexpr int64_t PARALLEL_BATCH_SIZE = 4096;
+
+		PhysicsSystem() = default;
+		~PhysicsSystem();
+
+		PhysicsSystem(const PhysicsSystem &) = delete;
+		PhysicsSystem &operator=(const PhysicsSystem &) = delete;
+
+		// has to be called again whenever nodes or components change, the world transforms have to be up to date
+		// because every mesh renderer without a rigidbody becomes a static bound. bodies that were already simulated
+		// keep their velocity
+		void rebuild(const ComponentPools &component_pools);
+		void invalidate() { valid = false; }
+		bool isValid() const { return valid; }
+
+		void setGravity(uint32_t index, float gravity);
+
+		// integrates every body by FIXED_DELTA_TIME, resolves the contacts with the static bounds and writes the
+		// positions of the moving bodies back into their transforms. translations edited since the last step and
+		// static bounds that moved are taken over first and wake the bodies
+		void step();
+
+		size_t size() const { return transforms.size(); }
+		size_t getStaticCount() const { return static_bounds.size(); }
+		// candidate pairs of the last broadphase
+		size_t getContactCount() const { return contacts.size(); }
+
+	private:
+		// takes over the translations that were not written by writeBack, like edits in the inspector or animations
+		void syncEditedBodies();
+		// returns true if a static bound moved
+		bool updateStaticBounds();
+		void integrate();
+		// sweep and prune along x, the bodies stay sorted from the last step so the insertion sort is about linear
+		void findContacts();
+		void resolveContacts();
+		void writeBack();
+		Aabb getBodyBounds(uint32_t body) const;
+		void detach();
+
+		std::vector<float> position_x, position_y, position_z;
+		std::vector<float> velocity_x, velocity_y, velocity_z;
+		// box of the body relative to its position
+		std::vector<float> offset_x, offset_y, offset_z;
+		std::vector<float> extent_x, extent_y, extent_z;
+		std::vector<float> gravity;
+		std::vector<uint8_t> resting;
+		std::vector<Transform *> transforms;
+		// world transform of the parent node, used to write the positions back
+		std::vector<const Transform *> parent_transforms;
+		// local translation last written to or read from each transform
+		std::vector<glm::vec3> synced_translations;
+		std::vector<Rigidbody *> rigidbodies;
+
+		// sorted by min.x
+		std::vector<Aabb> static_bounds;
+		// source of each static bound and the world transform it was computed with
+		std::vector<const Transform *> static_transforms;
+		std::vector<Aabb> static_local_bounds;
+		std::vector<glm::mat4> static_world_transforms;
+		// bodies above this can not touch any static bound
+		float static_max_y = 0.0f;
+		std::vector<uint32_t> sorted_bodies;
+		std::vector<float> sorted_min_x;
+		std::vector<uint32_t> active_statics;
+		// body, static bound
+		std::vector<std::pair<uint32_t, uint32_t>> contacts;
+
+		bool valid = false;
+	};
+} // namespace RtEngine
+
+#endif // PHYSICSSYSTEM_HPP
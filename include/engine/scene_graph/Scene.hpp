@@ -1,13 +1,21 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <AnimationSystem.hpp>
+#include <ComponentPools.hpp>
+#include <DrawList.hpp>
+#include <InstanceArray.hpp>
+#include <InstanceBvh.hpp>
 #include <MeshAsset.hpp>
 #include <MeshAssetBuilder.hpp>
 #include <Node.hpp>
 #include <PhongMaterial.hpp>
+#include <PhysicsSystem.hpp>
+#include <TransformHierarchy.hpp>
 #include <array>
 #include <bits/shared_ptr.h>
 #include <glm/vec3.hpp>
+#include <string_view>
 #include <utility>
 
 #include "Camera.hpp"
@@ -15,6 +23,8 @@
 #include "IScene.hpp"
 
 #define POINT_LIGHT_COUNT 4
+// below this many components of a type the update stays on the main thread
+#define PARALLEL_UPDATE_SIZE 256
 
 namespace RtEngine {
 	struct SceneData {
@@ -27,6 +37,7 @@ namespace RtEngine {
 		glm::vec4 sunlightDirection; // w for sun power
 		glm::vec4 sunlightColor;
 		uint32_t emitting_object_count;
+		uint32_t compact_vertices = 0;
 	};
 
 	struct PointLight {
@@ -49,26 +60,59 @@ namespace RtEngine {
 		float intensity = 0.0f;
 	};
 
+	// lets the name index be searched with a string_view without building a std::string
+	struct NodeNameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+	};
+
 	class Scene : public IScene
 	{
 	public:
+		static constexpr std::string_view ROOT_NODE_NAME = "root";
+
 		Scene(std::string path, const std::shared_ptr<Material>& material) :
 			path(std::move(path)), material(material) {
 		}
 
 		virtual ~Scene() = default;
 
-		void addNode(std::string name, std::shared_ptr<Node> node);
-		std::shared_ptr<Node> getRootNode();
+		// names have to be unique, the node named ROOT_NODE_NAME becomes the root
+		NodeId addNode(const std::shared_ptr<Node> &node);
+		std::shared_ptr<Node> getRootNode() const;
+		std::shared_ptr<Node> getNode(NodeId id) const;
+		// NO_NODE if there is no node with that name
+		NodeId findNode(std::string_view name) const;
+		const std::vector<std::shared_ptr<Node>> &getNodes() const { return nodes; }
+
+		// instance arrays are drawn without being part of the node hierarchy
+		void addInstanceArray(const std::shared_ptr<InstanceArray> &instance_array);
+		const std::vector<std::shared_ptr<InstanceArray>> &getInstanceArrays() const { return instance_arrays; }
 
 		void start();
 
-		void update();
+		// nodes were added, removed or reparented or components were added outside of addNode
+		void markHierarchyChanged();
+		// mesh bounds changed, everything that collides or is picked against them is rebuilt
+		void markMeshesReloaded();
+		// recomputes the dirty transforms and patches the draw list entries of the moved mesh renderers
+		void refreshTransforms();
+		const ComponentPools &getComponentPools();
+		std::shared_ptr<DrawList> getDrawList() const { return draw_list; }
+		// refit to the current transforms, only kept up to date once it was asked for
+		const InstanceBvh &getInstanceBvh();
+
+		// applies the animations at the scene time and the physics step, then parallel OnUpdate per component type
+		// and a serial OnCommit over all components. advances the scene time by FIXED_DELTA_TIME
+		void update(const UpdateFlagsHandle &update_flags);
+		double getTime() const { return time; }
+		void setTime(double time) { this->time = time; }
 		void destroy();
 
 		std::vector<std::shared_ptr<MeshAsset>> getMeshAssets() override;
 		std::vector<std::shared_ptr<MaterialInstance>> getMaterialInstances() override;
 		void fillDrawContext(const std::shared_ptr<DrawContext> &draw_context) override;
+		void refreshRenderObjects() override;
 		std::shared_ptr<Material> getMaterial() override;
 		std::shared_ptr<EnvironmentMap> getEnvironmentMap() override;
 
@@ -77,7 +121,6 @@ namespace RtEngine {
 
 		std::string path;
 
-		std::unordered_map<std::string, std::shared_ptr<Node>> nodes;
 		std::shared_ptr<EnvironmentMap> environment_map;
 
 		std::shared_ptr<SceneData> last_scene_data;
@@ -90,6 +133,20 @@ namespace RtEngine {
 	private:
 		std::shared_ptr<SceneData> createSceneData(uint32_t emitting_object_count);
 
+		// indexed by NodeId
+		std::vector<std::shared_ptr<Node>> nodes;
+		std::unordered_map<std::string, NodeId, NodeNameHash, std::equal_to<>> node_ids;
+		NodeId root_id = NO_NODE;
+		std::vector<std::shared_ptr<InstanceArray>> instance_arrays;
+
+		TransformHierarchy transform_hierarchy;
+		ComponentPools component_pools;
+		PhysicsSystem physics;
+		AnimationSystem animations;
+		InstanceBvh instance_bvh;
+		double time = 0.0;
+		std::shared_ptr<DrawList> draw_list = std::make_shared<DrawList>();
+
 		std::shared_ptr<Camera> main_camera;
 		std::vector<std::shared_ptr<Camera>> cameras{};
 	};
@@ -4,6 +4,7 @@
 
 #ifndef VULKAN_RAYTRACING_SCENEMANAGER_HPP
 #define VULKAN_RAYTRACING_SCENEMANAGER_HPP
+#include <cstdint>
 #include <memory>
 
 #include "Camera.hpp"
@@ -11,6 +12,15 @@
 #include "Scene.hpp"
 
 namespace RtEngine {
+    struct SceneResources;
+
+    // a scene that was shown before, together with its gpu representation
+    struct CachedScene {
+        std::shared_ptr<Scene> scene;
+        std::shared_ptr<SceneResources> resources;
+        size_t device_memory = 0;
+    };
+
     class SceneManager : public ISceneManager {
     public:
         explicit SceneManager(const std::string &resources_dir);
@@ -18,13 +28,31 @@ namespace RtEngine {
         std::shared_ptr<Scene> getCurrentScene();
         void setScene(const std::shared_ptr<Scene> &new_scene);
         std::shared_ptr<Material> getCurrentMaterial() override;
+        std::shared_ptr<DrawList> getCurrentDrawList() override;
 
         std::string getScenePath(std::string scene_name);
         std::vector<std::string> getSceneNames() const;
+        std::string getResourcesDir() const;
+
+        // least recently shown scenes are evicted once there are more than max_scenes or they use more than
+        // max_device_memory bytes. the evicted scenes are returned, the caller destroys them
+        std::vector<CachedScene> setSceneCacheBudget(uint32_t max_scenes, size_t max_device_memory);
+        std::vector<CachedScene> cacheScene(CachedScene cached_scene);
+        // removes the scene from the cache on success
+        bool takeCachedScene(const std::string &scene_path, CachedScene *cached_scene);
+        std::vector<CachedScene> clearSceneCache();
+        size_t getCachedSceneCount() const;
     private:
+        std::vector<CachedScene> evictScenes();
+
         std::string resources_dir;
         std::shared_ptr<Scene> scene;
         std::vector<std::string> scene_names;
+
+        // most recently shown first
+        std::vector<CachedScene> cached_scenes;
+        uint32_t max_cached_scenes = 0;
+        size_t max_cache_device_memory = 0;
     };
 } // RtEngine
 
@@ -0,0 +1,57 @@
+#ifndef TRANSFORMHIERARCHY_HPP
+#define TRANSFORMHIERARCHY_HPP
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+namespace RtEngine {
+	class Node;
+	class Transform;
+
+	// the transforms of a scene graph flattened in breadth first order, so every parent comes before its children and
+	// each level is a contiguous range that is updated in parallel. only transforms marked dirty and their
+	// descendants are recomputed
+	class TransformHierarchy {
+	public:
+		static constexpr uint32_t NO_PARENT = UINT32_MAX;
+		// smaller levels are not worth waking up the thread pool for
+		static constexpr int64_t PARALLEL_LEVEL_SIZE = 1024;
+
+		TransformHierarchy() = default;
+		~TransformHierarchy();
+
+		TransformHierarchy(const TransformHierarchy &) = delete;
+		TransformHierarchy &operator=(const TransformHierarchy &) = delete;
+
+		// has to be called again whenever nodes are added, removed or reparented, marks everything dirty
+		void rebuild(const std::shared_ptr<Node> &root);
+		void invalidate() { valid = false; }
+		bool isValid() const { return valid; }
+
+		void markDirty(uint32_t index);
+
+		// one pass per level, must not overlap with markDirty, returns the number of recomputed transforms
+		uint32_t update();
+		// nodes whose world transform was recomputed by the last update
+		const std::vector<Node *> &getUpdatedNodes() const { return updated_nodes; }
+
+		size_t size() const { return transforms.size(); }
+
+	private:
+		void detach();
+
+		std::vector<uint32_t> level_offsets;
+		std::vector<uint32_t> parents;
+		std::vector<uint8_t> dirty;
+		std::vector<glm::mat4> world_transforms;
+		std::vector<std::shared_ptr<Transform>> transforms;
+		std::vector<Node *> nodes;
+		std::vector<Node *> updated_nodes;
+
+		bool any_dirty = false;
+		bool valid = false;
+	};
+} // namespace RtEngine
+
+#endif // TRANSFORMHIERARCHY_HPP
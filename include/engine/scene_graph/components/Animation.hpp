@@ -0,0 +1,63 @@
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include <Component.hpp>
+#include <glm/glm.hpp>
+#include <yaml-cpp/yaml.h>
+
+namespace RtEngine {
+	class AnimationSystem;
+
+	enum class AnimationTarget : uint8_t {
+		POSITION,
+		ROTATION, // euler angles in degrees like the transform, interpolated per angle
+		SCALE,
+		MATERIAL,
+	};
+
+	// keyframes of one animated value, scalars only use x
+	struct AnimationTrack {
+		AnimationTarget target = AnimationTarget::POSITION;
+		// only for material tracks, parameter names are the keys of the material instance in the scene file
+		std::string material_instance_name;
+		std::string parameter;
+		bool step_interpolation = false;
+		uint32_t value_size = 3; // floats per value as authored
+		std::vector<float> times; // ascending
+		std::vector<glm::vec4> values;
+	};
+
+	// sampled by the AnimationSystem of the scene, the component only holds the authored tracks
+	class Animation : public Component {
+	public:
+		Animation() = default;
+		explicit Animation(const std::shared_ptr<Node> &node) : Component(nullptr, node) {}
+
+		static constexpr std::string COMPONENT_NAME = "Animation";
+
+		void OnStart() override {}
+		void OnRender(DrawContext &ctx) override {}
+		void OnUpdate() override {}
+		bool isSystemDriven() const override { return true; }
+		void OnDestroy() override {}
+
+		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
+
+		// the tracks sequence of the component in the scene file
+		void loadTracks(const YAML::Node &yaml_node);
+		YAML::Node writeTracksToYaml() const;
+
+		const std::vector<AnimationTrack> &getTracks() const { return tracks; }
+		bool isLooping() const { return loop; }
+		void attachToAnimations(AnimationSystem *animations, uint32_t first_track);
+
+	private:
+		std::vector<AnimationTrack> tracks;
+		bool loop = true;
+
+		AnimationSystem *animations = nullptr;
+		uint32_t first_track = 0;
+	};
+} // namespace RtEngine
+
+#endif // ANIMATION_HPP
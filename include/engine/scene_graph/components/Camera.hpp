@@ -19,6 +19,8 @@ namespace RtEngine {
         void OnStart() override;
         void OnRender(DrawContext &ctx) override;
         void OnUpdate() override;
+        bool hasParallelUpdate() const override { return true; }
+        void OnCommit() override;
         void OnDestroy() override;
 
         void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
@@ -28,6 +30,8 @@ namespace RtEngine {
         [[nodiscard]] glm::mat4 getProjection() const;
         [[nodiscard]] glm::mat4 getInverseProjection() const;
         [[nodiscard]] glm::vec3 getPosition() const;
+        // world space direction of the primary ray through uv, with 0, 0 in the top left corner of the image
+        [[nodiscard]] glm::vec3 getRayDirection(const glm::vec2 &uv) const;
 
         std::shared_ptr<RenderTarget> getRenderTarget();
 
@@ -62,6 +66,7 @@ namespace RtEngine {
         glm::vec3 velocity = glm::vec3(0.0f);
         glm::vec3 angular_velocity = glm::vec3(0.0f);
         bool isActive = true;
+        bool moved = false; // marks the transform dirty in OnCommit
 
         // Mouse state
         glm::vec2 last_mouse_pos = glm::vec2(0.0f);
@@ -18,6 +18,13 @@ namespace RtEngine {
 		virtual void OnUpdate() = 0;
 		virtual void OnDestroy() = 0;
 
+		// components whose OnUpdate only touches their own node may be updated concurrently with the other
+		// components of their type, anything shared has to wait for OnCommit, which always runs on the main thread
+		virtual bool hasParallelUpdate() const { return false; }
+		virtual void OnCommit() {}
+		// components that only hold data for a system of the scene, the update loop skips their pool
+		virtual bool isSystemDriven() const { return false; }
+
 		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override = 0;
 
 		std::weak_ptr<Node> node;
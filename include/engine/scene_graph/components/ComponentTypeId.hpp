@@ -0,0 +1,26 @@
+#ifndef COMPONENTTYPEID_HPP
+#define COMPONENTTYPEID_HPP
+
+#include <cstdint>
+#include <typeindex>
+
+namespace RtEngine {
+	class Component;
+
+	// dense ids for the concrete component types, rtti is only needed the first time a type is seen
+	class ComponentTypeId {
+		ComponentTypeId() = delete;
+
+	public:
+		template<typename T>
+		static uint32_t of() {
+			static const uint32_t id = of(std::type_index(typeid(T)));
+			return id;
+		}
+
+		static uint32_t of(const Component &component);
+		static uint32_t of(const std::type_index &type);
+	};
+} // namespace RtEngine
+
+#endif // COMPONENTTYPEID_HPP
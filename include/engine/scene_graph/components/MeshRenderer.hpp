@@ -2,6 +2,7 @@
 #define MESHRENDERER_HPP
 
 #include <Component.hpp>
+#include <DrawList.hpp>
 #include <Material.hpp>
 
 namespace RtEngine {
@@ -12,17 +13,39 @@ namespace RtEngine {
 
 		static constexpr std::string COMPONENT_NAME = "MeshRenderer";
 
+		// registers the renderer in the draw list of the current scene, it stays there until OnDestroy
 		void OnStart() override;
-		void OnRender(DrawContext &ctx) override;
+		void OnRender(DrawContext &ctx) override {};
 		void OnUpdate() override {};
-		void OnDestroy() override {};
+		void OnDestroy() override;
+
+		// rebuilds the draw list entry from the current mesh and materials
+		void refreshRenderObject();
+		// copies the world transform of the node into the draw list entry
+		void updateTransform();
 
 		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
 
+		// shared with the instance arrays, which draw meshes without a renderer per copy
+		static std::vector<std::shared_ptr<MaterialInstance>>
+		findSubmeshMaterials(const std::shared_ptr<Material> &material, const MeshAsset &mesh_asset,
+							 const std::string &mesh_asset_name, const std::string &material_instance_name);
+		static RenderObject buildRenderObject(const MeshAsset &mesh_asset,
+											  const std::vector<std::shared_ptr<MaterialInstance>> &submesh_materials,
+											  const glm::mat4 &transform);
+
 		std::shared_ptr<MeshAsset> mesh_asset;
 		std::shared_ptr<MaterialInstance> mesh_material;
+		// one per submesh, all equal to mesh_material if the renderer names a material
+		std::vector<std::shared_ptr<MaterialInstance>> submesh_materials;
 
 	private:
+		void resolveSubmeshMaterials();
+		RenderObject createRenderObject() const;
+
+		std::shared_ptr<DrawList> draw_list;
+		uint32_t draw_handle = DrawList::INVALID_HANDLE;
+
 		std::string mesh_asset_name;
 		std::string material_instance_name;
 	};
@@ -7,22 +7,35 @@
 #include <Component.hpp>
 
 namespace RtEngine {
+	class PhysicsSystem;
+
+	// integrated by the PhysicsSystem of the scene, the component itself only holds the settings of the body
 	class Rigidbody : public Component {
 	public:
 		Rigidbody() = default;
-		explicit Rigidbody(const std::shared_ptr<Node>& node) : Component(nullptr, node){};
+		explicit Rigidbody(const std::shared_ptr<Node>& node, float gravity = 0.0f) :
+			Component(nullptr, node), gravity(gravity){};
 
 		static constexpr std::string COMPONENT_NAME = "Rigidbody";
 
 		void OnStart() override {};
 		void OnRender(DrawContext &ctx) override {};
-		void OnUpdate() override;
+		void OnUpdate() override {};
+		bool isSystemDriven() const override { return true; }
 		void OnDestroy() override {}
 
 		void initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) override;
 
+		float getGravity() const { return gravity; }
+		void attachToPhysics(PhysicsSystem *physics, uint32_t index);
+
 	private:
+		// downward acceleration in units per second squared. before the PhysicsSystem it was a constant fall speed in
+		// units per second, so the same value now makes the body fall faster and faster
 		float gravity = 0.0f;
+
+		PhysicsSystem *physics = nullptr;
+		uint32_t physics_index = 0;
 	};
 } // namespace RtEngine
 
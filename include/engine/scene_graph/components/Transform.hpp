@@ -6,6 +6,8 @@
 #include <glm/glm.hpp>
 
 namespace RtEngine {
+	class TransformHierarchy;
+
 	class Transform : public Component {
 	public:
 		Transform();
@@ -23,10 +25,17 @@ namespace RtEngine {
 		void updateTransforms(glm::mat4 parent_matrix);
 		glm::mat4 getWorldTransform() const;
 
+		// has to be called after decomposed_transform was written to, otherwise the hierarchy skips this transform
+		void markDirty();
+		void attachToHierarchy(TransformHierarchy *hierarchy, uint32_t index);
+
 	public:
 		TransformUtil::DecomposedTransform decomposed_transform;
 
 	private:
+		TransformHierarchy *hierarchy = nullptr;
+		uint32_t hierarchy_index = 0;
+
 		glm::mat4 localTransform{};
 		glm::mat4 worldTransform{};
 	};
@@ -9,19 +9,20 @@
 #include <string>
 
 namespace RtEngine {
+	// copied byte wise by imgui, so it only holds ids
 	struct DragPayload {
-		std::string source_key = "";
-		std::string parent_key = "";
+		NodeId source_id = NO_NODE;
+		NodeId parent_id = NO_NODE;
 	};
 
 	struct NodeAdd {
-		std::string parent_key = "";
-		std::string node_key = "";
+		NodeId parent_id = NO_NODE;
+		NodeId node_id = NO_NODE;
 	};
 
 	struct NodeRemove {
-		std::string parent_key = "";
-		std::string node_key = "";
+		NodeId parent_id = NO_NODE;
+		NodeId node_id = NO_NODE;
 	};
 
 	static DragPayload dragPayload;
@@ -33,7 +34,7 @@ namespace RtEngine {
 		~HierarchyWindow() override = default;
 
 		void createFrame() override;
-		std::string last_clicked_node_key = "";
+		NodeId last_clicked_node = NO_NODE;
 
 	private:
 		void displayNode(std::shared_ptr<Node> node, std::shared_ptr<Node> parent, uint32_t depth);
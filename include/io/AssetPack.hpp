@@ -0,0 +1,75 @@
+#ifndef ASSETPACK_HPP
+#define ASSETPACK_HPP
+
+#include <MeshAsset.hpp>
+#include <ResourceBuilder.hpp>
+#include <glm/mat4x4.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RtEngine {
+	enum AssetType : uint32_t {
+		SCENE_ASSET = 1,
+		MESH_ASSET = 2,
+		TEXTURE_ASSET = 3,
+		INSTANCE_ASSET = 4,
+	};
+
+	struct AssetView {
+		AssetType type;
+		const uint8_t *data;
+		uint64_t size;
+	};
+
+	// read only, memory mapped archive of a scene description and its preprocessed meshes and textures
+	class AssetPack {
+	public:
+		static constexpr const char *EXTENSION = "rtpack";
+		// key of the scene description inside of a pack
+		static constexpr const char *SCENE_ENTRY = "scene.yaml";
+
+		explicit AssetPack(const std::string &path);
+		~AssetPack();
+		AssetPack(const AssetPack &) = delete;
+		AssetPack &operator=(const AssetPack &) = delete;
+
+		bool find(const std::string &name, AssetView &view) const;
+
+		// null terminated, can be handed to the YAML parser without a copy
+		const char *readText(const std::string &name) const;
+		bool readMesh(const std::string &name, MeshBuffers &mesh_buffers) const;
+		// the returned image data points into the mapping and stays valid as long as the pack
+		bool readTexture(const std::string &name, ImageData &image_data) const;
+		bool readInstances(const std::string &name, std::vector<glm::mat4> &transforms) const;
+
+		static uint64_t hashName(std::string_view name);
+
+	private:
+		std::string path;
+		int file_descriptor = -1;
+		const uint8_t *mapped = nullptr;
+		size_t mapped_size = 0;
+	};
+
+	class AssetPackWriter {
+	public:
+		void addText(const std::string &name, const std::string &text);
+		void addMesh(const std::string &name, const MeshBuffers &mesh_buffers);
+		void addTexture(const std::string &name, const ImageData &image_data);
+		void addInstances(const std::string &name, const std::vector<glm::mat4> &transforms);
+
+		void write(const std::string &path) const;
+
+	private:
+		struct PendingEntry {
+			std::string name;
+			AssetType type;
+			std::vector<uint8_t> payload;
+		};
+
+		std::vector<PendingEntry> entries;
+	};
+} // namespace RtEngine
+
+#endif // ASSETPACK_HPP
@@ -0,0 +1,29 @@
+#ifndef ASSETPACKER_HPP
+#define ASSETPACKER_HPP
+
+#include <AssetPack.hpp>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+namespace RtEngine {
+	// builds an asset pack from a scene yaml and every mesh and texture it references
+	class AssetPacker {
+	public:
+		explicit AssetPacker(const std::string &resources_dir) : resources_dir(resources_dir) {}
+
+		// writes resources/scenes/<scene_name>.rtpack next to the yaml it was built from
+		void pack(const std::string &scene_name) const;
+
+		// every texture the materials and the environment map of a scene node refer to, once per path
+		static std::vector<std::pair<std::string, TextureType>> collectTextures(const YAML::Node &scene_node);
+
+	private:
+		// merges the materials of gltf meshes into the scene, instances already defined in the scene are kept
+		void addModelMaterials(YAML::Node &scene_node) const;
+		ImageData importTexture(const std::string &path, TextureType type) const;
+
+		std::string resources_dir;
+	};
+} // namespace RtEngine
+
+#endif // ASSETPACKER_HPP
@@ -0,0 +1,31 @@
+#ifndef INSTANCEFILE_HPP
+#define INSTANCEFILE_HPP
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <string>
+#include <vector>
+
+namespace RtEngine {
+	// binary sidecar of an instance array: a small header followed by one row major 3x4 affine matrix per instance,
+	// the same layout the tlas instances use
+	class InstanceFile {
+		InstanceFile() = delete;
+
+	public:
+		static constexpr const char *EXTENSION = "rtinst";
+		static constexpr uint32_t FLOATS_PER_TRANSFORM = 12;
+
+		static std::vector<glm::mat4> read(const std::string &path);
+		static void write(const std::string &path, const std::vector<glm::mat4> &transforms);
+
+		// the file contents, also stored as is inside of asset packs
+		static std::vector<uint8_t> encode(const std::vector<glm::mat4> &transforms);
+		static std::vector<glm::mat4> decode(const uint8_t *data, size_t size, const std::string &name);
+
+		static glm::mat4 unpackTransform(const float *packed);
+		static void packTransform(const glm::mat4 &transform, float *packed);
+	};
+} // namespace RtEngine
+
+#endif // INSTANCEFILE_HPP
@@ -2,10 +2,20 @@
 #define SCENEREADER_H
 
 #include <../engine/scene_graph/Scene.hpp>
+#include <AssetPack.hpp>
 #include <string>
 #include <yaml-cpp/yaml.h>
 
 namespace RtEngine {
+	// the part of a scene that is loaded without the gpu, meshes and textures that are already loaded are left out
+	struct PreparedScene {
+		std::string path;
+		YAML::Node config;
+		std::shared_ptr<AssetPack> pack;
+		std::vector<std::pair<std::string, MeshAsset>> meshes;
+		std::unordered_map<std::string, ImageData> texture_images;
+	};
+
 	class SceneReader {
 	public:
 		SceneReader() = default;
@@ -13,8 +23,20 @@ namespace RtEngine {
 
 		std::shared_ptr<Scene> readScene(const std::string &file_path,
 										 std::unordered_map<std::string, std::shared_ptr<Material>> materials);
+		// parses the scene and imports its meshes and textures. the repositories are only read, so this can run on a
+		// loader thread as long as the main thread does not load anything in the meantime
+		PreparedScene prepareScene(const std::string &file_path) const;
+		// builds the scene from a prepared one and uploads its textures, has to run on the main thread
+		std::shared_ptr<Scene> readScene(PreparedScene prepared_scene,
+										 std::unordered_map<std::string, std::shared_ptr<Material>> materials);
 		void loadSceneLights(const YAML::Node &lights_node, std::shared_ptr<Scene> &scene);
+		// transforms are either inline or in a sidecar file next to the scene, packs carry the sidecars themselves
+		void loadInstanceArrays(const YAML::Node &array_nodes, const std::shared_ptr<Scene> &scene,
+								const std::string &scene_dir, const std::shared_ptr<AssetPack> &pack);
 		void initializeMaterial(const YAML::Node &material_node, std::shared_ptr<Material> &material);
+		// merges the materials defined by gltf meshes into the scene node, instances defined in the scene are kept.
+		// only the metal rough material can represent them
+		void addModelMaterials(YAML::Node &scene_node) const;
 
 	private:
 		std::shared_ptr<Node> processSceneNodesRecursiv(const YAML::Node &yaml_node,
@@ -15,6 +15,7 @@ namespace RtEngine {
 	private:
 		void writeMaterial(YAML::Emitter &out, const std::shared_ptr<Material> &material);
 		void writeSceneLights(YAML::Emitter &out, const std::shared_ptr<Scene> &scene);
+		void writeInstanceArrays(YAML::Emitter &out, const std::shared_ptr<Scene> &scene, const std::string &scene_dir);
 
 		YAML::Node writeComponents(const std::shared_ptr<Node> &node);
 		void writeSceneNode(YAML::Emitter &out, const std::shared_ptr<Node> &node);
@@ -0,0 +1,41 @@
+#ifndef STRESSSCENEGENERATOR_HPP
+#define STRESSSCENEGENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace RtEngine {
+	struct StressSceneParameters {
+		uint32_t instance_count = 1000;
+		uint32_t unique_mesh_count = 8;
+		uint32_t emitter_count = 4;
+		uint32_t texture_count = 4;
+		// longitude segments of the generated meshes, about segments^2 triangles each
+		uint32_t mesh_segments = 32;
+		uint32_t seed = 42;
+
+		std::string getSceneName() const;
+	};
+
+	// writes a scene with instance_count randomly placed copies of unique_mesh_count procedural rocks, emitter_count
+	// of them emitting and texture_count textured materials. meshes and textures are kept in generated/ folders of
+	// the resources and reused by later runs with the same seed. the scene files go into scenes_dir, which should be
+	// outside of the resources so they are neither listed as scenes nor picked up by the resource watcher
+	class StressSceneGenerator {
+	public:
+		StressSceneGenerator(const std::string &resources_dir, const std::string &scenes_dir) :
+			resources_dir(resources_dir), scenes_dir(scenes_dir) {}
+
+		// returns the path of the scene file, the instance transforms go into a sidecar next to it
+		std::string generate(const StressSceneParameters &parameters) const;
+
+	private:
+		std::string writeMesh(const StressSceneParameters &parameters, uint32_t mesh_index) const;
+		std::string writeTexture(const StressSceneParameters &parameters, uint32_t texture_index) const;
+
+		std::string resources_dir;
+		std::string scenes_dir;
+	};
+} // namespace RtEngine
+
+#endif // STRESSSCENEGENERATOR_HPP
@@ -43,13 +43,13 @@ namespace YAML {
 		}
 
 		static bool decode(const Node &node, glm::vec4 &v) {
-			if (!node.IsSequence() || node.size() != 3) {
+			if (!node.IsSequence() || node.size() != 4) {
 				return false;
 			}
 			v.x = node[0].as<float>();
 			v.y = node[1].as<float>();
 			v.z = node[2].as<float>();
-			v.z = node[3].as<float>();
+			v.w = node[3].as<float>();
 			return true;
 		}
 	};
@@ -0,0 +1,56 @@
+#ifndef AABB_HPP
+#define AABB_HPP
+
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace RtEngine {
+	struct Aabb {
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		bool isEmpty() const { return min.x > max.x; }
+
+		void grow(const glm::vec3 &point) {
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void grow(const Aabb &other) {
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+
+		bool overlaps(const Aabb &other) const {
+			return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y &&
+				   min.z <= other.max.z && max.z >= other.min.z;
+		}
+
+		glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+		glm::vec3 getExtent() const { return (max - min) * 0.5f; }
+
+		float getSurfaceArea() const {
+			if (isEmpty()) {
+				return 0.0f;
+			}
+			const glm::vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		// box around this box after transforming it, the extent is spread over the absolute rotation and scale
+		Aabb transformed(const glm::mat4 &transform) const {
+			if (isEmpty()) {
+				return *this;
+			}
+			const glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+			const glm::vec3 extent = getExtent();
+			glm::vec3 world_extent(0.0f);
+			for (int axis = 0; axis < 3; axis++) {
+				world_extent += glm::abs(glm::vec3(transform[axis])) * extent[axis];
+			}
+			return Aabb{center - world_extent, center + world_extent};
+		}
+	};
+} // namespace RtEngine
+
+#endif // AABB_HPP
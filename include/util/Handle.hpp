@@ -0,0 +1,86 @@
+#ifndef HANDLE_HPP
+#define HANDLE_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RtEngine {
+	// index into the handle table of a repository, the generation tells a reused slot apart from the one the handle
+	// was given out for
+	template<typename T>
+	struct Handle {
+		static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+		uint32_t index = INVALID_INDEX;
+		uint32_t generation = 0;
+
+		bool isValid() const { return index != INVALID_INDEX; }
+		bool operator==(const Handle &other) const = default;
+	};
+
+	// owns the objects behind the handles. lookups only read the dense pointer and generation arrays, so resolving a
+	// handle never touches the reference count of the shared_ptr
+	template<typename T>
+	class HandleTable {
+	public:
+		Handle<T> insert(std::shared_ptr<T> object) {
+			uint32_t index;
+			if (!free_indices.empty()) {
+				index = free_indices.back();
+				free_indices.pop_back();
+			} else {
+				index = static_cast<uint32_t>(objects.size());
+				objects.push_back(nullptr);
+				generations.push_back(0);
+				owners.emplace_back();
+			}
+
+			objects[index] = object.get();
+			owners[index] = std::move(object);
+			return Handle<T>{index, generations[index]};
+		}
+
+		void erase(Handle<T> handle) {
+			if (get(handle) == nullptr) {
+				return;
+			}
+			objects[handle.index] = nullptr;
+			owners[handle.index] = nullptr;
+			generations[handle.index]++;
+			free_indices.push_back(handle.index);
+		}
+
+		// nullptr if the object of the handle was erased
+		T *get(Handle<T> handle) const {
+			if (handle.index >= objects.size() || generations[handle.index] != handle.generation) {
+				return nullptr;
+			}
+			return objects[handle.index];
+		}
+
+		std::shared_ptr<T> getShared(Handle<T> handle) const {
+			return get(handle) != nullptr ? owners[handle.index] : nullptr;
+		}
+
+		// every handle given out so far becomes invalid
+		void clear() {
+			for (uint32_t i = 0; i < objects.size(); i++) {
+				if (objects[i] != nullptr) {
+					erase(Handle<T>{i, generations[i]});
+				}
+			}
+		}
+
+		size_t size() const { return objects.size() - free_indices.size(); }
+
+	private:
+		std::vector<T *> objects;
+		std::vector<uint32_t> generations;
+		std::vector<std::shared_ptr<T>> owners;
+		std::vector<uint32_t> free_indices;
+	};
+} // namespace RtEngine
+
+#endif // HANDLE_HPP
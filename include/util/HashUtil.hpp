@@ -0,0 +1,90 @@
+#ifndef HASHUTIL_HPP
+#define HASHUTIL_HPP
+
+#include <cstdint>
+#include <cstring>
+
+namespace RtEngine {
+	struct DeduplicationStats {
+		uint32_t aliased_assets = 0;
+		uint64_t bytes_saved = 0;
+	};
+
+	// content hashing for asset deduplication, implements XXH64
+	class HashUtil {
+		HashUtil() = delete;
+
+		static constexpr uint64_t PRIME_1 = 11400714785074694791ull;
+		static constexpr uint64_t PRIME_2 = 14029467366897019727ull;
+		static constexpr uint64_t PRIME_3 = 1609587929392839161ull;
+		static constexpr uint64_t PRIME_4 = 9650029242287828579ull;
+		static constexpr uint64_t PRIME_5 = 2870177450012600261ull;
+
+		static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+		static uint64_t read64(const uint8_t *p) {
+			uint64_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		static uint32_t read32(const uint8_t *p) {
+			uint32_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		static uint64_t round(uint64_t acc, uint64_t input) { return rotl(acc + input * PRIME_2, 31) * PRIME_1; }
+
+		static uint64_t mergeRound(uint64_t acc, uint64_t value) { return (acc ^ round(0, value)) * PRIME_1 + PRIME_4; }
+
+	public:
+		static uint64_t xxHash64(const void *data, size_t size, uint64_t seed = 0) {
+			const auto *p = static_cast<const uint8_t *>(data);
+			const uint8_t *end = p + size;
+			uint64_t hash;
+
+			if (size >= 32) {
+				uint64_t v1 = seed + PRIME_1 + PRIME_2;
+				uint64_t v2 = seed + PRIME_2;
+				uint64_t v3 = seed;
+				uint64_t v4 = seed - PRIME_1;
+				do {
+					v1 = round(v1, read64(p));
+					v2 = round(v2, read64(p + 8));
+					v3 = round(v3, read64(p + 16));
+					v4 = round(v4, read64(p + 24));
+					p += 32;
+				} while (p + 32 <= end);
+
+				hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+				hash = mergeRound(hash, v1);
+				hash = mergeRound(hash, v2);
+				hash = mergeRound(hash, v3);
+				hash = mergeRound(hash, v4);
+			} else {
+				hash = seed + PRIME_5;
+			}
+
+			hash += size;
+			for (; p + 8 <= end; p += 8) {
+				hash = rotl(hash ^ round(0, read64(p)), 27) * PRIME_1 + PRIME_4;
+			}
+			if (p + 4 <= end) {
+				hash = rotl(hash ^ (read32(p) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+				p += 4;
+			}
+			for (; p < end; p++) {
+				hash = rotl(hash ^ (*p * PRIME_5), 11) * PRIME_1;
+			}
+
+			hash ^= hash >> 33;
+			hash *= PRIME_2;
+			hash ^= hash >> 29;
+			hash *= PRIME_3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+	};
+} // namespace RtEngine
+#endif // HASHUTIL_HPP
@@ -1,6 +1,8 @@
 #ifndef PATHUTIL_HPP
 #define PATHUTIL_HPP
 
+#include <algorithm>
+#include <cctype>
 #include <string>
 
 namespace RtEngine
@@ -25,6 +27,26 @@ namespace RtEngine
             std::string filename = (lastSlash == std::string::npos) ? path : path.substr(lastSlash + 1);
             return filename;
         }
+
+        // everything before the file name without the trailing slash, empty if the path has no directory
+        static std::string getDirectory(const std::string& path)
+        {
+            size_t lastSlash = path.find_last_of("/\\");
+            return (lastSlash == std::string::npos) ? "" : path.substr(0, lastSlash);
+        }
+
+        // lower case extension without the dot, empty if the file has none
+        static std::string getExtension(const std::string& path)
+        {
+            const std::string filename = getFile(path);
+            size_t lastDot = filename.find_last_of(".");
+            if (lastDot == std::string::npos)
+                return "";
+            std::string extension = filename.substr(lastDot + 1);
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+            return extension;
+        }
     };
 } // namespace RtEngine
 #endif // PATHUTIL_HPP
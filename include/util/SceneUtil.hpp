@@ -5,77 +5,60 @@
 #ifndef SCENEUTIL_HPP
 #define SCENEUTIL_HPP
 
-#include <Node.hpp>
+#include <ComponentPools.hpp>
+#include <InstanceArray.hpp>
 #include <MeshRenderer.hpp>
+#include <Node.hpp>
 
 #include "components/Camera.hpp"
 
 namespace RtEngine {
 	class SceneUtil {
 	public:
-		static std::vector<std::shared_ptr<MeshAsset>> collectMeshAssets(const std::shared_ptr<Node> &root_node) {
-			auto mesh_map = std::make_shared<std::unordered_map<std::string, std::shared_ptr<MeshAsset>>>();
-			collectMeshAssetsRecursive(root_node, mesh_map);
+		static std::vector<std::shared_ptr<MeshAsset>>
+		collectMeshAssets(const ComponentPools &component_pools,
+						  const std::vector<std::shared_ptr<InstanceArray>> &instance_arrays) {
+			std::unordered_map<std::string, std::shared_ptr<MeshAsset>> mesh_map;
+			component_pools.forEach<MeshRenderer>([&](const std::shared_ptr<MeshRenderer> &mesh_renderer) {
+				mesh_map.try_emplace(mesh_renderer->mesh_asset->name, mesh_renderer->mesh_asset);
+			});
+			for (const auto &instance_array: instance_arrays) {
+				mesh_map.try_emplace(instance_array->getMeshAsset()->name, instance_array->getMeshAsset());
+			}
 
 			std::vector<std::shared_ptr<MeshAsset>> mesh_assets;
-			for (auto mesh_asset: *mesh_map) {
+			for (auto mesh_asset: mesh_map) {
 				mesh_assets.push_back(mesh_asset.second);
 			}
 			return mesh_assets;
 		}
 
-		static std::vector<std::shared_ptr<MaterialInstance>> collectMaterialInstances(const std::shared_ptr<Node> &root_node) {
-			auto material_map = std::make_shared<std::unordered_map<std::string, std::shared_ptr<MaterialInstance>>>();
-			collectMaterialInstancesRecursive(root_node, material_map);
+		static std::vector<std::shared_ptr<MaterialInstance>>
+		collectMaterialInstances(const ComponentPools &component_pools,
+								 const std::vector<std::shared_ptr<InstanceArray>> &instance_arrays) {
+			std::unordered_map<std::string, std::shared_ptr<MaterialInstance>> material_map;
+			component_pools.forEach<MeshRenderer>([&](const std::shared_ptr<MeshRenderer> &mesh_renderer) {
+				for (const auto &material_instance: mesh_renderer->submesh_materials) {
+					material_map[material_instance->name] = material_instance;
+				}
+			});
+			for (const auto &instance_array: instance_arrays) {
+				for (const auto &material_instance: instance_array->getSubmeshMaterials()) {
+					material_map[material_instance->name] = material_instance;
+				}
+			}
 
 			std::vector<std::shared_ptr<MaterialInstance>> material_instances;
-			for (auto material_instance: *material_map) {
+			for (auto material_instance: material_map) {
 				material_instances.push_back(material_instance.second);
 			}
 			return material_instances;
 		}
 
-		static std::vector<std::shared_ptr<Camera>> collectCameras(const std::shared_ptr<Node> &root_node) {
-			auto cameras = std::make_shared<std::vector<std::shared_ptr<Camera>>>();
-			collectCamerasRecursive(root_node, cameras);
-			return *cameras;
-		}
-
-	private:
-		static void collectMeshAssetsRecursive(
-				const std::shared_ptr<Node> &root_node,
-				std::shared_ptr<std::unordered_map<std::string, std::shared_ptr<MeshAsset>>> &mesh_map) {
-			for (auto child_node: root_node->children) {
-				std::shared_ptr<MeshRenderer> mesh_renderer = child_node->getComponent<MeshRenderer>();
-				if (mesh_renderer && !mesh_map->contains(mesh_renderer->mesh_asset->name)) {
-					(*mesh_map)[mesh_renderer->mesh_asset->name] = mesh_renderer->mesh_asset;
-				}
-				collectMeshAssetsRecursive(child_node, mesh_map);
-			}
-		}
-
-		static void collectMaterialInstancesRecursive(
-				const std::shared_ptr<Node> &root_node,
-				std::shared_ptr<std::unordered_map<std::string, std::shared_ptr<MaterialInstance>>> &material_map) {
-			for (auto child_node: root_node->children) {
-				std::shared_ptr<MeshRenderer> mesh_renderer = child_node->getComponent<MeshRenderer>();
-				if (mesh_renderer && !material_map->contains(mesh_renderer->mesh_asset->name)) {
-					(*material_map)[mesh_renderer->mesh_material->name] = mesh_renderer->mesh_material;
-				}
-				collectMaterialInstancesRecursive(child_node, material_map);
-			}
-		}
-
-		static void collectCamerasRecursive(
-				const std::shared_ptr<Node> &root_node,
-				std::shared_ptr<std::vector<std::shared_ptr<Camera>>> &cameras) {
-			for (auto child_node: root_node->children) {
-				std::shared_ptr<Camera> camera = child_node->getComponent<Camera>();
-				if (camera) {
-					(*cameras).push_back(camera);
-				}
-				collectCamerasRecursive(child_node, cameras);
-			}
+		static std::vector<std::shared_ptr<Camera>> collectCameras(const ComponentPools &component_pools) {
+			std::vector<std::shared_ptr<Camera>> cameras;
+			component_pools.forEach<Camera>([&](const std::shared_ptr<Camera> &camera) { cameras.push_back(camera); });
+			return cameras;
 		}
 	};
 } // namespace RtEngine
@@ -14,6 +14,8 @@ def add_meson_files(path):
             f.write("src += files(\n")
             for filename in filenames:
                 if filename == "meson.build": continue;
+                # the entry point is added by the executable, the rest is shared with the benchmarks
+                if dirpath == path and filename == "main.cpp": continue;
                 f.write(f"  '{filename}',\n")
             f.write(")\n")
 
@@ -1,9 +1,12 @@
+#include "vertex_codec.glsl"
+
 layout(location = 0) rayPayloadInEXT Payload payload;
 
 struct Vertex {
     vec3 position;
     vec3 normal;
     vec3 tangent;
+    float bitangent_sign;
     vec3 color;
     vec2 uv;
 };
@@ -11,12 +14,21 @@ struct Vertex {
 layout(binding = 3, set = 0) readonly buffer VertexBuffer {
     vec4[] data;
 } vertex_buffer;
+// compact layout: binding 3 holds tightly packed positions, binding 10 the encoded attributes
+layout(binding = 3, set = 0) readonly buffer PositionBuffer {
+    float data[];
+} position_buffer;
+layout(binding = 10, set = 0) readonly buffer AttributeBuffer {
+    uint data[];
+} attribute_buffer;
 layout(binding = 4, set = 0) readonly buffer IndexBuffer {
     uint indices[];
 } index_buffer;
 layout(binding = 5, set = 0) readonly buffer GeometryMappingBuffer {
     uint indices[];
 } geometry_mapping_buffer;
+// per instance the geometry id of its first submesh and the offset of its submesh materials, which follow all
+// instances in the same buffer
 layout(binding = 6, set = 0) readonly buffer InstanceMappingBuffer {
     uint indices[];
 } instance_mapping_buffer;
@@ -24,25 +36,48 @@ struct EmittingInstance {
     mat4 transform;
     uint instance_idx;
     uint primitive_count;
-    uint padding[2];
+    uint geometry_idx;
+    uint padding;
 };
 layout(binding = 7, set = 0) buffer EmittingInstanceBuffer {
     EmittingInstance instances[];
 } emitting_instance_buffer;
 
+vec3 getVertexPosition(uint vertexOffset, uint index)
+{
+    if (sceneData.compact_vertices != 0) {
+        uint base_index = 3 * (vertexOffset + index);
+        return vec3(position_buffer.data[base_index], position_buffer.data[base_index + 1], position_buffer.data[base_index + 2]);
+    }
+    return vertex_buffer.data[4 * (vertexOffset + index)].xyz;
+}
+
 Vertex getVertex(uint vertexOffset, uint index)
 {
+    Vertex v;
+    if (sceneData.compact_vertices != 0) {
+        uint base_index = 3 * (vertexOffset + index);
+        v.position = getVertexPosition(vertexOffset, index);
+        v.normal = decodeOctahedral(attribute_buffer.data[base_index]);
+        vec4 tangent = decodeTangent(attribute_buffer.data[base_index + 1]);
+        v.tangent = tangent.xyz;
+        v.bitangent_sign = tangent.w;
+        v.color = vec3(1.0);
+        v.uv = decodeUv(attribute_buffer.data[base_index + 2]);
+        return v;
+    }
+
     uint base_index = 4 * (vertexOffset + index);
     vec4 A = vertex_buffer.data[base_index];
     vec4 B = vertex_buffer.data[base_index + 1];
     vec4 C = vertex_buffer.data[base_index + 2];
     vec4 D = vertex_buffer.data[base_index + 3];
 
-    Vertex v;
     v.position = A.xyz;
     v.normal = vec3(A.w, B.x, B.y);
     v.tangent = vec3(B.zw, C.x);
-    v.color = vec3(C.yz, D.x);
+    v.bitangent_sign = C.y < 0.0 ? -1.0 : 1.0;
+    v.color = vec3(C.zw, D.x);
     v.uv = D.yz;
 
     return v;
@@ -61,11 +96,13 @@ struct Triangle {
     uint material_idx;
 };
 
-Triangle getTriangle(uint32_t instance_idx, uint32_t primitive_idx) {
+// geometry_idx is the submesh inside the instance, gl_GeometryIndexEXT for hits
+Triangle getTriangle(uint32_t instance_idx, uint32_t geometry_idx, uint32_t primitive_idx) {
     uint index = instance_idx;
 
-    uint geometry_index = instance_mapping_buffer.indices[2 * index];
-    uint material_index = instance_mapping_buffer.indices[2 * index + 1];
+    uint geometry_index = instance_mapping_buffer.indices[2 * index] + geometry_idx;
+    uint material_offset = instance_mapping_buffer.indices[2 * index + 1];
+    uint material_index = instance_mapping_buffer.indices[material_offset + geometry_idx];
 
     uint vertex_offset = geometry_mapping_buffer.indices[2 * geometry_index];
     uint index_offset = geometry_mapping_buffer.indices[2 * geometry_index + 1];
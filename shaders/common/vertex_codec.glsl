@@ -0,0 +1,46 @@
+#ifndef VERTEX_CODEC_GLSL
+#define VERTEX_CODEC_GLSL
+
+// Shared with the CPU encoder through CompactVertex.hpp, only use syntax that is valid in both GLSL and C++ (glm).
+#ifndef VERTEX_CODEC_FUNC
+#define VERTEX_CODEC_FUNC
+#endif
+
+VERTEX_CODEC_FUNC vec2 octWrap(vec2 v) {
+    return (vec2(1.0f) - abs(vec2(v.y, v.x))) * vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+// unit vector -> two snorm16 on the octahedron
+VERTEX_CODEC_FUNC uint encodeOctahedral(vec3 n) {
+    n /= max(abs(n.x) + abs(n.y) + abs(n.z), 1e-20f);
+    vec2 p = n.z >= 0.0f ? vec2(n.x, n.y) : octWrap(vec2(n.x, n.y));
+    return packSnorm2x16(p);
+}
+
+VERTEX_CODEC_FUNC vec3 decodeOctahedral(uint encoded) {
+    vec2 f = unpackSnorm2x16(encoded);
+    vec3 n = vec3(f.x, f.y, 1.0f - abs(f.x) - abs(f.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+// octahedral tangent, the lowest bit holds the sign of the bitangent
+VERTEX_CODEC_FUNC uint encodeTangent(vec4 t) {
+    return (encodeOctahedral(vec3(t.x, t.y, t.z)) & ~1u) | (t.w < 0.0f ? 1u : 0u);
+}
+
+VERTEX_CODEC_FUNC vec4 decodeTangent(uint encoded) {
+    return vec4(decodeOctahedral(encoded & ~1u), (encoded & 1u) != 0u ? -1.0f : 1.0f);
+}
+
+VERTEX_CODEC_FUNC uint encodeUv(vec2 uv) {
+    return packHalf2x16(uv);
+}
+
+VERTEX_CODEC_FUNC vec2 decodeUv(uint encoded) {
+    return unpackHalf2x16(encoded);
+}
+
+#endif // VERTEX_CODEC_GLSL
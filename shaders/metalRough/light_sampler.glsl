@@ -15,7 +15,7 @@ LightSample sampleEmittingPrimitive(vec3 P, uint emitter_count) {
     uint primitive_idx = uint(min(u * emitting_instance.primitive_count, emitting_instance.primitive_count - 1));
     float pmf_primitive = 1.0 / emitting_instance.primitive_count;
 
-    Triangle triangle = getTriangle(emitting_instance.instance_idx, primitive_idx);
+    Triangle triangle = getTriangle(emitting_instance.instance_idx, emitting_instance.geometry_idx, primitive_idx);
 
     u = stepAndOutputRNGFloat(payload.rng_state);
     float v = stepAndOutputRNGFloat(payload.rng_state);
@@ -12,6 +12,7 @@ struct Material {
     int albedo_tex_idx;
     int metal_rough_ao_tex_idx;
     int normal_tex_idx;
+    int metal_rough_layout;
 };
 
 layout(binding = 0, set = 1) readonly buffer MaterialBuffer {
@@ -4,6 +4,7 @@
 
 #include "../../include/engine/Engine.hpp"
 
+#include "AssetPacker.hpp"
 #include "BenchmarkRunner.hpp"
 #include "CommandLineParser.hpp"
 #include "HierarchyWindow.hpp"
@@ -11,12 +12,21 @@
 #include "PathUtil.hpp"
 #include "RealtimeRunner.hpp"
 #include "ReferenceRunner.hpp"
+#include "ScalingRunner.hpp"
+#include "SceneUtil.hpp"
 #include "YamlLoadProperties.hpp"
 
+#include <imgui.h>
+
 namespace RtEngine {
     void Engine::run(CliArguments cli_args) {
         parseCliArguments(cli_args);
 
+        if (!options->pack_scene.empty()) {
+            AssetPacker(options->resources_dir).pack(options->pack_scene);
+            return;
+        }
+
         init();
         mainLoop();
         cleanup();
@@ -79,6 +89,9 @@ namespace RtEngine {
         } else if (options->runner_type == BENCHMARK) {
             runner = std::make_shared<BenchmarkRunner>(engine_context, gui_renderer, scene_manager);
             SPDLOG_INFO("Benchmark runner created");
+        } else if (options->runner_type == SCALING) {
+            runner = std::make_shared<ScalingRunner>(engine_context, gui_renderer, scene_manager, options->scaling_tag);
+            SPDLOG_INFO("Scaling runner created");
         } else {
             SPDLOG_ERROR("No runner created");
             return;
@@ -97,18 +110,58 @@ namespace RtEngine {
     void Engine::mainLoop() {
         while (window->is_open() && runner->isRunning()) {
             window->pollEvents();
+            selectClickedNode();
 
             runner->renderScene();
             finishFrame();
         }
     }
 
+    // a left click into the viewport selects the node under the cursor, clicks on gui windows are left to imgui
+    void Engine::selectClickedNode() const {
+        if (!engine_context->input_manager->getMouseButtonDown(MouseButton::MOUSE_LEFT) ||
+            ImGui::GetIO().WantCaptureMouse) {
+            return;
+        }
+
+        std::shared_ptr<Scene> scene = scene_manager->getCurrentScene();
+        if (scene == nullptr) {
+            return;
+        }
+        std::vector<std::shared_ptr<Camera>> cameras = SceneUtil::collectCameras(scene->getComponentPools());
+        if (cameras.empty()) {
+            return;
+        }
+
+        // the image is stretched over the whole window
+        int width, height;
+        glfwGetWindowSize(window->getHandle(), &width, &height);
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+        const glm::vec2 uv = engine_context->input_manager->getMousePosition() / glm::vec2(width, height);
+
+        const std::shared_ptr<Camera> &camera = cameras.at(0);
+        InstancePick pick;
+        if (!scene->getInstanceBvh().pick(camera->getPosition(), camera->getRayDirection(uv), &pick)) {
+            return;
+        }
+        if (pick.instance.isNode()) {
+            gui_manager->hierarchy_window->last_clicked_node = pick.instance.node;
+        } else {
+            const std::shared_ptr<InstanceArray> &instance_array = scene->getInstanceArrays()[pick.instance.instance_array];
+            spdlog::info("Picked instance {} of instance array {}", pick.instance.instance, instance_array->name);
+        }
+    }
+
     void Engine::finishFrame() {
         engine_context->input_manager->reset();
     }
 
     void Engine::cleanup() {
+        runner->waitForSceneLoad();
         vulkan_renderer->waitForIdle();
+        runner->clearSceneCache();
         scene_manager->getCurrentScene()->destroy();
         gui_manager->destroy();
         vulkan_renderer->cleanup();
@@ -130,6 +183,10 @@ namespace RtEngine {
         cli_parser.addFlag("--benchmark", &benchmark, "Render an image and benchmark it against a reference.");
         cli_parser.addFlag("--realtime", &realtime, "Render an image in realtime.");
         cli_parser.addFlag("-v", &options->verbose, "Display debug messages.");
+        cli_parser.addString("--pack", &options->pack_scene,
+                             "Pack the named scene and everything it references into an asset pack, then exit.");
+        cli_parser.addString("--scaling", &options->scaling_tag,
+                             "Run the scaling suite on generated stress scenes and write resources/benchmarks/scaling_<tag>.csv.");
         cli_parser.parse(cli_args.argc, cli_args.argv);
 
         if (help) {
@@ -141,7 +198,9 @@ namespace RtEngine {
             spdlog::set_level(spdlog::level::debug);
         }
 
-        if (benchmark) {
+        if (!options->scaling_tag.empty()) {
+            options->runner_type = SCALING;
+        } else if (benchmark) {
             options->runner_type = BENCHMARK;
         } else if (reference) {
             options->runner_type = REFERENCE;
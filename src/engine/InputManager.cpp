@@ -10,6 +10,9 @@ namespace RtEngine {
         window->addMouseCallback([this](double xPos, double yPos) {
             processGlfwMouseEvent(xPos, yPos);
         });
+        window->addMouseButtonCallback([this](int button, int action, int mods) {
+            processGlfwMouseButtonEvent(button, action);
+        });
     }
 
     bool InputManager::getKeyDown(const Keycode key) const {
@@ -20,6 +23,14 @@ namespace RtEngine {
         return up_keycodes.contains(key);
     }
 
+    bool InputManager::getMouseButtonDown(const MouseButton button) const {
+        return down_buttons.contains(button);
+    }
+
+    bool InputManager::getMouseButtonUp(const MouseButton button) const {
+        return up_buttons.contains(button);
+    }
+
     glm::vec2 InputManager::getMousePosition() const {
         return mouse_pos;
     }
@@ -27,6 +38,8 @@ namespace RtEngine {
     void InputManager::reset() {
         down_keycodes.clear();
         up_keycodes.clear();
+        down_buttons.clear();
+        up_buttons.clear();
     }
 
     void InputManager::processGlfwKeyEvent(int key, int action) {
@@ -44,6 +57,16 @@ namespace RtEngine {
         mouse_pos.y = yPos;
     }
 
+    void InputManager::processGlfwMouseButtonEvent(int button, int action) {
+        if (action == GLFW_PRESS) {
+            down_buttons.insert(glfwToEngineMouseButton(button));
+        }
+
+        if (action == GLFW_RELEASE) {
+            up_buttons.insert(glfwToEngineMouseButton(button));
+        }
+    }
+
     Keycode InputManager::glfwToEngineKeycode(int glfw_key) {
         switch (glfw_key) {
             case GLFW_KEY_A: return Keycode::A;
@@ -81,4 +104,15 @@ namespace RtEngine {
                 return Keycode::UNKNOWN;
         }
     }
+
+    MouseButton InputManager::glfwToEngineMouseButton(int glfw_button) {
+        switch (glfw_button) {
+            case GLFW_MOUSE_BUTTON_LEFT: return MouseButton::MOUSE_LEFT;
+            case GLFW_MOUSE_BUTTON_RIGHT: return MouseButton::MOUSE_RIGHT;
+            case GLFW_MOUSE_BUTTON_MIDDLE: return MouseButton::MOUSE_MIDDLE;
+
+            default:
+                return MouseButton::MOUSE_UNKNOWN;
+        }
+    }
 } // RtEngine
\ No newline at end of file
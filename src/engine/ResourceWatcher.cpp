@@ -0,0 +1,113 @@
+#include "ResourceWatcher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace RtEngine {
+    namespace {
+        // editors often write to a temporary file and rename it, so moves count as writes as well
+        constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        const std::string CACHE_DIR = "cache";
+    } // namespace
+
+    ResourceWatcher::ResourceWatcher(const std::string &resources_dir) : resources_dir(resources_dir) {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0) {
+            spdlog::warn("Hot reload is disabled, inotify is not available: {}", std::strerror(errno));
+            return;
+        }
+        addWatches(resources_dir);
+        spdlog::debug("Watching {} directories below {} for changes", watched_dirs.size(), resources_dir);
+    }
+
+    ResourceWatcher::~ResourceWatcher() {
+        if (inotify_fd >= 0) {
+            close(inotify_fd);
+        }
+    }
+
+    std::vector<std::string> ResourceWatcher::poll() {
+        std::vector<std::string> changed_paths;
+        if (inotify_fd < 0) {
+            return changed_paths;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                if (length < 0 && errno != EAGAIN) {
+                    spdlog::warn("Failed to read resource changes: {}", std::strerror(errno));
+                }
+                break;
+            }
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0 || !watched_dirs.contains(event->wd)) {
+                    continue;
+                }
+                const std::string &dir = watched_dirs[event->wd];
+                const std::string path = dir.empty() ? event->name : dir + "/" + event->name;
+
+                if (event->mask & IN_ISDIR) {
+                    // new directories are watched as well, files inside of them show up with their own events
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        addWatches(std::filesystem::path(resources_dir) / path);
+                    }
+                    continue;
+                }
+
+                // a created file is reported again once it has been closed
+                if (event->mask & IN_CREATE) {
+                    continue;
+                }
+                if (std::find(changed_paths.begin(), changed_paths.end(), path) == changed_paths.end()) {
+                    changed_paths.push_back(path);
+                }
+            }
+        }
+        return changed_paths;
+    }
+
+    void ResourceWatcher::addWatches(const std::filesystem::path &dir) {
+        if (dir.filename() == CACHE_DIR) {
+            return;
+        }
+        addWatch(dir);
+
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(dir, error);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (error) {
+                break;
+            }
+            if (!it->is_directory()) {
+                continue;
+            }
+            // imported textures are written by the engine itself
+            if (it->path().filename() == CACHE_DIR) {
+                it.disable_recursion_pending();
+                continue;
+            }
+            addWatch(it->path());
+        }
+    }
+
+    void ResourceWatcher::addWatch(const std::filesystem::path &dir) {
+        const int watch_descriptor = inotify_add_watch(inotify_fd, dir.c_str(), WATCH_MASK);
+        if (watch_descriptor < 0) {
+            spdlog::warn("Failed to watch {}: {}", dir.string(), std::strerror(errno));
+            return;
+        }
+
+        std::string relative_dir = std::filesystem::relative(dir, resources_dir).generic_string();
+        watched_dirs[watch_descriptor] = relative_dir == "." ? "" : relative_dir;
+    }
+} // RtEngine
@@ -37,6 +37,7 @@ namespace RtEngine {
         glfwSetFramebufferSizeCallback(glfw_handle, framebufferResizeCallback);
         glfwSetKeyCallback(glfw_handle, keyCallback);
         glfwSetCursorPosCallback(glfw_handle, mouseCallback);
+        glfwSetMouseButtonCallback(glfw_handle, mouseButtonCallback);
     }
 
     void Window::addResizeCallback(const std::function<void(int, int)> &func) {
@@ -51,6 +52,10 @@ namespace RtEngine {
         mouse_callbacks.push_back(func);
     }
 
+    void Window::addMouseButtonCallback(const std::function<void(int, int, int)> &func) {
+        mouse_button_callbacks.push_back(func);
+    }
+
     void Window::framebufferResizeCallback(GLFWwindow *glfw_window, int width, int height) {
         auto window = reinterpret_cast<Window *>(glfwGetWindowUserPointer(glfw_window));
         for (const auto& func : window->resize_callbacks) {
@@ -71,4 +76,11 @@ namespace RtEngine {
             func(xPos, yPos);
         }
     }
+
+    void Window::mouseButtonCallback(GLFWwindow *glfw_window, int button, int action, int mods) {
+        auto window = reinterpret_cast<Window *>(glfwGetWindowUserPointer(glfw_window));
+        for (const auto& func : window->mouse_button_callbacks) {
+            func(button, action, mods);
+        }
+    }
 } // RtEngine
\ No newline at end of file
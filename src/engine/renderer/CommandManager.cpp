@@ -17,6 +17,12 @@ namespace RtEngine {
 		if (vkCreateCommandPool(deviceManager->getDevice(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create command pool!");
 		}
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (vkCreateFence(deviceManager->getDevice(), &fenceInfo, nullptr, &singleTimeFence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create single time command fence!");
+		}
 	}
 
 	VkCommandBuffer CommandManager::beginSingleTimeCommands() const {
@@ -46,14 +52,17 @@ namespace RtEngine {
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
+		// waiting on the fence instead of the queue does not wait for the frames still in flight
 		VkQueue graphics_queue = deviceManager->getQueue(GRAPHICS);
-		vkQueueSubmit(graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphics_queue);
+		vkResetFences(deviceManager->getDevice(), 1, &singleTimeFence);
+		vkQueueSubmit(graphics_queue, 1, &submitInfo, singleTimeFence);
+		vkWaitForFences(deviceManager->getDevice(), 1, &singleTimeFence, VK_TRUE, UINT64_MAX);
 
 		vkFreeCommandBuffers(deviceManager->getDevice(), commandPool, 1, &commandBuffer);
 	}
 
 	void CommandManager::destroy() const {
+		vkDestroyFence(deviceManager->getDevice(), singleTimeFence, nullptr);
 		vkDestroyCommandPool(deviceManager->getDevice(), commandPool, nullptr);
 	}
 } // namespace RtEngine
@@ -4,6 +4,7 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <components/Camera.hpp>
+#include <components/MeshRenderer.hpp>
 
 #include "SceneUtil.hpp"
 
@@ -11,7 +12,7 @@ namespace RtEngine {
 	std::shared_ptr<SceneData> Scene::createSceneData(uint32_t emitting_object_count) {
 		auto sceneData = std::make_shared<SceneData>();
 
-		std::shared_ptr<Camera> camera = SceneUtil::collectCameras(getRootNode()).at(0); // TODO remove this by having a own camera uniform buffer
+		std::shared_ptr<Camera> camera = SceneUtil::collectCameras(getComponentPools()).at(0); // TODO remove this by having a own camera uniform buffer
 		sceneData->inverse_view = camera->getInverseView();
 		sceneData->inverse_proj = camera->getInverseProjection();
 		sceneData->view_pos = glm::vec4(camera->getPosition(), 0.0f);
@@ -36,43 +37,169 @@ namespace RtEngine {
 		return sceneData;
 	}
 
-	void Scene::addNode(std::string name, std::shared_ptr<Node> node) {
-		assert(!nodes.contains(name));
-		nodes[name] = std::move(node);
+	NodeId Scene::addNode(const std::shared_ptr<Node> &node) {
+		assert(!node_ids.contains(node->name));
+		const auto id = static_cast<NodeId>(nodes.size());
+		node->id = id;
+		nodes.push_back(node);
+		node_ids.emplace(node->name, id);
+		if (node->name == ROOT_NODE_NAME) {
+			root_id = id;
+		}
+
+		transform_hierarchy.invalidate();
+		component_pools.invalidate();
+		physics.invalidate();
+		animations.invalidate();
+		instance_bvh.invalidate();
+		return id;
 	}
 
-	std::shared_ptr<Node> Scene::getRootNode() { return nodes["root"]; }
+	std::shared_ptr<Node> Scene::getRootNode() const { return getNode(root_id); }
+
+	std::shared_ptr<Node> Scene::getNode(NodeId id) const { return id < nodes.size() ? nodes[id] : nullptr; }
+
+	NodeId Scene::findNode(std::string_view name) const {
+		const auto it = node_ids.find(name);
+		return it != node_ids.end() ? it->second : NO_NODE;
+	}
+
+	void Scene::addInstanceArray(const std::shared_ptr<InstanceArray> &instance_array) {
+		instance_arrays.push_back(instance_array);
+		instance_bvh.invalidate();
+	}
 
 	void Scene::start() {
 		for (auto &node: nodes) {
-			node.second->start();
+			node->start();
+		}
+		for (auto &instance_array: instance_arrays) {
+			instance_array->start(draw_list);
 		}
 	}
 
-	void Scene::update() {
-		getRootNode()->refreshTransform(glm::mat4(1.0f));
+	void Scene::markHierarchyChanged() {
+		transform_hierarchy.invalidate();
+		component_pools.invalidate();
+		physics.invalidate();
+		animations.invalidate();
+		instance_bvh.invalidate();
+	}
 
-		for (auto &node: nodes) {
-			node.second->update();
+	void Scene::markMeshesReloaded() {
+		physics.invalidate();
+		instance_bvh.invalidate();
+	}
+
+	void Scene::refreshTransforms() {
+		if (!transform_hierarchy.isValid()) {
+			transform_hierarchy.rebuild(getRootNode());
+		}
+		if (transform_hierarchy.update() == 0) {
+			return;
+		}
+
+		for (Node *node: transform_hierarchy.getUpdatedNodes()) {
+			if (auto mesh_renderer = node->getComponent<MeshRenderer>()) {
+				mesh_renderer->updateTransform();
+				if (instance_bvh.isValid()) {
+					instance_bvh.markNodeMoved(node->id);
+				}
+			}
+		}
+	}
+
+	const ComponentPools &Scene::getComponentPools() {
+		if (!component_pools.isValid()) {
+			component_pools.rebuild(getRootNode());
+		}
+		return component_pools;
+	}
+
+	const InstanceBvh &Scene::getInstanceBvh() {
+		refreshTransforms();
+		if (!instance_bvh.isValid()) {
+			instance_bvh.rebuild(getComponentPools(), instance_arrays);
+		} else {
+			instance_bvh.refit();
+		}
+		return instance_bvh;
+	}
+
+	void Scene::update(const UpdateFlagsHandle &update_flags) {
+		getComponentPools();
+		if (!animations.isValid()) {
+			animations.rebuild(component_pools, material);
+		}
+		if (!physics.isValid()) {
+			// the static bounds come from the world transforms
+			refreshTransforms();
+			physics.rebuild(component_pools);
+		}
+
+		// animated and moved bodies are picked up by the same refresh as everything changed since the last frame
+		const UpdateFlagValue material_update = animations.apply(time);
+		if (material_update != NO_UPDATE) {
+			update_flags->setFlag(material_update);
+		}
+		physics.step();
+		refreshTransforms();
+		time += FIXED_DELTA_TIME;
+
+		for (auto &pool: component_pools.getPools()) {
+			if (pool.system_driven) {
+				continue;
+			}
+			const auto component_count = static_cast<int64_t>(pool.components.size());
+#pragma omp parallel for schedule(dynamic, 64) if (pool.parallel_update && component_count >= PARALLEL_UPDATE_SIZE)
+			for (int64_t i = 0; i < component_count; i++) {
+				pool.components[i]->OnUpdate();
+			}
+		}
+
+		for (auto &pool: component_pools.getPools()) {
+			if (pool.system_driven) {
+				continue;
+			}
+			for (auto &component: pool.components) {
+				component->OnCommit();
+			}
 		}
 	}
 
 	void Scene::destroy() {
 		for (auto &node: nodes) {
-			node.second->destroy();
+			node->destroy();
+		}
+		for (auto &instance_array: instance_arrays) {
+			instance_array->destroy();
 		}
 	}
 
 	std::vector<std::shared_ptr<MeshAsset>> Scene::getMeshAssets() {
-		return SceneUtil::collectMeshAssets(getRootNode());
+		return SceneUtil::collectMeshAssets(getComponentPools(), instance_arrays);
 	}
 
 	std::vector<std::shared_ptr<MaterialInstance>> Scene::getMaterialInstances() {
-		return  SceneUtil::collectMaterialInstances(getRootNode());
+		return  SceneUtil::collectMaterialInstances(getComponentPools(), instance_arrays);
 	}
 
+	// only the cameras have something to add, the render objects are already in the draw list
 	void Scene::fillDrawContext(const std::shared_ptr<DrawContext> &draw_context) {
-		getRootNode()->draw(*draw_context);
+		draw_context->clear();
+		getComponentPools().forEach<Camera>([&](const std::shared_ptr<Camera> &camera) {
+			camera->OnRender(*draw_context);
+		});
+		draw_context->draw_list = draw_list;
+	}
+
+	void Scene::refreshRenderObjects() {
+		getComponentPools().forEach<MeshRenderer>([](const std::shared_ptr<MeshRenderer> &mesh_renderer) {
+			mesh_renderer->refreshRenderObject();
+		});
+		for (auto &instance_array: instance_arrays) {
+			instance_array->refreshRenderObjects();
+		}
 	}
 
 	std::shared_ptr<Material> Scene::getMaterial() {
@@ -52,12 +52,13 @@ namespace RtEngine {
 		createVulkanContext();
 		createRepositories();
 
-		scene_adapter = std::make_shared<SceneAdapter>(vulkan_context, texture_repository, max_frames_in_flight,
-													   DeviceManager::RAYTRACING_PROPERTIES);
+		scene_adapter = std::make_shared<SceneAdapter>(vulkan_context, texture_repository, mesh_repository,
+													   max_frames_in_flight, DeviceManager::RAYTRACING_PROPERTIES);
 		mainDeletionQueue.pushFunction([&]() { scene_adapter->clearResources(); });
 
 		createCommandBuffers();
 		createSyncObjects();
+		createTimestampQueries();
 	}
 
 	void VulkanRenderer::createVulkanContext() {
@@ -116,10 +117,24 @@ namespace RtEngine {
 		return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 	}
 
-	void VulkanRenderer::loadScene(std::shared_ptr<IScene> scene) {
-		scene_adapter->loadNewScene(scene);
+	std::shared_ptr<SceneResources> VulkanRenderer::loadScene(std::shared_ptr<IScene> scene) {
+		scene_adapter->setCompactVertices(compact_vertices);
+		return scene_adapter->loadNewScene(scene);
 	}
 
+	std::shared_ptr<SceneResources>
+	VulkanRenderer::activateSceneResources(const std::shared_ptr<SceneResources> &resources) {
+		return scene_adapter->activateSceneResources(resources);
+	}
+
+	void VulkanRenderer::destroySceneResources(const std::shared_ptr<SceneResources> &resources) {
+		if (resources != nullptr) {
+			scene_adapter->destroySceneResources(*resources);
+		}
+	}
+
+	bool VulkanRenderer::usesCompactVertices() const { return compact_vertices; }
+
 	void VulkanRenderer::createCommandBuffers() {
 		commandBuffers.resize(max_frames_in_flight);
 
@@ -175,6 +190,49 @@ namespace RtEngine {
 		}
 	}
 
+	void VulkanRenderer::createTimestampQueries() {
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(vulkan_context->device_manager->getPhysicalDevice(), &properties);
+		timestamp_period = properties.limits.timestampPeriod;
+
+		VkQueryPoolCreateInfo query_pool_info{};
+		query_pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_info.queryCount = 2 * max_frames_in_flight;
+
+		if (vkCreateQueryPool(vulkan_context->device_manager->getDevice(), &query_pool_info, nullptr,
+							  &timestamp_query_pool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create timestamp query pool!");
+		}
+		timestamps_written.assign(max_frames_in_flight, false);
+
+		mainDeletionQueue.pushFunction([&]() {
+			vkDestroyQueryPool(vulkan_context->device_manager->getDevice(), timestamp_query_pool, nullptr);
+		});
+	}
+
+	double VulkanRenderer::getLastGpuFrameTime() const {
+		if (!timestamps_written[current_frame]) {
+			return -1.0;
+		}
+
+		uint64_t timestamps[2];
+		if (vkGetQueryPoolResults(vulkan_context->device_manager->getDevice(), timestamp_query_pool, 2 * current_frame,
+								  2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+								  VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+			return -1.0;
+		}
+		return static_cast<double>(timestamps[1] - timestamps[0]) * timestamp_period / 1e6;
+	}
+
+	const SceneAdapter::BuildTimings &VulkanRenderer::getBuildTimings() const {
+		return scene_adapter->getBuildTimings();
+	}
+
+	VkDeviceSize VulkanRenderer::getAllocatedDeviceMemory() const {
+		return vulkan_context->resource_builder->getAllocatedBytes();
+	}
+
 	void VulkanRenderer::updateSceneRepresentation(const std::shared_ptr<DrawContext> &draw_context, UpdateFlagsHandle update_flags) {
 		scene_adapter->updateScene(draw_context, current_frame, update_flags);
 	}
@@ -183,6 +241,10 @@ namespace RtEngine {
 		scene_adapter->updateRenderTarget(target);
 	}
 
+	void VulkanRenderer::reloadMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset) {
+		scene_adapter->reloadMeshGeometry(mesh_asset);
+	}
+
 	void VulkanRenderer::waitForNextFrameStart() {
 		vkWaitForFences(vulkan_context->device_manager->getDevice(), 1, &inFlightFences[current_frame], VK_TRUE,
 						UINT64_MAX);
@@ -276,7 +338,13 @@ namespace RtEngine {
 	}
 
 	void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, std::shared_ptr<RenderTarget> target, const uint32_t swapchain_image_idx, bool present) {
+		vkCmdResetQueryPool(commandBuffer, timestamp_query_pool, 2 * current_frame, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_query_pool, 2 * current_frame);
+		scene_adapter->recordFrameUpdates(commandBuffer, current_frame);
 		recordRenderToImage(commandBuffer, target);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_query_pool,
+							2 * current_frame + 1);
+		timestamps_written[current_frame] = true;
 		if (present) {
 			recordBlitToSwapchain(commandBuffer, target, swapchain_image_idx);
 		}
@@ -460,8 +528,15 @@ namespace RtEngine {
 			if (config->addUint("recursion_depth", &recursion_depth, 1, 10)) {
 				update_flags->setFlag(TARGET_RESET);
 			}
+			if (config->addBool("compact_vertices", &compact_vertices)) {
+				update_flags->setFlag(SCENE_UPDATE);
+			}
+			// a changed selection is picked up by the next scene update
+			config->addBool("mesh_lods", &mesh_lods);
+			config->addFloat("lod_pixel_error", &lod_pixel_error, 0.1f, 16.0f);
 			config->endChild();
 		}
+		scene_adapter->setLodSelection(mesh_lods, lod_pixel_error);
 
 		for (auto [name, material] : scene_adapter->defaultMaterials) {
 			material->initProperties(config, update_flags);
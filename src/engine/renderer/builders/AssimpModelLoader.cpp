@@ -1,9 +1,12 @@
 #include "AssimpModelLoader.hpp"
 
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <spdlog/spdlog.h>
 
 namespace RtEngine {
-	void AssimpModelLoader::loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) {
+	void AssimpModelLoader::loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+									 std::vector<Submesh> &submeshes) {
 		Assimp::Importer importer;
 		const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_CalcTangentSpace);
 
@@ -11,35 +14,55 @@ namespace RtEngine {
 			throw std::runtime_error("Assimp Error: " + std::string(importer.GetErrorString()));
 		}
 
-		processNode(scene->mRootNode, scene, vertices, indices);
+		processNode(scene->mRootNode, scene, glm::mat4(1.0f), vertices, indices, submeshes);
 	}
 
-	void AssimpModelLoader::processNode(aiNode *node, const aiScene *scene, std::vector<Vertex> &vertices,
-										std::vector<uint32_t> &indices) {
+	void AssimpModelLoader::processNode(aiNode *node, const aiScene *scene, const glm::mat4 &parent_transform,
+										std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+										std::vector<Submesh> &submeshes) {
+		// assimp matrices are row major
+		const glm::mat4 transform = parent_transform * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+
 		for (uint32_t i = 0; i < node->mNumMeshes; i++) {
 			aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-			processMesh(mesh, scene, vertices, indices);
+			processMesh(mesh, scene, transform, vertices, indices, submeshes);
 		}
 
 		for (uint32_t i = 0; i < node->mNumChildren; i++) {
-			processNode(node->mChildren[i], scene, vertices, indices);
+			processNode(node->mChildren[i], scene, transform, vertices, indices, submeshes);
 		}
 	}
 
-	void AssimpModelLoader::processMesh(aiMesh *mesh, const aiScene *scene, std::vector<Vertex> &vertices,
-										std::vector<uint32_t> &indices) {
-		if (!mesh->mTangents) {
-			spdlog::warn("No tangent found for mesh!");
-		}
+	void AssimpModelLoader::processMesh(aiMesh *mesh, const aiScene *scene, const glm::mat4 &transform,
+										std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+										std::vector<Submesh> &submeshes) {
+		const auto base_vertex = static_cast<uint32_t>(vertices.size());
+		const glm::mat3 model_matrix = glm::mat3(transform);
+		const glm::mat3 normal_matrix = glm::inverseTranspose(model_matrix);
+		const bool mirrored = glm::determinant(model_matrix) < 0.0f;
 
 		for (uint32_t i = 0; i < mesh->mNumVertices; i++) {
 			Vertex vertex;
 
-			vertex.pos = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-			vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+			vertex.pos = glm::vec3(transform * glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y,
+														 mesh->mVertices[i].z, 1.0f));
+			vertex.normal = glm::vec3(0.0f);
+			if (mesh->mNormals) {
+				const glm::vec3 normal =
+						normal_matrix * glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+				vertex.normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+			}
 			if (mesh->mTangents) {
-				vertex.tangent = glm::vec4(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z, 0);
+				const glm::vec3 tangent(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+				const glm::vec3 bitangent(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+				const glm::vec3 normal(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+				// assimp's bitangent follows v, which points down in the image since uvs are used as they are
+				float sign = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? 1.0f : -1.0f;
+				const glm::vec3 direction = model_matrix * tangent;
+				vertex.tangent = glm::vec4(glm::length(direction) > 0.0f ? glm::normalize(direction) : direction,
+										   mirrored ? -sign : sign);
 			} else {
+				// w == 0 marks the tangent as missing, it is generated after loading
 				vertex.tangent = glm::vec4(1, 0, 0, 0);
 			}
 			if (mesh->mTextureCoords[0]) {
@@ -52,11 +75,29 @@ namespace RtEngine {
 			vertices.push_back(vertex);
 		}
 
+		Submesh submesh{};
+		submesh.index_offset = static_cast<uint32_t>(indices.size());
+		if (mesh->mMaterialIndex < scene->mNumMaterials) {
+			submesh.material_name = scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str();
+		}
+
+		// points and lines left over after triangulation have no place in a blas
 		for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
-			aiFace face = mesh->mFaces[i];
-			for (uint32_t j = 0; j < face.mNumIndices; j++) {
-				indices.push_back(face.mIndices[j]);
+			const aiFace &face = mesh->mFaces[i];
+			if (face.mNumIndices != 3) {
+				continue;
 			}
+			// a mirroring transform flips the winding order
+			indices.push_back(base_vertex + face.mIndices[0]);
+			indices.push_back(base_vertex + face.mIndices[mirrored ? 2 : 1]);
+			indices.push_back(base_vertex + face.mIndices[mirrored ? 1 : 2]);
+		}
+
+		submesh.index_count = static_cast<uint32_t>(indices.size()) - submesh.index_offset;
+		if (submesh.index_count > 0) {
+			submeshes.push_back(submesh);
+		} else {
+			spdlog::warn("Skipping mesh {} without triangles", mesh->mName.C_Str());
 		}
 	}
 } // namespace RtEngine
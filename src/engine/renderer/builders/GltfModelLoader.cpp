@@ -0,0 +1,685 @@
+#include "GltfModelLoader.hpp"
+
+#include <PathUtil.hpp>
+#include <YAML_glm.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <optional>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+		constexpr uint32_t GLB_JSON_CHUNK = 0x4E4F534A;
+		constexpr uint32_t GLB_BIN_CHUNK = 0x004E4942;
+
+		constexpr uint32_t COMPONENT_BYTE = 5120;
+		constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+		constexpr uint32_t COMPONENT_SHORT = 5122;
+		constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+		constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+		constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+		constexpr uint32_t MODE_TRIANGLES = 4;
+
+		// read only mapping of a whole file, the pages are only loaded once an accessor touches them
+		class MappedFile {
+		public:
+			explicit MappedFile(const std::string &path) {
+				const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd < 0) {
+					throw std::runtime_error("failed to open " + path + "!");
+				}
+
+				struct stat file_stat{};
+				if (fstat(fd, &file_stat) != 0) {
+					close(fd);
+					throw std::runtime_error("failed to read the size of " + path + "!");
+				}
+
+				size = static_cast<size_t>(file_stat.st_size);
+				if (size > 0) {
+					void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (mapping == MAP_FAILED) {
+						close(fd);
+						throw std::runtime_error("failed to map " + path + "!");
+					}
+					madvise(mapping, size, MADV_WILLNEED);
+					data = static_cast<const uint8_t *>(mapping);
+				}
+				close(fd);
+			}
+
+			~MappedFile() {
+				if (data != nullptr) {
+					munmap(const_cast<uint8_t *>(data), size);
+				}
+			}
+
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+
+			std::span<const uint8_t> bytes() const { return {data, size}; }
+
+		private:
+			const uint8_t *data = nullptr;
+			size_t size = 0;
+		};
+
+		struct GltfDocument {
+			YAML::Node json;
+			std::vector<std::span<const uint8_t>> buffers;
+
+			// owners of the memory the buffer spans point into
+			std::vector<std::shared_ptr<MappedFile>> mapped_files;
+			std::vector<std::vector<uint8_t>> decoded_buffers;
+		};
+
+		struct AccessorView {
+			const uint8_t *data = nullptr;
+			uint32_t count = 0;
+			size_t stride = 0;
+			uint32_t component_type = 0;
+			uint32_t component_count = 0;
+			bool normalized = false;
+
+			// normalized integers are mapped to [0, 1] or [-1, 1] like the spec requires
+			float readComponent(uint32_t element, uint32_t component) const {
+				const uint8_t *src = data + element * stride;
+				switch (component_type) {
+					case COMPONENT_FLOAT: {
+						float value;
+						std::memcpy(&value, src + component * sizeof(float), sizeof(float));
+						return value;
+					}
+					case COMPONENT_UNSIGNED_BYTE: {
+						const float value = src[component];
+						return normalized ? value / 255.0f : value;
+					}
+					case COMPONENT_BYTE: {
+						const float value = static_cast<int8_t>(src[component]);
+						return normalized ? std::max(value / 127.0f, -1.0f) : value;
+					}
+					case COMPONENT_UNSIGNED_SHORT: {
+						uint16_t value;
+						std::memcpy(&value, src + component * sizeof(uint16_t), sizeof(uint16_t));
+						return normalized ? value / 65535.0f : value;
+					}
+					case COMPONENT_SHORT: {
+						int16_t value;
+						std::memcpy(&value, src + component * sizeof(int16_t), sizeof(int16_t));
+						return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+					}
+					default:
+						return 0.0f;
+				}
+			}
+
+			template<glm::length_t N>
+			glm::vec<N, float> readVec(uint32_t element) const {
+				glm::vec<N, float> value(0.0f);
+				const uint32_t read_count = std::min<uint32_t>(N, component_count);
+				if (component_type == COMPONENT_FLOAT) {
+					std::memcpy(glm::value_ptr(value), data + element * stride, read_count * sizeof(float));
+					return value;
+				}
+				for (uint32_t i = 0; i < read_count; i++) {
+					value[i] = readComponent(element, i);
+				}
+				return value;
+			}
+
+			uint32_t readIndex(uint32_t element) const {
+				const uint8_t *src = data + element * stride;
+				if (component_type == COMPONENT_UNSIGNED_BYTE) {
+					return *src;
+				}
+				if (component_type == COMPONENT_UNSIGNED_SHORT) {
+					uint16_t index;
+					std::memcpy(&index, src, sizeof(uint16_t));
+					return index;
+				}
+				uint32_t index;
+				std::memcpy(&index, src, sizeof(uint32_t));
+				return index;
+			}
+		};
+
+		YAML::Node parseJson(std::string text) {
+			// json allows tabs as whitespace everywhere, yaml does not, inside of json strings they are escaped
+			std::replace(text.begin(), text.end(), '\t', ' ');
+			return YAML::Load(text);
+		}
+
+		std::string joinPath(const std::string &directory, const std::string &file) {
+			return directory.empty() ? file : directory + "/" + file;
+		}
+
+		// uris are percent encoded, file names with spaces are common
+		std::string decodeUri(const std::string &uri) {
+			std::string decoded;
+			decoded.reserve(uri.size());
+			for (size_t i = 0; i < uri.size(); i++) {
+				if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(uri[i + 1]) && std::isxdigit(uri[i + 2])) {
+					decoded.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+					i += 2;
+				} else {
+					decoded.push_back(uri[i]);
+				}
+			}
+			return decoded;
+		}
+
+		std::vector<uint8_t> decodeBase64(const std::string &text) {
+			auto decode_char = [](char c) -> int32_t {
+				if (c >= 'A' && c <= 'Z') return c - 'A';
+				if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+				if (c >= '0' && c <= '9') return c - '0' + 52;
+				if (c == '+') return 62;
+				if (c == '/') return 63;
+				return -1;
+			};
+
+			std::vector<uint8_t> decoded;
+			decoded.reserve(text.size() * 3 / 4);
+			uint32_t bits = 0, bit_count = 0;
+			for (const char c: text) {
+				const int32_t value = decode_char(c);
+				if (value < 0) {
+					continue; // padding
+				}
+				bits = (bits << 6) | static_cast<uint32_t>(value);
+				bit_count += 6;
+				if (bit_count >= 8) {
+					bit_count -= 8;
+					decoded.push_back(static_cast<uint8_t>(bits >> bit_count));
+				}
+			}
+			return decoded;
+		}
+
+		// yaml-cpp throws on indexing missing nodes, so every lookup of a referenced element is checked
+		YAML::Node getElement(const YAML::Node &json, const char *array, const uint32_t idx) {
+			const YAML::Node elements = json[array];
+			if (!elements || !elements.IsSequence() || idx >= elements.size()) {
+				throw std::runtime_error(std::format("glTF {} {} does not exist", array, idx));
+			}
+			return elements[idx];
+		}
+
+		YAML::Node getChildOrEmpty(const YAML::Node &node, const char *key) {
+			return node[key] ? node[key] : YAML::Node(YAML::NodeType::Map);
+		}
+
+		GltfDocument loadDocument(const std::string &full_path, bool load_buffers) {
+			GltfDocument document;
+			std::span<const uint8_t> binary_chunk;
+
+			if (PathUtil::getExtension(full_path) == "glb") {
+				auto mapped_file = std::make_shared<MappedFile>(full_path);
+				const std::span<const uint8_t> file = mapped_file->bytes();
+
+				uint32_t header[3];
+				if (file.size() < sizeof(header)) {
+					throw std::runtime_error(full_path + " is too small to be a glTF binary");
+				}
+				std::memcpy(header, file.data(), sizeof(header));
+				if (header[0] != GLB_MAGIC || header[1] != 2) {
+					throw std::runtime_error(full_path + " is not a glTF 2.0 binary");
+				}
+
+				std::string json_text;
+				size_t offset = sizeof(header);
+				while (offset + 2 * sizeof(uint32_t) <= file.size()) {
+					uint32_t chunk_header[2]; // length, type
+					std::memcpy(chunk_header, file.data() + offset, sizeof(chunk_header));
+					offset += sizeof(chunk_header);
+					if (offset + chunk_header[0] > file.size()) {
+						throw std::runtime_error(full_path + " is truncated");
+					}
+
+					if (chunk_header[1] == GLB_JSON_CHUNK) {
+						json_text.assign(reinterpret_cast<const char *>(file.data() + offset), chunk_header[0]);
+					} else if (chunk_header[1] == GLB_BIN_CHUNK && binary_chunk.empty()) {
+						binary_chunk = file.subspan(offset, chunk_header[0]);
+					}
+					offset += (chunk_header[0] + 3) & ~3u; // chunks are 4 byte aligned
+				}
+				if (json_text.empty()) {
+					throw std::runtime_error(full_path + " contains no json chunk");
+				}
+
+				document.json = parseJson(json_text);
+				document.mapped_files.push_back(mapped_file);
+			} else {
+				std::ifstream file(full_path);
+				if (!file.is_open()) {
+					throw std::runtime_error("failed to open " + full_path + "!");
+				}
+				std::stringstream text;
+				text << file.rdbuf();
+				document.json = parseJson(text.str());
+			}
+
+			if (!load_buffers) {
+				return document;
+			}
+
+			const std::string directory = PathUtil::getDirectory(full_path);
+			for (const auto &buffer_node: document.json["buffers"]) {
+				const auto byte_length = buffer_node["byteLength"].as<size_t>();
+
+				std::span<const uint8_t> data;
+				if (!buffer_node["uri"]) {
+					data = binary_chunk;
+				} else if (const auto uri = buffer_node["uri"].as<std::string>(); uri.starts_with("data:")) {
+					const size_t comma = uri.find(',');
+					if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos) {
+						throw std::runtime_error("Only base64 data uris are supported in " + full_path);
+					}
+					document.decoded_buffers.push_back(decodeBase64(uri.substr(comma + 1)));
+					data = document.decoded_buffers.back();
+				} else {
+					auto mapped_file = std::make_shared<MappedFile>(joinPath(directory, decodeUri(uri)));
+					data = mapped_file->bytes();
+					document.mapped_files.push_back(mapped_file);
+				}
+
+				if (data.size() < byte_length) {
+					throw std::runtime_error("A buffer of " + full_path + " is smaller than its declared length");
+				}
+				document.buffers.push_back(data.first(byte_length));
+			}
+			return document;
+		}
+
+		uint32_t getComponentSize(uint32_t component_type) {
+			switch (component_type) {
+				case COMPONENT_BYTE:
+				case COMPONENT_UNSIGNED_BYTE:
+					return 1;
+				case COMPONENT_SHORT:
+				case COMPONENT_UNSIGNED_SHORT:
+					return 2;
+				case COMPONENT_UNSIGNED_INT:
+				case COMPONENT_FLOAT:
+					return 4;
+				default:
+					throw std::runtime_error("Unsupported glTF component type " + std::to_string(component_type));
+			}
+		}
+
+		uint32_t getComponentCount(const std::string &type) {
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			throw std::runtime_error("Unsupported glTF accessor type " + type);
+		}
+
+		// the view points straight into the mapped buffer, nothing is copied until the vertices are assembled
+		AccessorView getAccessor(const GltfDocument &document, const uint32_t accessor_idx) {
+			const YAML::Node accessor = getElement(document.json, "accessors", accessor_idx);
+			if (accessor["sparse"]) {
+				throw std::runtime_error("Sparse glTF accessors are not supported");
+			}
+			if (!accessor["bufferView"]) {
+				throw std::runtime_error("glTF accessors without a buffer view are not supported");
+			}
+
+			AccessorView view;
+			view.count = accessor["count"].as<uint32_t>();
+			view.component_type = accessor["componentType"].as<uint32_t>();
+			view.component_count = getComponentCount(accessor["type"].as<std::string>());
+			view.normalized = accessor["normalized"] && accessor["normalized"].as<bool>();
+
+			const YAML::Node buffer_view = getElement(document.json, "bufferViews", accessor["bufferView"].as<uint32_t>());
+			const auto buffer_idx = buffer_view["buffer"].as<uint32_t>();
+			if (buffer_idx >= document.buffers.size()) {
+				throw std::runtime_error(std::format("glTF buffer {} does not exist", buffer_idx));
+			}
+
+			const size_t element_size = getComponentSize(view.component_type) * view.component_count;
+			view.stride = buffer_view["byteStride"] ? buffer_view["byteStride"].as<size_t>() : element_size;
+			const size_t view_offset = buffer_view["byteOffset"] ? buffer_view["byteOffset"].as<size_t>() : 0;
+			const auto view_length = buffer_view["byteLength"].as<size_t>();
+			const size_t accessor_offset = accessor["byteOffset"] ? accessor["byteOffset"].as<size_t>() : 0;
+
+			const std::span<const uint8_t> buffer = document.buffers[buffer_idx];
+			if (view_offset + view_length > buffer.size() ||
+				(view.count > 0 && accessor_offset + view.stride * (view.count - 1) + element_size > view_length)) {
+				throw std::runtime_error(std::format("glTF accessor {} reads outside of its buffer", accessor_idx));
+			}
+			view.data = buffer.data() + view_offset + accessor_offset;
+			return view;
+		}
+
+		std::optional<AccessorView> getAttribute(const GltfDocument &document, const YAML::Node &attributes,
+												 const char *name) {
+			if (!attributes[name]) {
+				return std::nullopt;
+			}
+			return getAccessor(document, attributes[name].as<uint32_t>());
+		}
+
+		glm::mat4 getLocalTransform(const YAML::Node &node) {
+			if (node["matrix"]) {
+				glm::mat4 matrix; // both column major
+				for (uint32_t i = 0; i < 16; i++) {
+					glm::value_ptr(matrix)[i] = node["matrix"][i].as<float>();
+				}
+				return matrix;
+			}
+
+			glm::vec3 translation(0.0f), scale(1.0f);
+			glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+			if (node["translation"]) {
+				translation = node["translation"].as<glm::vec3>();
+			}
+			if (node["rotation"]) {
+				const auto xyzw = node["rotation"].as<glm::vec4>();
+				rotation = glm::quat(xyzw.w, xyzw.x, xyzw.y, xyzw.z);
+			}
+			if (node["scale"]) {
+				scale = node["scale"].as<glm::vec3>();
+			}
+			return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) *
+				   glm::scale(glm::mat4(1.0f), scale);
+		}
+
+		void collectMeshInstances(const YAML::Node &json, const uint32_t node_idx, const glm::mat4 &parent_transform,
+								  uint32_t depth, std::vector<std::pair<uint32_t, glm::mat4>> &mesh_instances) {
+			const YAML::Node node = getElement(json, "nodes", node_idx);
+			// the node hierarchy has to be a forest, a deeper recursion can only come from a cycle
+			if (depth > json["nodes"].size()) {
+				throw std::runtime_error("glTF node hierarchy contains a cycle");
+			}
+			const glm::mat4 transform = parent_transform * getLocalTransform(node);
+			if (node["mesh"]) {
+				mesh_instances.emplace_back(node["mesh"].as<uint32_t>(), transform);
+			}
+			for (const auto &child: node["children"]) {
+				collectMeshInstances(json, child.as<uint32_t>(), transform, depth + 1, mesh_instances);
+			}
+		}
+
+		// meshes are baked with the transforms of the nodes that reference them
+		std::vector<std::pair<uint32_t, glm::mat4>> collectMeshInstances(const YAML::Node &json) {
+			std::vector<std::pair<uint32_t, glm::mat4>> mesh_instances;
+			if (!json["scenes"] || json["scenes"].size() == 0) {
+				for (uint32_t i = 0; json["meshes"] && i < json["meshes"].size(); i++) {
+					mesh_instances.emplace_back(i, glm::mat4(1.0f));
+				}
+				return mesh_instances;
+			}
+
+			const uint32_t scene_idx = json["scene"] ? json["scene"].as<uint32_t>() : 0;
+			const YAML::Node scene = getElement(json, "scenes", scene_idx);
+			for (const auto &root: scene["nodes"]) {
+				collectMeshInstances(json, root.as<uint32_t>(), glm::mat4(1.0f), 0, mesh_instances);
+			}
+			return mesh_instances;
+		}
+
+		void appendPrimitive(const GltfDocument &document, const YAML::Node &primitive, const glm::mat4 &transform,
+							 std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) {
+			const uint32_t mode = primitive["mode"] ? primitive["mode"].as<uint32_t>() : MODE_TRIANGLES;
+			if (mode != MODE_TRIANGLES) {
+				spdlog::warn("Skipping glTF primitive with mode {}, only triangle lists are supported", mode);
+				return;
+			}
+
+			const YAML::Node attributes = primitive["attributes"];
+			if (!attributes || !attributes["POSITION"]) {
+				throw std::runtime_error("glTF primitive has no positions");
+			}
+			const AccessorView positions = getAccessor(document, attributes["POSITION"].as<uint32_t>());
+			const std::optional<AccessorView> normals = getAttribute(document, attributes, "NORMAL");
+			const std::optional<AccessorView> tangents = getAttribute(document, attributes, "TANGENT");
+			const std::optional<AccessorView> tex_coords = getAttribute(document, attributes, "TEXCOORD_0");
+			const std::optional<AccessorView> colors = getAttribute(document, attributes, "COLOR_0");
+
+			const auto base_vertex = static_cast<uint32_t>(vertices.size());
+			vertices.resize(base_vertex + positions.count);
+
+			const glm::mat3 model_matrix = glm::mat3(transform);
+			const glm::mat3 normal_matrix = glm::inverseTranspose(model_matrix);
+			const bool mirrored = glm::determinant(model_matrix) < 0.0f;
+#pragma omp parallel for
+			for (int i = 0; i < static_cast<int>(positions.count); i++) {
+				Vertex &vertex = vertices[base_vertex + i];
+				vertex.pos = glm::vec3(transform * glm::vec4(positions.readVec<3>(i), 1.0f));
+
+				vertex.normal = glm::vec3(0.0f);
+				if (normals) {
+					const glm::vec3 normal = normal_matrix * normals->readVec<3>(i);
+					vertex.normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+				}
+
+				// w == 0 marks the tangent as missing, it is generated after loading
+				vertex.tangent = glm::vec4(1, 0, 0, 0);
+				if (tangents) {
+					const glm::vec4 tangent = tangents->readVec<4>(i);
+					const glm::vec3 direction = model_matrix * glm::vec3(tangent);
+					vertex.tangent = glm::vec4(glm::length(direction) > 0.0f ? glm::normalize(direction) : direction,
+											   mirrored ? -tangent.w : tangent.w);
+				}
+
+				// gltf uvs have their origin in the top left corner just like vulkan images
+				vertex.texCoord = tex_coords ? glm::vec3(tex_coords->readVec<2>(i), 0.0f) : glm::vec3(0.0f);
+				vertex.color = colors ? colors->readVec<3>(i) : glm::vec3(1.0f);
+			}
+
+			const size_t base_index = indices.size();
+			if (primitive["indices"]) {
+				const AccessorView index_view = getAccessor(document, primitive["indices"].as<uint32_t>());
+				if (index_view.component_count != 1 || index_view.component_type == COMPONENT_BYTE ||
+					index_view.component_type == COMPONENT_SHORT || index_view.component_type == COMPONENT_FLOAT) {
+					throw std::runtime_error("glTF indices have to be unsigned integer scalars");
+				}
+				indices.resize(base_index + index_view.count);
+				for (uint32_t i = 0; i < index_view.count; i++) {
+					const uint32_t index = index_view.readIndex(i);
+					if (index >= positions.count) {
+						throw std::runtime_error("glTF index points outside of its primitive");
+					}
+					indices[base_index + i] = base_vertex + index;
+				}
+			} else {
+				indices.resize(base_index + positions.count);
+				for (uint32_t i = 0; i < positions.count; i++) {
+					indices[base_index + i] = base_vertex + i;
+				}
+			}
+
+			if ((indices.size() - base_index) % 3 != 0) {
+				throw std::runtime_error("glTF triangle list has an index count that is not a multiple of 3");
+			}
+			// a mirroring transform flips the winding order
+			if (mirrored) {
+				for (size_t i = base_index; i < indices.size(); i += 3) {
+					std::swap(indices[i + 1], indices[i + 2]);
+				}
+			}
+
+			if (!normals) {
+				for (size_t i = base_index; i < indices.size(); i += 3) {
+					Vertex &a = vertices[indices[i]];
+					Vertex &b = vertices[indices[i + 1]];
+					Vertex &c = vertices[indices[i + 2]];
+					const glm::vec3 face_normal = glm::cross(b.pos - a.pos, c.pos - a.pos); // area weighted
+					a.normal += face_normal;
+					b.normal += face_normal;
+					c.normal += face_normal;
+				}
+				for (size_t i = base_vertex; i < vertices.size(); i++) {
+					if (glm::length(vertices[i].normal) > 0.0f) {
+						vertices[i].normal = glm::normalize(vertices[i].normal);
+					}
+				}
+			}
+		}
+
+		// unnamed materials are numbered, submeshes reference their material by this name
+		std::string getMaterialName(const YAML::Node &json, const uint32_t material_idx) {
+			const YAML::Node material = getElement(json, "materials", material_idx);
+			return material["name"] ? material["name"].as<std::string>() : "material_" + std::to_string(material_idx);
+		}
+
+		// resource relative path of the image behind a texture info, empty if there is none or it is embedded
+		std::string getTexturePath(const YAML::Node &json, const std::string &directory,
+								   const YAML::Node &texture_info) {
+			if (!texture_info || !texture_info["index"]) {
+				return "";
+			}
+			if (texture_info["texCoord"] && texture_info["texCoord"].as<uint32_t>() != 0) {
+				spdlog::warn("glTF texture {} uses a second uv set, only TEXCOORD_0 is loaded",
+							 texture_info["index"].as<uint32_t>());
+			}
+
+			const YAML::Node texture = getElement(json, "textures", texture_info["index"].as<uint32_t>());
+			if (!texture["source"]) {
+				return "";
+			}
+			const YAML::Node image = getElement(json, "images", texture["source"].as<uint32_t>());
+			if (!image["uri"] || image["uri"].as<std::string>().starts_with("data:")) {
+				spdlog::warn("Embedded glTF image {} is not supported and skipped", texture["source"].as<uint32_t>());
+				return "";
+			}
+			return joinPath(directory, decodeUri(image["uri"].as<std::string>()));
+		}
+	} // namespace
+
+	bool GltfModelLoader::isGltfFile(const std::string &path) {
+		const std::string extension = PathUtil::getExtension(path);
+		return extension == "gltf" || extension == "glb";
+	}
+
+	void GltfModelLoader::loadData(std::string path, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+								   std::vector<Submesh> &submeshes) {
+		const GltfDocument document = loadDocument(path, true);
+		const YAML::Node &json = document.json;
+		const std::vector<std::pair<uint32_t, glm::mat4>> mesh_instances = collectMeshInstances(json);
+
+		// a first pass over the accessor headers sizes the output so that it is filled without reallocation
+		auto get_count = [&](const YAML::Node &accessor_idx) {
+			return getElement(json, "accessors", accessor_idx.as<uint32_t>())["count"].as<size_t>();
+		};
+		size_t vertex_count = 0, index_count = 0;
+		for (const auto &[mesh_idx, transform]: mesh_instances) {
+			for (const auto &primitive: getElement(json, "meshes", mesh_idx)["primitives"]) {
+				if (primitive["attributes"] && primitive["attributes"]["POSITION"]) {
+					const size_t position_count = get_count(primitive["attributes"]["POSITION"]);
+					vertex_count += position_count;
+					index_count += primitive["indices"] ? get_count(primitive["indices"]) : position_count;
+				}
+			}
+		}
+		vertices.reserve(vertices.size() + vertex_count);
+		indices.reserve(indices.size() + index_count);
+
+		// every primitive keeps its material as its own submesh
+		for (const auto &[mesh_idx, transform]: mesh_instances) {
+			for (const auto &primitive: getElement(json, "meshes", mesh_idx)["primitives"]) {
+				Submesh submesh{};
+				submesh.index_offset = static_cast<uint32_t>(indices.size());
+				appendPrimitive(document, primitive, transform, vertices, indices);
+				submesh.index_count = static_cast<uint32_t>(indices.size()) - submesh.index_offset;
+				if (submesh.index_count == 0) {
+					continue;
+				}
+
+				if (primitive["material"]) {
+					submesh.material_name = getMaterialName(json, primitive["material"].as<uint32_t>());
+				}
+				submeshes.push_back(submesh);
+			}
+		}
+
+		if (vertices.empty()) {
+			throw std::runtime_error(path + " contains no triangle geometry");
+		}
+	}
+
+	std::vector<YAML::Node> GltfModelLoader::loadMaterials(const std::string &resources_path,
+														   const std::string &path) {
+		const GltfDocument document = loadDocument(resources_path + "/" + path, false);
+		const YAML::Node &json = document.json;
+		const std::string directory = PathUtil::getDirectory(path);
+		const std::string prefix = PathUtil::getFileName(path);
+
+		std::vector<YAML::Node> material_nodes;
+		uint32_t material_idx = 0;
+		for (const auto &material: json["materials"]) {
+			const std::string material_name = getMaterialName(json, material_idx++);
+
+			YAML::Node out(YAML::NodeType::Map);
+			out["name"] = prefix + "/" + material_name;
+
+			// textures replace the factors instead of being multiplied with them
+			const YAML::Node pbr = getChildOrEmpty(material, "pbrMetallicRoughness");
+			const glm::vec4 base_color = pbr["baseColorFactor"] ? pbr["baseColorFactor"].as<glm::vec4>() : glm::vec4(1.0f);
+			const std::string albedo_tex = getTexturePath(json, directory, pbr["baseColorTexture"]);
+			if (!albedo_tex.empty()) {
+				out["albedo_tex"] = albedo_tex;
+				if (base_color != glm::vec4(1.0f)) {
+					spdlog::warn("Base color factor of glTF material {} is ignored, it has a texture", material_name);
+				}
+			} else {
+				out["albedo"] = YAML::convert<glm::vec3>::encode(glm::vec3(base_color));
+			}
+
+			const std::string metal_rough_tex = getTexturePath(json, directory, pbr["metallicRoughnessTexture"]);
+			if (!metal_rough_tex.empty()) {
+				// gltf stores roughness in green and metalness in blue
+				out["metal_rough_ao_tex"] = metal_rough_tex;
+				out["metal_rough_layout"] = "gltf";
+			} else {
+				out["metallic"] = pbr["metallicFactor"] ? pbr["metallicFactor"].as<float>() : 1.0f;
+				out["roughness"] = pbr["roughnessFactor"] ? pbr["roughnessFactor"].as<float>() : 1.0f;
+				out["ao"] = 0.0f;
+			}
+
+			const std::string normal_tex = getTexturePath(json, directory, material["normalTexture"]);
+			if (!normal_tex.empty()) {
+				out["normal_tex"] = normal_tex;
+			}
+
+			const YAML::Node extensions = getChildOrEmpty(material, "extensions");
+			const YAML::Node ior = getChildOrEmpty(extensions, "KHR_materials_ior");
+			if (ior["ior"]) {
+				out["eta"] = ior["ior"].as<float>();
+			}
+
+			const glm::vec3 emissive =
+					material["emissiveFactor"] ? material["emissiveFactor"].as<glm::vec3>() : glm::vec3(0.0f);
+			const YAML::Node emissive_strength = getChildOrEmpty(extensions, "KHR_materials_emissive_strength");
+			const float strength =
+					emissive_strength["emissiveStrength"] ? emissive_strength["emissiveStrength"].as<float>() : 1.0f;
+			const float max_emission = std::max(emissive.x, std::max(emissive.y, emissive.z));
+			if (max_emission > 0.0f) {
+				out["emission_color"] = YAML::convert<glm::vec3>::encode(emissive / max_emission);
+				out["emission_power"] = max_emission * strength;
+			}
+			if (material["emissiveTexture"]) {
+				spdlog::warn("Emissive texture of glTF material {} is not supported", material_name);
+			}
+
+			material_nodes.push_back(out);
+		}
+		return material_nodes;
+	}
+} // namespace RtEngine
@@ -0,0 +1,88 @@
+#include "Ktx2Reader.hpp"
+
+#include <TextureCompressor.hpp>
+#include <array>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+															 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+		struct Ktx2Header {
+			std::array<uint8_t, 12> identifier;
+			uint32_t vk_format;
+			uint32_t type_size;
+			uint32_t pixel_width, pixel_height, pixel_depth;
+			uint32_t layer_count, face_count, level_count;
+			uint32_t supercompression_scheme;
+			uint32_t dfd_byte_offset, dfd_byte_length;
+			uint32_t kvd_byte_offset, kvd_byte_length;
+			uint64_t sgd_byte_offset, sgd_byte_length;
+		};
+		static_assert(sizeof(Ktx2Header) == 80);
+
+		struct Ktx2LevelIndex {
+			uint64_t byte_offset;
+			uint64_t byte_length;
+			uint64_t uncompressed_byte_length;
+		};
+	} // namespace
+
+	ImageData Ktx2Reader::read(const std::string &path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open KTX2 file " + path + "!");
+		}
+
+		Ktx2Header header{};
+		file.read(reinterpret_cast<char *>(&header), sizeof(Ktx2Header));
+		if (!file || header.identifier != KTX2_IDENTIFIER) {
+			throw std::runtime_error(path + " is not a KTX2 file!");
+		}
+		if (header.vk_format == VK_FORMAT_UNDEFINED || header.supercompression_scheme != 0) {
+			throw std::runtime_error(path + " uses supercompression or Basis Universal, which is not supported!");
+		}
+		if (header.pixel_height == 0 || header.pixel_depth > 1 || header.layer_count > 1 || header.face_count != 1) {
+			throw std::runtime_error(path + " is not a plain 2D texture!");
+		}
+
+		ImageData image_data{};
+		image_data.extent = {header.pixel_width, header.pixel_height, 1};
+		image_data.format = static_cast<VkFormat>(header.vk_format);
+		// a level count of 0 asks the loader to generate mips, we just upload the base level then
+		image_data.mip_levels = std::max(1u, header.level_count);
+
+		std::vector<Ktx2LevelIndex> levels(image_data.mip_levels);
+		file.read(reinterpret_cast<char *>(levels.data()), levels.size() * sizeof(Ktx2LevelIndex));
+		if (!file) {
+			throw std::runtime_error(path + " has a truncated level index!");
+		}
+
+		// the level index starts at the base level, the data itself is stored smallest level first
+		VkDeviceSize total_size = 0;
+		for (uint32_t level = 0; level < image_data.mip_levels; level++) {
+			const VkExtent3D extent = TextureCompressor::getMipLevelExtent(image_data.extent, level);
+			if (levels[level].byte_length != ResourceBuilder::getImageSize(extent, image_data.format)) {
+				throw std::runtime_error(path + " has an unexpected size for mip level " + std::to_string(level) + "!");
+			}
+			total_size += levels[level].byte_length;
+		}
+
+		image_data.pixels.resize(total_size);
+		VkDeviceSize offset = 0;
+		for (const Ktx2LevelIndex &level: levels) {
+			file.seekg(static_cast<std::streamoff>(level.byte_offset));
+			file.read(reinterpret_cast<char *>(image_data.pixels.data() + offset), level.byte_length);
+			if (!file) {
+				throw std::runtime_error(path + " has truncated level data!");
+			}
+			offset += level.byte_length;
+		}
+
+		spdlog::debug("Read KTX2 texture {} ({}x{}, {} levels, format {})", path, header.pixel_width,
+					  header.pixel_height, image_data.mip_levels, header.vk_format);
+		return image_data;
+	}
+} // namespace RtEngine
@@ -2,14 +2,20 @@
 #include <iostream>
 #include <stdexcept>
 
-#include <AssimpModelLoader.hpp>
+#include <GltfModelLoader.hpp>
 #include <ModelLoader.hpp>
 #include <cstring>
 
 namespace RtEngine {
 	MeshAsset MeshAssetBuilder::loadMeshAsset(std::string path) {
-		AssimpModelLoader loader;
-		return loader.loadMeshAsset(resource_path, path);
+		return ModelLoader::createLoader(path)->loadMeshAsset(resource_path, path);
+	}
+
+	std::vector<YAML::Node> MeshAssetBuilder::loadMaterials(const std::string &path) {
+		if (!GltfModelLoader::isGltfFile(path)) {
+			return {};
+		}
+		return GltfModelLoader::loadMaterials(resource_path, path);
 	}
 
 	void MeshAssetBuilder::destroyMeshAsset(MeshAsset &meshAsset) {
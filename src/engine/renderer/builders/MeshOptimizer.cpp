@@ -0,0 +1,249 @@
+#include "MeshOptimizer.hpp"
+
+#include <QuickTimer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+
+namespace RtEngine {
+	namespace {
+		// parameters of Forsyth's linear-speed vertex cache optimisation
+		constexpr uint32_t CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		float vertexScore(int32_t cache_position, uint32_t remaining_valence) {
+			if (remaining_valence == 0) {
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cache_position >= 0) {
+				if (cache_position < 3) {
+					score = LAST_TRIANGLE_SCORE;
+				} else {
+					const float scaler = 1.0f / (CACHE_SIZE - 3);
+					score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+			return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining_valence), -VALENCE_BOOST_POWER);
+		}
+	} // namespace
+
+	void MeshOptimizer::optimize(MeshBuffers &mesh_buffers, const std::string &name) {
+		QuickTimer timer("Optimizing mesh");
+
+		const size_t vertices_before = mesh_buffers.vertices.size();
+		const float acmr_before = computeAcmr(mesh_buffers.indices, mesh_buffers.vertices.size());
+
+		weldVertices(mesh_buffers.vertices, mesh_buffers.indices);
+		optimizeVertexCache(mesh_buffers.indices, mesh_buffers.submeshes, mesh_buffers.vertices.size());
+		optimizeVertexFetch(mesh_buffers.vertices, mesh_buffers.indices);
+
+		const size_t vertices_after = mesh_buffers.vertices.size();
+		const float acmr_after = computeAcmr(mesh_buffers.indices, mesh_buffers.vertices.size());
+		spdlog::info("Optimized mesh {}: {} -> {} vertices ({:.2f} -> {:.2f} MB), ACMR {:.3f} -> {:.3f}", name,
+					 vertices_before, vertices_after, vertices_before * sizeof(Vertex) / 1e6f,
+					 vertices_after * sizeof(Vertex) / 1e6f, acmr_before, acmr_after);
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices, const std::vector<Submesh> &submeshes,
+											uint32_t vertex_count) {
+		if (submeshes.size() <= 1) {
+			indices = optimizeVertexCache(indices, vertex_count);
+			return;
+		}
+
+		// triangles must not move between submeshes, every submesh is reordered on its own with local vertex ids
+		// so the per vertex state of the optimizer only spans the vertices the submesh uses
+		std::vector<uint32_t> local_ids(vertex_count, UINT32_MAX);
+		std::vector<uint32_t> global_ids;
+		for (const Submesh &submesh: submeshes) {
+			const auto begin = indices.begin() + submesh.index_offset;
+			std::vector<uint32_t> local_indices(begin, begin + submesh.index_count);
+			global_ids.clear();
+			for (uint32_t &index: local_indices) {
+				if (local_ids[index] == UINT32_MAX) {
+					local_ids[index] = global_ids.size();
+					global_ids.push_back(index);
+				}
+				index = local_ids[index];
+			}
+
+			local_indices = optimizeVertexCache(local_indices, global_ids.size());
+			for (uint32_t i = 0; i < submesh.index_count; i++) {
+				begin[i] = global_ids[local_indices[i]];
+			}
+			for (uint32_t global_id: global_ids) {
+				local_ids[global_id] = UINT32_MAX;
+			}
+		}
+	}
+
+	void MeshOptimizer::weldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) {
+		std::unordered_map<Vertex, uint32_t> unique_vertices;
+		unique_vertices.reserve(vertices.size());
+
+		std::vector<uint32_t> remap(vertices.size());
+		std::vector<Vertex> welded_vertices;
+		welded_vertices.reserve(vertices.size());
+		for (uint32_t i = 0; i < vertices.size(); i++) {
+			auto [it, inserted] = unique_vertices.try_emplace(vertices[i], welded_vertices.size());
+			if (inserted) {
+				welded_vertices.push_back(vertices[i]);
+			}
+			remap[i] = it->second;
+		}
+
+		for (uint32_t &index: indices) {
+			index = remap[index];
+		}
+		vertices = std::move(welded_vertices);
+	}
+
+	std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(const std::vector<uint32_t> &indices,
+															 uint32_t vertex_count) {
+		const uint32_t triangle_count = indices.size() / 3;
+
+		// remaining valence and triangle adjacency per vertex, emitted triangles are swapped out of the live range
+		std::vector<uint32_t> valence(vertex_count, 0);
+		for (uint32_t index: indices) {
+			valence[index]++;
+		}
+		std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+		for (uint32_t v = 0; v < vertex_count; v++) {
+			adjacency_offsets[v + 1] = adjacency_offsets[v] + valence[v];
+		}
+		std::vector<uint32_t> adjacency(indices.size());
+		std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (uint32_t t = 0; t < triangle_count; t++) {
+			for (uint32_t k = 0; k < 3; k++) {
+				adjacency[fill_offsets[indices[3 * t + k]]++] = t;
+			}
+		}
+
+		std::vector<int32_t> cache_positions(vertex_count, -1);
+		std::vector<float> vertex_scores(vertex_count);
+		for (uint32_t v = 0; v < vertex_count; v++) {
+			vertex_scores[v] = vertexScore(-1, valence[v]);
+		}
+		std::vector<float> triangle_scores(triangle_count);
+		for (uint32_t t = 0; t < triangle_count; t++) {
+			triangle_scores[t] = vertex_scores[indices[3 * t]] + vertex_scores[indices[3 * t + 1]] +
+								 vertex_scores[indices[3 * t + 2]];
+		}
+
+		std::vector<bool> emitted(triangle_count, false);
+		std::vector<uint32_t> cache, new_cache;
+		std::vector<uint32_t> result;
+		result.reserve(triangle_count * 3);
+
+		uint32_t next_unemitted = 0;
+		int64_t best_triangle = -1;
+		while (result.size() < triangle_count * 3) {
+			if (best_triangle < 0) {
+				// nothing adjacent to the cache is left, continue with the next triangle in input order
+				while (emitted[next_unemitted]) {
+					next_unemitted++;
+				}
+				best_triangle = next_unemitted;
+			}
+
+			const uint32_t triangle = best_triangle;
+			emitted[triangle] = true;
+
+			new_cache.clear();
+			for (uint32_t k = 0; k < 3; k++) {
+				const uint32_t v = indices[3 * triangle + k];
+				result.push_back(v);
+
+				const uint32_t begin = adjacency_offsets[v];
+				const uint32_t end = begin + valence[v];
+				for (uint32_t a = begin; a < end; a++) {
+					if (adjacency[a] == triangle) {
+						std::swap(adjacency[a], adjacency[end - 1]);
+						break;
+					}
+				}
+				valence[v]--;
+
+				if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end()) {
+					new_cache.push_back(v);
+				}
+			}
+			const size_t triangle_vertices = new_cache.size();
+			for (uint32_t v: cache) {
+				if (std::find(new_cache.begin(), new_cache.begin() + triangle_vertices, v) ==
+					new_cache.begin() + triangle_vertices) {
+					new_cache.push_back(v);
+				}
+			}
+
+			// vertices pushed out of the cache are still rescored, then dropped
+			for (uint32_t i = 0; i < new_cache.size(); i++) {
+				cache_positions[new_cache[i]] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+			}
+			for (uint32_t v: new_cache) {
+				const float score = vertexScore(cache_positions[v], valence[v]);
+				const float delta = score - vertex_scores[v];
+				vertex_scores[v] = score;
+				for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v] + valence[v]; a++) {
+					triangle_scores[adjacency[a]] += delta;
+				}
+			}
+			if (new_cache.size() > CACHE_SIZE) {
+				new_cache.resize(CACHE_SIZE);
+			}
+
+			best_triangle = -1;
+			float best_score = -1.0f;
+			for (uint32_t v: new_cache) {
+				for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v] + valence[v]; a++) {
+					if (triangle_scores[adjacency[a]] > best_score) {
+						best_score = triangle_scores[adjacency[a]];
+						best_triangle = adjacency[a];
+					}
+				}
+			}
+			std::swap(cache, new_cache);
+		}
+
+		return result;
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices) {
+		// vertices are stored in the order the triangles first reference them, unused ones are dropped
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<Vertex> reordered_vertices;
+		reordered_vertices.reserve(vertices.size());
+		for (uint32_t &index: indices) {
+			if (remap[index] == UINT32_MAX) {
+				remap[index] = reordered_vertices.size();
+				reordered_vertices.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+		vertices = std::move(reordered_vertices);
+	}
+
+	float MeshOptimizer::computeAcmr(const std::vector<uint32_t> &indices, uint32_t vertex_count,
+									 uint32_t cache_size) {
+		if (indices.empty()) {
+			return 0.0f;
+		}
+
+		std::vector<uint32_t> insertion_time(vertex_count, 0);
+		uint32_t time = cache_size + 1;
+		uint32_t misses = 0;
+		for (uint32_t index: indices) {
+			if (time - insertion_time[index] > cache_size) {
+				insertion_time[index] = time++;
+				misses++;
+			}
+		}
+		return static_cast<float>(misses) / (indices.size() / 3);
+	}
+} // namespace RtEngine
@@ -0,0 +1,350 @@
+#include "MeshSimplifier.hpp"
+
+#include <MeshOptimizer.hpp>
+#include <QuickTimer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t MAX_LOD_COUNT = 4;
+		constexpr float LOD_TRIANGLE_RATIO = 0.25f;
+		constexpr size_t MIN_LOD_TRIANGLES = 256;
+		// a level that keeps more than this share of the triangles is not worth another blas
+		constexpr float MIN_LOD_REDUCTION = 0.75f;
+		// relative to the bounding sphere radius, summed over all levels
+		constexpr float MAX_LOD_ERROR = 0.1f;
+		// collapses may turn a triangle by at most ~75 degrees
+		constexpr float MIN_NORMAL_COS = 0.25f;
+
+		// area weighted sum of the squared distances to the planes of the merged triangles
+		struct Quadric {
+			double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+			double b0 = 0, b1 = 0, b2 = 0, c = 0;
+			double weight = 0;
+
+			void addPlane(const glm::vec3 &normal, double d, double w) {
+				const double x = normal.x, y = normal.y, z = normal.z;
+				a00 += w * x * x;
+				a01 += w * x * y;
+				a02 += w * x * z;
+				a11 += w * y * y;
+				a12 += w * y * z;
+				a22 += w * z * z;
+				b0 += w * x * d;
+				b1 += w * y * d;
+				b2 += w * z * d;
+				c += w * d * d;
+				weight += w;
+			}
+
+			Quadric &operator+=(const Quadric &other) {
+				a00 += other.a00;
+				a01 += other.a01;
+				a02 += other.a02;
+				a11 += other.a11;
+				a12 += other.a12;
+				a22 += other.a22;
+				b0 += other.b0;
+				b1 += other.b1;
+				b2 += other.b2;
+				c += other.c;
+				weight += other.weight;
+				return *this;
+			}
+
+			// mean squared distance of p to the planes
+			double evaluate(const glm::vec3 &p) const {
+				const double x = p.x, y = p.y, z = p.z;
+				const double error = a00 * x * x + a11 * y * y + a22 * z * z +
+									 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+									 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+				return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+			}
+		};
+
+		struct Collapse {
+			uint32_t from;
+			uint32_t to;
+			float error; // squared
+		};
+
+		uint64_t edgeKey(uint32_t a, uint32_t b) {
+			return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+		}
+
+		glm::vec3 triangleNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+			return glm::cross(b - a, c - a);
+		}
+	} // namespace
+
+	void MeshSimplifier::generateLods(MeshBuffers &mesh_buffers, const std::string &name) {
+		mesh_buffers.lods.clear();
+		if (mesh_buffers.indices.size() / 3 < MIN_LOD_TRIANGLES / LOD_TRIANGLE_RATIO) {
+			return;
+		}
+
+		QuickTimer timer("Generating mesh lods");
+		const auto start = std::chrono::high_resolution_clock::now();
+		const float radius = computeBoundingSphere(mesh_buffers.vertices).radius;
+
+		float error = 0.0f;
+		while (mesh_buffers.lods.size() < MAX_LOD_COUNT && error < MAX_LOD_ERROR) {
+			// every level is simplified from the previous one, so the errors add up
+			const std::vector<uint32_t> &source =
+					mesh_buffers.lods.empty() ? mesh_buffers.indices : mesh_buffers.lods.back().indices;
+			std::vector<Submesh> submeshes =
+					mesh_buffers.lods.empty() ? mesh_buffers.submeshes : mesh_buffers.lods.back().submeshes;
+			const size_t target_index_count =
+					std::max(static_cast<size_t>(source.size() / 3 * LOD_TRIANGLE_RATIO), MIN_LOD_TRIANGLES) * 3;
+
+			float lod_error = 0.0f;
+			std::vector<uint32_t> lod_indices = simplify(mesh_buffers.vertices, source, submeshes, target_index_count,
+														 (MAX_LOD_ERROR - error) * radius, lod_error);
+			if (lod_indices.size() > source.size() * MIN_LOD_REDUCTION) {
+				break;
+			}
+
+			error += radius > 0.0f ? lod_error / radius : 0.0f;
+			MeshOptimizer::optimizeVertexCache(lod_indices, submeshes, mesh_buffers.vertices.size());
+			mesh_buffers.lods.push_back(LodBuffers{std::move(lod_indices), std::move(submeshes), error});
+			if (mesh_buffers.lods.back().indices.size() / 3 <= MIN_LOD_TRIANGLES) {
+				break;
+			}
+		}
+
+		if (mesh_buffers.lods.empty()) {
+			spdlog::debug("Mesh {} does not simplify well enough for lods", name);
+			return;
+		}
+
+		std::string triangle_counts = std::to_string(mesh_buffers.indices.size() / 3);
+		for (const auto &lod: mesh_buffers.lods) {
+			triangle_counts += std::format(" -> {} ({:.2f}%)", lod.indices.size() / 3, lod.error * 100.0f);
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		spdlog::info("Generated {} lods for mesh {} in {:.2f} ms, triangles (error): {}", mesh_buffers.lods.size(),
+					 name, seconds * 1000.0, triangle_counts);
+	}
+
+	std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<Vertex> &vertices,
+												   const std::vector<uint32_t> &indices,
+												   std::vector<Submesh> &submeshes, size_t target_index_count,
+												   float max_error, float &result_error) {
+		const auto vertex_count = static_cast<uint32_t>(vertices.size());
+		std::vector<uint32_t> result = indices;
+		double max_collapse_error = 0.0;
+
+		// collapses only remove triangles, so tracking the submesh of every triangle keeps them grouped
+		std::vector<uint32_t> triangle_submeshes(result.size() / 3, 0);
+		for (uint32_t s = 0; s < submeshes.size(); s++) {
+			std::fill_n(triangle_submeshes.begin() + submeshes[s].index_offset / 3, submeshes[s].index_count / 3, s);
+		}
+
+		// an edge that does not have exactly two triangles is a border, a seam between attribute splits or non
+		// manifold, its vertices are locked
+		std::vector<uint8_t> locked(vertex_count, 0);
+		std::vector<uint64_t> edges(result.size());
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (uint32_t e = 0; e < 3; e++) {
+				edges[i + e] = edgeKey(result[i + e], result[i + (e + 1) % 3]);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		for (size_t i = 0; i < edges.size();) {
+			size_t j = i + 1;
+			while (j < edges.size() && edges[j] == edges[i]) {
+				j++;
+			}
+			if (j - i != 2) {
+				locked[edges[i] >> 32] = 1;
+				locked[edges[i] & UINT32_MAX] = 1;
+			}
+			i = j;
+		}
+
+		// welding joins the outlines of neighbouring submeshes, they have to stay in place like open borders
+		std::vector<uint32_t> vertex_submeshes(vertex_count, UINT32_MAX);
+		for (size_t i = 0; i < result.size(); i++) {
+			uint32_t &owner = vertex_submeshes[result[i]];
+			if (owner == UINT32_MAX) {
+				owner = triangle_submeshes[i / 3];
+			} else if (owner != triangle_submeshes[i / 3]) {
+				locked[result[i]] = 1;
+			}
+		}
+
+		std::vector<Quadric> quadrics(vertex_count);
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const glm::vec3 &p0 = vertices[result[i]].pos;
+			const glm::vec3 normal = triangleNormal(p0, vertices[result[i + 1]].pos, vertices[result[i + 2]].pos);
+			const float double_area = glm::length(normal);
+			if (double_area <= 0.0f) {
+				continue;
+			}
+			const glm::vec3 unit_normal = normal / double_area;
+			const double d = -glm::dot(unit_normal, p0);
+			for (uint32_t c = 0; c < 3; c++) {
+				quadrics[result[i + c]].addPlane(unit_normal, d, 0.5 * double_area);
+			}
+		}
+
+		const double max_error_sq = static_cast<double>(max_error) * max_error;
+		std::vector<uint32_t> adjacency_offsets(vertex_count + 1), adjacency;
+		std::vector<uint32_t> remap(vertex_count);
+		std::vector<uint8_t> touched(vertex_count);
+		std::vector<Collapse> collapses;
+
+		// every pass collapses an independent set of edges, cheapest first
+		while (result.size() > target_index_count) {
+			const size_t triangle_count = result.size() / 3;
+
+			// vertex -> triangle adjacency of the current index buffer
+			std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+			for (uint32_t index: result) {
+				adjacency_offsets[index + 1]++;
+			}
+			std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+			adjacency.resize(result.size());
+			std::vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++) {
+				adjacency[cursor[result[i]]++] = i / 3;
+			}
+
+			edges.resize(result.size());
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (uint32_t e = 0; e < 3; e++) {
+					edges[i + e] = edgeKey(result[i + e], result[i + (e + 1) % 3]);
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+			// half edge collapses, the removed vertex moves onto the one that stays
+			collapses.resize(edges.size());
+#pragma omp parallel for
+			for (int64_t i = 0; i < static_cast<int64_t>(edges.size()); i++) {
+				const auto a = static_cast<uint32_t>(edges[i] >> 32);
+				const auto b = static_cast<uint32_t>(edges[i] & UINT32_MAX);
+				Quadric quadric = quadrics[a];
+				quadric += quadrics[b];
+
+				constexpr float locked_error = std::numeric_limits<float>::infinity();
+				const float a_to_b = locked[a] ? locked_error : static_cast<float>(quadric.evaluate(vertices[b].pos));
+				const float b_to_a = locked[b] ? locked_error : static_cast<float>(quadric.evaluate(vertices[a].pos));
+				collapses[i] = a_to_b <= b_to_a ? Collapse{a, b, a_to_b} : Collapse{b, a, b_to_a};
+			}
+			std::erase_if(collapses, [&](const Collapse &collapse) { return collapse.error > max_error_sq; });
+			std::sort(collapses.begin(), collapses.end(),
+					  [](const Collapse &a, const Collapse &b) { return a.error < b.error; });
+
+			std::iota(remap.begin(), remap.end(), 0);
+			std::fill(touched.begin(), touched.end(), 0);
+			size_t remaining_triangles = triangle_count;
+			size_t collapse_count = 0;
+			for (const Collapse &collapse: collapses) {
+				if (remaining_triangles * 3 <= target_index_count) {
+					break;
+				}
+				if (touched[collapse.from] || touched[collapse.to]) {
+					continue;
+				}
+
+				// reject collapses that flip or fold a triangle that survives
+				bool flips = false;
+				size_t removed_triangles = 0;
+				for (uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1]; a++) {
+					const uint32_t *triangle = &result[3 * adjacency[a]];
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+						removed_triangles++;
+						continue;
+					}
+
+					glm::vec3 p[3], moved[3];
+					for (uint32_t c = 0; c < 3; c++) {
+						p[c] = vertices[triangle[c]].pos;
+						moved[c] = triangle[c] == collapse.from ? vertices[collapse.to].pos : p[c];
+					}
+					const glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+					const glm::vec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+					const float length_before = glm::length(before);
+					if (length_before > 0.0f &&
+						glm::dot(before, after) <= MIN_NORMAL_COS * length_before * glm::length(after)) {
+						flips = true;
+						break;
+					}
+				}
+				if (flips) {
+					continue;
+				}
+
+				// the one ring of the removed vertex is frozen, so all accepted collapses stay independent
+				for (uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1]; a++) {
+					const uint32_t *triangle = &result[3 * adjacency[a]];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				max_collapse_error = std::max(max_collapse_error, static_cast<double>(collapse.error));
+				remaining_triangles -= removed_triangles;
+				collapse_count++;
+			}
+
+			if (collapse_count == 0) {
+				break;
+			}
+
+			size_t write = 0;
+			for (size_t i = 0; i < result.size(); i += 3) {
+				const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+				if (a != b && b != c && a != c) {
+					triangle_submeshes[write / 3] = triangle_submeshes[i / 3];
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+			}
+			result.resize(write);
+			triangle_submeshes.resize(write / 3);
+		}
+
+		for (Submesh &submesh: submeshes) {
+			submesh.index_count = 0;
+		}
+		for (uint32_t submesh: triangle_submeshes) {
+			submeshes[submesh].index_count += 3;
+		}
+		uint32_t index_offset = 0;
+		for (Submesh &submesh: submeshes) {
+			submesh.index_offset = index_offset;
+			index_offset += submesh.index_count;
+		}
+
+		result_error = static_cast<float>(std::sqrt(max_collapse_error));
+		return result;
+	}
+
+	BoundingSphere MeshSimplifier::computeBoundingSphere(const std::vector<Vertex> &vertices) {
+		if (vertices.empty()) {
+			return {};
+		}
+
+		glm::vec3 min = vertices[0].pos, max = vertices[0].pos;
+		for (const auto &vertex: vertices) {
+			min = glm::min(min, vertex.pos);
+			max = glm::max(max, vertex.pos);
+		}
+
+		BoundingSphere sphere{(min + max) * 0.5f, 0.0f};
+		for (const auto &vertex: vertices) {
+			sphere.radius = std::max(sphere.radius, glm::length(vertex.pos - sphere.center));
+		}
+		return sphere;
+	}
+} // namespace RtEngine
@@ -1,22 +1,65 @@
 #include "ModelLoader.hpp"
 
+#include <AssimpModelLoader.hpp>
+#include <GltfModelLoader.hpp>
+#include <MeshOptimizer.hpp>
+#include <MeshSimplifier.hpp>
 #include <PathUtil.hpp>
+#include <TangentGenerator.hpp>
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
 namespace RtEngine {
 	MeshAsset ModelLoader::loadMeshAsset(std::string resources_path, std::string path) {
+		return createMeshAsset(path, loadMeshBuffers(resources_path, path));
+	}
+
+	MeshBuffers ModelLoader::loadMeshBuffers(const std::string &resources_path, const std::string &path) {
 		MeshBuffers meshBuffers{};
 
 		std::string full_path = resources_path + "/" + path;
-		loadData(full_path, meshBuffers.vertices, meshBuffers.indices);
+		loadData(full_path, meshBuffers.vertices, meshBuffers.indices, meshBuffers.submeshes);
+		if (meshBuffers.submeshes.empty()) {
+			meshBuffers.submeshes.push_back(Submesh{0, static_cast<uint32_t>(meshBuffers.indices.size()), ""});
+		}
+		// before welding, vertices split by the generator must not be merged again
+		if (!std::all_of(meshBuffers.vertices.begin(), meshBuffers.vertices.end(), TangentGenerator::hasTangent)) {
+			TangentGenerator::generateMissing(meshBuffers.vertices, meshBuffers.indices, path);
+		}
+		MeshOptimizer::optimize(meshBuffers, path);
+		MeshSimplifier::generateLods(meshBuffers, path);
+		return meshBuffers;
+	}
+
+	std::shared_ptr<ModelLoader> ModelLoader::createLoader(const std::string &path) {
+		if (GltfModelLoader::isGltfFile(path)) {
+			return std::make_shared<GltfModelLoader>();
+		}
+		return std::make_shared<AssimpModelLoader>();
+	}
+
+	MeshAsset ModelLoader::createMeshAsset(const std::string &path, MeshBuffers meshBuffers) {
+		// loaders and asset packs without submeshes describe a single one
+		if (meshBuffers.submeshes.empty()) {
+			meshBuffers.submeshes.push_back(Submesh{0, static_cast<uint32_t>(meshBuffers.indices.size()), ""});
+		}
+		for (auto &lod: meshBuffers.lods) {
+			if (lod.submeshes.empty()) {
+				lod.submeshes.push_back(Submesh{0, static_cast<uint32_t>(lod.indices.size()), ""});
+			}
+		}
 
 		MeshAsset meshAsset{};
 		meshAsset.name = PathUtil::getFileName(path);
 		meshAsset.path = path;
-		meshAsset.meshBuffers = meshBuffers;
-		meshAsset.vertex_count = meshBuffers.indices.size();
+		meshAsset.vertex_count = meshBuffers.vertices.size();
 		meshAsset.triangle_count = meshBuffers.indices.size() / 3;
+		meshAsset.bounds = MeshSimplifier::computeBoundingSphere(meshBuffers.vertices);
+		for (const auto &vertex: meshBuffers.vertices) {
+			meshAsset.bounding_box.grow(vertex.pos);
+		}
+		meshAsset.meshBuffers = std::move(meshBuffers);
 
 		meshAsset.instance_data = {};
 		return meshAsset;
@@ -1,7 +1,10 @@
 #include "ResourceBuilder.hpp"
+#include <algorithm>
 #include <stdexcept>
 
+#include <cassert>
 #include <cstring>
+#include <numeric>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -13,6 +16,8 @@
 #include <spdlog/spdlog.h>
 
 #include "QuickTimer.hpp"
+#include "Ktx2Reader.hpp"
+#include "TextureCompressor.hpp"
 
 namespace RtEngine {
 	VkDeviceAddress GetBufferDeviceAddressKHR(VkDevice device, const VkBufferDeviceAddressInfoKHR *address_info) {
@@ -58,6 +63,7 @@ namespace RtEngine {
 		if (vkAllocateMemory(device, &allocInfo, nullptr, &allocatedBuffer.bufferMemory) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate vertex buffer memory!");
 		}
+		trackAllocation(allocatedBuffer.bufferMemory, memRequirements.size);
 
 		vkBindBufferMemory(device, allocatedBuffer.handle, allocatedBuffer.bufferMemory, 0);
 
@@ -89,6 +95,27 @@ namespace RtEngine {
 		return mapping_buffer;
 	}
 
+	void ResourceBuilder::stageMemoryToBuffer(void *data, size_t size, AllocatedBuffer dst, VkDeviceSize dst_offset) {
+		assert(dst_offset + size <= dst.size);
+		// empty meshes and lods have nothing to copy, and a staging buffer of size 0 is invalid
+		if (size == 0) {
+			return;
+		}
+		VkDevice device = device_manager->getDevice();
+
+		AllocatedBuffer stagingBuffer =
+				createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		void *mapped_data;
+		vkMapMemory(device, stagingBuffer.bufferMemory, 0, size, 0, &mapped_data);
+		memcpy(mapped_data, data, size);
+		vkUnmapMemory(device, stagingBuffer.bufferMemory);
+
+		copyBuffer(stagingBuffer, dst, size, dst_offset);
+		destroyBuffer(stagingBuffer);
+	}
+
 	uint32_t ResourceBuilder::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
 		VkPhysicalDeviceMemoryProperties memProperies;
 		vkGetPhysicalDeviceMemoryProperties(device_manager->getPhysicalDevice(), &memProperies);
@@ -102,23 +129,39 @@ namespace RtEngine {
 		throw std::runtime_error("failed to find suitable memory type!");
 	}
 
-	void ResourceBuilder::copyBuffer(AllocatedBuffer src, AllocatedBuffer dst, VkDeviceSize size) {
+	void ResourceBuilder::copyBuffer(AllocatedBuffer src, AllocatedBuffer dst, VkDeviceSize size,
+									 VkDeviceSize dst_offset) {
 		VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
 
 		VkBufferCopy copyRegion{};
+		copyRegion.dstOffset = dst_offset;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, src.handle, dst.handle, 1, &copyRegion);
 
 		commandManager->endSingleTimeCommand(commandBuffer);
 	}
 
+	void ResourceBuilder::recordBufferUpdate(VkCommandBuffer command_buffer, VkBuffer dst, VkDeviceSize dst_offset,
+											 const void *data, VkDeviceSize size) {
+		assert(dst_offset % 4 == 0 && size % 4 == 0);
+		// vkCmdUpdateBuffer takes at most 64 KiB per call
+		constexpr VkDeviceSize MAX_UPDATE_SIZE = 65536;
+		const auto *bytes = static_cast<const uint8_t *>(data);
+		for (VkDeviceSize offset = 0; offset < size; offset += MAX_UPDATE_SIZE) {
+			vkCmdUpdateBuffer(command_buffer, dst, dst_offset + offset, std::min(MAX_UPDATE_SIZE, size - offset),
+							  bytes + offset);
+		}
+	}
+
 	void ResourceBuilder::destroyBuffer(AllocatedBuffer buffer) {
 		vkDestroyBuffer(device_manager->getDevice(), buffer.handle, nullptr);
 		vkFreeMemory(device_manager->getDevice(), buffer.bufferMemory, nullptr);
+		trackFree(buffer.bufferMemory);
 	}
 
 	AllocatedImage ResourceBuilder::createImage(VkExtent3D extent, VkFormat format, VkImageTiling tiling,
-												VkImageUsageFlags usage, VkImageAspectFlags aspectFlags) {
+												VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
+												uint32_t mip_levels) {
 		VkDevice device = device_manager->getDevice();
 
 		AllocatedImage image{};
@@ -129,7 +172,7 @@ namespace RtEngine {
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		imageInfo.imageType = VK_IMAGE_TYPE_2D;
 		imageInfo.extent = extent;
-		imageInfo.mipLevels = 1;
+		imageInfo.mipLevels = mip_levels;
 		imageInfo.arrayLayers = 1;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
@@ -153,10 +196,11 @@ namespace RtEngine {
 		if (vkAllocateMemory(device, &allocInfo, nullptr, &image.imageMemory) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate texture image memory!");
 		}
+		trackAllocation(image.imageMemory, memRequirements.size);
 
 		vkBindImageMemory(device, image.image, image.imageMemory, 0);
 
-		image.imageView = createImageView(image.image, format, aspectFlags);
+		image.imageView = createImageView(image.image, format, aspectFlags, mip_levels);
 
 		return image;
 	}
@@ -164,16 +208,7 @@ namespace RtEngine {
 	AllocatedImage ResourceBuilder::createImage(void *data, VkExtent3D extent, VkFormat format, VkImageTiling tiling,
 												VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
 												VkImageLayout target_layout) {
-		VkDeviceSize imageSize = extent.width * extent.height * extent.depth;
-		if (format == VK_FORMAT_R8G8B8_SRGB) {
-			imageSize *= 3;
-		} else if (format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM) {
-			imageSize *= 4;
-		} else if (format == VK_FORMAT_R32G32B32A32_UINT) {
-			imageSize *= 16;
-		} else {
-			throw std::invalid_argument("Image format not supported!");
-		}
+		VkDeviceSize imageSize = getImageSize(extent, format);
 
 		AllocatedBuffer stagingBuffer =
 				createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -200,12 +235,101 @@ namespace RtEngine {
 		return image;
 	}
 
+	std::vector<AllocatedImage> ResourceBuilder::createImages(const std::vector<ImageData> &images,
+															  VkImageTiling tiling, VkImageUsageFlags usage,
+															  VkImageAspectFlags aspectFlags) {
+		if (images.empty()) {
+			return {};
+		}
+
+		// all images share one staging buffer. every copied level starts at a multiple of both the texel or block
+		// size and 4 bytes, so the levels of an image are moved apart where its packed layout does not allow that
+		std::vector<std::vector<VkDeviceSize>> level_offsets(images.size());
+		VkDeviceSize total_size = 0;
+		for (uint32_t i = 0; i < images.size(); i++) {
+			const VkDeviceSize alignment = std::lcm(getImageSize(VkExtent3D{1, 1, 1}, images[i].format),
+													VkDeviceSize{4});
+			for (uint32_t level = 0; level < images[i].mip_levels; level++) {
+				total_size = (total_size + alignment - 1) / alignment * alignment;
+				level_offsets[i].push_back(total_size);
+				total_size += getImageSize(TextureCompressor::getMipLevelExtent(images[i].extent, level),
+										   images[i].format);
+			}
+		}
+
+		AllocatedBuffer stagingBuffer =
+				createBuffer(total_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		VkDevice device = device_manager->getDevice();
+		void *mapped_data;
+		vkMapMemory(device, stagingBuffer.bufferMemory, 0, total_size, 0, &mapped_data);
+		for (uint32_t i = 0; i < images.size(); i++) {
+			const std::span<const uint8_t> bytes = images[i].bytes();
+			VkDeviceSize src_offset = 0;
+			for (uint32_t level = 0; level < images[i].mip_levels; level++) {
+				const VkDeviceSize level_size =
+						getImageSize(TextureCompressor::getMipLevelExtent(images[i].extent, level), images[i].format);
+				if (src_offset + level_size > bytes.size()) {
+					vkUnmapMemory(device, stagingBuffer.bufferMemory);
+					destroyBuffer(stagingBuffer);
+					throw std::runtime_error("Image data is smaller than its mip chain!");
+				}
+				memcpy(static_cast<uint8_t *>(mapped_data) + level_offsets[i][level], bytes.data() + src_offset,
+					   level_size);
+				src_offset += level_size;
+			}
+		}
+		vkUnmapMemory(device, stagingBuffer.bufferMemory);
+
+		std::vector<AllocatedImage> allocated_images(images.size());
+		for (uint32_t i = 0; i < images.size(); i++) {
+			allocated_images[i] = createImage(images[i].extent, images[i].format, tiling,
+											  VK_IMAGE_USAGE_TRANSFER_DST_BIT | usage, aspectFlags, images[i].mip_levels);
+		}
+
+		// record every transition and copy into a single submission
+		VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+		for (uint32_t i = 0; i < images.size(); i++) {
+			transitionImageLayout(commandBuffer, allocated_images[i].image, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+								  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_NONE, VK_ACCESS_TRANSFER_WRITE_BIT,
+								  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, images[i].mip_levels);
+			for (uint32_t level = 0; level < images[i].mip_levels; level++) {
+				const VkExtent3D level_extent = TextureCompressor::getMipLevelExtent(images[i].extent, level);
+				copyBufferToImage(commandBuffer, stagingBuffer.handle, allocated_images[i].image, level_extent,
+								  level_offsets[i][level], level);
+			}
+			transitionImageLayout(commandBuffer, allocated_images[i].image, VK_PIPELINE_STAGE_TRANSFER_BIT,
+								  VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_TRANSFER_WRITE_BIT,
+								  VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+								  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, images[i].mip_levels);
+		}
+		commandManager->endSingleTimeCommand(commandBuffer);
+
+		destroyBuffer(stagingBuffer);
+		return allocated_images;
+	}
+
 	Texture ResourceBuilder::loadTextureImage(std::string path, TextureType type) {
+		ImageData image_data = decodeTextureImage(path, type);
+
+		AllocatedImage textureImage =
+				createImage(image_data.pixels.data(), image_data.extent, image_data.format, VK_IMAGE_TILING_OPTIMAL,
+							VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+		return Texture(PathUtil::getFileName(path), type, path, textureImage);
+	}
+
+	ImageData ResourceBuilder::decodeTextureImage(const std::string &path, TextureType type) {
+		return decodeTextureFile(resource_path + "/" + path, type);
+	}
+
+	ImageData ResourceBuilder::decodeTextureFile(const std::string &full_path, TextureType type) {
 		int texWidth, texHeight, texChannels;
-		uint8_t *pixels = loadImageData(resource_path + "/" + path, &texWidth, &texHeight, &texChannels);
+		uint8_t *pixels = stbi_load(full_path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
 		if (!pixels) {
-			throw std::runtime_error("failed to load texture image!");
+			throw std::runtime_error("failed to load texture image " + full_path + "!");
 		}
 
 		VkFormat format;
@@ -219,13 +343,72 @@ namespace RtEngine {
 			SPDLOG_ERROR("Texture type not supported!");
 		}
 
-		AllocatedImage textureImage =
-				createImage(pixels, {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1}, format,
-							VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-
+		ImageData image_data{};
+		image_data.extent = {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1};
+		image_data.format = format;
+		image_data.pixels.assign(pixels, pixels + getImageSize(image_data.extent, format));
 		stbi_image_free(pixels);
 
-		return Texture(PathUtil::getFileName(path), type, path, textureImage);
+		return image_data;
+	}
+
+	ImageData ResourceBuilder::loadKtx2Texture(const std::string &path, TextureType type) {
+		ImageData image_data = Ktx2Reader::read(resource_path + "/" + path);
+		validateTextureFormat(path, image_data, type);
+		return image_data;
+	}
+
+	void ResourceBuilder::validateTextureFormat(const std::string &path, ImageData &image_data,
+												TextureType type) const {
+		if (TextureCompressor::isBlockCompressed(image_data.format) && !device_manager->supportsBlockCompression()) {
+			throw std::runtime_error("Texture " + path + " is block compressed, but the device has no BC support!");
+		}
+		if (image_data.format == VK_FORMAT_R8G8B8_SRGB &&
+			!device_manager->supportsSampledImageFormat(VK_FORMAT_R8G8B8_SRGB)) {
+			// the levels are tightly packed, so every three bytes are one texel regardless of the level
+			const std::span<const uint8_t> rgb = image_data.bytes();
+			std::vector<uint8_t> rgba(rgb.size() / 3 * 4);
+			for (size_t texel = 0; texel < rgb.size() / 3; texel++) {
+				std::memcpy(&rgba[4 * texel], &rgb[3 * texel], 3);
+				rgba[4 * texel + 3] = 255;
+			}
+			image_data.pixels = std::move(rgba);
+			image_data.mapped = {};
+			image_data.format = VK_FORMAT_R8G8B8A8_SRGB;
+		}
+		if (!device_manager->supportsSampledImageFormat(image_data.format)) {
+			throw std::runtime_error("Texture " + path + " has a format the device can not sample!");
+		}
+		if (type == NORMAL && TextureCompressor::isSrgb(image_data.format)) {
+			spdlog::warn("Normal map {} is stored in an sRGB format", path);
+		}
+	}
+
+	bool ResourceBuilder::loadImportedTexture(const std::string &path, TextureType type, ImageData &image_data) {
+		if (type == ENVIRONMENT) {
+			return false;
+		}
+		return TextureCompressor::loadFromCache(getTextureCachePath(path, type), resource_path + "/" + path,
+												image_data);
+	}
+
+	void ResourceBuilder::importTextureImage(const std::string &path, TextureType type, ImageData &image_data) {
+		// environment maps are looked up by direction only and keep their single level
+		if (type == ENVIRONMENT) {
+			return;
+		}
+
+		TextureCompressor::generateMipChain(image_data, type == NORMAL);
+		if (device_manager->supportsBlockCompression()) {
+			TextureCompressor::compress(image_data, type == NORMAL);
+		}
+		TextureCompressor::storeInCache(getTextureCachePath(path, type), resource_path + "/" + path, image_data);
+	}
+
+	std::string ResourceBuilder::getTextureCachePath(const std::string &path, TextureType type) const {
+		const size_t hash = std::hash<std::string>{}(path);
+		const char *suffix = device_manager->supportsBlockCompression() ? "bc" : "mips";
+		return fmt::format("{}/cache/textures/{:016x}_{}.{}", resource_path, hash, static_cast<int>(type), suffix);
 	}
 
 	uint8_t *ResourceBuilder::loadImageData(std::string path, int *width, int *height, int *channels) {
@@ -264,7 +447,7 @@ namespace RtEngine {
 	void ResourceBuilder::transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image,
 												VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
 												VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
-												VkImageLayout oldLayout, VkImageLayout newLayout) {
+												VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mip_levels) {
 
 		VkImageMemoryBarrier barrier{};
 		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -275,7 +458,7 @@ namespace RtEngine {
 		barrier.image = image;
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.levelCount = mip_levels;
 		barrier.subresourceRange.baseArrayLayer = 0;
 		barrier.subresourceRange.layerCount = 1;
 		barrier.srcAccessMask = srcAccessMask;
@@ -295,16 +478,62 @@ namespace RtEngine {
 		commandManager->endSingleTimeCommand(commandBuffer);
 	}
 
+	VkDeviceSize ResourceBuilder::getImageSize(VkExtent3D extent, VkFormat format) {
+		VkDeviceSize imageSize = extent.width * extent.height * extent.depth;
+		VkDeviceSize block_count = ((extent.width + 3) / 4) * ((extent.height + 3) / 4) * extent.depth;
+		switch (format) {
+			case VK_FORMAT_R8_UNORM:
+				return imageSize;
+			case VK_FORMAT_R8G8_UNORM:
+				return imageSize * 2;
+			case VK_FORMAT_R8G8B8_SRGB:
+				return imageSize * 3;
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+				return imageSize * 4;
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				return imageSize * 8;
+			case VK_FORMAT_R32G32B32A32_UINT:
+			case VK_FORMAT_R32G32B32A32_SFLOAT:
+				return imageSize * 16;
+			// block compressed formats store 4x4 texel blocks
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return block_count * 8;
+			case VK_FORMAT_BC2_UNORM_BLOCK:
+			case VK_FORMAT_BC2_SRGB_BLOCK:
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return block_count * 16;
+			default:
+				throw std::invalid_argument("Image format not supported!");
+		}
+	}
+
 	void ResourceBuilder::copyBufferToImage(VkBuffer buffer, VkImage image, VkExtent3D extent) {
 		VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+		copyBufferToImage(commandBuffer, buffer, image, extent, 0);
+		commandManager->endSingleTimeCommand(commandBuffer);
+	}
 
+	void ResourceBuilder::copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image,
+											VkExtent3D extent, VkDeviceSize buffer_offset, uint32_t mip_level) {
 		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
+		region.bufferOffset = buffer_offset;
 		region.bufferRowLength = 0;
 		region.bufferImageHeight = 0;
 
 		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.mipLevel = mip_level;
 		region.imageSubresource.baseArrayLayer = 0;
 		region.imageSubresource.layerCount = 1;
 
@@ -312,8 +541,6 @@ namespace RtEngine {
 		region.imageExtent = extent;
 
 		vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-		commandManager->endSingleTimeCommand(commandBuffer);
 	}
 
 	void ResourceBuilder::copyImageToBuffer(VkImage image, VkBuffer buffer, VkExtent3D extent) {
@@ -337,7 +564,8 @@ namespace RtEngine {
 		commandManager->endSingleTimeCommand(commandBuffer);
 	}
 
-	VkImageView ResourceBuilder::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+	VkImageView ResourceBuilder::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+												 uint32_t mip_levels) {
 		VkImageViewCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 		createInfo.image = image;
@@ -351,7 +579,7 @@ namespace RtEngine {
 
 		createInfo.subresourceRange.aspectMask = aspectFlags;
 		createInfo.subresourceRange.baseMipLevel = 0;
-		createInfo.subresourceRange.levelCount = 1;
+		createInfo.subresourceRange.levelCount = mip_levels;
 		createInfo.subresourceRange.baseArrayLayer = 0;
 		createInfo.subresourceRange.layerCount = 1;
 
@@ -368,5 +596,19 @@ namespace RtEngine {
 		vkDestroyImageView(device, image.imageView, nullptr);
 		vkDestroyImage(device, image.image, nullptr);
 		vkFreeMemory(device, image.imageMemory, nullptr);
+		trackFree(image.imageMemory);
+	}
+
+	void ResourceBuilder::trackAllocation(VkDeviceMemory memory, VkDeviceSize size) {
+		allocations->sizes[memory] = size;
+		allocations->allocated_bytes += size;
+	}
+
+	void ResourceBuilder::trackFree(VkDeviceMemory memory) {
+		const auto it = allocations->sizes.find(memory);
+		if (it != allocations->sizes.end()) {
+			allocations->allocated_bytes -= it->second;
+			allocations->sizes.erase(it);
+		}
 	}
 } // namespace RtEngine
@@ -0,0 +1,142 @@
+#include "TangentGenerator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+		// any tangent works for triangles without usable uvs, it only has to be perpendicular to the normal
+		glm::vec3 perpendicularTangent(const glm::vec3 &normal) {
+			const glm::vec3 axis = std::abs(normal.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+			const glm::vec3 tangent = axis - normal * glm::dot(normal, axis);
+			return glm::length(tangent) > 0.0f ? glm::normalize(tangent) : glm::vec3(1, 0, 0);
+		}
+
+		float cornerAngle(const glm::vec3 &corner, const glm::vec3 &a, const glm::vec3 &b) {
+			const glm::vec3 edge_a = a - corner, edge_b = b - corner;
+			const float length_product = glm::length(edge_a) * glm::length(edge_b);
+			if (length_product <= 0.0f) {
+				return 0.0f;
+			}
+			return std::acos(std::clamp(glm::dot(edge_a, edge_b) / length_product, -1.0f, 1.0f));
+		}
+	} // namespace
+
+	size_t TangentGenerator::generateMissing(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices,
+											 const std::string &name) {
+		const auto start = std::chrono::high_resolution_clock::now();
+		const auto vertex_count = static_cast<uint32_t>(vertices.size());
+		const auto triangle_count = static_cast<int64_t>(indices.size() / 3);
+
+		// per corner: the face tangent projected into the tangent plane of the corner, weighted by the corner angle
+		// like mikktspace does, and whether the uvs of the face are mirrored
+		std::vector<glm::vec3> corner_tangents(indices.size());
+		std::vector<uint8_t> corner_mirrored(indices.size());
+#pragma omp parallel for
+		for (int64_t t = 0; t < triangle_count; t++) {
+			const uint32_t *triangle = &indices[3 * t];
+			const Vertex &v0 = vertices[triangle[0]], &v1 = vertices[triangle[1]], &v2 = vertices[triangle[2]];
+			if (hasTangent(v0) && hasTangent(v1) && hasTangent(v2)) {
+				continue;
+			}
+
+			const glm::vec3 edge1 = v1.pos - v0.pos, edge2 = v2.pos - v0.pos;
+			const glm::vec2 uv_edge1 = glm::vec2(v1.texCoord - v0.texCoord);
+			const glm::vec2 uv_edge2 = glm::vec2(v2.texCoord - v0.texCoord);
+			const float uv_area = uv_edge1.x * uv_edge2.y - uv_edge2.x * uv_edge1.y;
+
+			// dP/du up to a positive factor, degenerate uvs leave the corners without a contribution
+			glm::vec3 face_tangent(0.0f);
+			if (uv_area != 0.0f) {
+				face_tangent = (edge1 * uv_edge2.y - edge2 * uv_edge1.y) * (uv_area > 0.0f ? 1.0f : -1.0f);
+			}
+
+			for (uint32_t c = 0; c < 3; c++) {
+				const Vertex &vertex = vertices[triangle[c]];
+				const glm::vec3 projected = face_tangent - vertex.normal * glm::dot(vertex.normal, face_tangent);
+				const float length = glm::length(projected);
+				const float angle = cornerAngle(vertex.pos, vertices[triangle[(c + 1) % 3]].pos,
+												vertices[triangle[(c + 2) % 3]].pos);
+				corner_tangents[3 * t + c] = length > 0.0f ? projected * (angle / length) : glm::vec3(0.0f);
+				// uvs have their origin in the top left corner, so an upright mapping has a negative uv area
+				corner_mirrored[3 * t + c] = uv_area > 0.0f;
+			}
+		}
+
+		// corners grouped by vertex and uv orientation, group 2 * v + mirrored
+		std::vector<uint32_t> group_offsets(2 * static_cast<size_t>(vertex_count) + 1, 0);
+		for (size_t i = 0; i < indices.size(); i++) {
+			if (!hasTangent(vertices[indices[i]])) {
+				group_offsets[2 * indices[i] + corner_mirrored[i] + 1]++;
+			}
+		}
+		for (size_t g = 1; g < group_offsets.size(); g++) {
+			group_offsets[g] += group_offsets[g - 1];
+		}
+		std::vector<uint32_t> group_corners(group_offsets.back());
+		std::vector<uint32_t> group_cursor(group_offsets.begin(), group_offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) {
+			if (!hasTangent(vertices[indices[i]])) {
+				group_corners[group_cursor[2 * indices[i] + corner_mirrored[i]]++] = i;
+			}
+		}
+
+		// the mirrored side of a vertex that is used with both orientations becomes a new vertex
+		std::vector<uint32_t> mirrored_vertex(vertex_count, NO_VERTEX);
+		uint32_t split_count = 0;
+		for (uint32_t v = 0; v < vertex_count; v++) {
+			const bool has_unmirrored = group_offsets[2 * v + 1] > group_offsets[2 * v];
+			const bool has_mirrored = group_offsets[2 * v + 2] > group_offsets[2 * v + 1];
+			if (has_unmirrored && has_mirrored) {
+				mirrored_vertex[v] = vertex_count + split_count++;
+			}
+		}
+		vertices.resize(vertex_count + split_count);
+
+		size_t generated_count = 0;
+#pragma omp parallel for reduction(+ : generated_count)
+		for (int64_t v = 0; v < static_cast<int64_t>(vertex_count); v++) {
+			if (hasTangent(vertices[v])) {
+				continue;
+			}
+
+			for (uint32_t mirrored = 0; mirrored < 2; mirrored++) {
+				const auto group = static_cast<uint32_t>(2 * v + mirrored);
+				const bool unused = group_offsets[group + 1] == group_offsets[group];
+				// unreferenced vertices still get a valid tangent
+				if (unused && (mirrored == 1 || group_offsets[group + 2] > group_offsets[group + 1])) {
+					continue;
+				}
+
+				glm::vec3 tangent(0.0f);
+				for (uint32_t i = group_offsets[group]; i < group_offsets[group + 1]; i++) {
+					tangent += corner_tangents[group_corners[i]];
+				}
+
+				auto target = static_cast<uint32_t>(v);
+				if (mirrored == 1 && mirrored_vertex[v] != NO_VERTEX) {
+					target = mirrored_vertex[v];
+					vertices[target] = vertices[v];
+					for (uint32_t i = group_offsets[group]; i < group_offsets[group + 1]; i++) {
+						indices[group_corners[i]] = target;
+					}
+				}
+
+				const glm::vec3 &normal = vertices[target].normal;
+				tangent = glm::length(tangent) > 0.0f ? glm::normalize(tangent) : perpendicularTangent(normal);
+				vertices[target].tangent = glm::vec4(tangent, mirrored == 1 ? -1.0f : 1.0f);
+				generated_count++;
+			}
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		spdlog::info("Generated {} tangents for mesh {} in {:.2f} ms ({:.1f} M triangles/s), split {} vertices",
+					 generated_count, name, seconds * 1000.0, triangle_count / std::max(seconds, 1e-9) / 1e6,
+					 split_count);
+		return generated_count;
+	}
+} // namespace RtEngine
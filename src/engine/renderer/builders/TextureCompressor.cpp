@@ -0,0 +1,482 @@
+#include "TextureCompressor.hpp"
+
+#include <QuickTimer.hpp>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t CACHE_MAGIC = 0x43545452; // "RTTC"
+		constexpr uint32_t CACHE_VERSION = 1;
+
+		struct CacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t source_size;
+			int64_t source_mtime;
+			uint32_t format;
+			uint32_t width, height, mip_levels;
+			uint64_t data_size;
+		};
+
+		// weights of the 4 bit BC7 index palette
+		constexpr std::array<uint32_t, 16> BC7_WEIGHTS = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+		float srgbToLinear(float c) { return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f); }
+
+		float linearToSrgb(float c) {
+			return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+		}
+
+		uint8_t toUnorm8(float v) { return static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); }
+
+		bool getSourceStamp(const std::string &source_path, uint64_t &size, int64_t &mtime) {
+			std::error_code ec;
+			size = std::filesystem::file_size(source_path, ec);
+			if (ec) {
+				return false;
+			}
+			mtime = std::filesystem::last_write_time(source_path, ec).time_since_epoch().count();
+			return !ec;
+		}
+
+		// copies the 4x4 block at (bx, by), clamping reads at the image border
+		void fetchBlock(const uint8_t *level, uint32_t width, uint32_t height, uint32_t bx, uint32_t by,
+						uint8_t *block) {
+			for (uint32_t y = 0; y < 4; y++) {
+				const uint32_t sy = std::min(by * 4 + y, height - 1);
+				for (uint32_t x = 0; x < 4; x++) {
+					const uint32_t sx = std::min(bx * 4 + x, width - 1);
+					memcpy(block + (y * 4 + x) * 4, level + (sy * width + sx) * 4, 4);
+				}
+			}
+		}
+
+		class BitWriter {
+		public:
+			explicit BitWriter(uint8_t *data) : data(data) { memset(data, 0, 16); }
+
+			void write(uint32_t value, uint32_t bits) {
+				for (uint32_t i = 0; i < bits; i++, pos++) {
+					data[pos >> 3] |= ((value >> i) & 1) << (pos & 7);
+				}
+			}
+
+		private:
+			uint8_t *data;
+			uint32_t pos = 0;
+		};
+
+		struct Bc7Endpoints {
+			std::array<uint32_t, 4> e0, e1; // 7 bit per channel
+			uint32_t p0, p1;
+		};
+
+		// evaluates the endpoints and returns the squared error, indices receive the best palette entry per pixel
+		uint32_t evaluateBc7(const uint8_t *pixels, const Bc7Endpoints &ep, std::array<uint8_t, 16> &indices) {
+			std::array<std::array<int32_t, 4>, 16> palette;
+			for (uint32_t i = 0; i < 16; i++) {
+				for (uint32_t c = 0; c < 4; c++) {
+					const int32_t a = static_cast<int32_t>((ep.e0[c] << 1) | ep.p0);
+					const int32_t b = static_cast<int32_t>((ep.e1[c] << 1) | ep.p1);
+					palette[i][c] = ((64 - BC7_WEIGHTS[i]) * a + BC7_WEIGHTS[i] * b + 32) >> 6;
+				}
+			}
+
+			uint32_t total_error = 0;
+			for (uint32_t p = 0; p < 16; p++) {
+				uint32_t best_error = UINT32_MAX;
+				for (uint32_t i = 0; i < 16; i++) {
+					uint32_t error = 0;
+					for (uint32_t c = 0; c < 4; c++) {
+						const int32_t d = static_cast<int32_t>(pixels[p * 4 + c]) - palette[i][c];
+						error += d * d;
+					}
+					if (error < best_error) {
+						best_error = error;
+						indices[p] = i;
+					}
+				}
+				total_error += best_error;
+			}
+			return total_error;
+		}
+
+		// picks the p-bits and 7 bit endpoints that best represent the unquantized endpoints
+		uint32_t quantizeBc7(const uint8_t *pixels, const std::array<float, 4> &a, const std::array<float, 4> &b,
+							 Bc7Endpoints &best, std::array<uint8_t, 16> &best_indices) {
+			uint32_t best_error = UINT32_MAX;
+			for (uint32_t p0 = 0; p0 < 2; p0++) {
+				for (uint32_t p1 = 0; p1 < 2; p1++) {
+					Bc7Endpoints ep{};
+					ep.p0 = p0;
+					ep.p1 = p1;
+					for (uint32_t c = 0; c < 4; c++) {
+						ep.e0[c] = static_cast<uint32_t>(std::clamp(std::round((a[c] - p0) / 2.0f), 0.0f, 127.0f));
+						ep.e1[c] = static_cast<uint32_t>(std::clamp(std::round((b[c] - p1) / 2.0f), 0.0f, 127.0f));
+					}
+					std::array<uint8_t, 16> indices;
+					const uint32_t error = evaluateBc7(pixels, ep, indices);
+					if (error < best_error) {
+						best_error = error;
+						best = ep;
+						best_indices = indices;
+					}
+				}
+			}
+			return best_error;
+		}
+	} // namespace
+
+	bool TextureCompressor::isBlockCompressed(VkFormat format) {
+		return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+
+	bool TextureCompressor::isSrgb(VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_R8G8B8_SRGB:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC2_SRGB_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	VkExtent3D TextureCompressor::getMipLevelExtent(VkExtent3D extent, uint32_t level) {
+		return {std::max(1u, extent.width >> level), std::max(1u, extent.height >> level), 1};
+	}
+
+	void TextureCompressor::generateMipChain(ImageData &image_data, bool normal_map) {
+		const bool srgb = image_data.format == VK_FORMAT_R8G8B8A8_SRGB;
+		const uint32_t mip_levels =
+				static_cast<uint32_t>(std::floor(std::log2(std::max(image_data.extent.width, image_data.extent.height)))) + 1;
+
+		std::array<float, 256> to_linear;
+		for (uint32_t i = 0; i < 256; i++) {
+			to_linear[i] = srgb ? srgbToLinear(i / 255.0f) : i / 255.0f;
+		}
+
+		VkDeviceSize level_offset = 0;
+		for (uint32_t level = 1; level < mip_levels; level++) {
+			const VkExtent3D src_extent = getMipLevelExtent(image_data.extent, level - 1);
+			const VkExtent3D dst_extent = getMipLevelExtent(image_data.extent, level);
+			const VkDeviceSize dst_offset = image_data.pixels.size();
+			image_data.pixels.resize(dst_offset + dst_extent.width * dst_extent.height * 4);
+
+			const uint8_t *src = image_data.pixels.data() + level_offset;
+			uint8_t *dst = image_data.pixels.data() + dst_offset;
+
+#pragma omp parallel for
+			for (int y = 0; y < static_cast<int>(dst_extent.height); y++) {
+				for (uint32_t x = 0; x < dst_extent.width; x++) {
+					std::array<float, 4> sum{};
+					for (uint32_t sy = 0; sy < 2; sy++) {
+						for (uint32_t sx = 0; sx < 2; sx++) {
+							const uint32_t px = std::min(x * 2 + sx, src_extent.width - 1);
+							const uint32_t py = std::min(y * 2 + sy, src_extent.height - 1);
+							const uint8_t *texel = src + (py * src_extent.width + px) * 4;
+							for (uint32_t c = 0; c < 3; c++) {
+								sum[c] += normal_map ? texel[c] / 127.5f - 1.0f : to_linear[texel[c]];
+							}
+							sum[3] += texel[3] / 255.0f;
+						}
+					}
+
+					uint8_t *out = dst + (y * dst_extent.width + x) * 4;
+					if (normal_map) {
+						const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+						for (uint32_t c = 0; c < 3; c++) {
+							const float n = length > 0.0f ? sum[c] / length : (c == 2 ? 1.0f : 0.0f);
+							out[c] = toUnorm8(n * 0.5f + 0.5f);
+						}
+					} else {
+						for (uint32_t c = 0; c < 3; c++) {
+							out[c] = toUnorm8(srgb ? linearToSrgb(sum[c] * 0.25f) : sum[c] * 0.25f);
+						}
+					}
+					out[3] = toUnorm8(sum[3] * 0.25f);
+				}
+			}
+			level_offset = dst_offset;
+		}
+
+		image_data.mip_levels = mip_levels;
+	}
+
+	void TextureCompressor::compress(ImageData &image_data, bool normal_map) {
+		QuickTimer timer("Block compressing texture");
+
+		VkFormat target_format;
+		if (normal_map) {
+			target_format = VK_FORMAT_BC5_UNORM_BLOCK;
+		} else if (image_data.format == VK_FORMAT_R8G8B8A8_SRGB) {
+			target_format = VK_FORMAT_BC7_SRGB_BLOCK;
+		} else if (image_data.format == VK_FORMAT_R8G8B8A8_UNORM) {
+			target_format = VK_FORMAT_BC7_UNORM_BLOCK;
+		} else {
+			throw std::invalid_argument("Texture format can not be block compressed!");
+		}
+
+		VkDeviceSize compressed_size = 0;
+		for (uint32_t level = 0; level < image_data.mip_levels; level++) {
+			compressed_size +=
+					ResourceBuilder::getImageSize(getMipLevelExtent(image_data.extent, level), target_format);
+		}
+		std::vector<uint8_t> compressed(compressed_size);
+
+		VkDeviceSize src_offset = 0, dst_offset = 0;
+		for (uint32_t level = 0; level < image_data.mip_levels; level++) {
+			const VkExtent3D extent = getMipLevelExtent(image_data.extent, level);
+			const uint32_t blocks_x = (extent.width + 3) / 4;
+			const uint32_t blocks_y = (extent.height + 3) / 4;
+			const uint8_t *src = image_data.pixels.data() + src_offset;
+			uint8_t *dst = compressed.data() + dst_offset;
+
+#pragma omp parallel for schedule(dynamic, 64)
+			for (int b = 0; b < static_cast<int>(blocks_x * blocks_y); b++) {
+				std::array<uint8_t, 64> pixels;
+				fetchBlock(src, extent.width, extent.height, b % blocks_x, b / blocks_x, pixels.data());
+				uint8_t *block = dst + static_cast<size_t>(b) * 16;
+				if (normal_map) {
+					std::array<uint8_t, 16> x, y;
+					for (uint32_t i = 0; i < 16; i++) {
+						x[i] = pixels[i * 4 + 0];
+						y[i] = pixels[i * 4 + 1];
+					}
+					encodeBC4Block(x.data(), block);
+					encodeBC4Block(y.data(), block + 8);
+				} else {
+					encodeBC7Block(pixels.data(), block);
+				}
+			}
+
+			src_offset += extent.width * extent.height * 4;
+			dst_offset += ResourceBuilder::getImageSize(extent, target_format);
+		}
+
+		spdlog::debug("Compressed texture from {} KB to {} KB", image_data.pixels.size() / 1024,
+					  compressed.size() / 1024);
+		image_data.pixels = std::move(compressed);
+		image_data.format = target_format;
+	}
+
+	// single subset mode 6: RGBA 7.7.7.7 endpoints with one p-bit each and 4 bit indices
+	void TextureCompressor::encodeBC7Block(const uint8_t *pixels, uint8_t *block) {
+		std::array<float, 4> mean{};
+		for (uint32_t p = 0; p < 16; p++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				mean[c] += pixels[p * 4 + c] / 16.0f;
+			}
+		}
+
+		std::array<std::array<float, 4>, 4> covariance{};
+		for (uint32_t p = 0; p < 16; p++) {
+			for (uint32_t i = 0; i < 4; i++) {
+				for (uint32_t j = 0; j < 4; j++) {
+					covariance[i][j] += (pixels[p * 4 + i] - mean[i]) * (pixels[p * 4 + j] - mean[j]);
+				}
+			}
+		}
+
+		// principal axis by power iteration
+		std::array<float, 4> axis = {1.0f, 1.0f, 1.0f, 1.0f};
+		for (uint32_t iteration = 0; iteration < 8; iteration++) {
+			std::array<float, 4> next{};
+			for (uint32_t i = 0; i < 4; i++) {
+				for (uint32_t j = 0; j < 4; j++) {
+					next[i] += covariance[i][j] * axis[j];
+				}
+			}
+			const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+			if (length < 1e-6f) {
+				break;
+			}
+			for (uint32_t i = 0; i < 4; i++) {
+				axis[i] = next[i] / length;
+			}
+		}
+
+		float t_min = FLT_MAX, t_max = -FLT_MAX;
+		for (uint32_t p = 0; p < 16; p++) {
+			float t = 0.0f;
+			for (uint32_t c = 0; c < 4; c++) {
+				t += (pixels[p * 4 + c] - mean[c]) * axis[c];
+			}
+			t_min = std::min(t_min, t);
+			t_max = std::max(t_max, t);
+		}
+
+		std::array<float, 4> a, b;
+		for (uint32_t c = 0; c < 4; c++) {
+			a[c] = std::clamp(mean[c] + t_min * axis[c], 0.0f, 255.0f);
+			b[c] = std::clamp(mean[c] + t_max * axis[c], 0.0f, 255.0f);
+		}
+
+		Bc7Endpoints endpoints;
+		std::array<uint8_t, 16> indices;
+		uint32_t error = quantizeBc7(pixels, a, b, endpoints, indices);
+
+		// one least squares refinement of the endpoints for the chosen indices
+		if (error > 0) {
+			float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			std::array<float, 4> ax{}, bx{};
+			for (uint32_t p = 0; p < 16; p++) {
+				const float w = BC7_WEIGHTS[indices[p]] / 64.0f;
+				aa += (1.0f - w) * (1.0f - w);
+				ab += (1.0f - w) * w;
+				bb += w * w;
+				for (uint32_t c = 0; c < 4; c++) {
+					ax[c] += (1.0f - w) * pixels[p * 4 + c];
+					bx[c] += w * pixels[p * 4 + c];
+				}
+			}
+			const float det = aa * bb - ab * ab;
+			if (std::abs(det) > 1e-6f) {
+				std::array<float, 4> ra, rb;
+				for (uint32_t c = 0; c < 4; c++) {
+					ra[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+					rb[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+				}
+				Bc7Endpoints refined;
+				std::array<uint8_t, 16> refined_indices;
+				if (quantizeBc7(pixels, ra, rb, refined, refined_indices) < error) {
+					endpoints = refined;
+					indices = refined_indices;
+				}
+			}
+		}
+
+		// the anchor index is stored with an implicit zero msb
+		if (indices[0] >= 8) {
+			std::swap(endpoints.e0, endpoints.e1);
+			std::swap(endpoints.p0, endpoints.p1);
+			for (auto &index: indices) {
+				index = 15 - index;
+			}
+		}
+
+		BitWriter writer(block);
+		writer.write(1 << 6, 7);
+		for (uint32_t c = 0; c < 4; c++) {
+			writer.write(endpoints.e0[c], 7);
+			writer.write(endpoints.e1[c], 7);
+		}
+		writer.write(endpoints.p0, 1);
+		writer.write(endpoints.p1, 1);
+		writer.write(indices[0], 3);
+		for (uint32_t p = 1; p < 16; p++) {
+			writer.write(indices[p], 4);
+		}
+	}
+
+	void TextureCompressor::encodeBC4Block(const uint8_t *values, uint8_t *block) {
+		const uint8_t max = *std::max_element(values, values + 16);
+		const uint8_t min = *std::min_element(values, values + 16);
+
+		// max > min selects the eight value palette, identical endpoints decode to a constant block
+		std::array<int32_t, 8> palette;
+		palette[0] = max;
+		palette[1] = min;
+		for (uint32_t i = 2; i < 8; i++) {
+			palette[i] = ((8 - i) * max + (i - 1) * min) / 7;
+		}
+
+		block[0] = max;
+		block[1] = min;
+		uint64_t bits = 0;
+		for (uint32_t p = 0; p < 16; p++) {
+			uint32_t best_index = 0;
+			int32_t best_error = INT32_MAX;
+			for (uint32_t i = 0; i < 8; i++) {
+				const int32_t error = std::abs(values[p] - palette[i]);
+				if (error < best_error) {
+					best_error = error;
+					best_index = i;
+				}
+			}
+			bits |= static_cast<uint64_t>(best_index) << (p * 3);
+		}
+		for (uint32_t i = 0; i < 6; i++) {
+			block[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+		}
+	}
+
+	bool TextureCompressor::loadFromCache(const std::string &cache_path, const std::string &source_path,
+										  ImageData &image_data) {
+		uint64_t source_size;
+		int64_t source_mtime;
+		if (!getSourceStamp(source_path, source_size, source_mtime)) {
+			return false;
+		}
+
+		std::ifstream file(cache_path, std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		CacheHeader header{};
+		file.read(reinterpret_cast<char *>(&header), sizeof(CacheHeader));
+		if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+			header.source_size != source_size || header.source_mtime != source_mtime) {
+			spdlog::debug("Texture cache entry {} is stale", cache_path);
+			return false;
+		}
+
+		image_data.pixels.resize(header.data_size);
+		file.read(reinterpret_cast<char *>(image_data.pixels.data()), header.data_size);
+		if (!file) {
+			spdlog::warn("Texture cache entry {} is truncated", cache_path);
+			return false;
+		}
+
+		image_data.extent = {header.width, header.height, 1};
+		image_data.format = static_cast<VkFormat>(header.format);
+		image_data.mip_levels = header.mip_levels;
+		return true;
+	}
+
+	void TextureCompressor::storeInCache(const std::string &cache_path, const std::string &source_path,
+										 const ImageData &image_data) {
+		CacheHeader header{};
+		if (!getSourceStamp(source_path, header.source_size, header.source_mtime)) {
+			return;
+		}
+		header.magic = CACHE_MAGIC;
+		header.version = CACHE_VERSION;
+		header.format = image_data.format;
+		header.width = image_data.extent.width;
+		header.height = image_data.extent.height;
+		header.mip_levels = image_data.mip_levels;
+		header.data_size = image_data.pixels.size();
+
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::path(cache_path).parent_path(), ec);
+
+		// write to a temporary file first so a crash never leaves a half written entry behind
+		const std::string tmp_path = cache_path + ".tmp";
+		std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			spdlog::warn("Failed to write texture cache entry {}", cache_path);
+			return;
+		}
+		file.write(reinterpret_cast<const char *>(&header), sizeof(CacheHeader));
+		file.write(reinterpret_cast<const char *>(image_data.pixels.data()), image_data.pixels.size());
+		file.close();
+
+		std::filesystem::rename(tmp_path, cache_path, ec);
+		if (ec) {
+			spdlog::warn("Failed to write texture cache entry {}: {}", cache_path, ec.message());
+		}
+	}
+} // namespace RtEngine
@@ -79,6 +79,15 @@ namespace RtEngine {
 		throw std::runtime_error("Unknown QueueType");
 	}
 
+	bool DeviceManager::supportsBlockCompression() const { return block_compression_supported; }
+
+	bool DeviceManager::supportsSampledImageFormat(VkFormat format) const {
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+		const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+		return (properties.optimalTilingFeatures & required) == required;
+	}
+
 	void DeviceManager::createInstance(bool enable_validation_layers) {
 		if (enable_validation_layers && !checkValidationLayerSupport()) {
 			throw std::runtime_error("validation layers requested, but not available!");
@@ -293,6 +302,12 @@ namespace RtEngine {
 		deviceFeatures.shaderInt64 = VK_TRUE;
 		deviceFeatures.shaderFloat64 = VK_TRUE;
 
+		// BC formats are optional, textures fall back to uncompressed mip chains without them
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+		block_compression_supported = supportedFeatures.textureCompressionBC == VK_TRUE;
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
 		VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures{};
 		accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
 		accelerationStructureFeatures.accelerationStructure = VK_TRUE;
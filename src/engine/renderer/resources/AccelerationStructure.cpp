@@ -1,5 +1,6 @@
 #include "AccelerationStructure.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -100,21 +101,37 @@ namespace RtEngine {
 		return transform;
 	}
 
-	void AccelerationStructure::addInstance(std::shared_ptr<AccelerationStructure> &instance,
-											glm::mat4 transform_matrix, uint32_t instanceId) {
+	void AccelerationStructure::addInstance(uint64_t blas_address, glm::mat4 transform_matrix, uint32_t instanceId) {
 		VkAccelerationStructureInstanceKHR accelerationStructureInstance{};
 		accelerationStructureInstance.transform = convertToVkTransform(transform_matrix);
 		accelerationStructureInstance.instanceCustomIndex = instanceId;
 		accelerationStructureInstance.mask = 0xFF;
 		accelerationStructureInstance.instanceShaderBindingTableRecordOffset = 0;
 		// accelerationStructureInstance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-		accelerationStructureInstance.accelerationStructureReference = instance->getDeviceAddress();
+		accelerationStructureInstance.accelerationStructureReference = blas_address;
 		instances.push_back(accelerationStructureInstance);
 	}
 
+	void AccelerationStructure::setInstanceTransform(uint32_t index, const glm::mat4 &transform_matrix) {
+		assert(index < instances.size());
+		instances[index].transform = convertToVkTransform(transform_matrix);
+	}
+
+	void AccelerationStructure::setInstanceBlas(uint32_t index, uint64_t blas_address) {
+		assert(index < instances.size());
+		instances[index].accelerationStructureReference = blas_address;
+	}
+
+	void AccelerationStructure::clearInstances() { instances.clear(); }
+
 	void AccelerationStructure::fillInstanceBuffer() {
 		uint32_t instance_data_size = instances.size() * sizeof(VkAccelerationStructureInstanceKHR);
 
+		// grows with the instance count, the build reads it from the device so it is only replaced between frames
+		if (instance_buffer.handle != VK_NULL_HANDLE && instance_buffer.size < instance_data_size) {
+			ressource_builder.destroyBuffer(instance_buffer);
+			instance_buffer = AllocatedBuffer{};
+		}
 		if (instance_buffer.handle == VK_NULL_HANDLE) {
 			instance_buffer = ressource_builder.createBuffer(
 					instance_data_size, VK_BUFFER_USAGE_2_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
@@ -145,8 +162,6 @@ namespace RtEngine {
 		geometry.handle = accelerationStructureGeometry;
 		geometry.primitiveCount = static_cast<uint32_t>(instances.size());
 		geometries.push_back(geometry);
-
-		instances.clear();
 	}
 
 	void AccelerationStructure::update_instance_geometry(uint32_t index) {
@@ -167,8 +182,6 @@ namespace RtEngine {
 
 		geometries[index].primitiveCount = static_cast<uint32_t>(instances.size());
 		geometries[index].updated = true;
-
-		instances.clear();
 	}
 
 	void AccelerationStructure::build(VkBuildAccelerationStructureFlagsKHR flags,
@@ -178,7 +191,7 @@ namespace RtEngine {
 		std::vector<VkAccelerationStructureGeometryKHR> acceleration_structure_geometries;
 		std::vector<VkAccelerationStructureBuildRangeInfoKHR> acceleration_structure_build_range_infos;
 		std::vector<uint32_t> primitive_counts;
-		for (auto geometry: geometries) {
+		for (auto &geometry: geometries) {
 			if (mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR && !geometry.updated) {
 				continue;
 			}
@@ -211,7 +224,7 @@ namespace RtEngine {
 		VkAccelerationStructureBuildSizesInfoKHR build_sizes_info{};
 		build_sizes_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 		GetAccelerationStructureBuildSizesKHR(device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-											  &build_geometry_info, &geometries[0].primitiveCount, &build_sizes_info);
+											  &build_geometry_info, primitive_counts.data(), &build_sizes_info);
 
 		if (buffer.handle == VK_NULL_HANDLE || buffer.size != build_sizes_info.accelerationStructureSize) {
 			buffer = ressource_builder.createBuffer(build_sizes_info.accelerationStructureSize,
@@ -230,9 +243,11 @@ namespace RtEngine {
 			}
 		}
 
-		AllocatedBuffer scratchBuffer =
-				ressource_builder.createBuffer(build_sizes_info.buildScratchSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-											   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		const VkDeviceSize scratch_size = mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+												  ? build_sizes_info.updateScratchSize
+												  : build_sizes_info.buildScratchSize;
+		AllocatedBuffer scratchBuffer = ressource_builder.createBuffer(
+				scratch_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
 		build_geometry_info.dstAccelerationStructure = handle;
 		build_geometry_info.scratchData.deviceAddress = scratchBuffer.deviceAddress;
@@ -250,6 +265,84 @@ namespace RtEngine {
 		device_address = GetAccelerationStructureDeviceAddressKHR(device, &accelerationStructureDeviceAddressInfo);
 	}
 
+	void AccelerationStructure::recordInstanceUpdate(VkCommandBuffer command_buffer, uint32_t frame_index,
+													 VkBuildAccelerationStructureFlagsKHR flags) {
+		assert(type == VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR && handle != VK_NULL_HANDLE);
+		assert(geometries.size() == 1 && geometries[0].primitiveCount == instances.size());
+
+		if (frame_update_buffers.size() <= frame_index) {
+			frame_update_buffers.resize(frame_index + 1);
+		}
+		FrameUpdateBuffers &frame_buffers = frame_update_buffers[frame_index];
+
+		const VkDeviceSize instance_data_size = instances.size() * sizeof(VkAccelerationStructureInstanceKHR);
+		if (frame_buffers.instance_buffer.handle != VK_NULL_HANDLE &&
+			frame_buffers.instance_buffer.size < instance_data_size) {
+			ressource_builder.destroyBuffer(frame_buffers.instance_buffer);
+			frame_buffers.instance_buffer = AllocatedBuffer{};
+		}
+		if (frame_buffers.instance_buffer.handle == VK_NULL_HANDLE) {
+			frame_buffers.instance_buffer = ressource_builder.createBuffer(
+					instance_data_size, VK_BUFFER_USAGE_2_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+		frame_buffers.instance_buffer.update(device, instances.data(), instance_data_size);
+
+		VkAccelerationStructureGeometryKHR geometry = geometries[0].handle;
+		geometry.geometry.instances.data.deviceAddress = frame_buffers.instance_buffer.deviceAddress;
+
+		VkAccelerationStructureBuildGeometryInfoKHR build_geometry_info{};
+		build_geometry_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+		build_geometry_info.type = type;
+		build_geometry_info.flags = flags;
+		build_geometry_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+		build_geometry_info.srcAccelerationStructure = handle;
+		build_geometry_info.dstAccelerationStructure = handle;
+		build_geometry_info.geometryCount = 1;
+		build_geometry_info.pGeometries = &geometry;
+
+		const auto instance_count = static_cast<uint32_t>(instances.size());
+		VkAccelerationStructureBuildSizesInfoKHR build_sizes_info{};
+		build_sizes_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+		GetAccelerationStructureBuildSizesKHR(device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+											  &build_geometry_info, &instance_count, &build_sizes_info);
+
+		// the previous refit of this frame slot finished with its fence, so the scratch buffer is free to replace
+		const VkDeviceSize scratch_size = std::max<VkDeviceSize>(build_sizes_info.updateScratchSize, 1);
+		if (frame_buffers.scratch_buffer.handle != VK_NULL_HANDLE && frame_buffers.scratch_buffer.size < scratch_size) {
+			ressource_builder.destroyBuffer(frame_buffers.scratch_buffer);
+			frame_buffers.scratch_buffer = AllocatedBuffer{};
+		}
+		if (frame_buffers.scratch_buffer.handle == VK_NULL_HANDLE) {
+			frame_buffers.scratch_buffer = ressource_builder.createBuffer(
+					scratch_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		}
+		build_geometry_info.scratchData.deviceAddress = frame_buffers.scratch_buffer.deviceAddress;
+
+		// earlier frames on the queue may still trace against the structure or refit it
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask =
+				VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		barrier.dstAccessMask =
+				VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		vkCmdPipelineBarrier(command_buffer,
+							 VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR |
+									 VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+							 VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0,
+							 nullptr);
+
+		VkAccelerationStructureBuildRangeInfoKHR build_range_info{};
+		build_range_info.primitiveCount = instance_count;
+		const VkAccelerationStructureBuildRangeInfoKHR *build_range_infos = &build_range_info;
+		CmdBuildAccelerationStructuresKHR(device, command_buffer, 1, &build_geometry_info, &build_range_infos);
+
+		barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+		barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+							 VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
 	void AccelerationStructure::destroy() {
 		if (buffer.handle != VK_NULL_HANDLE) {
 			ressource_builder.destroyBuffer(buffer);
@@ -259,6 +352,16 @@ namespace RtEngine {
 			ressource_builder.destroyBuffer(instance_buffer);
 		}
 
+		for (const auto &frame_buffers: frame_update_buffers) {
+			if (frame_buffers.instance_buffer.handle != VK_NULL_HANDLE) {
+				ressource_builder.destroyBuffer(frame_buffers.instance_buffer);
+			}
+			if (frame_buffers.scratch_buffer.handle != VK_NULL_HANDLE) {
+				ressource_builder.destroyBuffer(frame_buffers.scratch_buffer);
+			}
+		}
+		frame_update_buffers.clear();
+
 		if (handle != VK_NULL_HANDLE) {
 			DestroyAccelerationStructureKHR(device, handle, nullptr);
 		}
@@ -267,4 +370,5 @@ namespace RtEngine {
 	VkAccelerationStructureKHR AccelerationStructure::getHandle() const { return handle; }
 
 	uint64_t AccelerationStructure::getDeviceAddress() const { return device_address; }
+	size_t AccelerationStructure::getSize() const { return buffer.size; }
 } // namespace RtEngine
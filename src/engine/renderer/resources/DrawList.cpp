@@ -0,0 +1,128 @@
+#include "DrawList.hpp"
+
+#include <cassert>
+
+namespace RtEngine {
+	uint32_t DrawList::add(RenderObject object) {
+		uint32_t handle;
+		if (!free_handles.empty()) {
+			handle = free_handles.back();
+			free_handles.pop_back();
+		} else {
+			handle = static_cast<uint32_t>(handle_objects.size());
+			handle_objects.push_back(INVALID_HANDLE);
+		}
+
+		handle_objects[handle] = static_cast<uint32_t>(objects.size());
+		emitting_object_count += countEmittingSubmeshes(object);
+		objects.push_back(std::move(object));
+		object_handles.push_back(handle);
+		object_moved.push_back(0);
+
+		markStructureChanged();
+		return handle;
+	}
+
+	void DrawList::remove(uint32_t handle) {
+		assert(handle < handle_objects.size() && handle_objects[handle] != INVALID_HANDLE);
+		// before the indices of the moved objects become stale
+		markStructureChanged();
+
+		const uint32_t index = handle_objects[handle];
+		emitting_object_count -= countEmittingSubmeshes(objects[index]);
+
+		// the last object takes the place of the removed one
+		const uint32_t last = static_cast<uint32_t>(objects.size()) - 1;
+		if (index != last) {
+			objects[index] = std::move(objects[last]);
+			object_handles[index] = object_handles[last];
+			handle_objects[object_handles[index]] = index;
+		}
+		objects.pop_back();
+		object_handles.pop_back();
+		object_moved.pop_back();
+
+		handle_objects[handle] = INVALID_HANDLE;
+		free_handles.push_back(handle);
+	}
+
+	void DrawList::update(uint32_t handle, RenderObject object) {
+		assert(handle < handle_objects.size() && handle_objects[handle] != INVALID_HANDLE);
+		const uint32_t index = handle_objects[handle];
+		RenderObject &current = objects[index];
+		emitting_object_count -= countEmittingSubmeshes(current);
+		emitting_object_count += countEmittingSubmeshes(object);
+
+		if (!keepsInstance(current, object)) {
+			current = std::move(object);
+			markStructureChanged();
+			return;
+		}
+
+		object.instance_mapping_data = current.instance_mapping_data;
+		object.blas_address = current.blas_address;
+		object.primitive_count = current.primitive_count;
+		if (object.transform != current.transform) {
+			markMoved(index);
+		}
+		for (size_t i = 0; i < object.submesh_materials.size(); i++) {
+			if (object.submesh_materials[i].emitting_power != current.submesh_materials[i].emitting_power) {
+				changes.emission_changed = true;
+			}
+		}
+		current = std::move(object);
+	}
+
+	void DrawList::setTransform(uint32_t handle, const glm::mat4 &transform) {
+		assert(handle < handle_objects.size() && handle_objects[handle] != INVALID_HANDLE);
+		const uint32_t index = handle_objects[handle];
+		objects[index].transform = transform;
+		markMoved(index);
+	}
+
+	void DrawList::clearChanges() {
+		for (uint32_t index: changes.moved_objects) {
+			object_moved[index] = 0;
+		}
+		changes.moved_objects.clear();
+		changes.structure_changed = false;
+		changes.emission_changed = false;
+	}
+
+	void DrawList::markStructureChanged() {
+		clearChanges();
+		changes.structure_changed = true;
+	}
+
+	void DrawList::markMoved(uint32_t index) {
+		// a structure change rebuilds everything anyway
+		if (!changes.structure_changed && !object_moved[index]) {
+			object_moved[index] = 1;
+			changes.moved_objects.push_back(index);
+		}
+	}
+
+	// the tlas instance and the instance buffer entry only depend on the mesh and the submesh materials
+	bool DrawList::keepsInstance(const RenderObject &current, const RenderObject &object) {
+		if (current.mesh != object.mesh || current.submesh_materials.size() != object.submesh_materials.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < object.submesh_materials.size(); i++) {
+			if (current.submesh_materials[i].material_index != object.submesh_materials[i].material_index) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// every emitting submesh is sampled as a light of its own
+	uint32_t DrawList::countEmittingSubmeshes(const RenderObject &object) {
+		uint32_t count = 0;
+		for (const auto &submesh_material: object.submesh_materials) {
+			if (submesh_material.emitting_power > 0.0f) {
+				count++;
+			}
+		}
+		return count;
+	}
+} // namespace RtEngine
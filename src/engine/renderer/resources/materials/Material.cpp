@@ -17,10 +17,21 @@ namespace RtEngine {
 		return instances[instance_name];
 	}
 
+	MaterialInstance *Material::getInstance(MaterialInstanceHandle handle) const {
+		return instance_table.get(handle);
+	}
+
+	void Material::addInstance(const std::shared_ptr<MaterialInstance> &instance) {
+		instance->handle = instance_table.insert(instance);
+		instances[instance->name] = instance;
+	}
+
 	void Material::clearResources() {
 		mainDeletionQueue.flush();
 	}
 
 	void Material::reset() {
+		instances.clear();
+		instance_table.clear();
 	}
 } // namespace RtEngine
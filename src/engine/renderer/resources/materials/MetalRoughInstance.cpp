@@ -1,5 +1,7 @@
 #include "MetalRoughInstance.hpp"
 
+#include <cassert>
+
 #include "Node.hpp"
 
 namespace RtEngine {
@@ -29,7 +31,7 @@ namespace RtEngine {
         resources->tex_indices =
                 glm::vec4{material_textures->addTexture(albedo_tex),
                           material_textures->addTexture(metal_rough_ao_tex),
-                          material_textures->addTexture(normal_tex), 0};
+                          material_textures->addTexture(normal_tex), gltf_channel_layout ? 1 : 0};
 
         *size = sizeof(MetalRoughResources);
         return resources.get();
@@ -48,11 +50,13 @@ namespace RtEngine {
 
         if (yaml_node["metal_rough_ao_tex"]) {
             metal_rough_ao_tex = tex_repo->addTexture(yaml_node["metal_rough_ao_tex"].as<std::string>(), PARAMETER);
+            gltf_channel_layout = yaml_node["metal_rough_layout"] && yaml_node["metal_rough_layout"].as<std::string>() == "gltf";
             metallic = 0.0f;
             roughness = 0.0f;
             ao = 0.0f;
         } else {
             metal_rough_ao_tex = tex_repo->getDefaultTex(PARAMETER);
+            gltf_channel_layout = false;
             if (yaml_node["metallic"])
                 metallic = yaml_node["metallic"].as<float>();
             if (yaml_node["roughness"])
@@ -98,6 +102,9 @@ namespace RtEngine {
             }
         } else {
             out["metal_rough_ao_tex"] = metal_rough_ao_tex->path;
+            if (gltf_channel_layout) {
+                out["metal_rough_layout"] = "gltf";
+            }
         }
 
         out["eta"] = eta;
@@ -117,4 +124,41 @@ namespace RtEngine {
     float MetalRoughInstance::getEmissionPower() {
         return emission_power;
     }
+
+    int32_t MetalRoughInstance::findParameter(const std::string &parameter) const {
+        for (int32_t i = 0; i < PARAMETER_NAMES.size(); i++) {
+            if (PARAMETER_NAMES[i] == parameter) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void MetalRoughInstance::setParameter(int32_t index, const glm::vec4 &value) {
+        switch (index) {
+            case ALBEDO:
+                albedo = glm::vec3(value);
+                break;
+            case METALLIC:
+                metallic = value.x;
+                break;
+            case ROUGHNESS:
+                roughness = value.x;
+                break;
+            case AO:
+                ao = value.x;
+                break;
+            case ETA:
+                eta = value.x;
+                break;
+            case EMISSION_COLOR:
+                emission_color = glm::vec3(value);
+                break;
+            case EMISSION_POWER:
+                emission_power = value.x;
+                break;
+            default:
+                assert(false);
+        }
+    }
 } // RtEngine
\ No newline at end of file
@@ -78,7 +78,7 @@ namespace RtEngine {
 			return instances[instance->name];
 		}
 
-		instances[instance->name] = instance;
+		addInstance(instance);
 		return instance;
 	}
 
@@ -105,7 +105,6 @@ namespace RtEngine {
 	}
 
 	void MetalRoughMaterial::reset() {
-		instances.clear();
 		Material::reset();
 	}
 } // namespace RtEngine
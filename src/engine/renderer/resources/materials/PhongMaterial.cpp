@@ -75,7 +75,7 @@ namespace RtEngine {
 			return instances[instance->name];
 		}
 
-		instances[instance->name] = instance;
+		addInstance(instance);
 		return instance;
 	}
 
@@ -100,7 +100,6 @@ namespace RtEngine {
 	}
 
 	void PhongMaterial::reset() {
-		instances.clear();
 		Material::reset();
 	}
 } // namespace RtEngine
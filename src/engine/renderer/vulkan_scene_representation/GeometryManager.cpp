@@ -1,6 +1,11 @@
+#include <CompactVertex.hpp>
 #include <GeometryManager.hpp>
 #include <MeshRenderer.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
 #include "QuickTimer.hpp"
 
 namespace RtEngine {
@@ -8,10 +13,99 @@ namespace RtEngine {
 	void GeometryManager::createGeometryBuffers(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) {
 		QuickTimer timer{"Static geometry", true};
 
-		vertex_buffer = createVertexBuffer(mesh_assets);
+		createVertexBuffers(mesh_assets);
 		index_buffer = createIndexBuffer(mesh_assets);
 		geometry_mapping_buffer = createGeometryMappingBuffer(mesh_assets);
 		createBlas(mesh_assets);
+
+		geometry_ranges.clear();
+		for (auto &mesh_asset: mesh_assets) {
+			geometry_ranges[mesh_asset->geometry_id] =
+					GeometryRange{static_cast<uint32_t>(mesh_asset->meshBuffers.vertices.size()),
+								  getIndexCount(mesh_asset->meshBuffers),
+								  static_cast<uint32_t>(mesh_asset->meshBuffers.submeshes.size())};
+		}
+
+		mesh_bindings.clear();
+		for (const auto &mesh_asset: mesh_assets) {
+			storeMeshBinding(mesh_asset);
+		}
+	}
+
+	bool GeometryManager::updateMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset) {
+		if (!geometry_ranges.contains(mesh_asset->geometry_id)) {
+			return false;
+		}
+
+		const GeometryRange &range = geometry_ranges[mesh_asset->geometry_id];
+		std::vector<Vertex> &vertices = mesh_asset->meshBuffers.vertices;
+		std::vector<uint32_t> &indices = mesh_asset->meshBuffers.indices;
+		// submeshes and lods have their own geometry ids, a different number of them needs new ones
+		if (vertices.size() > range.vertex_capacity || getIndexCount(mesh_asset->meshBuffers) > range.index_capacity ||
+			mesh_asset->meshBuffers.submeshes.size() != range.submesh_count ||
+			mesh_asset->meshBuffers.lods.size() != mesh_asset->lods.size()) {
+			return false;
+		}
+
+		// the offsets stay the same, so no other mesh has to change, only the lod offsets inside the range move
+		const uint32_t vertex_offset = mesh_asset->instance_data.vertex_offset;
+		if (!compact_vertices) {
+			vulkan_context->resource_builder->stageMemoryToBuffer(vertices.data(), vertices.size() * sizeof(Vertex),
+																  vertex_buffer, vertex_offset * sizeof(Vertex));
+		} else {
+			std::vector<float> positions(3 * vertices.size());
+			std::vector<CompactVertexAttributes> attributes(vertices.size());
+			for (uint32_t i = 0; i < vertices.size(); i++) {
+				positions[3 * i] = vertices[i].pos.x;
+				positions[3 * i + 1] = vertices[i].pos.y;
+				positions[3 * i + 2] = vertices[i].pos.z;
+				attributes[i] = CompactVertexAttributes::encode(vertices[i]);
+			}
+			vulkan_context->resource_builder->stageMemoryToBuffer(positions.data(), positions.size() * sizeof(float),
+																  vertex_buffer, vertex_offset * 3 * sizeof(float));
+			vulkan_context->resource_builder->stageMemoryToBuffer(
+					attributes.data(), attributes.size() * sizeof(CompactVertexAttributes), attribute_buffer,
+					vertex_offset * sizeof(CompactVertexAttributes));
+		}
+		vulkan_context->resource_builder->stageMemoryToBuffer(indices.data(), indices.size() * sizeof(uint32_t),
+															  index_buffer,
+															  mesh_asset->instance_data.triangle_offset * sizeof(uint32_t));
+
+		// the submesh ranges may have moved inside the mesh
+		stageSubmeshGeometryData(mesh_asset->geometry_id, mesh_asset->instance_data, mesh_asset->meshBuffers.submeshes);
+
+		const std::shared_ptr<AccelerationStructure> old_blas = mesh_asset->accelerationStructure;
+		mesh_asset->accelerationStructure =
+				buildBlas(mesh_asset->vertex_count, mesh_asset->instance_data, mesh_asset->meshBuffers.submeshes);
+		std::replace(blas.begin(), blas.end(), old_blas, mesh_asset->accelerationStructure);
+		retired_blas.push_back(old_blas);
+
+		// the lods follow the full index buffer, their offsets move with its size
+		uint32_t index_offset = mesh_asset->instance_data.triangle_offset + indices.size();
+		for (uint32_t i = 0; i < mesh_asset->lods.size(); i++) {
+			MeshLod &lod = mesh_asset->lods[i];
+			const LodBuffers &lod_buffers = mesh_asset->meshBuffers.lods[i];
+			const std::vector<uint32_t> &lod_indices = lod_buffers.indices;
+			vulkan_context->resource_builder->stageMemoryToBuffer(lod_indices.data(),
+																  lod_indices.size() * sizeof(uint32_t), index_buffer,
+																  index_offset * sizeof(uint32_t));
+
+			lod.triangle_count = lod_indices.size() / 3;
+			lod.error = lod_buffers.error;
+			lod.instance_data = GeometryData{vertex_offset, index_offset};
+			stageSubmeshGeometryData(lod.geometry_id, lod.instance_data, lod_buffers.submeshes);
+			index_offset += lod_indices.size();
+
+			const std::shared_ptr<AccelerationStructure> old_lod_blas = lod.accelerationStructure;
+			lod.accelerationStructure = buildBlas(mesh_asset->vertex_count, lod.instance_data, lod_buffers.submeshes);
+			std::replace(blas.begin(), blas.end(), old_lod_blas, lod.accelerationStructure);
+			retired_blas.push_back(old_lod_blas);
+		}
+
+		spdlog::debug("Updated geometry {} in place with {} vertices and {} indices", mesh_asset->geometry_id,
+					  vertices.size(), indices.size());
+		storeMeshBinding(mesh_asset);
+		return true;
 	}
 
 	void GeometryManager::writeGeometryBuffers() const {
@@ -21,35 +115,118 @@ namespace RtEngine {
 														  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 		vulkan_context->descriptor_allocator->writeBuffer(5, geometry_mapping_buffer.handle, 0,
 														  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		// the attribute binding has to be valid even if the shaders read the full layout
+		vulkan_context->descriptor_allocator->writeBuffer(
+				10, compact_vertices ? attribute_buffer.handle : vertex_buffer.handle, 0,
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	}
+
+	void GeometryManager::destroyRetiredBlas() {
+		for (auto &structure: retired_blas) {
+			structure->destroy();
+		}
+		retired_blas.clear();
+	}
+
+	void GeometryManager::bindMeshAssets() const {
+		for (const auto &binding: mesh_bindings) {
+			binding.mesh_asset->geometry_id = binding.geometry_id;
+			binding.mesh_asset->instance_data = binding.instance_data;
+			binding.mesh_asset->accelerationStructure = binding.acceleration_structure;
+			binding.mesh_asset->lods = binding.lods;
+		}
+	}
+
+	VkDeviceSize GeometryManager::getDeviceMemorySize() const {
+		VkDeviceSize size =
+				vertex_buffer.size + attribute_buffer.size + index_buffer.size + geometry_mapping_buffer.size;
+		for (const auto &structure: blas) {
+			size += structure->getSize();
+		}
+		return size;
+	}
+
+	void GeometryManager::storeMeshBinding(const std::shared_ptr<MeshAsset> &mesh_asset) {
+		const MeshBinding binding{mesh_asset, mesh_asset->geometry_id, mesh_asset->instance_data,
+								  mesh_asset->accelerationStructure, mesh_asset->lods};
+		for (auto &existing: mesh_bindings) {
+			if (existing.mesh_asset == mesh_asset) {
+				existing = binding;
+				return;
+			}
+		}
+		mesh_bindings.push_back(binding);
+	}
+
+	void GeometryManager::setCompactVertices(bool compact) {
+		compact_vertices = compact;
+	}
+
+	bool GeometryManager::usesCompactVertices() const {
+		return compact_vertices;
 	}
 
-	AllocatedBuffer GeometryManager::createVertexBuffer(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) const {
+	uint32_t GeometryManager::getVertexStride() const {
+		return compact_vertices ? 3 * sizeof(float) : sizeof(Vertex);
+	}
+
+	void GeometryManager::createVertexBuffers(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) {
 		assert(!mesh_assets.empty());
 
 		if (vertex_buffer.handle != VK_NULL_HANDLE) {
 			vulkan_context->resource_builder->destroyBuffer(vertex_buffer);
 		}
+		if (attribute_buffer.handle != VK_NULL_HANDLE) {
+			vulkan_context->resource_builder->destroyBuffer(attribute_buffer);
+			attribute_buffer = {};
+		}
 
 		VkDeviceSize size = 0;
 		for (auto &mesh_asset: mesh_assets) {
 			size += mesh_asset->meshBuffers.vertices.size();
 		}
 
-		std::vector<Vertex> vertices(size);
+		std::vector<Vertex> vertices;
+		vertices.reserve(size);
 
 		uint32_t vertex_offset = 0;
 		for (auto &mesh_asset: mesh_assets) {
-			vertices.insert(vertices.begin() + vertex_offset, mesh_asset->meshBuffers.vertices.begin(),
+			vertices.insert(vertices.end(), mesh_asset->meshBuffers.vertices.begin(),
 							mesh_asset->meshBuffers.vertices.end());
 
 			mesh_asset->instance_data.vertex_offset = vertex_offset;
 			vertex_offset += mesh_asset->meshBuffers.vertices.size();
 		}
 
-		return vulkan_context->resource_builder->stageMemoryToNewBuffer(
-				vertices.data(), vertices.size() * sizeof(Vertex),
-				VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-						VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+		const VkBufferUsageFlags usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+										 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		const size_t full_size = vertices.size() * sizeof(Vertex);
+		if (!compact_vertices) {
+			spdlog::info("Vertex data: {:.2f} MB", full_size / 1e6f);
+			vertex_buffer = vulkan_context->resource_builder->stageMemoryToNewBuffer(vertices.data(), full_size, usage);
+			return;
+		}
+
+		// positions go into their own stream so the blas build input has a 12 byte stride
+		std::vector<float> positions(3 * vertices.size());
+		std::vector<CompactVertexAttributes> attributes(vertices.size());
+		for (uint32_t i = 0; i < vertices.size(); i++) {
+			positions[3 * i] = vertices[i].pos.x;
+			positions[3 * i + 1] = vertices[i].pos.y;
+			positions[3 * i + 2] = vertices[i].pos.z;
+			attributes[i] = CompactVertexAttributes::encode(vertices[i]);
+		}
+
+		const size_t compact_size = positions.size() * sizeof(float) +
+									attributes.size() * sizeof(CompactVertexAttributes);
+		spdlog::info("Vertex data: {:.2f} MB compact instead of {:.2f} MB, saved {:.2f} MB", compact_size / 1e6f,
+					 full_size / 1e6f, (full_size - compact_size) / 1e6f);
+
+		vertex_buffer = vulkan_context->resource_builder->stageMemoryToNewBuffer(
+				positions.data(), positions.size() * sizeof(float), usage);
+		attribute_buffer = vulkan_context->resource_builder->stageMemoryToNewBuffer(
+				attributes.data(), attributes.size() * sizeof(CompactVertexAttributes),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 	}
 
 	AllocatedBuffer GeometryManager::createIndexBuffer(std::vector<std::shared_ptr<MeshAsset>> &mesh_assets) const {
@@ -61,18 +238,32 @@ namespace RtEngine {
 
 		VkDeviceSize size = 0;
 		for (auto &mesh_asset: mesh_assets) {
-			size += mesh_asset->meshBuffers.indices.size();
+			size += getIndexCount(mesh_asset->meshBuffers);
 		}
 
-		std::vector<uint32_t> indices(size);
+		std::vector<uint32_t> indices;
+		indices.reserve(size);
 
+		// the lods of a mesh directly follow its full index buffer and share its vertices
 		uint32_t index_offset = 0;
 		for (auto &mesh_asset: mesh_assets) {
-			indices.insert(indices.begin() + index_offset, mesh_asset->meshBuffers.indices.begin(),
+			indices.insert(indices.end(), mesh_asset->meshBuffers.indices.begin(),
 						   mesh_asset->meshBuffers.indices.end());
 
 			mesh_asset->instance_data.triangle_offset = index_offset;
 			index_offset += mesh_asset->meshBuffers.indices.size();
+
+			mesh_asset->lods.clear();
+			for (const auto &lod_buffers: mesh_asset->meshBuffers.lods) {
+				indices.insert(indices.end(), lod_buffers.indices.begin(), lod_buffers.indices.end());
+
+				MeshLod lod{};
+				lod.triangle_count = lod_buffers.indices.size() / 3;
+				lod.error = lod_buffers.error;
+				lod.instance_data = GeometryData{mesh_asset->instance_data.vertex_offset, index_offset};
+				mesh_asset->lods.push_back(lod);
+				index_offset += lod_buffers.indices.size();
+			}
 		}
 
 		return vulkan_context->resource_builder->stageMemoryToNewBuffer(
@@ -89,45 +280,103 @@ namespace RtEngine {
 			vulkan_context->resource_builder->destroyBuffer(geometry_mapping_buffer);
 		}
 
+		// one geometry id per submesh, the submeshes of a mesh are consecutive so the shaders find them with
+		// gl_GeometryIndexEXT. the lods are appended after all full meshes
 		std::vector<GeometryData> geometry_datas;
+		auto add_submeshes = [&](const GeometryData &mesh_data, const std::vector<Submesh> &submeshes) {
+			const auto geometry_id = static_cast<uint32_t>(geometry_datas.size());
+			for (const auto &submesh: submeshes) {
+				geometry_datas.push_back(
+						GeometryData{mesh_data.vertex_offset, mesh_data.triangle_offset + submesh.index_offset});
+			}
+			return geometry_id;
+		};
 		for (auto &mesh_asset: mesh_assets) {
-			geometry_datas.push_back(mesh_asset->instance_data);
+			mesh_asset->geometry_id = add_submeshes(mesh_asset->instance_data, mesh_asset->meshBuffers.submeshes);
+		}
+		for (auto &mesh_asset: mesh_assets) {
+			for (uint32_t i = 0; i < mesh_asset->lods.size(); i++) {
+				mesh_asset->lods[i].geometry_id =
+						add_submeshes(mesh_asset->lods[i].instance_data, mesh_asset->meshBuffers.lods[i].submeshes);
+			}
 		}
 		return vulkan_context->resource_builder->stageMemoryToNewBuffer(
-				geometry_datas.data(), mesh_assets.size() * sizeof(GeometryData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+				geometry_datas.data(), geometry_datas.size() * sizeof(GeometryData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 	}
 
 	void GeometryManager::createBlas(std::vector<std::shared_ptr<MeshAsset>> &meshes) {
 		assert(vertex_buffer.handle != VK_NULL_HANDLE && index_buffer.handle != VK_NULL_HANDLE);
 
-		for (auto& structure : blas) {
-			structure->destroy();
-		}
+		// the tlas is rebuilt after the geometry, until then it still references the old blas
+		retired_blas.insert(retired_blas.end(), blas.begin(), blas.end());
 		blas.clear();
 
-		VkDevice device = vulkan_context->device_manager->getDevice();
-
-		uint32_t object_id = 0;
+		size_t mesh_blas_size = 0, lod_blas_size = 0, lod_count = 0;
 		for (auto &meshAsset: meshes) {
-			meshAsset->accelerationStructure = std::make_shared<AccelerationStructure>(
-					device, *vulkan_context->resource_builder, *vulkan_context->command_manager,
-					VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR);
-
-			meshAsset->accelerationStructure->addTriangleGeometry(
-					vertex_buffer, index_buffer,
-					meshAsset->vertex_count - 1, meshAsset->triangle_count, sizeof(Vertex),
-					meshAsset->instance_data.vertex_offset, meshAsset->instance_data.triangle_offset);
-			meshAsset->accelerationStructure->build();
-			meshAsset->geometry_id = object_id++;
+			meshAsset->accelerationStructure =
+					buildBlas(meshAsset->vertex_count, meshAsset->instance_data, meshAsset->meshBuffers.submeshes);
 
 			blas.push_back(meshAsset->accelerationStructure);
+			mesh_blas_size += meshAsset->accelerationStructure->getSize();
+
+			for (uint32_t i = 0; i < meshAsset->lods.size(); i++) {
+				MeshLod &lod = meshAsset->lods[i];
+				lod.accelerationStructure = buildBlas(meshAsset->vertex_count, lod.instance_data,
+													  meshAsset->meshBuffers.lods[i].submeshes);
+				blas.push_back(lod.accelerationStructure);
+				lod_blas_size += lod.accelerationStructure->getSize();
+				lod_count++;
+			}
+		}
+		spdlog::info("BLAS memory: {:.2f} MB for {} meshes, {:.2f} MB for {} lods", mesh_blas_size / 1e6f,
+					 meshes.size(), lod_blas_size / 1e6f, lod_count);
+	}
+
+	uint32_t GeometryManager::getIndexCount(const MeshBuffers &mesh_buffers) {
+		size_t index_count = mesh_buffers.indices.size();
+		for (const auto &lod: mesh_buffers.lods) {
+			index_count += lod.indices.size();
+		}
+		return index_count;
+	}
+
+	void GeometryManager::stageSubmeshGeometryData(uint32_t geometry_id, const GeometryData &mesh_data,
+												   const std::vector<Submesh> &submeshes) const {
+		std::vector<GeometryData> geometry_datas;
+		for (const auto &submesh: submeshes) {
+			geometry_datas.push_back(
+					GeometryData{mesh_data.vertex_offset, mesh_data.triangle_offset + submesh.index_offset});
+		}
+		vulkan_context->resource_builder->stageMemoryToBuffer(geometry_datas.data(),
+															  geometry_datas.size() * sizeof(GeometryData),
+															  geometry_mapping_buffer,
+															  geometry_id * sizeof(GeometryData));
+	}
+
+	// one geometry per submesh, all of them share the vertices of the mesh
+	std::shared_ptr<AccelerationStructure>
+	GeometryManager::buildBlas(uint32_t vertex_count, const GeometryData &geometry_data,
+							   const std::vector<Submesh> &submeshes) const {
+		auto acceleration_structure = std::make_shared<AccelerationStructure>(
+				vulkan_context->device_manager->getDevice(), *vulkan_context->resource_builder,
+				*vulkan_context->command_manager, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR);
+
+		for (const auto &submesh: submeshes) {
+			acceleration_structure->addTriangleGeometry(
+					vertex_buffer, index_buffer,
+					vertex_count - 1, submesh.index_count / 3, getVertexStride(),
+					geometry_data.vertex_offset, geometry_data.triangle_offset + submesh.index_offset);
 		}
+		acceleration_structure->build();
+		return acceleration_structure;
 	}
 
 
 	void GeometryManager::destroy() {
 		if (vertex_buffer.handle != VK_NULL_HANDLE)
 			vulkan_context->resource_builder->destroyBuffer(vertex_buffer);
+		if (attribute_buffer.handle != VK_NULL_HANDLE)
+			vulkan_context->resource_builder->destroyBuffer(attribute_buffer);
 		if (index_buffer.handle != VK_NULL_HANDLE)
 			vulkan_context->resource_builder->destroyBuffer(index_buffer);
 		if (geometry_mapping_buffer.handle != VK_NULL_HANDLE)
@@ -137,6 +386,7 @@ namespace RtEngine {
 			structure->destroy();
 		}
 		blas.clear();
+		destroyRetiredBlas();
 	}
 
 } // namespace RtEngine
@@ -6,44 +6,65 @@
 
 namespace RtEngine {
 	void InstanceManager::createInstanceMappingBuffer(std::vector<RenderObject> &objects) {
-		assert(!objects.empty());
-
 		if (instance_mapping_buffer.handle != VK_NULL_HANDLE) {
 			resource_builder->destroyBuffer(instance_mapping_buffer);
 		}
 
-		std::vector<InstanceMappingData> instance_datas;
+		// the instance entries are followed by the material indices of their submeshes, material_offset counts
+		// uints from the start of the buffer
+		std::vector<uint32_t> instance_datas(2 * objects.size());
 		for (int i = 0; i < objects.size(); i++) {
-			instance_datas.push_back(objects[i].instance_mapping_data);
+			objects[i].instance_mapping_data.material_offset = instance_datas.size();
+			for (const auto &submesh_material: objects[i].submesh_materials) {
+				instance_datas.push_back(submesh_material.material_index);
+			}
+			instance_datas[2 * i] = objects[i].instance_mapping_data.geometry_id;
+			instance_datas[2 * i + 1] = objects[i].instance_mapping_data.material_offset;
+		}
+		// the buffer must not be empty, a scene without objects never reads it
+		if (instance_datas.empty()) {
+			instance_datas.resize(2, 0);
 		}
 
 		instance_mapping_buffer = resource_builder->stageMemoryToNewBuffer(instance_datas.data(),
-																		   instance_datas.size() * sizeof(InstanceMappingData),
+																		   instance_datas.size() * sizeof(uint32_t),
 																		   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 	}
 
-	void InstanceManager::createEmittingInstancesBuffer(const std::vector<RenderObject> &objects) {
-		assert(!objects.empty());
-
-		if (emitting_instances_buffer.handle != VK_NULL_HANDLE) {
-			resource_builder->destroyBuffer(emitting_instances_buffer);
-		}
-
+	void InstanceManager::createEmittingInstancesBuffer(const std::vector<RenderObject> &objects,
+													   const MeshRepository &mesh_repository) {
+		// one entry per emitting submesh, emitters always use the full mesh so its submesh ranges apply
 		std::vector<EmittingInstanceData> emitting_instances;
 		for (int i = 0; i < objects.size(); i++) {
-			EmittingInstanceData instance_data;
-			instance_data.instance_id = i;
-			instance_data.model_matrix = objects[i].transform;
-			float power = objects[i].emitting_power;
-			instance_data.primitive_count = objects[i].primitive_count;
-			if (power > 0.0f || (i == objects.size() - 1 && emitting_instances.empty())) {
+			const std::vector<SubmeshMaterial> &submesh_materials = objects[i].submesh_materials;
+			for (uint32_t k = 0; k < submesh_materials.size(); k++) {
+				if (submesh_materials[k].emitting_power <= 0.0f) {
+					continue;
+				}
+
+				EmittingInstanceData instance_data{};
+				instance_data.instance_id = i;
+				instance_data.model_matrix = objects[i].transform;
+				instance_data.primitive_count =
+						mesh_repository.getMesh(objects[i].mesh)->meshBuffers.submeshes[k].index_count / 3;
+				instance_data.geometry_index = k;
 				emitting_instances.push_back(instance_data);
 			}
 		}
+		// the buffer must not be empty, the shaders never sample the placeholder since the emitter count is zero
+		if (emitting_instances.empty()) {
+			emitting_instances.push_back(EmittingInstanceData{});
+		}
 
-		emitting_instances_buffer = resource_builder->stageMemoryToNewBuffer(
+		// moved emitters replace the buffer without waiting for the device. the upload waits for the queue, so once
+		// it returned the frames that still read the old buffer are done
+		AllocatedBuffer new_buffer = resource_builder->stageMemoryToNewBuffer(
 				emitting_instances.data(), emitting_instances.size() * sizeof(EmittingInstanceData),
 				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+		if (emitting_instances_buffer.handle != VK_NULL_HANDLE) {
+			resource_builder->destroyBuffer(emitting_instances_buffer);
+		}
+		emitting_instances_buffer = new_buffer;
 	}
 
 	AllocatedBuffer InstanceManager::getInstanceBuffer() const {
@@ -2,9 +2,11 @@
 
 #include "Material.hpp"
 
+#include <cassert>
+
 namespace RtEngine {
     MaterialManager::MaterialManager(std::shared_ptr<ResourceBuilder> resource_builder,
-        std::shared_ptr<TextureRepository> tex_repo) : resource_builder(resource_builder) {
+        std::shared_ptr<TextureRepository> tex_repo) : resource_builder(resource_builder), tex_repo(tex_repo) {
         material_textures = std::make_shared<MaterialTextures<>>(tex_repo);
     }
 
@@ -14,6 +16,8 @@ namespace RtEngine {
             resource_builder->destroyBuffer(material_buffer);
         }
         material_textures->clear();
+        // textures added outside of scene loading are still waiting for their upload
+        tex_repo->uploadPendingTextures();
 
         // collect material instance from scene graph, combine their data resources into a buffer and the textures into material_textures
         std::vector<std::shared_ptr<MaterialInstance>> material_instances = scene->getMaterialInstances();
@@ -24,7 +28,45 @@ namespace RtEngine {
         material->writeMaterial(material_buffer, material_textures);
     }
 
+    void MaterialManager::patchMaterialResources(std::shared_ptr<IScene> scene) {
+        tex_repo->uploadPendingTextures();
+
+        // texture slots are kept, new textures are appended behind the existing ones
+        std::vector<std::shared_ptr<MaterialInstance>> material_instances = scene->getMaterialInstances();
+        std::vector<std::byte> material_data = collectMaterialData(material_instances);
+        if (material_buffer.handle == VK_NULL_HANDLE || material_data.size() != material_buffer.size) {
+            updateMaterialResources(scene);
+            return;
+        }
+        resource_builder->stageMemoryToBuffer(material_data.data(), material_data.size(), material_buffer, 0);
+
+        std::shared_ptr<Material> material = scene->getMaterial();
+        material->writeMaterial(material_buffer, material_textures);
+    }
+
+    bool MaterialManager::collectMaterialValues(std::shared_ptr<IScene> scene,
+        std::vector<uint32_t> *material_values) const {
+        const uint32_t texture_count = material_textures->getTextureCount();
+        std::vector<std::byte> material_data = collectMaterialData(scene->getMaterialInstances());
+        if (material_buffer.handle == VK_NULL_HANDLE || material_data.size() != material_buffer.size ||
+            material_textures->getTextureCount() != texture_count) {
+            return false;
+        }
+
+        assert(material_data.size() % sizeof(uint32_t) == 0);
+        material_values->resize(material_data.size() / sizeof(uint32_t));
+        std::memcpy(material_values->data(), material_data.data(), material_data.size());
+        return true;
+    }
+
     AllocatedBuffer MaterialManager::createMaterialBuffer(const std::vector<std::shared_ptr<MaterialInstance>> &instances) const {
+        std::vector<std::byte> material_data = collectMaterialData(instances);
+        return resource_builder->stageMemoryToNewBuffer(
+                material_data.data(), material_data.size(),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    std::vector<std::byte> MaterialManager::collectMaterialData(const std::vector<std::shared_ptr<MaterialInstance>> &instances) const {
         std::vector<void*> resource_ptrs(instances.size());
         std::vector<size_t> sizes(instances.size());
         size_t total_size = 0;
@@ -34,19 +76,13 @@ namespace RtEngine {
             total_size += sizes[i];
         }
 
-        const auto material_data = static_cast<std::byte*>(std::malloc(total_size));
-        std::byte* dst = material_data;
+        std::vector<std::byte> material_data(total_size);
+        std::byte* dst = material_data.data();
         for (uint32_t i = 0; i < resource_ptrs.size(); i++) {
             std::memcpy(dst, resource_ptrs[i], sizes[i]);
             dst += sizes[i];
         }
-
-        AllocatedBuffer material_buffer = resource_builder->stageMemoryToNewBuffer(
-                material_data, total_size,
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-
-        free(material_data);
-        return material_buffer;
+        return material_data;
     }
 
     void MaterialManager::destroy() {
@@ -5,42 +5,133 @@
 #include <MetalRoughMaterial.hpp>
 #include <OptionsWindow.hpp>
 #include <QuickTimer.hpp>
+#include <Scene.hpp>
 #include <SceneUtil.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
 
 #include "PhongMaterial.hpp"
 #include "UpdateFlagValue.hpp"
 
 namespace RtEngine {
+	namespace {
+		// allow update so moved instances can be refit into the existing tlas
+		constexpr VkBuildAccelerationStructureFlagsKHR TLAS_BUILD_FLAGS =
+				VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+				VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+
+		// a lod is only left once its projected error is this factor away from lod_pixel_error, so objects close to the
+		// threshold do not switch back and forth while the camera moves
+		constexpr float LOD_HYSTERESIS = 1.25f;
+
+		double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+	} // namespace
+
+	VkDeviceSize SceneResources::getDeviceMemorySize() const {
+		VkDeviceSize size = geometry_manager->getDeviceMemorySize() + material_manager->getDeviceMemorySize() +
+							instance_manager->getInstanceBuffer().size +
+							instance_manager->getEmittingInstancesBuffer().size +
+							top_level_acceleration_structure->getSize();
+		for (const auto &uniform_buffer: uniform_buffers) {
+			size += uniform_buffer.size;
+		}
+		return size;
+	}
 
-	void SceneAdapter::loadNewScene(const std::shared_ptr<IScene> &new_scene) {
+	std::shared_ptr<SceneResources> SceneAdapter::loadNewScene(const std::shared_ptr<IScene> &new_scene) {
 		QuickTimer timer{"Scene Creation", true};
 
-		scene_resource_deletion_queue.flush();
+		// the uploads and blas builds wait on their own fence, so the frames of the active scene in flight keep
+		// running until activateSceneResources waits for the device to swap the sets
+		return activateSceneResources(createSceneResources(new_scene));
+	}
 
-		loaded_scene = new_scene;
+	std::shared_ptr<SceneResources>
+	SceneAdapter::activateSceneResources(const std::shared_ptr<SceneResources> &resources) {
+		// the shared descriptor sets and material resources are rewritten for the new scene
+		vkDeviceWaitIdle(vulkan_context->device_manager->getDevice());
+		std::shared_ptr<SceneResources> previous_resources = active_resources;
+		active_resources = resources;
+
+		active_resources->geometry_manager->bindMeshAssets();
+		active_resources->geometry_manager->writeGeometryBuffers();
+		// cached resources are shown with the tlas and instance buffers they were built with, new ones get theirs
+		// with the first STATIC_GEOMETRY_UPDATE
+		const VkAccelerationStructureKHR tlas = active_resources->top_level_acceleration_structure->getHandle();
+		if (tlas != VK_NULL_HANDLE) {
+			vulkan_context->descriptor_allocator->writeAccelerationStructure(
+				0, tlas, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
+		}
+		const std::shared_ptr<InstanceManager> &instance_manager = active_resources->instance_manager;
+		if (instance_manager->getInstanceBuffer().handle != VK_NULL_HANDLE) {
+			vulkan_context->descriptor_allocator->writeBuffer(6, instance_manager->getInstanceBuffer().handle, 0,
+															  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		}
+		if (instance_manager->getEmittingInstancesBuffer().handle != VK_NULL_HANDLE) {
+			vulkan_context->descriptor_allocator->writeBuffer(7, instance_manager->getEmittingInstancesBuffer().handle,
+															  0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		}
+		updateMaterial();
+		return previous_resources;
+	}
 
-		setupNewScene(loaded_scene);
-		updateGeometryResources(loaded_scene);
-		updateMaterial(loaded_scene);
+	void SceneAdapter::setCompactVertices(bool compact) {
+		compact_vertices = compact;
 	}
 
-	void SceneAdapter::setupNewScene(const std::shared_ptr<IScene> &scene) {
-		createTlas();
-		createUniformBuffers(scene);
+	void SceneAdapter::setLodSelection(bool enabled, float max_pixel_error) {
+		mesh_lods = enabled;
+		lod_pixel_error = max_pixel_error;
 	}
 
-	void SceneAdapter::createTlas() {
-		assert(top_level_acceleration_structure == nullptr);
+	std::shared_ptr<SceneResources> SceneAdapter::createSceneResources(const std::shared_ptr<IScene> &scene) {
+		auto resources = std::make_shared<SceneResources>();
+		resources->scene = scene;
+		resources->geometry_manager = std::make_shared<GeometryManager>(vulkan_context);
+		resources->geometry_manager->setCompactVertices(compact_vertices);
+		resources->instance_manager = std::make_shared<InstanceManager>(vulkan_context->resource_builder);
+		resources->material_manager =
+				std::make_shared<MaterialManager>(vulkan_context->resource_builder, texture_repository);
+
+		try {
+			createTlas(*resources);
+			createUniformBuffers(*resources);
+			updateGeometryResources(*resources);
+		} catch (const std::exception &) {
+			// the mesh assets shared with the active scene already point at the new blas, which are destroyed here
+			destroySceneResources(*resources);
+			if (active_resources != nullptr) {
+				active_resources->geometry_manager->bindMeshAssets();
+			}
+			throw;
+		}
+		return resources;
+	}
+
+	void SceneAdapter::destroySceneResources(SceneResources &resources) const {
+		resources.geometry_manager->destroy();
+		resources.instance_manager->destroy();
+		resources.material_manager->destroy();
+		if (resources.top_level_acceleration_structure != nullptr) {
+			resources.top_level_acceleration_structure->destroy();
+			resources.top_level_acceleration_structure = nullptr;
+		}
+		for (const auto &uniform_buffer: resources.uniform_buffers) {
+			vulkan_context->resource_builder->destroyBuffer(uniform_buffer);
+		}
+		resources.uniform_buffers.clear();
+		resources.uniform_buffers_mapped.clear();
+	}
+
+	void SceneAdapter::createTlas(SceneResources &resources) const {
+		assert(resources.top_level_acceleration_structure == nullptr);
 
 		VkDevice device = vulkan_context->device_manager->getDevice();
-		top_level_acceleration_structure = std::make_shared<AccelerationStructure>(
+		resources.top_level_acceleration_structure = std::make_shared<AccelerationStructure>(
 			device, *vulkan_context->resource_builder, *vulkan_context->command_manager,
 			VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR);
-		scene_resource_deletion_queue.pushFunction([&]()
-		{
-			top_level_acceleration_structure->destroy();
-			top_level_acceleration_structure = nullptr;
-		});
 	}
 
 	void SceneAdapter::createSceneLayout() {
@@ -56,6 +147,7 @@ namespace RtEngine {
 		layoutBuilder.addBinding(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER); // emitting instances buffer
 		layoutBuilder.addBinding(8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6); // env map
 		layoutBuilder.addBinding(9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE); // rng tex
+		layoutBuilder.addBinding(10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER); // compact vertex attributes
 
 		scene_descriptor_set_layout = layoutBuilder.build(
 				vulkan_context->device_manager->getDevice(),
@@ -73,46 +165,123 @@ namespace RtEngine {
 		}
 	}
 
-	void SceneAdapter::createUniformBuffers(const std::shared_ptr<IScene> &scene) {
-		sceneUniformBuffers.resize(max_frames_in_flight);
-		sceneUniformBuffersMapped.resize(max_frames_in_flight);
-
+	void SceneAdapter::createUniformBuffers(SceneResources &resources) const {
 		size_t scene_data_size = 0;
-		scene->getSceneData(&scene_data_size, 0);
+		resources.scene->getSceneData(&scene_data_size, 0);
 		for (size_t i = 0; i < max_frames_in_flight; i++) {
 			VkDeviceSize size = scene_data_size;
-			sceneUniformBuffers[i] = vulkan_context->resource_builder->createBuffer(
+			resources.uniform_buffers.push_back(vulkan_context->resource_builder->createBuffer(
 					size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-			vkMapMemory(vulkan_context->device_manager->getDevice(), sceneUniformBuffers[i].bufferMemory, 0, size, 0,
-						&sceneUniformBuffersMapped[i]);
+					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
 
-			scene_resource_deletion_queue.pushFunction(
-					[&, i]() { vulkan_context->resource_builder->destroyBuffer(sceneUniformBuffers[i]); });
+			resources.uniform_buffers_mapped.push_back(nullptr);
+			vkMapMemory(vulkan_context->device_manager->getDevice(), resources.uniform_buffers[i].bufferMemory, 0, size,
+						0, &resources.uniform_buffers_mapped[i]);
 		}
 	}
 
 	// ----------------------------------------------------------------------------------------------------------------
 
 	void SceneAdapter::updateScene(const std::shared_ptr<DrawContext> &draw_context, uint32_t current_frame, UpdateFlagsHandle update_flags) {
-		assert(loaded_scene != nullptr);
+		assert(active_resources != nullptr);
+		assert(draw_context->draw_list != nullptr);
 
 		// QuickTimer timer{"Scene Update", true};
 		VkDevice device = vulkan_context->device_manager->getDevice();
 
-		if (update_flags->checkFlag(STATIC_GEOMETRY_UPDATE) || update_flags->checkFlag(MATERIAL_UPDATE))
+		// animated material values are written into the frame like the tlas refit, unless a patch is needed anyway
+		if (update_flags->checkFlag(MATERIAL_VALUES) && !update_flags->checkFlag(MATERIAL_UPDATE) &&
+			!update_flags->checkFlag(MATERIAL_PATCH)) {
+			const std::shared_ptr<MaterialManager> &material_manager = active_resources->material_manager;
+			PendingBufferWrite material_write{material_manager->getMaterialBuffer(), 0, {}};
+			if (material_manager->collectMaterialValues(active_resources->scene, &material_write.data)) {
+				active_resources->pending_buffer_writes.push_back(std::move(material_write));
+			} else {
+				update_flags->setFlag(MATERIAL_PATCH);
+			}
+		}
+
+		// materials and meshes are copied into the draw list entries, so they have to be taken over again. objects that
+		// keep their mesh and submesh materials are not a structure change, so this alone does not rebuild the tlas
+		if (update_flags->checkFlag(STATIC_GEOMETRY_UPDATE) || update_flags->checkFlag(MATERIAL_UPDATE) ||
+			update_flags->checkFlag(MATERIAL_PATCH)) {
+			active_resources->scene->refreshRenderObjects();
+		}
+
+		DrawList &draw_list = *draw_context->draw_list;
+		const DrawListChanges &changes = draw_list.getChanges();
+		std::vector<RenderObject> &render_objects = draw_list.getRenderObjects();
+		const bool structure_changed = update_flags->checkFlag(STATIC_GEOMETRY_UPDATE) || changes.structure_changed;
+
+		std::vector<uint32_t> &lod_changed_objects = active_resources->lod_changed_objects;
+		selectLods(render_objects, changes, *draw_context, structure_changed, &lod_changed_objects);
+		// moved objects and lod switches keep the instance count, so their tlas instances are patched and refit unless
+		// the tlas is rebuilt anyway. a lod switch alone barely changes the image and keeps the accumulated frames
+		const bool objects_moved = !structure_changed && !changes.moved_objects.empty();
+		const bool instances_patched = objects_moved || (!structure_changed && !lod_changed_objects.empty());
+		if (objects_moved) {
+			update_flags->setFlag(TARGET_RESET);
+		}
+
+		// these replace or rewrite buffers that frames in flight still read, a refit is recorded into the frame instead
+		if (structure_changed || update_flags->checkFlag(MATERIAL_UPDATE) || update_flags->checkFlag(MATERIAL_PATCH))
 			vkDeviceWaitIdle(device);
 
 		if (update_flags->checkFlag(MATERIAL_UPDATE)) {
 			// !!!! This clear the descriptor set writes
-			material_manager->updateMaterialResources(loaded_scene);
+			active_resources->material_manager->updateMaterialResources(active_resources->scene);
+		} else if (update_flags->checkFlag(MATERIAL_PATCH)) {
+			active_resources->material_manager->patchMaterialResources(active_resources->scene);
 		}
 
-		updateStaticGeometry(draw_context->getRenderObjects(), update_flags);
-		updateSceneData(loaded_scene, draw_context, current_frame);
+		// the emitting instances carry their own copy of the transform and only list emitting submeshes
+		bool emitters_changed = structure_changed || changes.emission_changed;
+		if (structure_changed) {
+			updateStaticGeometry(render_objects);
+		} else if (instances_patched) {
+			emitters_changed |= updateDynamicGeometry(render_objects, changes.moved_objects, lod_changed_objects);
+		}
+		if (emitters_changed) {
+			updateEmittingInstances(render_objects);
+		}
+		updateSceneData(active_resources->scene, draw_list, current_frame);
 
 		updateSceneDescriptorSets();
+		draw_list.clearChanges();
+	}
+
+	void SceneAdapter::recordFrameUpdates(VkCommandBuffer command_buffer, uint32_t current_frame) {
+		if (active_resources == nullptr) {
+			return;
+		}
+
+		std::vector<PendingBufferWrite> &buffer_writes = active_resources->pending_buffer_writes;
+		if (!buffer_writes.empty()) {
+			// earlier frames on the queue may still read the buffers
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+								 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			for (const auto &write: buffer_writes) {
+				ResourceBuilder::recordBufferUpdate(command_buffer, write.buffer, write.offset, write.data.data(),
+													write.data.size() * sizeof(uint32_t));
+			}
+			buffer_writes.clear();
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+								 VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		if (active_resources->tlas_refit_pending) {
+			active_resources->top_level_acceleration_structure->recordInstanceUpdate(command_buffer, current_frame,
+																					 TLAS_BUILD_FLAGS);
+			active_resources->tlas_refit_pending = false;
+		}
 	}
 
 	void SceneAdapter::updateRenderTarget(const std::shared_ptr<RenderTarget> target) {
@@ -125,46 +294,185 @@ namespace RtEngine {
 		updateSceneDescriptorSets();
 	}
 
-	void SceneAdapter::updateGeometryResources(const std::shared_ptr<IScene> &scene) {
-		std::vector<std::shared_ptr<MeshAsset>> mesh_assets = scene->getMeshAssets();
-		geometry_manager->createGeometryBuffers(mesh_assets);
-		geometry_manager->writeGeometryBuffers();
+	// the buffers are written to the descriptor sets by the caller, once the resources are the active ones
+	void SceneAdapter::updateGeometryResources(SceneResources &resources) {
+		const auto start = std::chrono::high_resolution_clock::now();
+		std::vector<std::shared_ptr<MeshAsset>> mesh_assets = resources.scene->getMeshAssets();
+		resources.geometry_manager->createGeometryBuffers(mesh_assets);
+		build_timings.geometry_ms = millisecondsSince(start);
 	}
 
-	// TODO split into dynamic and static
-	void SceneAdapter::updateStaticGeometry(std::vector<RenderObject> render_objects, UpdateFlagsHandle update_flags) {
-		if (update_flags->checkFlag(STATIC_GEOMETRY_UPDATE)) {
-			instance_manager->createInstanceMappingBuffer(render_objects);
-			vulkan_context->descriptor_allocator->writeBuffer(6, instance_manager->getInstanceBuffer().handle, 0,
-															  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// the tlas still references the old blas until the next STATIC_GEOMETRY_UPDATE, they are destroyed after it
+	void SceneAdapter::reloadMeshGeometry(const std::shared_ptr<MeshAsset> &mesh_asset) {
+		assert(active_resources != nullptr);
 
-			// TODO Only partially update tlas depending on the updated dynamic objects
-			updateTlas(render_objects);
-			vulkan_context->descriptor_allocator->writeAccelerationStructure(
-				0, top_level_acceleration_structure->getHandle(), VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
+		if (!active_resources->geometry_manager->updateMeshGeometry(mesh_asset)) {
+			spdlog::info("Mesh {} outgrew its geometry range, rebuilding all geometry", mesh_asset->path);
+			updateGeometryResources(*active_resources);
+			active_resources->geometry_manager->writeGeometryBuffers();
 		}
+	}
 
-		if (update_flags->checkFlag(STATIC_GEOMETRY_UPDATE) || update_flags->checkFlag(MATERIAL_UPDATE)) {
-			instance_manager->createEmittingInstancesBuffer(render_objects);
-			vulkan_context->descriptor_allocator->writeBuffer(7, instance_manager->getEmittingInstancesBuffer().handle,
-												  0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	void SceneAdapter::selectLods(std::vector<RenderObject> &render_objects, const DrawListChanges &changes,
+								  const DrawContext &draw_context, bool select_all,
+								  std::vector<uint32_t> *changed_objects) {
+		changed_objects->clear();
+		std::vector<uint32_t> &selected_lods = active_resources->selected_lods;
+		selected_lods.resize(render_objects.size(), 0);
+
+		// the selection only depends on the view and the transforms, while neither changes only moved objects can
+		// get a different lod
+		const bool view_changed = draw_context.view_position != active_resources->selected_view_position ||
+								  draw_context.pixels_per_unit != active_resources->selected_pixels_per_unit;
+		active_resources->selected_view_position = draw_context.view_position;
+		active_resources->selected_pixels_per_unit = draw_context.pixels_per_unit;
+
+		if (select_all || view_changed) {
+			for (uint32_t i = 0; i < render_objects.size(); i++) {
+				if (selectLod(render_objects[i], draw_context, selected_lods[i])) {
+					changed_objects->push_back(i);
+				}
+			}
+		} else {
+			for (uint32_t i: changes.moved_objects) {
+				if (selectLod(render_objects[i], draw_context, selected_lods[i])) {
+					changed_objects->push_back(i);
+				}
+			}
 		}
 
-		/*if (update_flags & GEOMETRY_UPDATE) {
-			vulkan_context->descriptor_allocator->writeAccelerationStructure(
-					0, top_level_acceleration_structure->getHandle(), VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
-		}*/
+		if (!changed_objects->empty() && spdlog::should_log(spdlog::level::debug)) {
+			std::vector<uint32_t> histogram;
+			for (uint32_t lod : selected_lods) {
+				histogram.resize(std::max<size_t>(histogram.size(), lod + 1), 0);
+				histogram[lod]++;
+			}
+			std::string counts;
+			for (size_t lod = 0; lod < histogram.size(); lod++) {
+				counts += fmt::format("{}{}: {}", lod == 0 ? "" : ", ", lod, histogram[lod]);
+			}
+			spdlog::debug("Lod selection changed, instances per lod {}", counts);
+		}
+	}
+
+	bool SceneAdapter::selectLod(RenderObject &object, const DrawContext &draw_context, uint32_t &selected_lod) const {
+		const MeshAsset *mesh_asset = mesh_repository->getMesh(object.mesh);
+
+		// emitters keep the full mesh, the emitting instances buffer is not rebuilt on lod changes
+		uint32_t lod = 0;
+		if (mesh_lods && mesh_asset != nullptr && !mesh_asset->lods.empty() && object.emitting_power <= 0.0f &&
+			draw_context.pixels_per_unit > 0.0f) {
+			const glm::vec3 center = glm::vec3(object.transform * glm::vec4(mesh_asset->bounds.center, 1.0f));
+			const float scale = std::max({glm::length(glm::vec3(object.transform[0])),
+										  glm::length(glm::vec3(object.transform[1])),
+										  glm::length(glm::vec3(object.transform[2]))});
+			const float radius = mesh_asset->bounds.radius * scale;
+			const float distance = glm::length(center - draw_context.view_position);
+
+			// lod errors are relative to the bounding radius, inside the bounds the full mesh is always used
+			if (distance > radius) {
+				const float radius_pixels = radius * draw_context.pixels_per_unit / distance;
+				const auto lod_count = static_cast<uint32_t>(mesh_asset->lods.size());
+				auto projected_error = [&](uint32_t l) {
+					return l == 0 ? 0.0f : mesh_asset->lods[l - 1].error * radius_pixels;
+				};
+
+				// starting from the current lod, refine once it is clearly too coarse and only coarsen while the next
+				// lod is clearly fine enough
+				lod = std::min(selected_lod, lod_count);
+				if (projected_error(lod) > lod_pixel_error * LOD_HYSTERESIS) {
+					while (lod > 0 && projected_error(lod) > lod_pixel_error) {
+						lod--;
+					}
+				} else {
+					while (lod < lod_count && projected_error(lod + 1) <= lod_pixel_error / LOD_HYSTERESIS) {
+						lod++;
+					}
+				}
+			}
+		}
+
+		// the render objects persist across frames, so going back to the full mesh has to be written as well
+		if (lod > 0) {
+			const MeshLod &mesh_lod = mesh_asset->lods[lod - 1];
+			object.blas_address = mesh_lod.accelerationStructure->getDeviceAddress();
+			object.instance_mapping_data.geometry_id = mesh_lod.geometry_id;
+			object.primitive_count = mesh_lod.triangle_count;
+		} else if (mesh_asset != nullptr) {
+			object.blas_address = mesh_asset->accelerationStructure->getDeviceAddress();
+			object.instance_mapping_data.geometry_id = mesh_asset->geometry_id;
+			object.primitive_count = mesh_asset->triangle_count;
+		}
+
+		const bool changed = selected_lod != lod;
+		selected_lod = lod;
+		return changed;
 	}
 
-	void SceneAdapter::updateDynamicGeometry(std::vector<RenderObject> render_objects, uint32_t update_flags) {
+	void SceneAdapter::updateStaticGeometry(std::vector<RenderObject> &render_objects) {
+		// the new instance buffer and tlas already contain everything the pending instance writes and the refit
+		// would have patched
+		const std::shared_ptr<InstanceManager> &instance_manager = active_resources->instance_manager;
+		std::erase_if(active_resources->pending_buffer_writes, [&](const PendingBufferWrite &write) {
+			return write.buffer == instance_manager->getInstanceBuffer().handle;
+		});
+		instance_manager->createInstanceMappingBuffer(render_objects);
+		vulkan_context->descriptor_allocator->writeBuffer(6, instance_manager->getInstanceBuffer().handle, 0,
+														  VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		updateTlas(render_objects);
+		active_resources->tlas_refit_pending = false;
+		build_timings.tlas_build_ms = millisecondsSince(start);
+		active_resources->geometry_manager->destroyRetiredBlas();
+		vulkan_context->descriptor_allocator->writeAccelerationStructure(
+			0, active_resources->top_level_acceleration_structure->getHandle(),
+			VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
+	}
 
+	// the instance count and the blas of every instance are unchanged, so the tlas is refit instead of rebuilt. the
+	// refit is recorded into the command buffer of the frame, so nothing here waits for the frames in flight
+	bool SceneAdapter::updateDynamicGeometry(const std::vector<RenderObject> &render_objects,
+											 const std::vector<uint32_t> &moved_objects,
+											 const std::vector<uint32_t> &lod_changed_objects) {
+		const std::shared_ptr<AccelerationStructure> &top_level_acceleration_structure =
+				active_resources->top_level_acceleration_structure;
+		assert(top_level_acceleration_structure->getHandle() != VK_NULL_HANDLE);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		bool emitter_moved = false;
+		for (uint32_t i: moved_objects) {
+			top_level_acceleration_structure->setInstanceTransform(i, render_objects[i].transform);
+			emitter_moved |= render_objects[i].emitting_power > 0.0f;
+		}
+
+		// another lod has its own blas and geometry id, the geometry id lives in the instance buffer
+		const VkBuffer instance_buffer = active_resources->instance_manager->getInstanceBuffer().handle;
+		for (uint32_t i: lod_changed_objects) {
+			top_level_acceleration_structure->setInstanceBlas(i, render_objects[i].blas_address);
+			active_resources->pending_buffer_writes.push_back(
+					{instance_buffer, 2 * i * sizeof(uint32_t), {render_objects[i].instance_mapping_data.geometry_id}});
+		}
+		active_resources->tlas_refit_pending = true;
+		build_timings.tlas_refit_ms = millisecondsSince(start);
+		return emitter_moved;
+	}
+
+	void SceneAdapter::updateEmittingInstances(const std::vector<RenderObject> &render_objects) {
+		const std::shared_ptr<InstanceManager> &instance_manager = active_resources->instance_manager;
+		instance_manager->createEmittingInstancesBuffer(render_objects, *mesh_repository);
+		vulkan_context->descriptor_allocator->writeBuffer(7, instance_manager->getEmittingInstancesBuffer().handle,
+														  0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	}
 
-	void SceneAdapter::updateTlas(std::vector<RenderObject> objects) const
+	void SceneAdapter::updateTlas(const std::vector<RenderObject> &objects) const
 	{
+		const std::shared_ptr<AccelerationStructure> &top_level_acceleration_structure =
+				active_resources->top_level_acceleration_structure;
+		top_level_acceleration_structure->clearInstances();
 		uint32_t instance_id = 0;
 		for (auto & object : objects) {
-			top_level_acceleration_structure->addInstance(object.acceleration_structure, object.transform, instance_id++);
+			top_level_acceleration_structure->addInstance(object.blas_address, object.transform, instance_id++);
 		}
 
 		if (top_level_acceleration_structure->getHandle() == VK_NULL_HANDLE) {
@@ -172,20 +480,22 @@ namespace RtEngine {
 		} else {
 			top_level_acceleration_structure->update_instance_geometry(0);
 		}
-		top_level_acceleration_structure->build();
+		top_level_acceleration_structure->build(TLAS_BUILD_FLAGS);
 	}
 
-	void SceneAdapter::updateMaterial(const std::shared_ptr<IScene> &scene) const {
-		material_manager->updateMaterialResources(scene);
+	void SceneAdapter::updateMaterial() const {
+		active_resources->material_manager->updateMaterialResources(active_resources->scene);
 	}
 
-	void SceneAdapter::updateSceneData(const std::shared_ptr<IScene> &scene, const std::shared_ptr<DrawContext> &draw_context, uint32_t current_frame) const {
+	void SceneAdapter::updateSceneData(const std::shared_ptr<IScene> &scene, const DrawList &draw_list, uint32_t current_frame) const {
 		size_t size = 0;
-		void* scene_data = scene->getSceneData(&size, draw_context->getEmittingObjectCount());
-		memcpy(sceneUniformBuffersMapped[current_frame], scene_data, size);
+		void* scene_data = scene->getSceneData(&size, draw_list.getEmittingObjectCount());
+		memcpy(active_resources->uniform_buffers_mapped[current_frame], scene_data, size);
+		static_cast<SceneData *>(active_resources->uniform_buffers_mapped[current_frame])->compact_vertices =
+				active_resources->geometry_manager->usesCompactVertices();
 
-		vulkan_context->descriptor_allocator->writeBuffer(2, sceneUniformBuffers[current_frame].handle, size,
-														  0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+		vulkan_context->descriptor_allocator->writeBuffer(2, active_resources->uniform_buffers[current_frame].handle,
+														  size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 		scene->getEnvironmentMap()->writeToDescriptor(vulkan_context->descriptor_allocator, defaultSamplerLinear);
 	}
@@ -218,6 +528,8 @@ namespace RtEngine {
 
 		samplerInfo.magFilter = VK_FILTER_LINEAR;
 		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 		if (vkCreateSampler(device, &samplerInfo, nullptr, &defaultSamplerLinear) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create texture sampler!");
 		}
@@ -226,8 +538,6 @@ namespace RtEngine {
 		vkGetPhysicalDeviceProperties(vulkan_context->device_manager->getPhysicalDevice(), &properties);
 		samplerInfo.anisotropyEnable = VK_TRUE;
 		samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-		samplerInfo.magFilter = VK_FILTER_NEAREST;
-		samplerInfo.minFilter = VK_FILTER_NEAREST;
 		if (vkCreateSampler(device, &samplerInfo, nullptr, &defaultSamplerAnisotropic) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create texture sampler!");
 		}
@@ -247,7 +557,7 @@ namespace RtEngine {
 		main_deletion_queue.pushFunction([&]() { defaultMaterials["phong"]->clearResources(); });
 
 		auto metal_rough_material =
-				std::make_shared<MetalRoughMaterial>(vulkan_context, texture_repository, defaultSamplerLinear);
+				std::make_shared<MetalRoughMaterial>(vulkan_context, texture_repository, defaultSamplerAnisotropic);
 		metal_rough_material->buildPipelines(scene_descriptor_set_layout);
 		metal_rough_material->pipeline->createShaderBindingTables(raytracingProperties);
 		defaultMaterials["metal_rough"] = metal_rough_material;
@@ -255,8 +565,8 @@ namespace RtEngine {
 	}
 
 	std::shared_ptr<Material> SceneAdapter::getMaterial() const {
-		if (loaded_scene != nullptr) {
-			return loaded_scene->getMaterial();
+		if (active_resources != nullptr) {
+			return active_resources->scene->getMaterial();
 		}
 		return nullptr;
 	}
@@ -266,7 +576,10 @@ namespace RtEngine {
 	}
 
 	void SceneAdapter::clearResources() {
-		scene_resource_deletion_queue.flush();
+		if (active_resources != nullptr) {
+			destroySceneResources(*active_resources);
+			active_resources = nullptr;
+		}
 		main_deletion_queue.flush();
 	}
 } // namespace RtEngine
@@ -1,9 +1,34 @@
 #include "MeshRepository.hpp"
 
+#include <AssetPack.hpp>
+#include <HashUtil.hpp>
+#include <PathUtil.hpp>
 #include <VulkanContext.hpp>
 #include <spdlog/spdlog.h>
 
 namespace RtEngine {
+	namespace {
+		// hashes the vertex attributes one by one, the padding inside of Vertex is not guaranteed to be zeroed
+		uint64_t hashMeshBuffers(const MeshBuffers &mesh_buffers) {
+			std::vector<float> attributes;
+			attributes.reserve(mesh_buffers.vertices.size() * 16);
+			for (const auto &v: mesh_buffers.vertices) {
+				attributes.insert(attributes.end(), {v.pos.x, v.pos.y, v.pos.z, v.normal.x, v.normal.y, v.normal.z,
+													 v.tangent.x, v.tangent.y, v.tangent.z, v.tangent.w, v.color.x,
+													 v.color.y, v.color.z, v.texCoord.x, v.texCoord.y, v.texCoord.z});
+			}
+			uint64_t seed = HashUtil::xxHash64(attributes.data(), attributes.size() * sizeof(float));
+			// the same triangles with other submeshes or material names reference different materials
+			for (const auto &submesh: mesh_buffers.submeshes) {
+				const uint32_t range[2] = {submesh.index_offset, submesh.index_count};
+				seed = HashUtil::xxHash64(range, sizeof(range), seed);
+				seed = HashUtil::xxHash64(submesh.material_name.data(), submesh.material_name.size(), seed);
+			}
+			return HashUtil::xxHash64(mesh_buffers.indices.data(), mesh_buffers.indices.size() * sizeof(uint32_t),
+									  seed);
+		}
+	} // namespace
+
 	MeshRepository::MeshRepository(const std::shared_ptr<VulkanContext> &context, const std::string& resource_dir) {
 		mesh_asset_builder = std::make_shared<MeshAssetBuilder>(context->device_manager->getDevice(),
 																resource_dir);
@@ -23,17 +48,96 @@ namespace RtEngine {
 			return mesh_path_cache[path]->name;
 		}
 
-		MeshAsset mesh_asset = mesh_asset_builder->loadMeshAsset(path);
+		return addMesh(path, importMesh(path, asset_pack));
+	}
+
+	std::string MeshRepository::addMesh(const std::string &path, MeshAsset mesh_asset) {
+		if (mesh_path_cache.contains(path)) {
+			spdlog::debug("Mesh cache hit with path: {}", path);
+			return mesh_path_cache[path]->name;
+		}
+
+		// a copy of an already loaded mesh becomes another name for it, the geometry is only uploaded once
+		const uint64_t content_hash = hashMeshBuffers(mesh_asset.meshBuffers);
+		if (mesh_hash_cache.contains(content_hash)) {
+			std::shared_ptr<MeshAsset> original = mesh_hash_cache[content_hash];
+			spdlog::debug("Mesh {} has the same content as {}", path, original->path);
+			original->alias_paths.push_back(path);
+			mesh_name_cache[mesh_asset.name] = original;
+			mesh_path_cache[path] = original;
+
+			dedup_stats.aliased_assets++;
+			dedup_stats.bytes_saved += mesh_asset.meshBuffers.vertices.size() * sizeof(Vertex) +
+									   mesh_asset.meshBuffers.indices.size() * sizeof(uint32_t);
+			for (const auto &lod: mesh_asset.meshBuffers.lods) {
+				dedup_stats.bytes_saved += lod.indices.size() * sizeof(uint32_t);
+			}
+			return mesh_asset.name;
+		}
+
 		mesh_name_cache[mesh_asset.name] = std::make_shared<MeshAsset>(mesh_asset);
+		mesh_name_cache[mesh_asset.name]->handle = mesh_table.insert(mesh_name_cache[mesh_asset.name]);
 		mesh_path_cache[path] = mesh_name_cache[mesh_asset.name];
+		mesh_hash_cache[content_hash] = mesh_name_cache[mesh_asset.name];
 		return mesh_asset.name;
 	}
 
+	MeshAsset MeshRepository::importMesh(const std::string &path, const std::shared_ptr<AssetPack> &pack) const {
+		MeshBuffers mesh_buffers{};
+		if (pack != nullptr && pack->readMesh(path, mesh_buffers)) {
+			return ModelLoader::createMeshAsset(path, std::move(mesh_buffers));
+		}
+		return mesh_asset_builder->loadMeshAsset(path);
+	}
+
+	std::shared_ptr<MeshAsset> MeshRepository::reloadMesh(const std::string &path) {
+		if (!mesh_path_cache.contains(path)) {
+			return nullptr;
+		}
+
+		std::shared_ptr<MeshAsset> mesh_asset = mesh_path_cache[path];
+		if (mesh_asset->path != path) {
+			spdlog::warn("Mesh {} shares its geometry with {}, reload the scene to apply the change", path,
+						 mesh_asset->path);
+			return nullptr;
+		}
+
+		// the asset keeps its name, geometry id and offsets so that everything referencing it stays valid
+		MeshAsset reloaded = mesh_asset_builder->loadMeshAsset(path);
+		mesh_asset->meshBuffers = std::move(reloaded.meshBuffers);
+		mesh_asset->vertex_count = reloaded.vertex_count;
+		mesh_asset->triangle_count = reloaded.triangle_count;
+		mesh_asset->bounds = reloaded.bounds;
+		mesh_asset->bounding_box = reloaded.bounding_box;
+
+		// on a collision the asset stays registered under its old hash so that destroy still sees it
+		const uint64_t content_hash = hashMeshBuffers(mesh_asset->meshBuffers);
+		if (!mesh_hash_cache.contains(content_hash)) {
+			std::erase_if(mesh_hash_cache, [&](const auto &entry) { return entry.second == mesh_asset; });
+			mesh_hash_cache[content_hash] = mesh_asset;
+		}
+
+		spdlog::info("Reloaded mesh {}", path);
+		return mesh_asset;
+	}
+
+	std::vector<YAML::Node> MeshRepository::loadMeshMaterials(const std::string &path) const {
+		return mesh_asset_builder->loadMaterials(path);
+	}
+
+	const DeduplicationStats &MeshRepository::getDeduplicationStats() const { return dedup_stats; }
+
+	void MeshRepository::resetDeduplicationStats() { dedup_stats = {}; }
+
+	void MeshRepository::setAssetPack(const std::shared_ptr<AssetPack> &pack) { asset_pack = pack; }
+
 	void MeshRepository::destroy() {
 		deletion_queue.flush();
 
-		for (auto &mesh: mesh_name_cache) {
+		// aliases share the asset, so every asset is destroyed once
+		for (auto &mesh: mesh_hash_cache) {
 			mesh_asset_builder->destroyMeshAsset(*mesh.second);
 		}
+		mesh_table.clear();
 	}
 } // namespace RtEngine
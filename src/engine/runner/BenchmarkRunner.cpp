@@ -27,7 +27,7 @@ namespace RtEngine {
 	void BenchmarkRunner::loadScene(const std::string &scene_path) {
 		Runner::loadScene(scene_path);
 
-		scene_manager->getCurrentScene()->update();
+		scene_manager->getCurrentScene()->update(update_flags);
 		draw_context = createMainDrawContext();
 
 		assert(draw_context->targets.size() == 1);
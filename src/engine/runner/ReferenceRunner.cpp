@@ -21,7 +21,7 @@ namespace RtEngine {
 	void ReferenceRunner::loadScene(const std::string &scene_path) {
 		Runner::loadScene(scene_path);
 
-		scene_manager->getCurrentScene()->update();
+		scene_manager->getCurrentScene()->update(update_flags);
 		draw_context = createMainDrawContext();
 
 		assert(draw_context->targets.size() == 1);
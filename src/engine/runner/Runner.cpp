@@ -1,9 +1,12 @@
 #include "../../../include/engine/runner/Runner.hpp"
 
+#include "Material.hpp"
 #include "PathUtil.hpp"
 #include "SceneWriter.hpp"
 #include "UpdateFlagValue.hpp"
 
+#include <spdlog/spdlog.h>
+
 namespace RtEngine {
     Runner::Runner(std::shared_ptr<EngineContext> engine_context,
         const std::shared_ptr<GuiRenderer> &gui_renderer, const std::shared_ptr<SceneManager> &scene_manager)
@@ -11,7 +14,9 @@ namespace RtEngine {
         gui_manager(gui_renderer), scene_manager(scene_manager) {
 
         scene_reader = std::make_shared<SceneReader>(engine_context);
+        main_draw_context = std::make_shared<DrawContext>();
         update_flags = std::make_shared<UpdateFlags>();
+        resource_watcher = std::make_shared<ResourceWatcher>(scene_manager->getResourcesDir());
     }
 
     std::string Runner::getScenePath() const {
@@ -20,32 +25,146 @@ namespace RtEngine {
 
     void Runner::loadScene(const std::string &scene_path) {
         assert(!scene_path.empty());
+        activateScene(scene_reader->prepareScene(scene_path));
+    }
 
+    void Runner::activateScene(PreparedScene prepared_scene) {
+        const std::string scene_path = prepared_scene.path;
         std::shared_ptr<Scene> old_scene = scene_manager->getCurrentScene(); // hold until it can be safely destroyed
-        std::shared_ptr<Scene> new_scene = scene_reader->readScene(scene_path, renderer->getMaterials());
-        scene_manager->setScene(new_scene);
+        std::shared_ptr<Scene> new_scene = scene_reader->readScene(std::move(prepared_scene), renderer->getMaterials());
 
-        renderer->waitForIdle();
-        if (old_scene != nullptr) {
-            old_scene->destroy();
+        // the mesh renderers take their draw list and material from the current scene when they start, and the gpu
+        // resources are built from the started scene. starting only touches the cpu side, the renderer waits for
+        // the device itself when it swaps the resources
+        std::shared_ptr<SceneResources> old_resources;
+        scene_manager->setScene(new_scene);
+        try {
+            new_scene->start();
+            old_resources = renderer->loadScene(new_scene);
+        } catch (const std::exception &) {
+            // the renderer still shows the old scene with its resources
+            new_scene->destroy();
+            scene_manager->setScene(old_scene);
+            throw;
         }
-        new_scene->start();
-        renderer->loadScene(new_scene);
+        retireScene(old_scene, old_resources);
 
         SceneWriter writer;
         writer.writeScene(PathUtil::getFileName(scene_path), new_scene);
+
+        // changes made before the scene was loaded are already part of it
+        resource_watcher->poll();
+    }
+
+    void Runner::activateCachedScene(CachedScene cached_scene) {
+        spdlog::info("Switching to cached scene {}", cached_scene.scene->path);
+        std::shared_ptr<Scene> old_scene = scene_manager->getCurrentScene();
+        scene_manager->setScene(cached_scene.scene);
+        retireScene(old_scene, renderer->activateSceneResources(cached_scene.resources));
+
+        // the cached tlas, instance buffers and draw list still match the scene, only the image starts over
+        update_flags->setFlag(TARGET_RESET);
+    }
+
+    // the replaced scene stays resident for switching back, a reload of the same scene drops it
+    void Runner::retireScene(const std::shared_ptr<Scene> &old_scene,
+                             const std::shared_ptr<SceneResources> &old_resources) {
+        if (old_scene == nullptr) {
+            renderer->destroySceneResources(old_resources);
+            return;
+        }
+        if (old_resources == nullptr || cached_scene_count == 0 ||
+            old_scene->path == scene_manager->getCurrentScene()->path) {
+            old_scene->destroy();
+            renderer->destroySceneResources(old_resources);
+            return;
+        }
+        const CachedScene cached_scene{old_scene, old_resources, old_resources->getDeviceMemorySize()};
+        destroyCachedScenes(scene_manager->cacheScene(cached_scene));
+    }
+
+    void Runner::destroyCachedScenes(const std::vector<CachedScene> &cached_scenes) const {
+        for (const auto &cached_scene : cached_scenes) {
+            cached_scene.scene->destroy();
+            renderer->destroySceneResources(cached_scene.resources);
+        }
+    }
+
+    void Runner::clearSceneCache() {
+        destroyCachedScenes(scene_manager->clearSceneCache());
+    }
+
+    void Runner::startSceneLoad(const std::string &scene_path) {
+        assert(!scene_path.empty());
+
+        // the current scene is rendered as it is until the new one replaces it
+        update_flags->clearFlag(SCENE_UPDATE);
+        update_flags->clearFlag(STATIC_GEOMETRY_UPDATE);
+        update_flags->clearFlag(MATERIAL_UPDATE);
+
+        if (pending_scene.valid()) {
+            queued_scene_path = scene_path;
+            return;
+        }
+
+        CachedScene cached_scene;
+        if (scene_path != getScenePath() && scene_manager->takeCachedScene(scene_path, &cached_scene)) {
+            // the vertex layout is baked into the cached buffers
+            if (cached_scene.resources->geometry_manager->usesCompactVertices() == renderer->usesCompactVertices()) {
+                activateCachedScene(std::move(cached_scene));
+                return;
+            }
+            destroyCachedScenes({cached_scene});
+        }
+        spdlog::info("Loading {} in the background", scene_path);
+        pending_scene = std::async(std::launch::async, [scene_reader = scene_reader, scene_path]() {
+            return scene_reader->prepareScene(scene_path);
+        });
+    }
+
+    void Runner::finishSceneLoad() {
+        if (!pending_scene.valid() ||
+            pending_scene.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        try {
+            PreparedScene prepared_scene = pending_scene.get();
+            if (queued_scene_path.empty()) {
+                // the materials were uploaded with the resources, the tlas is built with the next update
+                activateScene(std::move(prepared_scene));
+                update_flags->setFlag(STATIC_GEOMETRY_UPDATE);
+            }
+        } catch (const std::exception &e) {
+            spdlog::error("Failed to load scene, keeping {}: {}", getScenePath(), e.what());
+        }
+
+        if (!queued_scene_path.empty()) {
+            const std::string scene_path = queued_scene_path;
+            queued_scene_path.clear();
+            startSceneLoad(scene_path);
+        }
     }
 
     void Runner::renderScene() {
         if (update_flags->checkFlag(SCENE_UPDATE)) {
-            loadScene(scene_manager->getScenePath(scene_name));
+            if (scene_manager->getCurrentScene() == nullptr) {
+                loadScene(scene_manager->getScenePath(scene_name));
+            } else {
+                startSceneLoad(scene_manager->getScenePath(scene_name));
+            }
+        } else if (!pending_scene.valid()) {
+            // the loader thread reads the repositories, so nothing is reloaded into them while it runs
+            reloadChangedResources();
         }
+        finishSceneLoad();
 
-        scene_manager->getCurrentScene()->update();
-        std::shared_ptr<DrawContext> draw_context = createMainDrawContext();
-        if (draw_context->targets.size() < 1)
+        scene_manager->getCurrentScene()->update(update_flags);
+        // refilled every frame, only the cameras are visited
+        scene_manager->getCurrentScene()->fillDrawContext(main_draw_context);
+        if (main_draw_context->targets.size() < 1)
             return;
-        drawFrame(draw_context);
+        drawFrame(main_draw_context);
     }
 
     void Runner::drawFrame(const std::shared_ptr<DrawContext>& draw_context) {
@@ -99,6 +218,57 @@ namespace RtEngine {
         gui_manager->updateWindows();
     }
 
+    // applies changed files to the loaded scene without reloading it
+    void Runner::reloadChangedResources() {
+        const std::vector<std::string> changed_paths = resource_watcher->poll();
+        if (changed_paths.empty()) {
+            return;
+        }
+
+        // resources are swapped in place, so nothing may still be using them
+        renderer->waitForIdle();
+        const std::string scene_path = scene_manager->getCurrentScene()->path;
+        for (const auto &path : changed_paths) {
+            try {
+                if (scene_manager->getResourcesDir() + "/" + path == scene_path) {
+                    reloadSceneMaterials();
+                    update_flags->setFlag(MATERIAL_PATCH);
+                } else if (engine_context->texture_repository->reloadTexture(path)) {
+                    update_flags->setFlag(MATERIAL_PATCH);
+                } else if (auto mesh_asset = engine_context->mesh_repository->reloadMesh(path)) {
+                    renderer->reloadMeshGeometry(mesh_asset);
+                    scene_manager->getCurrentScene()->markMeshesReloaded();
+                    // cached scenes may still point at the geometry of the old mesh
+                    clearSceneCache();
+                    update_flags->setFlag(STATIC_GEOMETRY_UPDATE);
+                }
+            } catch (const std::exception &e) {
+                spdlog::error("Failed to reload {}: {}", path, e.what());
+            }
+        }
+    }
+
+    // only the material instances are taken over, structural changes need a full scene reload
+    void Runner::reloadSceneMaterials() {
+        const std::shared_ptr<Scene> scene = scene_manager->getCurrentScene();
+        if (PathUtil::getExtension(scene->path) != "yaml") {
+            return;
+        }
+
+        YAML::Node material_nodes = YAML::LoadFile(scene->path)["scene"]["materials"];
+        std::shared_ptr<Material> material = scene->getMaterial();
+        for (const auto &material_node : material_nodes) {
+            const std::shared_ptr<MaterialInstance> instance =
+                    material->getInstanceByName(material_node["name"].as<std::string>());
+            if (instance != nullptr) {
+                instance->loadResources(material_node);
+            } else {
+                material->loadInstance(material_node);
+            }
+        }
+        spdlog::info("Reloaded materials of {}", scene->path);
+    }
+
     std::shared_ptr<DrawContext> Runner::createMainDrawContext() const {
         auto draw_context = std::make_shared<DrawContext>();
         scene_manager->getCurrentScene()->fillDrawContext(draw_context);
@@ -109,6 +279,14 @@ namespace RtEngine {
         update_flags->setFlags(new_flags);
     }
 
+    void Runner::waitForSceneLoad() {
+        queued_scene_path.clear();
+        if (pending_scene.valid()) {
+            pending_scene.wait();
+            pending_scene = {};
+        }
+    }
+
     bool Runner::isRunning() const {
         return running;
     }
@@ -118,7 +296,16 @@ namespace RtEngine {
             if (config->addSelection("scene_name", &scene_name, scene_manager->getSceneNames())) {
                 update_flags->setFlag(SCENE_UPDATE);
             }
+            config->addUint("cached_scene_count", &cached_scene_count, 0, 8);
+            config->addFloat("scene_cache_budget_mb", &scene_cache_budget_mb, 0.0f, 16384.0f);
             config->endChild();
         }
+
+        const std::vector<CachedScene> evicted_scenes = scene_manager->setSceneCacheBudget(
+                cached_scene_count, static_cast<size_t>(scene_cache_budget_mb) * 1024 * 1024);
+        if (!evicted_scenes.empty()) {
+            renderer->waitForIdle();
+            destroyCachedScenes(evicted_scenes);
+        }
     }
 } // RtEngine
\ No newline at end of file
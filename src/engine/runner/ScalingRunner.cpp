@@ -0,0 +1,184 @@
+#include "ScalingRunner.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "UpdateFlagValue.hpp"
+
+namespace RtEngine {
+	namespace {
+		using Clock = std::chrono::high_resolution_clock;
+
+		double millisecondsSince(Clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+	} // namespace
+
+	ScalingRunner::ScalingRunner(const std::shared_ptr<EngineContext> &engine_context,
+								 const std::shared_ptr<GuiRenderer> &gui_renderer,
+								 const std::shared_ptr<SceneManager> &scene_manager, const std::string &tag) :
+		Runner(engine_context, gui_renderer, scene_manager), tag(tag) {
+		// one dimension is swept at a time, the others stay at the base case
+		const StressSceneParameters base{10000, 16, 16, 8};
+		for (uint32_t instance_count: {1000u, 10000u, 100000u, 1000000u}) {
+			StressSceneParameters parameters = base;
+			parameters.instance_count = instance_count;
+			sweep.push_back(parameters);
+		}
+		for (uint32_t unique_mesh_count: {1u, 64u, 256u}) {
+			StressSceneParameters parameters = base;
+			parameters.unique_mesh_count = unique_mesh_count;
+			sweep.push_back(parameters);
+		}
+		for (uint32_t emitter_count: {1u, 256u, 4096u}) {
+			StressSceneParameters parameters = base;
+			parameters.emitter_count = emitter_count;
+			sweep.push_back(parameters);
+		}
+		for (uint32_t texture_count: {0u, 32u, 128u}) {
+			StressSceneParameters parameters = base;
+			parameters.texture_count = texture_count;
+			sweep.push_back(parameters);
+		}
+	}
+
+	// same as Runner::loadScene without writing the scene back, only the cpu side is timed here
+	void ScalingRunner::loadScene(const std::string &scene_path) {
+		const auto start = Clock::now();
+		std::shared_ptr<Scene> old_scene = scene_manager->getCurrentScene();
+		std::shared_ptr<Scene> new_scene = scene_reader->readScene(scene_path, renderer->getMaterials());
+		scene_manager->setScene(new_scene);
+
+		renderer->waitForIdle();
+		if (old_scene != nullptr) {
+			old_scene->destroy();
+		}
+		new_scene->start();
+		current_result.load_ms = millisecondsSince(start);
+
+		// every case is a new stress scene, so nothing is kept for switching back
+		renderer->destroySceneResources(renderer->loadScene(new_scene));
+		current_result.geometry_ms = renderer->getBuildTimings().geometry_ms;
+		update_flags->setFlag(SCENE_UPDATE);
+	}
+
+	void ScalingRunner::renderScene() {
+		if (case_frame == 0) {
+			startCase();
+		}
+
+		// the previous frame of this slot is done afterwards, so neither its gpu time nor the wait end up in the
+		// cpu measurement
+		renderer->waitForNextFrameStart();
+		const bool measured = case_frame > WARMUP_FRAMES;
+		const double gpu_frame_ms = renderer->getLastGpuFrameTime();
+		if (measured && gpu_frame_ms >= 0.0) {
+			current_result.gpu_frame_ms += gpu_frame_ms;
+			gpu_frame_count++;
+		}
+
+		const auto start = Clock::now();
+		if (case_frame > 0) {
+			moveInstances();
+		}
+		const std::shared_ptr<Scene> scene = scene_manager->getCurrentScene();
+		scene->update(update_flags);
+		scene->fillDrawContext(main_draw_context);
+		renderer->updateSceneRepresentation(main_draw_context, update_flags);
+		const double update_ms = millisecondsSince(start);
+		update_flags->resetFlags();
+
+		if (case_frame == 0) {
+			current_result.tlas_build_ms = renderer->getBuildTimings().tlas_build_ms;
+			current_result.device_memory_mb =
+					static_cast<double>(renderer->getAllocatedDeviceMemory()) / (1024.0 * 1024.0);
+		} else if (case_frame >= WARMUP_FRAMES && case_frame < WARMUP_FRAMES + MEASURED_FRAMES) {
+			current_result.cpu_update_ms += update_ms;
+			current_result.tlas_refit_ms += renderer->getBuildTimings().tlas_refit_ms;
+		}
+
+		drawFrame(main_draw_context);
+
+		case_frame++;
+		if (case_frame > WARMUP_FRAMES + MEASURED_FRAMES) {
+			finishCase();
+		}
+	}
+
+	// the scene representation was already updated inside of the timed part of renderScene
+	void ScalingRunner::prepareFrame(VkCommandBuffer cmd, const std::shared_ptr<DrawContext> &draw_context) {
+		renderer->recordBeginCommandBuffer(cmd);
+	}
+
+	void ScalingRunner::startCase() {
+		const StressSceneParameters &parameters = sweep[current_case];
+		spdlog::info("Scaling case {}/{}: {}", current_case + 1, sweep.size(), parameters.getSceneName());
+
+		current_result = {};
+		current_result.parameters = parameters;
+		gpu_frame_count = 0;
+		const std::string scene_path =
+				StressSceneGenerator(scene_manager->getResourcesDir(), TMP_FOLDER + "/scenes").generate(parameters);
+		loadScene(scene_path);
+
+		for (const auto &instance_array: scene_manager->getCurrentScene()->getInstanceArrays()) {
+			current_result.triangle_count += instance_array->size() * instance_array->getMeshAsset()->triangle_count;
+		}
+	}
+
+	void ScalingRunner::finishCase() {
+		current_result.cpu_update_ms /= MEASURED_FRAMES;
+		current_result.tlas_refit_ms /= MEASURED_FRAMES;
+		current_result.gpu_frame_ms /= std::max(gpu_frame_count, 1u);
+		results.push_back(current_result);
+
+		spdlog::info("  load {:.1f} ms, geometry {:.1f} ms, tlas {:.2f} ms, update {:.3f} ms, gpu {:.3f} ms, {:.1f} MB",
+					 current_result.load_ms, current_result.geometry_ms, current_result.tlas_build_ms,
+					 current_result.cpu_update_ms, current_result.gpu_frame_ms, current_result.device_memory_mb);
+
+		case_frame = 0;
+		current_case++;
+		if (current_case == sweep.size()) {
+			writeResults();
+			running = false;
+		}
+	}
+
+	void ScalingRunner::moveInstances() {
+		std::uniform_real_distribution<float> offset(-0.05f, 0.05f);
+		for (const auto &instance_array: scene_manager->getCurrentScene()->getInstanceArrays()) {
+			const auto moving_count = static_cast<uint32_t>(instance_array->size() * MOVING_FRACTION);
+			for (uint32_t i = 0; i < moving_count; i++) {
+				const uint32_t instance = std::uniform_int_distribution<uint32_t>(0, instance_array->size() - 1)(random);
+				const glm::vec3 translation(offset(random), 0.0f, offset(random));
+				instance_array->setTransform(instance, glm::translate(glm::mat4(1.0f), translation) *
+															   instance_array->getTransforms()[instance]);
+			}
+		}
+	}
+
+	void ScalingRunner::writeResults() const {
+		const std::string output_dir = scene_manager->getResourcesDir() + "/benchmarks";
+		std::filesystem::create_directories(output_dir);
+		const std::string output_path = std::format("{}/scaling_{}.csv", output_dir, tag);
+
+		std::ofstream out(output_path);
+		if (!out) {
+			throw std::runtime_error("Failed to open CSV file " + output_path);
+		}
+		out << "instances,unique_meshes,emitters,textures,triangles,load_ms,geometry_ms,tlas_build_ms,cpu_update_ms,"
+			   "tlas_refit_ms,gpu_frame_ms,device_memory_mb\n";
+		for (const auto &result: results) {
+			const StressSceneParameters &parameters = result.parameters;
+			out << std::format("{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.1f}\n",
+							   parameters.instance_count, parameters.unique_mesh_count, parameters.emitter_count,
+							   parameters.texture_count, result.triangle_count, result.load_ms, result.geometry_ms,
+							   result.tlas_build_ms, result.cpu_update_ms, result.tlas_refit_ms, result.gpu_frame_ms,
+							   result.device_memory_mb);
+		}
+		SPDLOG_INFO("Saved scaling table to {}!", output_path);
+	}
+} // namespace RtEngine
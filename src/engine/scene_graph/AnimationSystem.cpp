@@ -0,0 +1,181 @@
+#include "AnimationSystem.hpp"
+
+#include <ComponentPools.hpp>
+#include <Material.hpp>
+#include <Node.hpp>
+#include <cmath>
+#include <spdlog/spdlog.h>
+
+namespace RtEngine {
+	AnimationSystem::~AnimationSystem() { detach(); }
+
+	void AnimationSystem::rebuild(const ComponentPools &component_pools, const std::shared_ptr<Material> &material) {
+		detach();
+		key_times.clear();
+		key_values.clear();
+		first_keys.clear();
+		key_counts.clear();
+		step_interpolation.clear();
+		looping.clear();
+		track_targets.clear();
+		transforms.clear();
+		material_instances.clear();
+		parameters.clear();
+		animations.clear();
+		this->material = material;
+
+		const ComponentPool &animation_pool = component_pools.getPool<Animation>();
+		for (size_t i = 0; i < animation_pool.components.size(); i++) {
+			auto *animation = static_cast<Animation *>(animation_pool.components[i].get());
+			Node *node = animation_pool.nodes[i];
+			animation->attachToAnimations(this, static_cast<uint32_t>(track_targets.size()));
+			animations.push_back(animation);
+
+			for (const auto &track: animation->getTracks()) {
+				// tracks without a target keep their slot so the track range of the component stays contiguous
+				MaterialInstanceHandle material_instance;
+				int32_t parameter = -1;
+				if (track.target == AnimationTarget::MATERIAL) {
+					std::shared_ptr<MaterialInstance> instance =
+							material ? material->getInstanceByName(track.material_instance_name) : nullptr;
+					if (instance == nullptr) {
+						spdlog::warn("Animation of {} refers to unknown material instance {}", node->name,
+									 track.material_instance_name);
+					} else if ((parameter = instance->findParameter(track.parameter)) < 0) {
+						spdlog::warn("Animation of {} refers to unknown parameter {} of {}", node->name,
+									 track.parameter, track.material_instance_name);
+					} else {
+						material_instance = instance->handle;
+					}
+				}
+
+				first_keys.push_back(static_cast<uint32_t>(key_times.size()));
+				key_counts.push_back(static_cast<uint32_t>(track.times.size()));
+				key_times.insert(key_times.end(), track.times.begin(), track.times.end());
+				key_values.insert(key_values.end(), track.values.begin(), track.values.end());
+				step_interpolation.push_back(track.step_interpolation);
+				looping.push_back(animation->isLooping());
+				track_targets.push_back(track.target);
+				transforms.push_back(node->transform.get());
+				material_instances.push_back(material_instance);
+				parameters.push_back(parameter);
+			}
+		}
+
+		const size_t track_count = track_targets.size();
+		key_cursors.assign(track_count, 0);
+		samples.assign(track_count, glm::vec4(0.0f));
+		written_samples.assign(track_count, glm::vec4(0.0f));
+		written.assign(track_count, 0);
+		valid = true;
+	}
+
+	void AnimationSystem::setLooping(uint32_t first_track, uint32_t track_count, bool loop) {
+		for (uint32_t i = first_track; i < first_track + track_count; i++) {
+			looping[i] = loop;
+		}
+	}
+
+	UpdateFlagValue AnimationSystem::apply(double time) {
+		written_count = 0;
+		if (track_targets.empty()) {
+			return NO_UPDATE;
+		}
+
+		sample(time);
+
+		// tracks that hold their value leave their target alone, so resting objects are not moved in the tlas
+		bool material_changed = false;
+		bool emitters_changed = false;
+		for (size_t i = 0; i < track_targets.size(); i++) {
+			if (written[i] && samples[i] == written_samples[i]) {
+				continue;
+			}
+
+			const glm::vec3 value(samples[i]);
+			switch (track_targets[i]) {
+				case AnimationTarget::POSITION:
+					transforms[i]->decomposed_transform.translation = value;
+					transforms[i]->markDirty();
+					break;
+				case AnimationTarget::ROTATION:
+					transforms[i]->decomposed_transform.rotation = value;
+					transforms[i]->markDirty();
+					break;
+				case AnimationTarget::SCALE:
+					transforms[i]->decomposed_transform.scale = value;
+					transforms[i]->markDirty();
+					break;
+				case AnimationTarget::MATERIAL: {
+					MaterialInstance *instance = material ? material->getInstance(material_instances[i]) : nullptr;
+					if (instance == nullptr) {
+						continue;
+					}
+					// the emitting instances only list emitting submeshes, everything else is a plain value
+					const bool was_emitting = instance->getEmissionPower() > 0.0f;
+					instance->setParameter(parameters[i], samples[i]);
+					emitters_changed |= was_emitting != (instance->getEmissionPower() > 0.0f);
+					material_changed = true;
+					break;
+				}
+			}
+			written_samples[i] = samples[i];
+			written[i] = 1;
+			written_count++;
+		}
+		if (emitters_changed) {
+			return MATERIAL_PATCH;
+		}
+		return material_changed ? MATERIAL_VALUES : NO_UPDATE;
+	}
+
+	void AnimationSystem::sample(double time) {
+		const auto track_count = static_cast<int64_t>(track_targets.size());
+#pragma omp parallel for schedule(static) if (track_count >= PARALLEL_BATCH_SIZE)
+		for (int64_t i = 0; i < track_count; i++) {
+			const uint32_t first = first_keys[i], count = key_counts[i];
+			const float *times = key_times.data() + first;
+			const glm::vec4 *values = key_values.data() + first;
+
+			const float duration = times[count - 1];
+			float t = static_cast<float>(time);
+			if (looping[i] && duration > 0.0f) {
+				t = static_cast<float>(std::fmod(time, static_cast<double>(duration)));
+			}
+
+			if (t <= times[0] || count == 1) {
+				key_cursors[i] = 0;
+				samples[i] = values[0];
+				continue;
+			}
+			if (t >= times[count - 1]) {
+				key_cursors[i] = count - 1;
+				samples[i] = values[count - 1];
+				continue;
+			}
+
+			// times[0] < t < times[count - 1], so the cursor ends up on a key with a successor
+			uint32_t key = key_cursors[i];
+			if (times[key] > t) {
+				key = 0;
+			}
+			while (times[key + 1] <= t) {
+				key++;
+			}
+			key_cursors[i] = key;
+
+			if (step_interpolation[i]) {
+				samples[i] = values[key];
+			} else {
+				const float alpha = (t - times[key]) / (times[key + 1] - times[key]);
+				samples[i] = glm::mix(values[key], values[key + 1], alpha);
+			}
+		}
+	}
+
+	void AnimationSystem::detach() {
+		for (Animation *animation: animations) {
+			animation->attachToAnimations(nullptr, 0);
+		}
+	}
+} // namespace RtEngine
@@ -0,0 +1,40 @@
+#include "ComponentPools.hpp"
+
+#include <Node.hpp>
+
+namespace RtEngine {
+	void ComponentPools::rebuild(const std::shared_ptr<Node> &root) {
+		for (auto &pool: pools) {
+			pool.components.clear();
+			pool.nodes.clear();
+		}
+
+		// depth first in child order, the order the recursive scene traversals used to visit components in
+		std::vector<Node *> stack;
+		if (root) {
+			stack.push_back(root.get());
+		}
+		while (!stack.empty()) {
+			Node *node = stack.back();
+			stack.pop_back();
+
+			for (auto &component: node->components) {
+				const uint32_t type_id = ComponentTypeId::of(*component);
+				if (type_id >= pools.size()) {
+					pools.resize(type_id + 1);
+				}
+				pools[type_id].components.push_back(component);
+				pools[type_id].nodes.push_back(node);
+			}
+			for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+				stack.push_back(it->get());
+			}
+		}
+
+		for (auto &pool: pools) {
+			pool.parallel_update = !pool.components.empty() && pool.components.front()->hasParallelUpdate();
+			pool.system_driven = !pool.components.empty() && pool.components.front()->isSystemDriven();
+		}
+		valid = true;
+	}
+} // namespace RtEngine
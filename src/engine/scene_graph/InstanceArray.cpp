@@ -0,0 +1,71 @@
+#include "InstanceArray.hpp"
+
+#include <InstanceBvh.hpp>
+#include <MeshRenderer.hpp>
+#include <cassert>
+
+namespace RtEngine {
+	void InstanceArray::start(const std::shared_ptr<DrawList> &scene_draw_list) {
+		mesh_asset = context->mesh_repository->getMesh(mesh_asset_name);
+		if (mesh_asset == nullptr) {
+			throw std::runtime_error("Mesh '" + mesh_asset_name + "' of instance array '" + name + "' does not exist");
+		}
+		resolveSubmeshMaterials();
+
+		draw_list = scene_draw_list;
+		assert(draw_list != nullptr);
+
+		// every copy shares everything but the transform
+		RenderObject render_object = MeshRenderer::buildRenderObject(*mesh_asset, submesh_materials, glm::mat4(1.0f));
+		draw_handles.reserve(transforms.size());
+		for (const auto &transform: transforms) {
+			render_object.transform = transform;
+			draw_handles.push_back(draw_list->add(render_object));
+		}
+	}
+
+	void InstanceArray::destroy() {
+		for (uint32_t draw_handle: draw_handles) {
+			draw_list->remove(draw_handle);
+		}
+		draw_handles.clear();
+		draw_list = nullptr;
+	}
+
+	void InstanceArray::refreshRenderObjects() {
+		if (draw_handles.empty()) {
+			return;
+		}
+
+		// a hot reload may change the submeshes of the mesh
+		if (submesh_materials.size() != mesh_asset->meshBuffers.submeshes.size()) {
+			resolveSubmeshMaterials();
+		}
+		RenderObject render_object = MeshRenderer::buildRenderObject(*mesh_asset, submesh_materials, glm::mat4(1.0f));
+		for (size_t i = 0; i < draw_handles.size(); i++) {
+			render_object.transform = transforms[i];
+			draw_list->update(draw_handles[i], render_object);
+		}
+	}
+
+	void InstanceArray::setTransform(uint32_t instance, const glm::mat4 &transform) {
+		assert(instance < transforms.size());
+		transforms[instance] = transform;
+		if (!draw_handles.empty()) {
+			draw_list->setTransform(draw_handles[instance], transform);
+		}
+		if (bvh != nullptr) {
+			bvh->markEntryMoved(first_entry + instance);
+		}
+	}
+
+	void InstanceArray::attachToBvh(InstanceBvh *bvh, uint32_t first_entry) {
+		this->bvh = bvh;
+		this->first_entry = first_entry;
+	}
+
+	void InstanceArray::resolveSubmeshMaterials() {
+		submesh_materials = MeshRenderer::findSubmeshMaterials(context->scene_manager->getCurrentMaterial(),
+																*mesh_asset, mesh_asset_name, material_instance_name);
+	}
+} // namespace RtEngine
@@ -0,0 +1,347 @@
+#include "InstanceBvh.hpp"
+
+#include <ComponentPools.hpp>
+#include <InstanceArray.hpp>
+#include <MeshRenderer.hpp>
+#include <Transform.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+
+namespace RtEngine {
+	namespace {
+		// distances at which the ray enters and leaves the box, the box is missed if the first is behind the second
+		void intersectRay(const Aabb &box, const glm::vec3 &origin, const glm::vec3 &inverse_direction, float *t_near,
+						  float *t_far) {
+			const glm::vec3 t0 = (box.min - origin) * inverse_direction;
+			const glm::vec3 t1 = (box.max - origin) * inverse_direction;
+			const glm::vec3 t_min = glm::min(t0, t1), t_max = glm::max(t0, t1);
+			*t_near = std::max(std::max(t_min.x, t_min.y), t_min.z);
+			*t_far = std::min(std::min(t_max.x, t_max.y), t_max.z);
+		}
+
+		// a median split never gets deeper than this for 2^32 entries
+		constexpr size_t MAX_STACK_SIZE = 64;
+	} // namespace
+
+	InstanceBvh::~InstanceBvh() { detach(); }
+
+	void InstanceBvh::rebuild(const ComponentPools &component_pools,
+							  const std::vector<std::shared_ptr<InstanceArray>> &instance_arrays) {
+		detach();
+		entries.clear();
+		node_entries.clear();
+		this->instance_arrays.clear();
+
+		const ComponentPool &renderer_pool = component_pools.getPool<MeshRenderer>();
+		for (size_t i = 0; i < renderer_pool.components.size(); i++) {
+			auto *mesh_renderer = static_cast<MeshRenderer *>(renderer_pool.components[i].get());
+			Node *node = renderer_pool.nodes[i];
+			if (!mesh_renderer->mesh_asset || mesh_renderer->mesh_asset->bounding_box.isEmpty()) {
+				continue;
+			}
+			if (node->id >= node_entries.size()) {
+				node_entries.resize(node->id + 1, NO_ENTRY);
+			}
+			node_entries[node->id] = static_cast<uint32_t>(entries.size());
+
+			Entry entry;
+			entry.instance.node = node->id;
+			entry.local_bounds = mesh_renderer->mesh_asset->bounding_box;
+			entry.transform = node->transform.get();
+			entries.push_back(entry);
+		}
+
+		for (size_t a = 0; a < instance_arrays.size(); a++) {
+			InstanceArray *instance_array = instance_arrays[a].get();
+			this->instance_arrays.push_back(instance_array);
+			const std::shared_ptr<MeshAsset> mesh_asset = instance_array->getMeshAsset();
+			if (!mesh_asset || mesh_asset->bounding_box.isEmpty()) {
+				continue;
+			}
+			instance_array->attachToBvh(this, static_cast<uint32_t>(entries.size()));
+
+			Entry entry;
+			entry.instance.instance_array = static_cast<uint32_t>(a);
+			entry.local_bounds = mesh_asset->bounding_box;
+			entry.instance_array = instance_array;
+			for (uint32_t i = 0; i < instance_array->size(); i++) {
+				entry.instance.instance = i;
+				entries.push_back(entry);
+			}
+		}
+
+		entry_bounds.resize(entries.size());
+		for (size_t i = 0; i < entries.size(); i++) {
+			entry_bounds[i] = computeEntryBounds(entries[i]);
+		}
+		moved_entries.clear();
+		entry_moved.assign(entries.size(), 0);
+
+		build();
+		valid = true;
+	}
+
+	void InstanceBvh::markNodeMoved(NodeId node) {
+		if (node < node_entries.size() && node_entries[node] != NO_ENTRY) {
+			markEntryMoved(node_entries[node]);
+		}
+	}
+
+	void InstanceBvh::markEntryMoved(uint32_t entry) {
+		assert(entry < entries.size());
+		if (!entry_moved[entry]) {
+			entry_moved[entry] = 1;
+			moved_entries.push_back(entry);
+		}
+	}
+
+	void InstanceBvh::refit() {
+		if (moved_entries.empty()) {
+			return;
+		}
+
+		for (uint32_t entry: moved_entries) {
+			entry_bounds[entry] = computeEntryBounds(entries[entry]);
+			entry_moved[entry] = 0;
+		}
+
+		moves_since_check += moved_entries.size();
+		if (moves_since_check < entries.size() &&
+			static_cast<double>(moved_entries.size()) < PARTIAL_REFIT_FRACTION * static_cast<double>(entries.size())) {
+			for (uint32_t entry: moved_entries) {
+				refitLeaf(entry_leaves[entry]);
+			}
+		} else {
+			refitAll();
+			// scattered moves can stretch the nodes far beyond their content
+			if (computeNodeArea() > REBUILD_AREA_FACTOR * built_node_area) {
+				build();
+			}
+			moves_since_check = 0;
+		}
+		moved_entries.clear();
+	}
+
+	bool InstanceBvh::pick(const glm::vec3 &origin, const glm::vec3 &direction, InstancePick *hit) const {
+		if (bvh_nodes.empty()) {
+			return false;
+		}
+
+		const glm::vec3 inverse_direction = 1.0f / direction;
+		float closest = std::numeric_limits<float>::max();
+		uint32_t closest_entry = NO_ENTRY;
+
+		std::array<uint32_t, MAX_STACK_SIZE> stack;
+		size_t stack_size = 0;
+		float t_near, t_far;
+		intersectRay(bvh_nodes[0].bounds, origin, inverse_direction, &t_near, &t_far);
+		if (t_far >= std::max(t_near, 0.0f)) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size > 0) {
+			const BvhNode &node = bvh_nodes[stack[--stack_size]];
+			intersectRay(node.bounds, origin, inverse_direction, &t_near, &t_far);
+			// the node may have been pushed before a closer hit was found
+			if (std::max(t_near, 0.0f) >= closest) {
+				continue;
+			}
+
+			if (node.isLeaf()) {
+				for (uint32_t k = node.first; k < node.first + node.count; k++) {
+					const uint32_t entry = entry_order[k];
+					intersectRay(entry_bounds[entry], origin, inverse_direction, &t_near, &t_far);
+					if (t_far < std::max(t_near, 0.0f)) {
+						continue;
+					}
+					const float distance = t_near >= 0.0f ? t_near : t_far;
+					if (distance < closest) {
+						closest = distance;
+						closest_entry = entry;
+					}
+				}
+				continue;
+			}
+
+			// the nearer child goes on top, so its hits prune the other one
+			float near_a, far_a, near_b, far_b;
+			intersectRay(bvh_nodes[node.first].bounds, origin, inverse_direction, &near_a, &far_a);
+			intersectRay(bvh_nodes[node.first + 1].bounds, origin, inverse_direction, &near_b, &far_b);
+			const bool hit_a = far_a >= std::max(near_a, 0.0f) && std::max(near_a, 0.0f) < closest;
+			const bool hit_b = far_b >= std::max(near_b, 0.0f) && std::max(near_b, 0.0f) < closest;
+			if (hit_a && hit_b) {
+				const bool a_first = near_a <= near_b;
+				stack[stack_size++] = a_first ? node.first + 1 : node.first;
+				stack[stack_size++] = a_first ? node.first : node.first + 1;
+			} else if (hit_a) {
+				stack[stack_size++] = node.first;
+			} else if (hit_b) {
+				stack[stack_size++] = node.first + 1;
+			}
+			assert(stack_size <= MAX_STACK_SIZE - 2);
+		}
+
+		if (closest_entry == NO_ENTRY) {
+			return false;
+		}
+		hit->instance = entries[closest_entry].instance;
+		hit->distance = closest;
+		return true;
+	}
+
+	void InstanceBvh::queryBox(const Aabb &box, std::vector<InstanceRef> &instances) const {
+		if (bvh_nodes.empty() || !box.overlaps(bvh_nodes[0].bounds)) {
+			return;
+		}
+
+		std::array<uint32_t, MAX_STACK_SIZE> stack;
+		size_t stack_size = 0;
+		stack[stack_size++] = 0;
+		while (stack_size > 0) {
+			const BvhNode &node = bvh_nodes[stack[--stack_size]];
+			if (node.isLeaf()) {
+				for (uint32_t k = node.first; k < node.first + node.count; k++) {
+					if (box.overlaps(entry_bounds[entry_order[k]])) {
+						instances.push_back(entries[entry_order[k]].instance);
+					}
+				}
+				continue;
+			}
+			for (uint32_t child = node.first; child < node.first + 2; child++) {
+				if (box.overlaps(bvh_nodes[child].bounds)) {
+					stack[stack_size++] = child;
+				}
+			}
+			assert(stack_size <= MAX_STACK_SIZE - 2);
+		}
+	}
+
+	const Aabb &InstanceBvh::getBounds() const {
+		static const Aabb empty_bounds;
+		return bvh_nodes.empty() ? empty_bounds : bvh_nodes[0].bounds;
+	}
+
+	void InstanceBvh::build() {
+		bvh_nodes.clear();
+		entry_order.resize(entries.size());
+		entry_leaves.resize(entries.size());
+		if (entries.empty()) {
+			return;
+		}
+		for (uint32_t i = 0; i < entry_order.size(); i++) {
+			entry_order[i] = i;
+		}
+
+		std::vector<glm::vec3> centers(entries.size());
+		for (size_t i = 0; i < entries.size(); i++) {
+			centers[i] = entry_bounds[i].getCenter();
+		}
+
+		// splits at the median center along the longest axis of the centers, which keeps the depth logarithmic
+		struct Range {
+			uint32_t node, begin, end;
+		};
+		std::vector<Range> ranges{{0, 0, static_cast<uint32_t>(entries.size())}};
+		bvh_nodes.reserve(2 * entries.size() / MAX_LEAF_SIZE + 1);
+		bvh_nodes.emplace_back();
+		while (!ranges.empty()) {
+			const Range range = ranges.back();
+			ranges.pop_back();
+
+			Aabb bounds, center_bounds;
+			for (uint32_t k = range.begin; k < range.end; k++) {
+				bounds.grow(entry_bounds[entry_order[k]]);
+				center_bounds.grow(centers[entry_order[k]]);
+			}
+			bvh_nodes[range.node].bounds = bounds;
+
+			if (range.end - range.begin <= MAX_LEAF_SIZE) {
+				bvh_nodes[range.node].first = range.begin;
+				bvh_nodes[range.node].count = range.end - range.begin;
+				for (uint32_t k = range.begin; k < range.end; k++) {
+					entry_leaves[entry_order[k]] = range.node;
+				}
+				continue;
+			}
+
+			const glm::vec3 center_extent = center_bounds.max - center_bounds.min;
+			int axis = 0;
+			if (center_extent.y > center_extent[axis]) {
+				axis = 1;
+			}
+			if (center_extent.z > center_extent[axis]) {
+				axis = 2;
+			}
+			const uint32_t middle = range.begin + (range.end - range.begin) / 2;
+			std::nth_element(entry_order.begin() + range.begin, entry_order.begin() + middle,
+							 entry_order.begin() + range.end,
+							 [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+			const auto left = static_cast<uint32_t>(bvh_nodes.size());
+			bvh_nodes[range.node].first = left;
+			bvh_nodes.emplace_back().parent = range.node;
+			bvh_nodes.emplace_back().parent = range.node;
+			ranges.push_back({left, range.begin, middle});
+			ranges.push_back({left + 1, middle, range.end});
+		}
+		built_node_area = computeNodeArea();
+		moves_since_check = 0;
+	}
+
+	void InstanceBvh::refitAll() {
+		for (size_t i = bvh_nodes.size(); i-- > 0;) {
+			BvhNode &node = bvh_nodes[i];
+			node.bounds = Aabb{};
+			if (node.isLeaf()) {
+				for (uint32_t k = node.first; k < node.first + node.count; k++) {
+					node.bounds.grow(entry_bounds[entry_order[k]]);
+				}
+			} else {
+				node.bounds.grow(bvh_nodes[node.first].bounds);
+				node.bounds.grow(bvh_nodes[node.first + 1].bounds);
+			}
+		}
+	}
+
+	float InstanceBvh::computeNodeArea() const {
+		float area = 0.0f;
+		for (const auto &node: bvh_nodes) {
+			area += node.bounds.getSurfaceArea();
+		}
+		return area;
+	}
+
+	Aabb InstanceBvh::computeEntryBounds(const Entry &entry) const {
+		if (entry.transform != nullptr) {
+			return entry.local_bounds.transformed(entry.transform->getWorldTransform());
+		}
+		return entry.local_bounds.transformed(entry.instance_array->getTransforms()[entry.instance.instance]);
+	}
+
+	void InstanceBvh::refitLeaf(uint32_t node_index) {
+		BvhNode &leaf = bvh_nodes[node_index];
+		leaf.bounds = Aabb{};
+		for (uint32_t k = leaf.first; k < leaf.first + leaf.count; k++) {
+			leaf.bounds.grow(entry_bounds[entry_order[k]]);
+		}
+
+		// stops at the first node that does not change, everything above it is still up to date
+		for (uint32_t i = leaf.parent; i != UINT32_MAX; i = bvh_nodes[i].parent) {
+			BvhNode &node = bvh_nodes[i];
+			Aabb bounds = bvh_nodes[node.first].bounds;
+			bounds.grow(bvh_nodes[node.first + 1].bounds);
+			if (bounds.min == node.bounds.min && bounds.max == node.bounds.max) {
+				break;
+			}
+			node.bounds = bounds;
+		}
+	}
+
+	void InstanceBvh::detach() {
+		for (InstanceArray *instance_array: instance_arrays) {
+			instance_array->attachToBvh(nullptr, 0);
+		}
+	}
+} // namespace RtEngine
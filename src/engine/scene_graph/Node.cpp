@@ -3,7 +3,7 @@
 namespace RtEngine {
 	Node::Node() {
 		transform = std::make_shared<Transform>();
-		components.push_back(transform);
+		addComponent(transform);
 	}
 
 	void Node::refreshTransform(const glm::mat4 &parentMatrix) {
@@ -23,7 +23,16 @@ namespace RtEngine {
 		}
 	}
 
-	void Node::addComponent(const std::shared_ptr<Component> &component) { components.push_back(component); }
+	void Node::addComponent(const std::shared_ptr<Component> &component) {
+		const uint32_t type_id = ComponentTypeId::of(*component);
+		if (type_id >= component_slots.size()) {
+			component_slots.resize(type_id + 1, NO_COMPONENT);
+		}
+		if (component_slots[type_id] == NO_COMPONENT) {
+			component_slots[type_id] = static_cast<uint32_t>(components.size());
+		}
+		components.push_back(component);
+	}
 
 	void Node::start() const {
 		for (auto &component: components) {
@@ -0,0 +1,315 @@
+#include "PhysicsSystem.hpp"
+
+#include <ComponentPools.hpp>
+#include <MeshRenderer.hpp>
+#include <Node.hpp>
+#include <Rigidbody.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace RtEngine {
+	PhysicsSystem::~PhysicsSystem() { detach(); }
+
+	void PhysicsSystem::rebuild(const ComponentPools &component_pools) {
+		// rebuilds happen whenever the hierarchy changes, that must not stop bodies that are still falling
+		std::unordered_map<const Rigidbody *, glm::vec3> kept_velocities;
+		for (size_t i = 0; i < rigidbodies.size(); i++) {
+			kept_velocities.emplace(rigidbodies[i], glm::vec3(velocity_x[i], velocity_y[i], velocity_z[i]));
+		}
+
+		detach();
+		transforms.clear();
+		parent_transforms.clear();
+		synced_translations.clear();
+		rigidbodies.clear();
+		position_x.clear(), position_y.clear(), position_z.clear();
+		velocity_x.clear(), velocity_y.clear(), velocity_z.clear();
+		offset_x.clear(), offset_y.clear(), offset_z.clear();
+		extent_x.clear(), extent_y.clear(), extent_z.clear();
+		gravity.clear();
+		static_bounds.clear();
+		static_transforms.clear();
+		static_local_bounds.clear();
+		static_world_transforms.clear();
+
+		// bodies are stored in the order of their x position, so the sweep walks the arrays about sequentially
+		const ComponentPool &body_pool = component_pools.getPool<Rigidbody>();
+		std::vector<uint32_t> pool_order(body_pool.components.size());
+		std::iota(pool_order.begin(), pool_order.end(), 0);
+		std::sort(pool_order.begin(), pool_order.end(), [&](uint32_t a, uint32_t b) {
+			return body_pool.nodes[a]->transform->getWorldTransform()[3].x <
+				   body_pool.nodes[b]->transform->getWorldTransform()[3].x;
+		});
+		for (uint32_t i: pool_order) {
+			auto *rigidbody = static_cast<Rigidbody *>(body_pool.components[i].get());
+			Node *node = body_pool.nodes[i];
+			rigidbody->attachToPhysics(this, static_cast<uint32_t>(transforms.size()));
+			rigidbodies.push_back(rigidbody);
+			transforms.push_back(node->transform.get());
+			const std::shared_ptr<Node> parent = node->parent.lock();
+			parent_transforms.push_back(parent ? parent->transform.get() : nullptr);
+			synced_translations.push_back(node->transform->decomposed_transform.translation);
+
+			const glm::mat4 world_transform = node->transform->getWorldTransform();
+			position_x.push_back(world_transform[3].x);
+			position_y.push_back(world_transform[3].y);
+			position_z.push_back(world_transform[3].z);
+			const auto kept_velocity = kept_velocities.find(rigidbody);
+			const glm::vec3 velocity = kept_velocity != kept_velocities.end() ? kept_velocity->second : glm::vec3(0.0f);
+			velocity_x.push_back(velocity.x);
+			velocity_y.push_back(velocity.y);
+			velocity_z.push_back(velocity.z);
+			gravity.push_back(rigidbody->getGravity());
+
+			// the rotation is not simulated, the box is taken in the world orientation the body starts with
+			Aabb local_bounds{glm::vec3(0.0f), glm::vec3(0.0f)};
+			auto mesh_renderer = node->getComponent<MeshRenderer>();
+			if (mesh_renderer && mesh_renderer->mesh_asset && !mesh_renderer->mesh_asset->bounding_box.isEmpty()) {
+				glm::mat4 orientation = world_transform;
+				orientation[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+				local_bounds = mesh_renderer->mesh_asset->bounding_box.transformed(orientation);
+			}
+			const glm::vec3 offset = local_bounds.getCenter(), extent = local_bounds.getExtent();
+			offset_x.push_back(offset.x);
+			offset_y.push_back(offset.y);
+			offset_z.push_back(offset.z);
+			extent_x.push_back(extent.x);
+			extent_y.push_back(extent.y);
+			extent_z.push_back(extent.z);
+		}
+
+		const size_t body_count = transforms.size();
+		resting.assign(body_count, 0);
+
+		// every renderer that is not a body collides, moving it wakes the bodies with the next step
+		const ComponentPool &renderer_pool = component_pools.getPool<MeshRenderer>();
+		for (size_t i = 0; i < renderer_pool.components.size(); i++) {
+			auto *mesh_renderer = static_cast<MeshRenderer *>(renderer_pool.components[i].get());
+			Node *node = renderer_pool.nodes[i];
+			if (!mesh_renderer->mesh_asset || mesh_renderer->mesh_asset->bounding_box.isEmpty() ||
+				node->getComponent<Rigidbody>()) {
+				continue;
+			}
+			static_transforms.push_back(node->transform.get());
+			static_local_bounds.push_back(mesh_renderer->mesh_asset->bounding_box);
+			static_world_transforms.push_back(node->transform->getWorldTransform());
+		}
+		updateStaticBounds();
+
+		// the first order is sorted in full, later steps only repair it
+		sorted_bodies.resize(body_count);
+		std::iota(sorted_bodies.begin(), sorted_bodies.end(), 0);
+		std::sort(sorted_bodies.begin(), sorted_bodies.end(), [&](uint32_t a, uint32_t b) {
+			return position_x[a] + offset_x[a] - extent_x[a] < position_x[b] + offset_x[b] - extent_x[b];
+		});
+		sorted_min_x.resize(body_count);
+		contacts.clear();
+		valid = true;
+	}
+
+	void PhysicsSystem::setGravity(uint32_t index, float gravity) {
+		this->gravity[index] = gravity;
+		resting[index] = 0;
+	}
+
+	void PhysicsSystem::step() {
+		if (transforms.empty()) {
+			return;
+		}
+
+		syncEditedBodies();
+		if (updateStaticBounds()) {
+			std::fill(resting.begin(), resting.end(), 0);
+		}
+		integrate();
+		findContacts();
+		resolveContacts();
+		writeBack();
+	}
+
+	void PhysicsSystem::syncEditedBodies() {
+		for (size_t i = 0; i < transforms.size(); i++) {
+			const glm::vec3 &translation = transforms[i]->decomposed_transform.translation;
+			if (translation == synced_translations[i]) {
+				continue;
+			}
+
+			// the world transform of the body itself is only refreshed after the step, the one of its parent is
+			// current
+			const glm::mat4 parent_transform =
+					parent_transforms[i] ? parent_transforms[i]->getWorldTransform() : glm::mat4(1.0f);
+			const glm::vec3 position(parent_transform * glm::vec4(translation, 1.0f));
+			position_x[i] = position.x;
+			position_y[i] = position.y;
+			position_z[i] = position.z;
+			synced_translations[i] = translation;
+			resting[i] = 0;
+		}
+	}
+
+	bool PhysicsSystem::updateStaticBounds() {
+		bool moved = static_bounds.size() != static_transforms.size();
+		for (size_t i = 0; i < static_transforms.size(); i++) {
+			const glm::mat4 world_transform = static_transforms[i]->getWorldTransform();
+			if (world_transform != static_world_transforms[i]) {
+				static_world_transforms[i] = world_transform;
+				moved = true;
+			}
+		}
+		if (!moved) {
+			return false;
+		}
+
+		static_bounds.clear();
+		for (size_t i = 0; i < static_transforms.size(); i++) {
+			static_bounds.push_back(static_local_bounds[i].transformed(static_world_transforms[i]));
+		}
+		std::sort(static_bounds.begin(), static_bounds.end(),
+				  [](const Aabb &a, const Aabb &b) { return a.min.x < b.min.x; });
+		static_max_y = std::numeric_limits<float>::lowest();
+		for (const auto &bounds: static_bounds) {
+			static_max_y = std::max(static_max_y, bounds.max.y);
+		}
+		return true;
+	}
+
+	void PhysicsSystem::integrate() {
+		const auto body_count = static_cast<int64_t>(transforms.size());
+		float *px = position_x.data(), *py = position_y.data(), *pz = position_z.data();
+		float *vx = velocity_x.data(), *vy = velocity_y.data(), *vz = velocity_z.data();
+		const float *g = gravity.data();
+		const uint8_t *rest = resting.data();
+
+		// semi implicit euler, every lane only touches its own body. resting bodies have no velocity and stay where
+		// they are until something wakes them up
+#pragma omp parallel for simd if (body_count >= PARALLEL_BATCH_SIZE)
+		for (int64_t i = 0; i < body_count; i++) {
+			vy[i] -= (rest[i] ? 0.0f : g[i]) * FIXED_DELTA_TIME;
+			px[i] += vx[i] * FIXED_DELTA_TIME;
+			py[i] += vy[i] * FIXED_DELTA_TIME;
+			pz[i] += vz[i] * FIXED_DELTA_TIME;
+		}
+	}
+
+	void PhysicsSystem::findContacts() {
+		contacts.clear();
+		if (static_bounds.empty()) {
+			return;
+		}
+
+		const size_t body_count = sorted_bodies.size();
+		for (size_t k = 0; k < body_count; k++) {
+			const uint32_t body = sorted_bodies[k];
+			sorted_min_x[k] = position_x[body] + offset_x[body] - extent_x[body];
+		}
+		for (size_t k = 1; k < body_count; k++) {
+			const float min_x = sorted_min_x[k];
+			const uint32_t body = sorted_bodies[k];
+			size_t j = k;
+			for (; j > 0 && sorted_min_x[j - 1] > min_x; j--) {
+				sorted_min_x[j] = sorted_min_x[j - 1];
+				sorted_bodies[j] = sorted_bodies[j - 1];
+			}
+			sorted_min_x[j] = min_x;
+			sorted_bodies[j] = body;
+		}
+
+		active_statics.clear();
+		size_t next_static = 0;
+		for (size_t k = 0; k < body_count; k++) {
+			const uint32_t body = sorted_bodies[k];
+			const float min_x = sorted_min_x[k];
+			// statics that end before this body end before all following ones as well
+			while (next_static < static_bounds.size() && static_bounds[next_static].min.x <= min_x) {
+				active_statics.push_back(static_cast<uint32_t>(next_static++));
+			}
+			std::erase_if(active_statics, [&](uint32_t s) { return static_bounds[s].max.x < min_x; });
+
+			if (resting[body] || position_y[body] + offset_y[body] - extent_y[body] > static_max_y) {
+				continue;
+			}
+			const Aabb bounds = getBodyBounds(body);
+			for (uint32_t s: active_statics) {
+				if (bounds.overlaps(static_bounds[s])) {
+					contacts.emplace_back(body, s);
+				}
+			}
+			for (size_t s = next_static; s < static_bounds.size() && static_bounds[s].min.x <= bounds.max.x; s++) {
+				if (bounds.overlaps(static_bounds[s])) {
+					contacts.emplace_back(body, static_cast<uint32_t>(s));
+				}
+			}
+		}
+	}
+
+	void PhysicsSystem::resolveContacts() {
+		for (const auto &[body, s]: contacts) {
+			// an earlier contact of the same body may already have pushed it out
+			const Aabb bounds = getBodyBounds(body);
+			const Aabb &static_bound = static_bounds[s];
+			if (!bounds.overlaps(static_bound)) {
+				continue;
+			}
+
+			// push out along the axis and direction of the least penetration
+			const glm::vec3 push_positive = static_bound.max - bounds.min;
+			const glm::vec3 push_negative = bounds.max - static_bound.min;
+			int axis = 0;
+			float push = push_positive.x;
+			for (int a = 0; a < 3; a++) {
+				if (push_positive[a] < std::abs(push)) {
+					axis = a, push = push_positive[a];
+				}
+				if (push_negative[a] < std::abs(push)) {
+					axis = a, push = -push_negative[a];
+				}
+			}
+
+			float *position[] = {&position_x[body], &position_y[body], &position_z[body]};
+			float *velocity[] = {&velocity_x[body], &velocity_y[body], &velocity_z[body]};
+			*position[axis] += push;
+			// only the velocity into the static bound is removed, sliding along it stays
+			if ((push > 0.0f && *velocity[axis] < 0.0f) || (push < 0.0f && *velocity[axis] > 0.0f)) {
+				*velocity[axis] = 0.0f;
+			}
+		}
+	}
+
+	void PhysicsSystem::writeBack() {
+		// most bodies share their parent, so its inverse is only computed when the parent changes
+		const Transform *inverted_parent = nullptr;
+		glm::mat4 inverse_parent(1.0f);
+
+		// a body that came to rest is written once more, after that its transform is left alone
+		for (size_t i = 0; i < transforms.size(); i++) {
+			const bool moving = velocity_x[i] != 0.0f || velocity_y[i] != 0.0f || velocity_z[i] != 0.0f;
+			if (moving || !resting[i]) {
+				if (parent_transforms[i] != inverted_parent) {
+					inverted_parent = parent_transforms[i];
+					inverse_parent = inverted_parent ? glm::inverse(inverted_parent->getWorldTransform())
+													 : glm::mat4(1.0f);
+				}
+				const glm::vec4 world_position(position_x[i], position_y[i], position_z[i], 1.0f);
+				synced_translations[i] = glm::vec3(inverse_parent * world_position);
+				transforms[i]->decomposed_transform.translation = synced_translations[i];
+				transforms[i]->markDirty();
+			}
+			resting[i] = !moving;
+		}
+	}
+
+	Aabb PhysicsSystem::getBodyBounds(uint32_t body) const {
+		const glm::vec3 center(position_x[body] + offset_x[body], position_y[body] + offset_y[body],
+							   position_z[body] + offset_z[body]);
+		const glm::vec3 extent(extent_x[body], extent_y[body], extent_z[body]);
+		return Aabb{center - extent, center + extent};
+	}
+
+	void PhysicsSystem::detach() {
+		for (Rigidbody *rigidbody: rigidbodies) {
+			rigidbody->attachToPhysics(nullptr, 0);
+		}
+	}
+} // namespace RtEngine
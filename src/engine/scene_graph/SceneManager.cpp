@@ -4,14 +4,29 @@
 
 #include "SceneManager.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <filesystem>
+#include <spdlog/spdlog.h>
+
+#include "AssetPack.hpp"
+#include "PathUtil.hpp"
 
 namespace RtEngine {
     SceneManager::SceneManager(const std::string &resources_dir) : resources_dir(resources_dir) {
         std::string scenes_dir = std::format("{}/scenes", resources_dir);
         try {
             for (const auto &entry: std::filesystem::directory_iterator(scenes_dir)) {
-                scene_names.push_back(entry.path().filename().stem());
+                // instance sidecars live next to the scenes
+                const std::string extension = PathUtil::getExtension(entry.path().string());
+                if (extension != "yaml" && extension != AssetPack::EXTENSION) {
+                    continue;
+                }
+                // a scene can exist both as yaml and as packed version
+                std::string scene_name = entry.path().filename().stem();
+                if (std::find(scene_names.begin(), scene_names.end(), scene_name) == scene_names.end()) {
+                    scene_names.push_back(scene_name);
+                }
             }
         } catch (const std::exception &e) {
             throw std::runtime_error("failed to load scene directory: " + std::string(e.what()));
@@ -37,11 +52,97 @@ namespace RtEngine {
         return nullptr;
     }
 
+    std::shared_ptr<DrawList> SceneManager::getCurrentDrawList() {
+        if (scene != nullptr) {
+            return scene->getDrawList();
+        }
+        return nullptr;
+    }
+
     std::string SceneManager::getScenePath(std::string scene_name) {
-        return std::format("{}/scenes/{}.yaml", resources_dir, scene_name);
+        std::string pack_path = std::format("{}/scenes/{}.{}", resources_dir, scene_name, AssetPack::EXTENSION);
+        std::string yaml_path = std::format("{}/scenes/{}.yaml", resources_dir, scene_name);
+        if (!std::filesystem::exists(pack_path)) {
+            return yaml_path;
+        }
+        // a pack is not rebuilt when the scene is edited, an older one would hide the changes
+        if (std::filesystem::exists(yaml_path) &&
+            std::filesystem::last_write_time(yaml_path) > std::filesystem::last_write_time(pack_path)) {
+            spdlog::warn("{} is older than {}, loading the yaml scene instead", pack_path, yaml_path);
+            return yaml_path;
+        }
+        return pack_path;
     }
 
     std::vector<std::string> SceneManager::getSceneNames() const {
         return scene_names;
     }
+
+    std::string SceneManager::getResourcesDir() const {
+        return resources_dir;
+    }
+
+    std::vector<CachedScene> SceneManager::setSceneCacheBudget(uint32_t max_scenes, size_t max_device_memory) {
+        max_cached_scenes = max_scenes;
+        max_cache_device_memory = max_device_memory;
+        return evictScenes();
+    }
+
+    std::vector<CachedScene> SceneManager::cacheScene(CachedScene cached_scene) {
+        assert(cached_scene.scene != nullptr);
+        std::vector<CachedScene> evicted_scenes;
+        CachedScene previous;
+        if (takeCachedScene(cached_scene.scene->path, &previous)) {
+            evicted_scenes.push_back(std::move(previous));
+        }
+
+        cached_scenes.insert(cached_scenes.begin(), std::move(cached_scene));
+        std::vector<CachedScene> over_budget = evictScenes();
+        evicted_scenes.insert(evicted_scenes.end(), over_budget.begin(), over_budget.end());
+        return evicted_scenes;
+    }
+
+    bool SceneManager::takeCachedScene(const std::string &scene_path, CachedScene *cached_scene) {
+        const auto it = std::find_if(cached_scenes.begin(), cached_scenes.end(), [&](const CachedScene &entry) {
+            return entry.scene->path == scene_path;
+        });
+        if (it == cached_scenes.end()) {
+            return false;
+        }
+        *cached_scene = std::move(*it);
+        cached_scenes.erase(it);
+        return true;
+    }
+
+    std::vector<CachedScene> SceneManager::clearSceneCache() {
+        std::vector<CachedScene> evicted_scenes = std::move(cached_scenes);
+        cached_scenes.clear();
+        return evicted_scenes;
+    }
+
+    size_t SceneManager::getCachedSceneCount() const {
+        return cached_scenes.size();
+    }
+
+    std::vector<CachedScene> SceneManager::evictScenes() {
+        size_t device_memory = 0;
+        size_t kept_count = 0;
+        for (const auto &cached_scene : cached_scenes) {
+            if (kept_count == max_cached_scenes ||
+                device_memory + cached_scene.device_memory > max_cache_device_memory) {
+                break;
+            }
+            device_memory += cached_scene.device_memory;
+            kept_count++;
+        }
+
+        std::vector<CachedScene> evicted_scenes(std::make_move_iterator(cached_scenes.begin() + kept_count),
+                                                std::make_move_iterator(cached_scenes.end()));
+        cached_scenes.resize(kept_count);
+        if (!evicted_scenes.empty()) {
+            spdlog::info("Evicted {} scenes from the scene cache, {} MB stay resident", evicted_scenes.size(),
+                         device_memory / (1024 * 1024));
+        }
+        return evicted_scenes;
+    }
 } // RtEngine
\ No newline at end of file
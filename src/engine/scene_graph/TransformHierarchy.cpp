@@ -0,0 +1,94 @@
+#include "TransformHierarchy.hpp"
+
+#include <Node.hpp>
+#include <algorithm>
+
+namespace RtEngine {
+	TransformHierarchy::~TransformHierarchy() { detach(); }
+
+	void TransformHierarchy::rebuild(const std::shared_ptr<Node> &root) {
+		detach();
+		parents.clear();
+		transforms.clear();
+		nodes.clear();
+		level_offsets.clear();
+
+		// breadth first, the previous level is the queue for the next one
+		std::vector<Node *> level_nodes, next_level_nodes;
+		if (root) {
+			level_nodes.push_back(root.get());
+			parents.push_back(NO_PARENT);
+		}
+		while (!level_nodes.empty()) {
+			const auto level_start = static_cast<uint32_t>(transforms.size());
+			level_offsets.push_back(level_start);
+
+			next_level_nodes.clear();
+			for (uint32_t i = 0; i < level_nodes.size(); i++) {
+				Node *node = level_nodes[i];
+				transforms.push_back(node->transform);
+				nodes.push_back(node);
+				node->transform->attachToHierarchy(this, level_start + i);
+				for (auto &child: node->children) {
+					next_level_nodes.push_back(child.get());
+					parents.push_back(level_start + i);
+				}
+			}
+			std::swap(level_nodes, next_level_nodes);
+		}
+		level_offsets.push_back(static_cast<uint32_t>(transforms.size()));
+
+		dirty.assign(transforms.size(), 1);
+		world_transforms.assign(transforms.size(), glm::mat4(1.0f));
+		any_dirty = !transforms.empty();
+		valid = true;
+	}
+
+	void TransformHierarchy::markDirty(uint32_t index) {
+		dirty[index] = 1;
+		any_dirty = true;
+	}
+
+	uint32_t TransformHierarchy::update() {
+		updated_nodes.clear();
+		if (!any_dirty) {
+			return 0;
+		}
+
+		uint32_t updated_count = 0;
+		for (size_t level = 0; level + 1 < level_offsets.size(); level++) {
+			const int64_t level_start = level_offsets[level], level_end = level_offsets[level + 1];
+			// the parents all live in earlier levels, so the nodes of one level are independent of each other
+#pragma omp parallel for reduction(+ : updated_count) if (level_end - level_start >= PARALLEL_LEVEL_SIZE)
+			for (int64_t i = level_start; i < level_end; i++) {
+				const uint32_t parent = parents[i];
+				// a moved parent moves the whole subtree
+				if (parent != NO_PARENT && dirty[parent]) {
+					dirty[i] = 1;
+				}
+				if (!dirty[i]) {
+					continue;
+				}
+
+				transforms[i]->updateTransforms(parent == NO_PARENT ? glm::mat4(1.0f) : world_transforms[parent]);
+				world_transforms[i] = transforms[i]->getWorldTransform();
+				updated_count++;
+			}
+		}
+
+		for (size_t i = 0; i < dirty.size(); i++) {
+			if (dirty[i]) {
+				updated_nodes.push_back(nodes[i]);
+			}
+		}
+		std::fill(dirty.begin(), dirty.end(), 0);
+		any_dirty = false;
+		return updated_count;
+	}
+
+	void TransformHierarchy::detach() {
+		for (auto &transform: transforms) {
+			transform->attachToHierarchy(nullptr, 0);
+		}
+	}
+} // namespace RtEngine
@@ -0,0 +1,133 @@
+#include "Animation.hpp"
+
+#include <AnimationSystem.hpp>
+#include <array>
+#include <stdexcept>
+
+namespace RtEngine {
+	namespace {
+		constexpr std::array<std::pair<AnimationTarget, const char *>, 4> TARGET_NAMES = {{
+				{AnimationTarget::POSITION, "position"},
+				{AnimationTarget::ROTATION, "rotation"},
+				{AnimationTarget::SCALE, "scale"},
+				{AnimationTarget::MATERIAL, "material"},
+		}};
+
+		AnimationTarget parseTarget(const std::string &name) {
+			for (const auto &[target, target_name]: TARGET_NAMES) {
+				if (name == target_name) {
+					return target;
+				}
+			}
+			throw std::runtime_error("Unknown animation target " + name);
+		}
+
+		const char *getTargetName(AnimationTarget target) {
+			return TARGET_NAMES[static_cast<size_t>(target)].second;
+		}
+
+		// scalars and sequences of up to four floats
+		glm::vec4 parseValue(const YAML::Node &yaml_node, uint32_t *value_size) {
+			if (yaml_node.IsScalar()) {
+				*value_size = 1;
+				return glm::vec4(yaml_node.as<float>(), 0.0f, 0.0f, 0.0f);
+			}
+			if (!yaml_node.IsSequence() || yaml_node.size() == 0 || yaml_node.size() > 4) {
+				throw std::runtime_error("Animation values have to be a float or a sequence of up to four floats");
+			}
+			glm::vec4 value(0.0f);
+			for (size_t i = 0; i < yaml_node.size(); i++) {
+				value[static_cast<int>(i)] = yaml_node[i].as<float>();
+			}
+			*value_size = static_cast<uint32_t>(yaml_node.size());
+			return value;
+		}
+	} // namespace
+
+	void Animation::initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) {
+		if (config->startChild(COMPONENT_NAME)) {
+			if (config->addBool("Loop", &loop) && animations != nullptr) {
+				animations->setLooping(first_track, static_cast<uint32_t>(tracks.size()), loop);
+			}
+			config->endChild();
+		}
+	}
+
+	void Animation::loadTracks(const YAML::Node &yaml_node) {
+		tracks.clear();
+		if (!yaml_node) {
+			return;
+		}
+
+		for (const auto &track_node: yaml_node) {
+			AnimationTrack track;
+			track.target = parseTarget(track_node["target"].as<std::string>());
+			if (track.target == AnimationTarget::MATERIAL) {
+				track.material_instance_name = track_node["material"].as<std::string>();
+				track.parameter = track_node["parameter"].as<std::string>();
+			}
+			track.step_interpolation =
+					track_node["interpolation"] && track_node["interpolation"].as<std::string>() == "step";
+
+			const YAML::Node &times = track_node["times"];
+			const YAML::Node &values = track_node["values"];
+			if (!times || !values || times.size() != values.size() || times.size() == 0) {
+				throw std::runtime_error("Animation track needs as many times as values");
+			}
+			for (size_t i = 0; i < times.size(); i++) {
+				track.times.push_back(times[i].as<float>());
+				track.values.push_back(parseValue(values[i], &track.value_size));
+				if (i > 0 && track.times[i] < track.times[i - 1]) {
+					throw std::runtime_error("Animation track times have to be ascending");
+				}
+			}
+			if (track.target != AnimationTarget::MATERIAL && track.value_size != 3) {
+				throw std::runtime_error("Transform animation tracks need three floats per value");
+			}
+			tracks.push_back(std::move(track));
+		}
+	}
+
+	YAML::Node Animation::writeTracksToYaml() const {
+		YAML::Node out(YAML::NodeType::Sequence);
+		for (const auto &track: tracks) {
+			YAML::Node track_node(YAML::NodeType::Map);
+			track_node["target"] = getTargetName(track.target);
+			if (track.target == AnimationTarget::MATERIAL) {
+				track_node["material"] = track.material_instance_name;
+				track_node["parameter"] = track.parameter;
+			}
+			if (track.step_interpolation) {
+				track_node["interpolation"] = "step";
+			}
+
+			YAML::Node times(YAML::NodeType::Sequence), values(YAML::NodeType::Sequence);
+			times.SetStyle(YAML::EmitterStyle::Flow);
+			if (track.value_size == 1) {
+				values.SetStyle(YAML::EmitterStyle::Flow);
+			}
+			for (size_t i = 0; i < track.times.size(); i++) {
+				times.push_back(track.times[i]);
+				if (track.value_size == 1) {
+					values.push_back(track.values[i].x);
+					continue;
+				}
+				YAML::Node value(YAML::NodeType::Sequence);
+				value.SetStyle(YAML::EmitterStyle::Flow);
+				for (uint32_t c = 0; c < track.value_size; c++) {
+					value.push_back(track.values[i][static_cast<int>(c)]);
+				}
+				values.push_back(value);
+			}
+			track_node["times"] = times;
+			track_node["values"] = values;
+			out.push_back(track_node);
+		}
+		return out;
+	}
+
+	void Animation::attachToAnimations(AnimationSystem *animations, uint32_t first_track) {
+		this->animations = animations;
+		this->first_track = first_track;
+	}
+} // namespace RtEngine
@@ -28,6 +28,10 @@ namespace RtEngine {
     }
 
     void Camera::OnRender(DrawContext &ctx) {
+        if (ctx.targets.empty()) {
+            ctx.view_position = getPosition();
+            ctx.pixels_per_unit = std::abs(projection[1][1]) * static_cast<float>(image_height) / 2.0f;
+        }
         ctx.targets.push_back(render_target);
     }
 
@@ -41,6 +45,13 @@ namespace RtEngine {
     	updateProjection(static_cast<float>(image_width) / static_cast<float>(image_height));
     }
 
+    void Camera::OnCommit() {
+    	if (moved) {
+    		transform->markDirty();
+    		moved = false;
+    	}
+    }
+
     void Camera::OnDestroy() {
     	render_target->destroy();
     }
@@ -129,6 +140,7 @@ namespace RtEngine {
     	glm::mat4 cameraRotation = getRotationMatrix();
     	transform->decomposed_transform.translation += glm::vec3(cameraRotation * glm::vec4(velocity * MOVE_SPEED, 0.f));
 
+    	moved |= angular_velocity != glm::vec3(0) || velocity != glm::vec3(0);
     	angular_velocity = glm::vec3(0);
     }
 
@@ -156,6 +168,13 @@ namespace RtEngine {
 
 	glm::vec3 Camera::getPosition() const { return transform->decomposed_transform.translation; }
 
+	// same as the raygen shader, the flipped projection already maps the top of the image to -1
+	glm::vec3 Camera::getRayDirection(const glm::vec2 &uv) const {
+		const glm::vec2 ndc = uv * 2.0f - 1.0f;
+		const glm::vec4 target = inverse_projection * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+		return glm::vec3(inverse_view * glm::vec4(glm::normalize(glm::vec3(target)), 0.0f));
+	}
+
 	std::shared_ptr<RenderTarget> Camera::getRenderTarget() {
     	return render_target;
 	}
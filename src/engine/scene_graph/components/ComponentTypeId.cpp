@@ -0,0 +1,18 @@
+#include "ComponentTypeId.hpp"
+
+#include <Component.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace RtEngine {
+	uint32_t ComponentTypeId::of(const Component &component) { return of(std::type_index(typeid(component))); }
+
+	uint32_t ComponentTypeId::of(const std::type_index &type) {
+		static std::mutex mutex;
+		static std::unordered_map<std::type_index, uint32_t> ids;
+
+		std::lock_guard lock(mutex);
+		auto [it, inserted] = ids.try_emplace(type, static_cast<uint32_t>(ids.size()));
+		return it->second;
+	}
+} // namespace RtEngine
@@ -1,27 +1,101 @@
 #include "MeshRenderer.hpp"
 #include <Node.hpp>
 #include <Scene.hpp>
+#include <algorithm>
 
 namespace RtEngine {
 	void MeshRenderer::OnStart() {
 		mesh_asset = context->mesh_repository->getMesh(mesh_asset_name);
 		assert(mesh_asset != nullptr);
+		resolveSubmeshMaterials();
 
-		std::shared_ptr<Material> material = context->scene_manager->getCurrentMaterial();
-		mesh_material = material->getInstanceByName(material_instance_name);
-		assert(mesh_material != nullptr);
+		draw_list = context->scene_manager->getCurrentDrawList();
+		assert(draw_list != nullptr);
+		draw_handle = draw_list->add(createRenderObject());
 	}
 
-	void MeshRenderer::OnRender(DrawContext &ctx) {
+	void MeshRenderer::OnDestroy() {
+		if (draw_handle != DrawList::INVALID_HANDLE) {
+			draw_list->remove(draw_handle);
+			draw_handle = DrawList::INVALID_HANDLE;
+		}
+		draw_list = nullptr;
+	}
+
+	void MeshRenderer::resolveSubmeshMaterials() {
+		submesh_materials = findSubmeshMaterials(context->scene_manager->getCurrentMaterial(), *mesh_asset,
+												 mesh_asset_name, material_instance_name);
+		mesh_material = submesh_materials[0];
+	}
+
+	void MeshRenderer::refreshRenderObject() {
+		if (draw_handle == DrawList::INVALID_HANDLE) {
+			return;
+		}
+
+		// a hot reload may change the submeshes of the mesh
+		if (submesh_materials.size() != mesh_asset->meshBuffers.submeshes.size()) {
+			resolveSubmeshMaterials();
+		}
+		draw_list->update(draw_handle, createRenderObject());
+	}
+
+	void MeshRenderer::updateTransform() {
+		if (draw_handle == DrawList::INVALID_HANDLE) {
+			return;
+		}
+
 		auto shared_node = node.lock();
 		if (!shared_node) {
 			assert(false);
 		}
+		draw_list->setTransform(draw_handle, shared_node->transform->getWorldTransform());
+	}
+
+	RenderObject MeshRenderer::createRenderObject() const {
+		auto shared_node = node.lock();
+		if (!shared_node) {
+			assert(false);
+		}
+		return buildRenderObject(*mesh_asset, submesh_materials, shared_node->transform->getWorldTransform());
+	}
+
+	std::vector<std::shared_ptr<MaterialInstance>>
+	MeshRenderer::findSubmeshMaterials(const std::shared_ptr<Material> &material, const MeshAsset &mesh_asset,
+									   const std::string &mesh_asset_name, const std::string &material_instance_name) {
+		// without a material name every submesh uses the material it has in the model file
+		std::vector<std::shared_ptr<MaterialInstance>> materials;
+		for (const auto &submesh: mesh_asset.meshBuffers.submeshes) {
+			const std::string name = material_instance_name.empty()
+											 ? mesh_asset_name + "/" + submesh.material_name
+											 : material_instance_name;
+			std::shared_ptr<MaterialInstance> instance = material->getInstanceByName(name);
+			if (instance == nullptr) {
+				throw std::runtime_error("Material instance '" + name + "' of mesh '" + mesh_asset_name +
+										 "' does not exist");
+			}
+			materials.push_back(instance);
+		}
+		assert(!materials.empty());
+		return materials;
+	}
 
-		glm::mat4 nodeMatrix = shared_node->transform->getWorldTransform();
+	RenderObject MeshRenderer::buildRenderObject(const MeshAsset &mesh_asset,
+												 const std::vector<std::shared_ptr<MaterialInstance>> &submesh_materials,
+												 const glm::mat4 &transform) {
+		std::vector<SubmeshMaterial> materials;
+		float emitting_power = 0.0f;
+		for (const auto &submesh_material: submesh_materials) {
+			materials.push_back(SubmeshMaterial{submesh_material->getMaterialIndex(), submesh_material->getEmissionPower()});
+			emitting_power = std::max(emitting_power, materials.back().emitting_power);
+		}
 
-		ctx.addRenderObject(RenderObject{InstanceMappingData{mesh_asset->geometry_id, mesh_material->getMaterialIndex()},
-										   mesh_asset->accelerationStructure, nodeMatrix, mesh_asset->triangle_count, mesh_material->getEmissionPower()});
+		// the blas of a freshly loaded mesh is built after the scene started, the scene adapter fills in the address
+		// when it selects the lods
+		const uint64_t blas_address =
+				mesh_asset.accelerationStructure != nullptr ? mesh_asset.accelerationStructure->getDeviceAddress() : 0;
+		return RenderObject{InstanceMappingData{mesh_asset.geometry_id, 0}, blas_address, transform,
+							mesh_asset.triangle_count, emitting_power, mesh_asset.handle, std::move(materials)};
 	}
 
 	void MeshRenderer::initProperties(const std::shared_ptr<IProperties> &config,
@@ -31,8 +105,12 @@ namespace RtEngine {
 			config->addString("mesh", &mesh_asset_name);
 			config->addString("material_name", &material_instance_name);
 
-			if (mesh_material) {
-				mesh_material->initProperties(config, update_flags);
+			// submeshes sharing a material show it once
+			for (size_t i = 0; i < submesh_materials.size(); i++) {
+				if (std::find(submesh_materials.begin(), submesh_materials.begin() + i, submesh_materials[i]) ==
+					submesh_materials.begin() + i) {
+					submesh_materials[i]->initProperties(config, update_flags);
+				}
 			}
 			config->endChild();
 		}
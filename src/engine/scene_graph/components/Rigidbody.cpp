@@ -3,21 +3,20 @@
 //
 
 #include "Rigidbody.hpp"
-#include <Node.hpp>
+#include <PhysicsSystem.hpp>
 
 namespace RtEngine {
-	void Rigidbody::OnUpdate() {
-		auto shared_node = node.lock();
-		if (!shared_node) {
-			assert(false);
-		}
-
-		shared_node->transform->decomposed_transform.translation.y -= gravity * FIXED_DELTA_TIME;
+	void Rigidbody::attachToPhysics(PhysicsSystem *physics, uint32_t index) {
+		this->physics = physics;
+		physics_index = index;
 	}
 
 	void Rigidbody::initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) {
 		if (config->startChild(COMPONENT_NAME)) {
-			config->addFloat("Gravity", &gravity);
+			if (config->addFloat("Gravity", &gravity) && physics != nullptr) {
+				physics->setGravity(physics_index, gravity);
+			}
+			config->endChild();
 		}
 	}
 } // namespace RtEngine
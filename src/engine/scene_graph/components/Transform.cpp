@@ -1,4 +1,5 @@
 #include <Transform.hpp>
+#include <TransformHierarchy.hpp>
 
 namespace RtEngine {
 	Transform::Transform() : Component(nullptr, nullptr) {
@@ -9,6 +10,7 @@ namespace RtEngine {
 	void Transform::setLocalTransform(glm::mat4 transform_matrix) {
 		localTransform = transform_matrix;
 		decomposed_transform = TransformUtil::decomposeMatrix(localTransform);
+		markDirty();
 	}
 
 	glm::mat4 Transform::getLocalTransform() const { return localTransform; }
@@ -20,11 +22,26 @@ namespace RtEngine {
 
 	glm::mat4 Transform::getWorldTransform() const { return worldTransform; }
 
+	void Transform::markDirty() {
+		// a detached transform is recomputed as a whole with the next rebuild
+		if (hierarchy != nullptr) {
+			hierarchy->markDirty(hierarchy_index);
+		}
+	}
+
+	void Transform::attachToHierarchy(TransformHierarchy *hierarchy, uint32_t index) {
+		this->hierarchy = hierarchy;
+		hierarchy_index = index;
+	}
+
 	void Transform::initProperties(const std::shared_ptr<IProperties> &config, const UpdateFlagsHandle &update_flags) {
 		if (config->startChild(COMPONENT_NAME)) {
-			config->addVector("position", &decomposed_transform.translation);
-			config->addVector("rotation", &decomposed_transform.rotation);
-			config->addVector("scale", &decomposed_transform.scale);
+			bool changed = config->addVector("position", &decomposed_transform.translation);
+			changed |= config->addVector("rotation", &decomposed_transform.rotation);
+			changed |= config->addVector("scale", &decomposed_transform.scale);
+			if (changed) {
+				markDirty();
+			}
 			config->endChild();
 		}
 	}
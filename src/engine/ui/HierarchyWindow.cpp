@@ -17,46 +17,44 @@ namespace RtEngine {
 
 		if (show_window) {
 			ImGui::Begin("Hierarchy", &show_window);
-			displayNode(scene->nodes["root"], nullptr, 0);
+			displayNode(scene->getRootNode(), nullptr, 0);
 			ImGui::End();
 		}
 
 		for (auto &node_add: nodes_to_add) {
-			scene->nodes[node_add.parent_key]->children.push_back(scene->nodes[node_add.node_key]);
+			const std::shared_ptr<Node> parent = scene->getNode(node_add.parent_id);
+			const std::shared_ptr<Node> node = scene->getNode(node_add.node_id);
+			parent->children.push_back(node);
 			// TODO not quite working
-			glm::mat4 new_parent_transform = scene->nodes[node_add.parent_key]->transform->getWorldTransform();
-			glm::mat4 prev_world_transform = scene->nodes[node_add.node_key]->transform->getWorldTransform();
-			scene->nodes[node_add.node_key]->transform->setLocalTransform(glm::inverse(new_parent_transform) *
-																		  prev_world_transform);
+			glm::mat4 new_parent_transform = parent->transform->getWorldTransform();
+			glm::mat4 prev_world_transform = node->transform->getWorldTransform();
+			node->transform->setLocalTransform(glm::inverse(new_parent_transform) * prev_world_transform);
 		}
 
 		for (auto &node_remove: nodes_to_remove) {
-			scene->nodes[node_remove.parent_key]->children.erase(
-					std::remove(scene->nodes[node_remove.parent_key]->children.begin(),
-								scene->nodes[node_remove.parent_key]->children.end(),
-								scene->nodes[node_remove.node_key]),
-					scene->nodes[node_remove.parent_key]->children.end());
+			std::vector<std::shared_ptr<Node>> &children = scene->getNode(node_remove.parent_id)->children;
+			children.erase(std::remove(children.begin(), children.end(), scene->getNode(node_remove.node_id)),
+						   children.end());
 		}
 
-		std::shared_ptr<Node> root_node = scene->nodes["root"];
-
 		if (!nodes_to_add.empty() || !nodes_to_remove.empty()) {
+			scene->markHierarchyChanged();
 			notifyUpdate(0);
 		}
 
 		nodes_to_add.clear();
 		nodes_to_remove.clear();
 
-		if (last_clicked_node_key != "")
-			inspector_window->setNode(scene->nodes[last_clicked_node_key]);
-		last_clicked_node_key = "";
+		if (last_clicked_node != NO_NODE)
+			inspector_window->setNode(scene->getNode(last_clicked_node));
+		last_clicked_node = NO_NODE;
 	}
 
 	void HierarchyWindow::displayNode(std::shared_ptr<Node> node, std::shared_ptr<Node> parent, uint32_t depth) {
 		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
 		// Highlight if selected
-		if (last_clicked_node_key == node->name) {
+		if (last_clicked_node == node->id) {
 			flags |= ImGuiTreeNodeFlags_Selected;
 		}
 
@@ -64,12 +62,12 @@ namespace RtEngine {
 
 		// Register clicks directly on the TreeNode
 		if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
-			last_clicked_node_key = node->name;
+			last_clicked_node = node->id;
 		}
 
-		if (node->name != "root" && ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
-			dragPayload.source_key = node->name;
-			dragPayload.parent_key = parent->name;
+		if (parent != nullptr && ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
+			dragPayload.source_id = node->id;
+			dragPayload.parent_id = parent->id;
 			ImGui::SetDragDropPayload("DRAG_PAYLOAD", &dragPayload, sizeof(DragPayload));
 			ImGui::EndDragDropSource();
 		}
@@ -79,10 +77,9 @@ namespace RtEngine {
 			const ImGuiPayload *drag_payload = ImGui::AcceptDragDropPayload("DRAG_PAYLOAD");
 
 			if (drag_payload) {
-				DragPayload dragged_keys = *static_cast<DragPayload *>(drag_payload->Data);
-				std::shared_ptr<Node> dragged_node = scene_manager->getCurrentScene()->nodes[dragged_keys.source_key];
-				nodes_to_add.push_back({node->name, dragged_keys.source_key});
-				nodes_to_remove.push_back({dragged_keys.parent_key, dragged_keys.source_key});
+				DragPayload dragged_ids = *static_cast<DragPayload *>(drag_payload->Data);
+				nodes_to_add.push_back({node->id, dragged_ids.source_id});
+				nodes_to_remove.push_back({dragged_ids.parent_id, dragged_ids.source_id});
 			}
 			ImGui::EndDragDropTarget();
 		}
@@ -14,8 +14,6 @@ namespace RtEngine {
 		if (!node || !scene_manager)
 			return;
 
-		std::shared_ptr<Node> root_node = scene_manager->getCurrentScene()->nodes["root"];
-
 		ImGui::SetNextWindowSize(ImVec2(400, 300), ImGuiCond_Once);
 
 		auto updateFlags = std::make_shared<UpdateFlags>();
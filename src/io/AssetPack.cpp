@@ -0,0 +1,377 @@
+#include "AssetPack.hpp"
+
+#include <InstanceFile.hpp>
+#include <QuickTimer.hpp>
+#include <bit>
+#include <cassert>
+#include <fcntl.h>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t PACK_MAGIC = 0x4B505452; // "RTPK"
+		constexpr uint32_t PACK_VERSION = 1;
+		// payloads start on page boundaries so every entry can be mapped and read ahead on its own
+		constexpr uint64_t PAYLOAD_ALIGNMENT = 4096;
+
+		struct PackHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entry_count;
+			uint32_t table_size; // power of two, open addressing with linear probing
+			uint64_t table_offset;
+			uint64_t names_offset;
+			uint64_t names_size;
+		};
+
+		struct PackEntry {
+			uint64_t hash;
+			uint64_t offset;
+			uint64_t size;
+			uint32_t type; // 0 marks an empty slot
+			uint32_t name_offset;
+			uint32_t name_length;
+			uint32_t padding;
+		};
+
+		struct MeshPayloadHeader {
+			uint32_t vertex_count;
+			uint32_t index_count;
+			uint32_t lod_count; // zero in packs written before lods existed
+			uint32_t submesh_count; // zero in packs written before submeshes existed
+		};
+
+		// follows the indices once per lod, the lod indices come after all lod headers
+		struct LodPayloadHeader {
+			uint32_t index_count;
+			float error;
+		};
+
+		// after the lod indices once per submesh, then the submesh ranges of every lod and the material names
+		struct SubmeshPayloadHeader {
+			uint32_t index_offset;
+			uint32_t index_count;
+			uint32_t name_length;
+		};
+
+		struct TexturePayloadHeader {
+			uint32_t format;
+			uint32_t width, height, mip_levels;
+			uint64_t data_size;
+			uint64_t padding;
+		};
+
+		uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+		// hands out the parts of a payload in order and throws instead of reading past its end
+		class PayloadReader {
+		public:
+			PayloadReader(const AssetView &view, const std::string &name) :
+				data(view.data), size(view.size), name(name) {}
+
+			template<typename T>
+			const T *read(uint64_t count = 1) {
+				if (count > (size - offset) / sizeof(T)) {
+					throw std::runtime_error("Asset pack entry " + name + " is truncated");
+				}
+				const auto *result = reinterpret_cast<const T *>(data + offset);
+				offset += count * sizeof(T);
+				return result;
+			}
+
+		private:
+			const uint8_t *data;
+			uint64_t size;
+			uint64_t offset = 0;
+			const std::string &name;
+		};
+
+		void checkSubmeshRange(const Submesh &submesh, size_t index_count, const std::string &name) {
+			if (static_cast<uint64_t>(submesh.index_offset) + submesh.index_count > index_count) {
+				throw std::runtime_error("Submesh " + submesh.material_name + " of " + name +
+										 " lies outside of its indices");
+			}
+		}
+
+		template<typename T>
+		void appendBytes(std::vector<uint8_t> &payload, const T *data, size_t count) {
+			const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+			payload.insert(payload.end(), bytes, bytes + count * sizeof(T));
+		}
+	} // namespace
+
+	AssetPack::AssetPack(const std::string &path) : path(path) {
+		file_descriptor = open(path.c_str(), O_RDONLY);
+		if (file_descriptor < 0) {
+			throw std::runtime_error("failed to open asset pack " + path + "!");
+		}
+
+		struct stat file_stat{};
+		fstat(file_descriptor, &file_stat);
+		mapped_size = file_stat.st_size;
+		if (mapped_size < sizeof(PackHeader)) {
+			close(file_descriptor);
+			throw std::runtime_error(path + " is not an asset pack!");
+		}
+
+		void *mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+		if (mapping == MAP_FAILED) {
+			close(file_descriptor);
+			throw std::runtime_error("failed to map asset pack " + path + "!");
+		}
+		mapped = static_cast<const uint8_t *>(mapping);
+		// the whole pack is needed during loading, ask for it to be read ahead in large sequential chunks
+		madvise(mapping, mapped_size, MADV_WILLNEED);
+
+		const auto *header = reinterpret_cast<const PackHeader *>(mapped);
+		if (header->magic != PACK_MAGIC || header->version != PACK_VERSION || !std::has_single_bit(header->table_size) ||
+			header->table_offset + header->table_size * sizeof(PackEntry) > mapped_size ||
+			header->names_offset + header->names_size > mapped_size) {
+			munmap(mapping, mapped_size);
+			close(file_descriptor);
+			throw std::runtime_error(path + " is not a valid asset pack!");
+		}
+
+		spdlog::info("Mounted asset pack {} with {} entries ({} MB)", path, header->entry_count,
+					 mapped_size / (1024 * 1024));
+	}
+
+	AssetPack::~AssetPack() {
+		munmap(const_cast<uint8_t *>(mapped), mapped_size);
+		close(file_descriptor);
+	}
+
+	uint64_t AssetPack::hashName(std::string_view name) {
+		// FNV-1a
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (const char c: name) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	bool AssetPack::find(const std::string &name, AssetView &view) const {
+		const auto *header = reinterpret_cast<const PackHeader *>(mapped);
+		const auto *table = reinterpret_cast<const PackEntry *>(mapped + header->table_offset);
+		const auto *names = reinterpret_cast<const char *>(mapped + header->names_offset);
+
+		const uint64_t hash = hashName(name);
+		const uint32_t mask = header->table_size - 1;
+		for (uint32_t probe = 0; probe < header->table_size; probe++) {
+			const PackEntry &entry = table[(hash + probe) & mask];
+			if (entry.type == 0) {
+				return false;
+			}
+			if (static_cast<uint64_t>(entry.name_offset) + entry.name_length > header->names_size) {
+				throw std::runtime_error(path + " has an entry name outside of its name table!");
+			}
+			if (entry.hash == hash && std::string_view(names + entry.name_offset, entry.name_length) == name) {
+				if (entry.offset > mapped_size || entry.size > mapped_size - entry.offset) {
+					throw std::runtime_error("Asset pack entry " + name + " lies outside of " + path + "!");
+				}
+				view = {static_cast<AssetType>(entry.type), mapped + entry.offset, entry.size};
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char *AssetPack::readText(const std::string &name) const {
+		AssetView view{};
+		if (!find(name, view) || view.type != SCENE_ASSET) {
+			return nullptr;
+		}
+		if (view.size == 0 || view.data[view.size - 1] != '\0') {
+			throw std::runtime_error("Asset pack entry " + name + " is not null terminated");
+		}
+		return reinterpret_cast<const char *>(view.data);
+	}
+
+	bool AssetPack::readMesh(const std::string &name, MeshBuffers &mesh_buffers) const {
+		AssetView view{};
+		if (!find(name, view) || view.type != MESH_ASSET) {
+			return false;
+		}
+
+		// every count comes from the file, so nothing is read before its range was checked against the entry
+		PayloadReader reader(view, name);
+		const auto *header = reader.read<MeshPayloadHeader>();
+		const auto *vertices = reader.read<Vertex>(header->vertex_count);
+		const auto *indices = reader.read<uint32_t>(header->index_count);
+		mesh_buffers.vertices.assign(vertices, vertices + header->vertex_count);
+		mesh_buffers.indices.assign(indices, indices + header->index_count);
+
+		const auto *lod_headers = reader.read<LodPayloadHeader>(header->lod_count);
+		mesh_buffers.lods.resize(header->lod_count);
+		for (uint32_t i = 0; i < header->lod_count; i++) {
+			const auto *lod_indices = reader.read<uint32_t>(lod_headers[i].index_count);
+			mesh_buffers.lods[i].indices.assign(lod_indices, lod_indices + lod_headers[i].index_count);
+			mesh_buffers.lods[i].error = lod_headers[i].error;
+		}
+
+		const auto *submesh_headers = reader.read<SubmeshPayloadHeader>(header->submesh_count);
+		const auto *lod_ranges =
+				reader.read<uint32_t>(2 * static_cast<uint64_t>(header->lod_count) * header->submesh_count);
+		mesh_buffers.submeshes.resize(header->submesh_count);
+		for (uint32_t s = 0; s < header->submesh_count; s++) {
+			Submesh &submesh = mesh_buffers.submeshes[s];
+			submesh.index_offset = submesh_headers[s].index_offset;
+			submesh.index_count = submesh_headers[s].index_count;
+			submesh.material_name.assign(reader.read<char>(submesh_headers[s].name_length),
+										 submesh_headers[s].name_length);
+			checkSubmeshRange(submesh, mesh_buffers.indices.size(), name);
+		}
+		for (auto &lod: mesh_buffers.lods) {
+			lod.submeshes = mesh_buffers.submeshes;
+			for (auto &submesh: lod.submeshes) {
+				submesh.index_offset = *lod_ranges++;
+				submesh.index_count = *lod_ranges++;
+				checkSubmeshRange(submesh, lod.indices.size(), name);
+			}
+		}
+		return true;
+	}
+
+	bool AssetPack::readTexture(const std::string &name, ImageData &image_data) const {
+		AssetView view{};
+		if (!find(name, view) || view.type != TEXTURE_ASSET) {
+			return false;
+		}
+
+		PayloadReader reader(view, name);
+		const auto *header = reader.read<TexturePayloadHeader>();
+		image_data.extent = {header->width, header->height, 1};
+		image_data.format = static_cast<VkFormat>(header->format);
+		image_data.mip_levels = header->mip_levels;
+		image_data.pixels.clear();
+		image_data.mapped = {reader.read<uint8_t>(header->data_size), header->data_size};
+		return true;
+	}
+
+	bool AssetPack::readInstances(const std::string &name, std::vector<glm::mat4> &transforms) const {
+		AssetView view{};
+		if (!find(name, view) || view.type != INSTANCE_ASSET) {
+			return false;
+		}
+		transforms = InstanceFile::decode(view.data, view.size, name);
+		return true;
+	}
+
+	void AssetPackWriter::addText(const std::string &name, const std::string &text) {
+		PendingEntry entry{name, SCENE_ASSET, {}};
+		appendBytes(entry.payload, text.c_str(), text.size() + 1);
+		entries.push_back(std::move(entry));
+	}
+
+	void AssetPackWriter::addMesh(const std::string &name, const MeshBuffers &mesh_buffers) {
+		PendingEntry entry{name, MESH_ASSET, {}};
+		MeshPayloadHeader header{static_cast<uint32_t>(mesh_buffers.vertices.size()),
+								 static_cast<uint32_t>(mesh_buffers.indices.size()),
+								 static_cast<uint32_t>(mesh_buffers.lods.size()),
+								 static_cast<uint32_t>(mesh_buffers.submeshes.size())};
+		appendBytes(entry.payload, &header, 1);
+		appendBytes(entry.payload, mesh_buffers.vertices.data(), mesh_buffers.vertices.size());
+		appendBytes(entry.payload, mesh_buffers.indices.data(), mesh_buffers.indices.size());
+		for (const auto &lod: mesh_buffers.lods) {
+			LodPayloadHeader lod_header{static_cast<uint32_t>(lod.indices.size()), lod.error};
+			appendBytes(entry.payload, &lod_header, 1);
+		}
+		for (const auto &lod: mesh_buffers.lods) {
+			appendBytes(entry.payload, lod.indices.data(), lod.indices.size());
+		}
+
+		for (const auto &submesh: mesh_buffers.submeshes) {
+			SubmeshPayloadHeader submesh_header{submesh.index_offset, submesh.index_count,
+												static_cast<uint32_t>(submesh.material_name.size())};
+			appendBytes(entry.payload, &submesh_header, 1);
+		}
+		for (const auto &lod: mesh_buffers.lods) {
+			assert(lod.submeshes.size() == mesh_buffers.submeshes.size());
+			for (const auto &submesh: lod.submeshes) {
+				const uint32_t range[2] = {submesh.index_offset, submesh.index_count};
+				appendBytes(entry.payload, range, 2);
+			}
+		}
+		for (const auto &submesh: mesh_buffers.submeshes) {
+			appendBytes(entry.payload, submesh.material_name.data(), submesh.material_name.size());
+		}
+		entries.push_back(std::move(entry));
+	}
+
+	void AssetPackWriter::addTexture(const std::string &name, const ImageData &image_data) {
+		PendingEntry entry{name, TEXTURE_ASSET, {}};
+		const std::span<const uint8_t> bytes = image_data.bytes();
+		TexturePayloadHeader header{static_cast<uint32_t>(image_data.format), image_data.extent.width,
+									image_data.extent.height, image_data.mip_levels, bytes.size(), 0};
+		appendBytes(entry.payload, &header, 1);
+		appendBytes(entry.payload, bytes.data(), bytes.size());
+		entries.push_back(std::move(entry));
+	}
+
+	void AssetPackWriter::addInstances(const std::string &name, const std::vector<glm::mat4> &transforms) {
+		entries.push_back({name, INSTANCE_ASSET, InstanceFile::encode(transforms)});
+	}
+
+	void AssetPackWriter::write(const std::string &path) const {
+		QuickTimer timer("Writing asset pack");
+
+		PackHeader header{};
+		header.magic = PACK_MAGIC;
+		header.version = PACK_VERSION;
+		header.entry_count = static_cast<uint32_t>(entries.size());
+		header.table_size = std::bit_ceil(std::max<uint32_t>(2 * header.entry_count, 1));
+
+		// layout: header, table, names, then the page aligned payloads
+		std::vector<PackEntry> table(header.table_size);
+		std::string names;
+		header.table_offset = sizeof(PackHeader);
+		uint64_t offset = header.table_offset + table.size() * sizeof(PackEntry);
+		for (const auto &entry: entries) {
+			names += entry.name;
+		}
+		header.names_offset = offset;
+		header.names_size = names.size();
+		offset += names.size();
+
+		uint32_t name_offset = 0;
+		std::vector<uint64_t> payload_offsets;
+		for (const auto &entry: entries) {
+			offset = alignUp(offset, PAYLOAD_ALIGNMENT);
+			payload_offsets.push_back(offset);
+
+			const uint64_t hash = AssetPack::hashName(entry.name);
+			uint32_t slot = hash & (header.table_size - 1);
+			while (table[slot].type != 0) {
+				slot = (slot + 1) & (header.table_size - 1);
+			}
+			table[slot] = {hash, offset, entry.payload.size(), entry.type, name_offset,
+						   static_cast<uint32_t>(entry.name.size()), 0};
+
+			name_offset += entry.name.size();
+			offset += entry.payload.size();
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to create asset pack " + path + "!");
+		}
+		file.write(reinterpret_cast<const char *>(&header), sizeof(PackHeader));
+		file.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(PackEntry));
+		file.write(names.data(), names.size());
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			const std::vector<char> padding(payload_offsets[i] - static_cast<uint64_t>(file.tellp()), 0);
+			file.write(padding.data(), padding.size());
+			file.write(reinterpret_cast<const char *>(entries[i].payload.data()), entries[i].payload.size());
+		}
+		if (!file) {
+			throw std::runtime_error("failed to write asset pack " + path + "!");
+		}
+
+		spdlog::info("Wrote asset pack {} with {} entries ({} MB)", path, entries.size(), offset / (1024 * 1024));
+	}
+} // namespace RtEngine
@@ -0,0 +1,126 @@
+#include "AssetPacker.hpp"
+
+#include <GltfModelLoader.hpp>
+#include <InstanceFile.hpp>
+#include <Ktx2Reader.hpp>
+#include <MetalRoughMaterial.hpp>
+#include <PathUtil.hpp>
+#include <QuickTimer.hpp>
+#include <TextureCompressor.hpp>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <unordered_set>
+
+namespace RtEngine {
+	void AssetPacker::pack(const std::string &scene_name) const {
+		QuickTimer timer("Packing scene");
+
+		const std::string scene_path = std::format("{}/scenes/{}.yaml", resources_dir, scene_name);
+		std::ifstream scene_file(scene_path);
+		if (!scene_file.is_open()) {
+			throw std::runtime_error("failed to open scene " + scene_path + "!");
+		}
+		std::stringstream scene_text;
+		scene_text << scene_file.rdbuf();
+
+		AssetPackWriter writer;
+		YAML::Node config = YAML::Load(scene_text.str());
+		YAML::Node scene_node = config["scene"];
+		for (const auto &mesh_node: scene_node["meshes"]) {
+			const auto mesh_path = mesh_node["path"].as<std::string>();
+			spdlog::info("Packing mesh {}", mesh_path);
+			writer.addMesh(mesh_path, ModelLoader::createLoader(mesh_path)->loadMeshBuffers(resources_dir, mesh_path));
+		}
+
+		// sidecar paths are relative to the scene file
+		for (const auto &array_node: scene_node["instance_arrays"]) {
+			if (array_node["transforms_file"]) {
+				const auto instance_path = array_node["transforms_file"].as<std::string>();
+				spdlog::info("Packing instances {}", instance_path);
+				writer.addInstances(instance_path,
+									InstanceFile::read(std::format("{}/scenes/{}", resources_dir, instance_path)));
+			}
+		}
+
+		// packed scenes never touch the model files, so their materials are written into the scene
+		if (scene_node["material_name"].as<std::string>() == METAL_ROUGH_MATERIAL_NAME) {
+			addModelMaterials(scene_node);
+		}
+		YAML::Emitter scene_out;
+		scene_out << config;
+		writer.addText(AssetPack::SCENE_ENTRY, scene_out.c_str());
+
+		for (const auto &[texture_path, type]: collectTextures(scene_node)) {
+			spdlog::info("Packing texture {}", texture_path);
+			writer.addTexture(texture_path, importTexture(texture_path, type));
+		}
+
+		writer.write(std::format("{}/scenes/{}.{}", resources_dir, scene_name, AssetPack::EXTENSION));
+	}
+
+	void AssetPacker::addModelMaterials(YAML::Node &scene_node) const {
+		std::unordered_set<std::string> material_names;
+		for (const auto &material_node: scene_node["materials"]) {
+			material_names.insert(material_node["name"].as<std::string>());
+		}
+
+		for (const auto &mesh_node: scene_node["meshes"]) {
+			const auto mesh_path = mesh_node["path"].as<std::string>();
+			if (!GltfModelLoader::isGltfFile(mesh_path)) {
+				continue;
+			}
+			for (const auto &material_node: GltfModelLoader::loadMaterials(resources_dir, mesh_path)) {
+				if (material_names.insert(material_node["name"].as<std::string>()).second) {
+					scene_node["materials"].push_back(material_node);
+				}
+			}
+		}
+	}
+
+	std::vector<std::pair<std::string, TextureType>> AssetPacker::collectTextures(const YAML::Node &scene_node) {
+		std::vector<std::pair<std::string, TextureType>> textures;
+		auto add_texture = [&](const std::string &path, TextureType type) {
+			for (const auto &texture: textures) {
+				if (texture.first == path) {
+					return;
+				}
+			}
+			textures.emplace_back(path, type);
+		};
+
+		for (const auto &material_node: scene_node["materials"]) {
+			if (material_node["albedo_tex"]) {
+				add_texture(material_node["albedo_tex"].as<std::string>(), PARAMETER);
+			}
+			if (material_node["metal_rough_ao_tex"]) {
+				add_texture(material_node["metal_rough_ao_tex"].as<std::string>(), PARAMETER);
+			}
+			if (material_node["normal_tex"]) {
+				add_texture(material_node["normal_tex"].as<std::string>(), NORMAL);
+			}
+		}
+
+		if (scene_node["environment_map"]) {
+			for (const auto &texture_node: scene_node["environment_map"]["textures"]) {
+				add_texture(texture_node.as<std::string>(), ENVIRONMENT);
+			}
+		}
+		return textures;
+	}
+
+	// same import as ResourceBuilder::importTextureImage, packs always target devices with BC support
+	ImageData AssetPacker::importTexture(const std::string &path, TextureType type) const {
+		const std::string full_path = resources_dir + "/" + path;
+		if (PathUtil::getExtension(path) == "ktx2") {
+			return Ktx2Reader::read(full_path);
+		}
+
+		ImageData image_data = ResourceBuilder::decodeTextureFile(full_path, type);
+		if (type != ENVIRONMENT) {
+			TextureCompressor::generateMipChain(image_data, type == NORMAL);
+			TextureCompressor::compress(image_data, type == NORMAL);
+		}
+		return image_data;
+	}
+} // namespace RtEngine
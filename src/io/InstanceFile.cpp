@@ -0,0 +1,96 @@
+#include "InstanceFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace RtEngine {
+	namespace {
+		constexpr size_t TRANSFORM_SIZE = InstanceFile::FLOATS_PER_TRANSFORM * sizeof(float);
+		constexpr uint32_t INSTANCE_MAGIC = 0x4E495452; // "RTIN"
+		constexpr uint32_t INSTANCE_VERSION = 1;
+
+		struct InstanceFileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t instance_count;
+			uint32_t floats_per_transform;
+		};
+	} // namespace
+
+	std::vector<glm::mat4> InstanceFile::read(const std::string &path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			throw std::runtime_error("failed to open instance file " + path + "!");
+		}
+		const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return decode(bytes.data(), bytes.size(), path);
+	}
+
+	void InstanceFile::write(const std::string &path, const std::vector<glm::mat4> &transforms) {
+		const std::vector<uint8_t> bytes = encode(transforms);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+		if (!file) {
+			throw std::runtime_error("failed to write instance file " + path + "!");
+		}
+	}
+
+	std::vector<uint8_t> InstanceFile::encode(const std::vector<glm::mat4> &transforms) {
+		if (transforms.size() > UINT32_MAX) {
+			throw std::runtime_error("Too many instances for an instance file");
+		}
+		const InstanceFileHeader header{INSTANCE_MAGIC, INSTANCE_VERSION, static_cast<uint32_t>(transforms.size()),
+										FLOATS_PER_TRANSFORM};
+		std::vector<uint8_t> bytes(sizeof(InstanceFileHeader) + transforms.size() * TRANSFORM_SIZE);
+		std::memcpy(bytes.data(), &header, sizeof(InstanceFileHeader));
+
+		auto *packed = reinterpret_cast<float *>(bytes.data() + sizeof(InstanceFileHeader));
+		for (size_t i = 0; i < transforms.size(); i++) {
+			packTransform(transforms[i], packed + i * FLOATS_PER_TRANSFORM);
+		}
+		return bytes;
+	}
+
+	std::vector<glm::mat4> InstanceFile::decode(const uint8_t *data, size_t size, const std::string &name) {
+		InstanceFileHeader header{};
+		if (size >= sizeof(InstanceFileHeader)) {
+			std::memcpy(&header, data, sizeof(InstanceFileHeader));
+		}
+		// the count is checked by division, a product of it could wrap around for crafted files
+		if (header.magic != INSTANCE_MAGIC || header.version != INSTANCE_VERSION ||
+			header.floats_per_transform != FLOATS_PER_TRANSFORM ||
+			header.instance_count > (size - sizeof(InstanceFileHeader)) / TRANSFORM_SIZE) {
+			throw std::runtime_error(name + " is not a valid instance file!");
+		}
+
+		// the payload may sit anywhere inside of a mapped pack, copy it out instead of casting
+		std::vector<float> packed(static_cast<size_t>(header.instance_count) * FLOATS_PER_TRANSFORM);
+		std::memcpy(packed.data(), data + sizeof(InstanceFileHeader), packed.size() * sizeof(float));
+
+		std::vector<glm::mat4> transforms(header.instance_count);
+		for (size_t i = 0; i < transforms.size(); i++) {
+			transforms[i] = unpackTransform(packed.data() + i * FLOATS_PER_TRANSFORM);
+		}
+		return transforms;
+	}
+
+	glm::mat4 InstanceFile::unpackTransform(const float *packed) {
+		glm::mat4 transform(1.0f);
+		for (uint32_t row = 0; row < 3; row++) {
+			for (uint32_t column = 0; column < 4; column++) {
+				transform[column][row] = packed[row * 4 + column];
+			}
+		}
+		return transform;
+	}
+
+	void InstanceFile::packTransform(const glm::mat4 &transform, float *packed) {
+		for (uint32_t row = 0; row < 3; row++) {
+			for (uint32_t column = 0; column < 4; column++) {
+				packed[row * 4 + column] = transform[column][row];
+			}
+		}
+	}
+} // namespace RtEngine
@@ -1,14 +1,21 @@
 #include "SceneReader.hpp"
 
+#include <Animation.hpp>
+#include <AssetPack.hpp>
+#include <AssetPacker.hpp>
+#include <InstanceFile.hpp>
 #include <MeshRenderer.hpp>
 #include <Node.hpp>
+#include <PathUtil.hpp>
 #include <QuickTimer.hpp>
 #include <Rigidbody.hpp>
 #include <TransformUtil.hpp>
 #include <YAML_glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <spdlog/spdlog.h>
+#include <unordered_set>
 #include "Material.hpp"
+#include "MetalRoughMaterial.hpp"
 #include "YamlLoadProperties.hpp"
 #include "components/Camera.hpp"
 
@@ -18,11 +25,66 @@ namespace RtEngine {
 	std::shared_ptr<Scene>
 	SceneReader::readScene(const std::string &file_path,
 						   std::unordered_map<std::string, std::shared_ptr<Material>> materials) {
+		return readScene(prepareScene(file_path), std::move(materials));
+	}
+
+	PreparedScene SceneReader::prepareScene(const std::string &file_path) const {
+		QuickTimer quick_timer("Preparing scene from file");
+
+		try {
+			PreparedScene prepared_scene;
+			prepared_scene.path = file_path;
+			if (PathUtil::getExtension(file_path) == AssetPack::EXTENSION) {
+				// everything the scene references is read from the pack while it stays mounted
+				prepared_scene.pack = std::make_shared<AssetPack>(file_path);
+				const char *scene_text = prepared_scene.pack->readText(AssetPack::SCENE_ENTRY);
+				if (scene_text == nullptr) {
+					throw std::runtime_error("Asset pack " + file_path + " contains no scene");
+				}
+				prepared_scene.config = YAML::Load(scene_text);
+			} else {
+				prepared_scene.config = YAML::LoadFile(file_path);
+			}
+			YAML::Node scene_node = prepared_scene.config["scene"];
+
+			// packs already contain the materials of their models
+			if (prepared_scene.pack == nullptr &&
+				scene_node["material_name"].as<std::string>() == METAL_ROUGH_MATERIAL_NAME) {
+				addModelMaterials(scene_node);
+			}
+
+			for (const auto &mesh_node: scene_node["meshes"]) {
+				auto mesh_path = mesh_node["path"].as<std::string>();
+				if (!engine_context->mesh_repository->hasMesh(mesh_path)) {
+					prepared_scene.meshes.emplace_back(
+							mesh_path, engine_context->mesh_repository->importMesh(mesh_path, prepared_scene.pack));
+				}
+			}
+
+			std::vector<std::pair<std::string, TextureType>> textures = AssetPacker::collectTextures(scene_node);
+			std::erase_if(textures, [&](const auto &texture) {
+				return engine_context->texture_repository->hasTexture(texture.first);
+			});
+			prepared_scene.texture_images =
+					engine_context->texture_repository->loadTextureImages(textures, prepared_scene.pack);
+
+			return prepared_scene;
+		} catch (const YAML::Exception &e) {
+			throw std::runtime_error(e.what());
+		}
+	}
+
+	std::shared_ptr<Scene>
+	SceneReader::readScene(PreparedScene prepared_scene,
+						   std::unordered_map<std::string, std::shared_ptr<Material>> materials) {
 		QuickTimer quick_timer("Reading scene from file");
 
 		try {
-			YAML::Node config = YAML::LoadFile(file_path);
-			YAML::Node scene_node = config["scene"];
+			const std::string &file_path = prepared_scene.path;
+			const std::shared_ptr<AssetPack> &pack = prepared_scene.pack;
+			engine_context->mesh_repository->setAssetPack(pack);
+			engine_context->texture_repository->setAssetPack(pack);
+			YAML::Node scene_node = prepared_scene.config["scene"];
 
 			auto material_name = scene_node["material_name"].as<std::string>();
 			if (!materials.contains(material_name))
@@ -38,15 +100,29 @@ namespace RtEngine {
 				scene->environment_map->loadFromYaml(scene_node["environment_map"]);
 			}
 
+			engine_context->mesh_repository->resetDeduplicationStats();
+			engine_context->texture_repository->resetDeduplicationStats();
+			for (auto &[mesh_path, mesh_asset]: prepared_scene.meshes) {
+				engine_context->mesh_repository->addMesh(mesh_path, std::move(mesh_asset));
+			}
 			for (const auto &mesh_node: scene_node["meshes"]) {
 				std::string mesh_path = mesh_node["path"].as<std::string>();
 				engine_context->mesh_repository->addMesh(mesh_path);
 			}
 
 			initializeMaterial(scene_node["materials"], materials[material_name]);
+			engine_context->texture_repository->uploadPendingTextures(std::move(prepared_scene.texture_images));
+
+			const DeduplicationStats &mesh_dedup = engine_context->mesh_repository->getDeduplicationStats();
+			const DeduplicationStats &texture_dedup = engine_context->texture_repository->getDeduplicationStats();
+			if (mesh_dedup.aliased_assets + texture_dedup.aliased_assets > 0) {
+				spdlog::info("Deduplicated {} meshes and {} textures, saved {:.2f} MB",
+							 mesh_dedup.aliased_assets, texture_dedup.aliased_assets,
+							 (mesh_dedup.bytes_saved + texture_dedup.bytes_saved) / (1024.0 * 1024.0));
+			}
 
 			std::shared_ptr<Node> scene_graph_node = std::make_shared<Node>();
-			scene_graph_node->name = "root";
+			scene_graph_node->name = Scene::ROOT_NODE_NAME;
 			glm::mat4 identity = glm::mat4(1.0f);
 			scene_graph_node->transform->setLocalTransform(identity);
 			scene_graph_node->children = {};
@@ -54,7 +130,10 @@ namespace RtEngine {
 				scene_graph_node->children.push_back(
 						processSceneNodesRecursiv(static_cast<YAML::Node>(yaml_mesh_node), scene));
 			}
-			scene->addNode(scene_graph_node->name, scene_graph_node);
+			scene->addNode(scene_graph_node);
+			scene->refreshTransforms();
+
+			loadInstanceArrays(scene_node["instance_arrays"], scene, PathUtil::getDirectory(file_path), pack);
 
 			return scene;
 		} catch (const YAML::Exception &e) {
@@ -77,12 +156,67 @@ namespace RtEngine {
 		}
 	}
 
+	void SceneReader::loadInstanceArrays(const YAML::Node &array_nodes, const std::shared_ptr<Scene> &scene,
+										 const std::string &scene_dir, const std::shared_ptr<AssetPack> &pack) {
+		for (const auto &array_node: array_nodes) {
+			const auto name = array_node["name"].as<std::string>();
+			std::vector<glm::mat4> transforms;
+			std::string transforms_file;
+			if (array_node["transforms_file"]) {
+				transforms_file = array_node["transforms_file"].as<std::string>();
+				if (pack == nullptr || !pack->readInstances(transforms_file, transforms)) {
+					transforms = InstanceFile::read(scene_dir.empty() ? transforms_file
+																	  : scene_dir + "/" + transforms_file);
+				}
+			} else {
+				// one row major 3x4 matrix per instance, flattened
+				std::array<float, InstanceFile::FLOATS_PER_TRANSFORM> packed{};
+				for (const auto &transform_node: array_node["transforms"]) {
+					if (transform_node.size() != InstanceFile::FLOATS_PER_TRANSFORM) {
+						throw std::runtime_error("Transform of instance array " + name + " needs " +
+												 std::to_string(InstanceFile::FLOATS_PER_TRANSFORM) + " values");
+					}
+					for (uint32_t i = 0; i < InstanceFile::FLOATS_PER_TRANSFORM; i++) {
+						packed[i] = transform_node[i].as<float>();
+					}
+					transforms.push_back(InstanceFile::unpackTransform(packed.data()));
+				}
+			}
+
+			const std::string material_instance_name =
+					array_node["material_name"] ? array_node["material_name"].as<std::string>() : "";
+			auto instance_array =
+					std::make_shared<InstanceArray>(engine_context, name, array_node["mesh"].as<std::string>(),
+													material_instance_name, std::move(transforms));
+			instance_array->transforms_file = transforms_file;
+			scene->addInstanceArray(instance_array);
+			spdlog::debug("Loaded instance array {} with {} instances", name, instance_array->size());
+		}
+	}
+
 	void SceneReader::initializeMaterial(const YAML::Node &material_nodes, std::shared_ptr<Material> &material) {
 		for (const auto &material_node: material_nodes) {
 			material->loadInstance(material_node);
 		}
 	}
 
+	void SceneReader::addModelMaterials(YAML::Node &scene_node) const {
+		std::unordered_set<std::string> material_names;
+		for (const auto &material_node: scene_node["materials"]) {
+			material_names.insert(material_node["name"].as<std::string>());
+		}
+
+		for (const auto &mesh_node: scene_node["meshes"]) {
+			const auto mesh_path = mesh_node["path"].as<std::string>();
+			for (const auto &material_node: engine_context->mesh_repository->loadMeshMaterials(mesh_path)) {
+				// instances defined in the scene override the ones from the model file
+				if (material_names.insert(material_node["name"].as<std::string>()).second) {
+					scene_node["materials"].push_back(material_node);
+				}
+			}
+		}
+	}
+
 	std::shared_ptr<Node> SceneReader::processSceneNodesRecursiv(const YAML::Node &yaml_node,
 																 const std::shared_ptr<Scene> &scene) {
 		std::shared_ptr<Node> scene_graph_node = std::make_shared<Node>();
@@ -92,9 +226,7 @@ namespace RtEngine {
 		for (auto &child_node: yaml_node["children"]) {
 			scene_graph_node->children.push_back(processSceneNodesRecursiv(child_node, scene));
 		}
-		scene_graph_node->refreshTransform(glm::mat4(1.0f));
-
-		scene->addNode(scene_graph_node->name, scene_graph_node);
+		scene->addNode(scene_graph_node);
 		return scene_graph_node;
 	}
 
@@ -115,6 +247,11 @@ namespace RtEngine {
 				auto rb = std::make_shared<Rigidbody>(scene_node);
 				rb->initProperties(properties, update_flags);
 				scene_node->addComponent(rb);
+			} else if (comp_name == Animation::COMPONENT_NAME) {
+				auto animation = std::make_shared<Animation>(scene_node);
+				animation->initProperties(properties, update_flags);
+				animation->loadTracks(comp_node.second["tracks"]);
+				scene_node->addComponent(animation);
 			} else if (comp_name == Camera::COMPONENT_NAME) {
 				auto cam = std::make_shared<Camera>(engine_context, scene_node);
 				cam->initProperties(properties, update_flags);
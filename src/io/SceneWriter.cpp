@@ -1,5 +1,8 @@
 #include "SceneWriter.hpp"
+#include <Animation.hpp>
+#include <InstanceFile.hpp>
 #include <MeshRenderer.hpp>
+#include <PathUtil.hpp>
 #include <QuickTimer.hpp>
 #include <SceneUtil.hpp>
 #include <TransformUtil.hpp>
@@ -24,23 +27,30 @@ namespace RtEngine {
 
 		writeSceneLights(out, scene);
 
-		std::vector<std::shared_ptr<MeshAsset>> meshes = SceneUtil::collectMeshAssets(scene->getRootNode());
+		std::vector<std::shared_ptr<MeshAsset>> meshes = scene->getMeshAssets();
 		out << YAML::Key << "meshes" << YAML::Value << YAML::BeginSeq;
 		for (const auto &mesh: meshes) {
 			out << YAML::BeginMap;
 			out << YAML::Key << "path" << YAML::Value << mesh->path;
 			out << YAML::EndMap;
+			for (const auto &alias_path: mesh->alias_paths) {
+				out << YAML::BeginMap;
+				out << YAML::Key << "path" << YAML::Value << alias_path;
+				out << YAML::EndMap;
+			}
 		}
 		out << YAML::EndSeq;
 
 		writeMaterial(out, scene->material);
 
 		out << YAML::Key << "nodes" << YAML::Value << YAML::BeginSeq;
-		for (const auto &node: scene->nodes["root"]->children) {
+		for (const auto &node: scene->getRootNode()->children) {
 			writeSceneNode(out, node);
 		}
 		out << YAML::EndSeq;
 
+		writeInstanceArrays(out, scene, PathUtil::getDirectory(filename));
+
 		out << YAML::EndMap;
 		out << YAML::EndMap;
 
@@ -60,6 +70,45 @@ namespace RtEngine {
 		out << YAML::EndSeq;
 	}
 
+	void SceneWriter::writeInstanceArrays(YAML::Emitter &out, const std::shared_ptr<Scene> &scene,
+										  const std::string &scene_dir) {
+		if (scene->getInstanceArrays().empty()) {
+			return;
+		}
+
+		out << YAML::Key << "instance_arrays" << YAML::Value << YAML::BeginSeq;
+		for (const auto &instance_array: scene->getInstanceArrays()) {
+			out << YAML::BeginMap;
+			out << YAML::Key << "name" << YAML::Value << instance_array->name;
+			out << YAML::Key << "mesh" << YAML::Value << instance_array->mesh_asset_name;
+			if (!instance_array->material_instance_name.empty()) {
+				out << YAML::Key << "material_name" << YAML::Value << instance_array->material_instance_name;
+			}
+
+			if (!instance_array->transforms_file.empty()) {
+				// the sidecar is written next to the scene so the reference stays valid
+				out << YAML::Key << "transforms_file" << YAML::Value << instance_array->transforms_file;
+				InstanceFile::write(scene_dir.empty() ? instance_array->transforms_file
+													  : scene_dir + "/" + instance_array->transforms_file,
+									instance_array->getTransforms());
+			} else {
+				std::array<float, InstanceFile::FLOATS_PER_TRANSFORM> packed{};
+				out << YAML::Key << "transforms" << YAML::Value << YAML::BeginSeq;
+				for (const auto &transform: instance_array->getTransforms()) {
+					InstanceFile::packTransform(transform, packed.data());
+					out << YAML::Flow << YAML::BeginSeq;
+					for (float value: packed) {
+						out << value;
+					}
+					out << YAML::EndSeq;
+				}
+				out << YAML::EndSeq;
+			}
+			out << YAML::EndMap;
+		}
+		out << YAML::EndSeq;
+	}
+
 	void SceneWriter::writeSceneLights(YAML::Emitter &out, const std::shared_ptr<Scene> &scene) {
 		out << YAML::Key << "lights" << YAML::Value << YAML::BeginMap;
 
@@ -121,6 +170,10 @@ namespace RtEngine {
 		for (auto &component: node->components) {
 			component->initProperties(props, update_flags);
 		}
+		// the tracks are lists, which the properties can not express
+		if (auto animation = node->getComponent<Animation>()) {
+			components_root[Animation::COMPONENT_NAME]["tracks"] = animation->writeTracksToYaml();
+		}
 
 		return components_root;
 	}
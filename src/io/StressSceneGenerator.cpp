@@ -0,0 +1,284 @@
+#include "StressSceneGenerator.hpp"
+
+#include <InstanceFile.hpp>
+#include <QuickTimer.hpp>
+#include <YAML_glm.hpp>
+#include <array>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <stb_image_write.h>
+#include <yaml-cpp/yaml.h>
+
+namespace RtEngine {
+	namespace {
+		constexpr uint32_t TEXTURE_SIZE = 256;
+		constexpr uint32_t ROCK_WAVE_COUNT = 6;
+		// distance between neighbouring instances on average
+		constexpr float INSTANCE_SPACING = 3.0f;
+
+		// sphere with a few random waves on its radius, smooth enough to get its normals from finite differences
+		struct RockShape {
+			std::array<glm::vec3, ROCK_WAVE_COUNT> frequencies;
+			std::array<float, ROCK_WAVE_COUNT> phases;
+			std::array<float, ROCK_WAVE_COUNT> amplitudes;
+
+			glm::vec3 position(float theta, float phi) const {
+				const glm::vec3 direction(std::sin(theta) * std::cos(phi), std::cos(theta),
+										  std::sin(theta) * std::sin(phi));
+				float radius = 1.0f;
+				for (uint32_t i = 0; i < ROCK_WAVE_COUNT; i++) {
+					radius += amplitudes[i] * std::sin(glm::dot(frequencies[i], direction) + phases[i]);
+				}
+				return direction * radius;
+			}
+		};
+
+		std::string generatedPath(const std::string &folder, const std::string &file_name) {
+			return std::format("{}/generated/{}", folder, file_name);
+		}
+	} // namespace
+
+	std::string StressSceneParameters::getSceneName() const {
+		return std::format("stress_n{}_m{}_e{}_t{}", instance_count, unique_mesh_count, emitter_count, texture_count);
+	}
+
+	std::string StressSceneGenerator::generate(const StressSceneParameters &parameters) const {
+		QuickTimer timer("Generating stress scene");
+
+		const std::string scene_name = parameters.getSceneName();
+		std::filesystem::create_directories(scenes_dir);
+		std::filesystem::create_directories(resources_dir + "/meshes/generated");
+		std::filesystem::create_directories(resources_dir + "/textures/generated");
+
+		const uint32_t mesh_count = std::max(parameters.unique_mesh_count, 1u);
+		const uint32_t material_count = std::max(parameters.texture_count, 1u);
+		const uint32_t emitter_count = std::min(parameters.emitter_count, parameters.instance_count);
+
+		YAML::Emitter out;
+		out << YAML::BeginMap;
+		out << YAML::Key << "scene" << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "material_name" << YAML::Value << "metal_rough";
+
+		out << YAML::Key << "lights" << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "point_lights" << YAML::Value << YAML::BeginSeq << YAML::EndSeq;
+		out << YAML::EndMap;
+
+		out << YAML::Key << "meshes" << YAML::Value << YAML::BeginSeq;
+		std::vector<std::string> mesh_names;
+		for (uint32_t i = 0; i < mesh_count; i++) {
+			const std::string mesh_path = writeMesh(parameters, i);
+			mesh_names.push_back(std::filesystem::path(mesh_path).stem().string());
+			out << YAML::BeginMap << YAML::Key << "path" << YAML::Value << mesh_path << YAML::EndMap;
+		}
+		out << YAML::EndSeq;
+
+		std::mt19937 random(parameters.seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		out << YAML::Key << "materials" << YAML::Value << YAML::BeginSeq;
+		for (uint32_t i = 0; i < material_count; i++) {
+			out << YAML::BeginMap;
+			out << YAML::Key << "name" << YAML::Value << std::format("stress_material_{}", i);
+			if (parameters.texture_count > 0) {
+				out << YAML::Key << "albedo_tex" << YAML::Value << writeTexture(parameters, i);
+			} else {
+				out << YAML::Key << "albedo" << YAML::Value
+					<< YAML::convert<glm::vec3>::encode(glm::vec3(unit(random), unit(random), unit(random)));
+			}
+			out << YAML::Key << "metallic" << YAML::Value << 0.1f;
+			out << YAML::Key << "roughness" << YAML::Value << 0.2f + 0.8f * unit(random);
+			out << YAML::Key << "ao" << YAML::Value << 1.0f;
+			out << YAML::Key << "eta" << YAML::Value << 1.0f;
+			out << YAML::EndMap;
+		}
+		out << YAML::BeginMap;
+		out << YAML::Key << "name" << YAML::Value << "stress_emitter";
+		out << YAML::Key << "albedo" << YAML::Value << YAML::convert<glm::vec3>::encode(glm::vec3(1.0f));
+		out << YAML::Key << "eta" << YAML::Value << 1.0f;
+		out << YAML::Key << "emission_color" << YAML::Value << YAML::convert<glm::vec3>::encode(glm::vec3(1.0f, 0.9f, 0.7f));
+		out << YAML::Key << "emission_power" << YAML::Value << 5.0f;
+		out << YAML::EndMap;
+		out << YAML::EndSeq;
+
+		// the field grows with the instance count so the density stays the same
+		const float extent = std::sqrt(static_cast<float>(parameters.instance_count)) * INSTANCE_SPACING;
+
+		out << YAML::Key << "nodes" << YAML::Value << YAML::BeginSeq;
+		out << YAML::BeginMap;
+		out << YAML::Key << "name" << YAML::Value << "Camera";
+		out << YAML::Key << "components" << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "Transform" << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "position" << YAML::Value
+			<< YAML::convert<glm::vec3>::encode(glm::vec3(0.0f, 0.3f * extent + 5.0f, 0.6f * extent + 5.0f));
+		out << YAML::Key << "rotation" << YAML::Value << YAML::convert<glm::vec3>::encode(glm::vec3(-0.45f, 0.0f, 0.0f));
+		out << YAML::Key << "scale" << YAML::Value << YAML::convert<glm::vec3>::encode(glm::vec3(1.0f));
+		out << YAML::EndMap;
+		out << YAML::Key << "Camera" << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "fov" << YAML::Value << 45.0f;
+		out << YAML::EndMap;
+		out << YAML::EndMap;
+		out << YAML::Key << "children" << YAML::Value << YAML::BeginSeq << YAML::EndSeq;
+		out << YAML::EndMap;
+		out << YAML::EndSeq;
+
+		// every combination of mesh and material gets an array of its own, the emitters float above the field
+		const uint32_t array_count = std::max(mesh_count, material_count);
+		std::vector<std::vector<glm::mat4>> array_transforms(array_count);
+		for (uint32_t i = 0; i < parameters.instance_count - emitter_count; i++) {
+			const glm::vec3 position((unit(random) - 0.5f) * extent, 0.0f, (unit(random) - 0.5f) * extent);
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+			transform = glm::rotate(transform, unit(random) * glm::two_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f));
+			transform = glm::scale(transform, glm::vec3(0.5f + unit(random)));
+			array_transforms[i % array_count].push_back(transform);
+		}
+		std::vector<glm::mat4> emitter_transforms;
+		for (uint32_t i = 0; i < emitter_count; i++) {
+			const glm::vec3 position((unit(random) - 0.5f) * extent, 4.0f, (unit(random) - 0.5f) * extent);
+			emitter_transforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.3f)));
+		}
+
+		auto write_array = [&](const std::string &array_name, const std::string &mesh, const std::string &material,
+							   const std::vector<glm::mat4> &transforms) {
+			if (transforms.empty()) {
+				return;
+			}
+			const std::string transforms_file = std::format("{}.{}", array_name, InstanceFile::EXTENSION);
+			InstanceFile::write(scenes_dir + "/" + transforms_file, transforms);
+
+			out << YAML::BeginMap;
+			out << YAML::Key << "name" << YAML::Value << array_name;
+			out << YAML::Key << "mesh" << YAML::Value << mesh;
+			out << YAML::Key << "material_name" << YAML::Value << material;
+			out << YAML::Key << "transforms_file" << YAML::Value << transforms_file;
+			out << YAML::EndMap;
+		};
+
+		out << YAML::Key << "instance_arrays" << YAML::Value << YAML::BeginSeq;
+		for (uint32_t i = 0; i < array_count; i++) {
+			write_array(std::format("{}_{}", scene_name, i), mesh_names[i % mesh_count],
+						std::format("stress_material_{}", i % material_count), array_transforms[i]);
+		}
+		write_array(scene_name + "_emitters", mesh_names[0], "stress_emitter", emitter_transforms);
+		out << YAML::EndSeq;
+
+		out << YAML::EndMap;
+		out << YAML::EndMap;
+
+		const std::string scene_path = std::format("{}/{}.yaml", scenes_dir, scene_name);
+		std::ofstream scene_file(scene_path);
+		scene_file << out.c_str();
+		if (!scene_file) {
+			throw std::runtime_error("failed to write scene " + scene_path + "!");
+		}
+
+		spdlog::info("Generated {} with {} instances in {} arrays", scene_path, parameters.instance_count,
+					 array_count + (emitter_count > 0 ? 1 : 0));
+		return scene_path;
+	}
+
+	std::string StressSceneGenerator::writeMesh(const StressSceneParameters &parameters, uint32_t mesh_index) const {
+		const std::string mesh_path = generatedPath(
+				"meshes", std::format("stress_rock_{}_{}_{}.obj", parameters.seed, parameters.mesh_segments, mesh_index));
+		const std::string full_path = resources_dir + "/" + mesh_path;
+		if (std::filesystem::exists(full_path)) {
+			return mesh_path;
+		}
+
+		std::mt19937 random(parameters.seed * 7919 + mesh_index);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		RockShape shape{};
+		for (uint32_t i = 0; i < ROCK_WAVE_COUNT; i++) {
+			shape.frequencies[i] = glm::vec3(unit(random), unit(random), unit(random)) * 6.0f - 3.0f;
+			shape.phases[i] = unit(random) * glm::two_pi<float>();
+			shape.amplitudes[i] = 0.15f * unit(random) / static_cast<float>(i + 1);
+		}
+
+		// the seam column is duplicated so the texture coordinates can wrap around
+		const uint32_t columns = std::max(parameters.mesh_segments, 3u);
+		const uint32_t rows = std::max(columns / 2, 2u);
+		constexpr float epsilon = 1e-3f;
+
+		std::ofstream file(full_path);
+		for (uint32_t row = 0; row <= rows; row++) {
+			for (uint32_t column = 0; column <= columns; column++) {
+				const float theta = glm::pi<float>() * static_cast<float>(row) / static_cast<float>(rows);
+				const float phi = glm::two_pi<float>() * static_cast<float>(column) / static_cast<float>(columns);
+				const glm::vec3 position = shape.position(theta, phi);
+
+				glm::vec3 normal = glm::normalize(position);
+				if (row > 0 && row < rows) {
+					const glm::vec3 d_theta = shape.position(theta + epsilon, phi) - shape.position(theta - epsilon, phi);
+					const glm::vec3 d_phi = shape.position(theta, phi + epsilon) - shape.position(theta, phi - epsilon);
+					normal = glm::normalize(glm::cross(d_phi, d_theta));
+				}
+
+				file << std::format("v {} {} {}\n", position.x, position.y, position.z);
+				file << std::format("vt {} {}\n", static_cast<float>(column) / columns, static_cast<float>(row) / rows);
+				file << std::format("vn {} {} {}\n", normal.x, normal.y, normal.z);
+			}
+		}
+
+		// obj indices start at one, the rows at the poles only need one triangle per quad
+		auto index = [&](uint32_t row, uint32_t column) { return row * (columns + 1) + column + 1; };
+		auto face = [&](uint32_t a, uint32_t b, uint32_t c) {
+			file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, c);
+		};
+		for (uint32_t row = 0; row < rows; row++) {
+			for (uint32_t column = 0; column < columns; column++) {
+				if (row > 0) {
+					face(index(row, column), index(row, column + 1), index(row + 1, column));
+				}
+				if (row < rows - 1) {
+					face(index(row, column + 1), index(row + 1, column + 1), index(row + 1, column));
+				}
+			}
+		}
+
+		if (!file) {
+			throw std::runtime_error("failed to write mesh " + full_path + "!");
+		}
+		return mesh_path;
+	}
+
+	std::string StressSceneGenerator::writeTexture(const StressSceneParameters &parameters,
+												   uint32_t texture_index) const {
+		const std::string texture_path =
+				generatedPath("textures", std::format("stress_texture_{}_{}.png", parameters.seed, texture_index));
+		const std::string full_path = resources_dir + "/" + texture_path;
+		if (std::filesystem::exists(full_path)) {
+			return texture_path;
+		}
+
+		// checker board with two random colors and a random cell size
+		std::mt19937 random(parameters.seed * 104729 + texture_index);
+		std::uniform_int_distribution<uint32_t> channel(0, 255);
+		const std::array<uint8_t, 3> colors[2] = {
+				{static_cast<uint8_t>(channel(random)), static_cast<uint8_t>(channel(random)),
+				 static_cast<uint8_t>(channel(random))},
+				{static_cast<uint8_t>(channel(random)), static_cast<uint8_t>(channel(random)),
+				 static_cast<uint8_t>(channel(random))}};
+		const uint32_t cell_size = 4u << std::uniform_int_distribution<uint32_t>(0, 4)(random);
+
+		std::vector<uint8_t> pixels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+		for (uint32_t y = 0; y < TEXTURE_SIZE; y++) {
+			for (uint32_t x = 0; x < TEXTURE_SIZE; x++) {
+				const auto &color = colors[(x / cell_size + y / cell_size) % 2];
+				uint8_t *pixel = &pixels[(y * TEXTURE_SIZE + x) * 4];
+				pixel[0] = color[0];
+				pixel[1] = color[1];
+				pixel[2] = color[2];
+				pixel[3] = 255;
+			}
+		}
+
+		if (!stbi_write_png(full_path.c_str(), TEXTURE_SIZE, TEXTURE_SIZE, 4, pixels.data(), TEXTURE_SIZE * 4)) {
+			throw std::runtime_error("failed to write texture " + full_path + "!");
+		}
+		return texture_path;
+	}
+} // namespace RtEngine
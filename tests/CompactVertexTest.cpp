@@ -0,0 +1,90 @@
+#include <CompactVertex.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+using namespace RtEngine;
+
+namespace {
+	// snorm16 octahedral stays below 0.004 deg, the tangent gives up one bit of x for the bitangent sign
+	constexpr float MAX_NORMAL_ERROR_DEG = 0.005f;
+	constexpr float MAX_TANGENT_ERROR_DEG = 0.01f;
+	// half floats have 11 significant bits, uvs in [-4, 4] stay within 2^-9
+	constexpr float MAX_UV_ERROR = 1.0f / 512.0f;
+	constexpr uint32_t SAMPLE_COUNT = 100000;
+
+	// acos loses too much precision close to 1 for errors this small
+	float angleDegrees(const glm::vec3 &a, const glm::vec3 &b) {
+		return glm::degrees(std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)));
+	}
+
+	glm::vec3 randomDirection(std::mt19937 &rng) {
+		std::normal_distribution<float> dist;
+		glm::vec3 v;
+		do {
+			v = glm::vec3(dist(rng), dist(rng), dist(rng));
+		} while (glm::length(v) < 1e-6f);
+		return glm::normalize(v);
+	}
+} // namespace
+
+int main() {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> uv_dist(-4.0f, 4.0f);
+
+	// the axes and octahedron edges are the usual trouble spots, test them explicitly
+	std::vector<glm::vec3> directions = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1},
+										 {0, 0, -1}, {1, 1, 0}, {-1, 0, -1}, {0, -1, -1}, {1, -1, -1}};
+	for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+		directions.push_back(randomDirection(rng));
+	}
+
+	float max_normal_error = 0.0f, max_tangent_error = 0.0f, max_uv_error = 0.0f;
+	uint32_t sign_errors = 0;
+	for (uint32_t i = 0; i < directions.size(); i++) {
+		Vertex vertex{};
+		vertex.pos = glm::vec3(i, -static_cast<float>(i), 0.5f);
+		vertex.normal = directions[i];
+		vertex.tangent = glm::vec4(directions[(i + 1) % directions.size()], i % 2 == 0 ? 1.0f : -1.0f);
+		vertex.texCoord = glm::vec3(uv_dist(rng), uv_dist(rng), 0.0f);
+
+		const Vertex decoded = CompactVertexAttributes::encode(vertex).decode(vertex.pos);
+		if (decoded.pos != vertex.pos) {
+			spdlog::error("Position of vertex {} changed in the round trip", i);
+			return EXIT_FAILURE;
+		}
+		max_normal_error = std::max(max_normal_error, angleDegrees(vertex.normal, decoded.normal));
+		max_tangent_error = std::max(max_tangent_error,
+									 angleDegrees(glm::vec3(vertex.tangent), glm::vec3(decoded.tangent)));
+		max_uv_error = std::max(max_uv_error, glm::length(glm::vec2(vertex.texCoord - decoded.texCoord)));
+		if (decoded.tangent.w != vertex.tangent.w) {
+			sign_errors++;
+		}
+	}
+
+	spdlog::info("Compact vertex round trip over {} vertices: normal {:.5f} deg, tangent {:.5f} deg, uv {:.6f}",
+				 directions.size(), max_normal_error, max_tangent_error, max_uv_error);
+
+	bool passed = true;
+	if (max_normal_error > MAX_NORMAL_ERROR_DEG) {
+		spdlog::error("Normal error exceeds {} deg", MAX_NORMAL_ERROR_DEG);
+		passed = false;
+	}
+	if (max_tangent_error > MAX_TANGENT_ERROR_DEG) {
+		spdlog::error("Tangent error exceeds {} deg", MAX_TANGENT_ERROR_DEG);
+		passed = false;
+	}
+	if (sign_errors > 0) {
+		spdlog::error("{} tangents lost the sign of their bitangent", sign_errors);
+		passed = false;
+	}
+	if (max_uv_error > MAX_UV_ERROR) {
+		spdlog::error("Uv error exceeds {}", MAX_UV_ERROR);
+		passed = false;
+	}
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}